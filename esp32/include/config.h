@@ -4,6 +4,12 @@
 // Serial communication
 #define SERIAL_BAUDRATE 115200
 #define SERIAL_TIMEOUT 1000  // milliseconds
+#define SERIAL_RX_BUFFER_SIZE 1024   // UART driver RX ring (bytes), drained in bulk by the comms task
+#define SERIAL_RX_CHUNK_SIZE 64      // Bytes copied out of the UART driver per readBytes() call
+#define SERIAL_MAX_LINE_LENGTH 256   // Longest accepted command line; longer lines are discarded
+#define SERIAL_TX_RING_SIZE 4096     // Outgoing bytes queued for the TX task (power of two)
+#define SERIAL_TX_RESPONSE_RESERVE 1024  // TX ring space telemetry and dumps leave free for responses
+#define SERIAL_RESPONSE_VERBOSE 0    // 1 = add "message"/"detail" debug text to JSON responses
 
 // Motor driver pins (BTS7960)
 // BTS7960 uses: PWM for speed, R_EN and L_EN for direction
@@ -29,33 +35,160 @@
 #define I2C_SCL 22
 #define I2C_FREQ 400000  // 400kHz I2C speed
 
+// IMU acquisition (MPU6050)
+// FIFO mode: sensor samples into its hardware FIFO; a background task on core 0
+// drains it over I2C so the control task only copies the latest averages.
+#define IMU_USE_FIFO 1              // 1 = hardware FIFO + acquisition task, 0 = Adafruit getEvent per tick
+#define IMU_I2C_ADDRESS 0x68
+#define IMU_SAMPLE_RATE_HZ 1000     // 1 kHz / (1 + SMPLRT_DIV) with DLPF enabled (max 1000)
+#define IMU_DLPF_CFG 2              // MPU6050 DLPF: 2 = 94 Hz accel / 98 Hz gyro bandwidth
+#define IMU_ACQ_TASK_CORE 0
+#define IMU_ACQ_TASK_PRIORITY 3     // Above comms: FIFO must be drained before it overflows
+#define IMU_ACQ_TASK_STACK_SIZE 3072
+#define IMU_STALE_TIMEOUT_US 20000  // update() fails if no new sample for this long
+#define IMU_MAX_AVERAGED_SAMPLES (IMU_SAMPLE_RATE_HZ / 10)  // 100 ms: an older backlog is dropped, not averaged
+
+// Pitch estimator: complementary filter (fixed alpha) or two-state Kalman filter (pitch + gyro bias)
+#define IMU_ESTIMATOR_COMPLEMENTARY 0
+#define IMU_ESTIMATOR_KALMAN 1
+#define IMU_ESTIMATOR IMU_ESTIMATOR_KALMAN
+#define IMU_COMPLEMENTARY_ALPHA 0.98   // Gyro weight per update (complementary filter)
+#define IMU_KALMAN_Q_ANGLE 0.002       // Pitch process noise (deg^2/s)
+#define IMU_KALMAN_Q_BIAS 0.00005      // Gyro bias random walk ((deg/s)^2/s)
+#define IMU_KALMAN_R_MEASURE 0.1       // Accelerometer pitch noise (deg^2)
+
+// IMU calibration (pitch offset + gyro bias), kept in NVS so warm boots skip it
+#define IMU_CALIBRATION_NVS_NAMESPACE "imu"
+#define IMU_CALIBRATION_UPDATES 100        // Updates averaged (one per BALANCE_LOOP_DT: 1 s)
+#define IMU_CALIBRATION_MAX_GYRO_STD 0.5   // deg/s: more spread (pitch or yaw rate) means the robot moved
+#define IMU_CALIBRATION_MAX_ANGLE_STD 0.5  // deg
+#define IMU_CALIBRATION_ATTEMPTS 3         // Boot gives up (uncalibrated) after this many
+#define IMU_CALIBRATION_TEMP_TOLERANCE 10.0  // deg C: stored calibration older than this drift is redone
+
 // PID controller parameters (tune these for your robot)
 // Start with KP only, then add KD, finally KI
-#define KP 40.0   // Proportional gain
-#define KI 0.5    // Integral gain
-#define KD 2.0    // Derivative gain
+// Output is normalized motor command (fraction of full duty) per degree;
+// these are 40 / 0.5 / 2.0 on the former 8-bit (+/-255) scale.
+// KD sign: until the D term was corrected (PidKernel::compute), positive KD was
+// anti-damping (it pushed the robot further the way it was falling). Gains tuned
+// on hardware before that change must be re-checked, KD especially.
+#define KP 0.157    // Proportional gain
+#define KI 0.00196  // Integral gain
+#define KD 0.00784  // Derivative gain
+
+// Gain scheduling: the balance PID interpolates KP/KI/KD over |wheel speed| (m/s).
+// Default table is the single point above; edit live with the "gains" command.
+#define GAIN_SCHEDULE_MAX_POINTS 4
+#define GAIN_SCHEDULE_NVS_NAMESPACE "gains"  // NVS namespace for saved tables (loaded at boot)
+
+// Relay autotune ("autotune" command): relay on tilt (plus Kd damping) => Ku, Tu => Ziegler-Nichols gains
+#define AUTOTUNE_RELAY_AMPLITUDE 0.25  // Normalized motor output of the relay
+#define AUTOTUNE_HYSTERESIS 0.5        // degrees (relay switching band, rejects IMU noise)
+#define AUTOTUNE_MAX_TILT 10.0         // degrees from BALANCE_ANGLE_OFFSET: abort beyond
+#define AUTOTUNE_SETTLE_CYCLES 2       // Oscillation cycles discarded before measuring
+#define AUTOTUNE_MEASURE_CYCLES 4      // Cycles averaged for Ku and Tu
+#define AUTOTUNE_TIMEOUT_S 15          // Abort if the measurement has not finished by then
 
 // Balance controller settings
 #define BALANCE_LOOP_FREQ 100  // Hz (10ms period) - CRITICAL: Must maintain this frequency
+#define BALANCE_LOOP_PERIOD_US (1000000UL / BALANCE_LOOP_FREQ)  // Control tick period (microseconds)
+#define BALANCE_LOOP_DT (1.0f / BALANCE_LOOP_FREQ)  // Fixed controller timestep (seconds)
 #define BALANCE_ANGLE_OFFSET 0.0  // degrees (calibrated offset)
 #define MAX_TILT_ANGLE 45.0  // degrees (max acceptable tilt)
 #define FALL_DETECTION_THRESHOLD 40.0  // degrees (emergency stop: isBalanced() uses this)
 #define INTEGRAL_LIMIT 50.0  // integral windup clamp (tune if needed)
+#define CONTROL_USE_FIXED_POINT 0  // 1 = Q16.16 integer pitch filter + PID, 0 = float (same templated code)
+
+// Setpoint trajectory (normalized motor output, per second): commands set targets, setpoints ramp to them.
+// Jerk-limited S-curve; a jerk limit of 0 gives a plain trapezoidal (rate-limited) ramp.
+#define VELOCITY_MAX_ACCEL 1.18    // 1/s: 0 -> full speed in ~0.85 s
+#define VELOCITY_MAX_JERK 5.9      // 1/s^2
+#define ROTATION_MAX_ACCEL 1.96
+#define ROTATION_MAX_JERK 11.8
+
+// Cascaded outer loop: wheel velocity/position (encoders) -> target tilt for the pitch PID.
+// 0 = legacy open loop (velocity setpoint added to the motor output).
+#define VELOCITY_LOOP_ENABLED 1
+#define VELOCITY_LOOP_DECIMATION 5      // Outer loop runs every 5th control tick (20 Hz)
+#define VELOCITY_FULL_SCALE_MPS 0.8     // Wheel speed commanded by a 1.0 velocity setpoint (m/s)
+#define VELOCITY_KP 6.0                 // deg of tilt per m/s of speed error
+#define VELOCITY_KI 2.0                 // deg of tilt per m of accumulated speed error
+#define VELOCITY_INTEGRAL_LIMIT 1.5     // m (integral windup clamp)
+#define POSITION_KP 1.5                 // m/s per m of drift while holding station
+#define VELOCITY_LOOP_MAX_TILT 8.0      // deg (target tilt clamp)
+
+// FreeRTOS task layout (dual-core ESP32)
+// Core 1: balance control task only (esp_timer notifies it every control tick)
+// Core 0: serial command handling and telemetry
+#define CONTROL_TASK_CORE 1
+#define CONTROL_TASK_PRIORITY (configMAX_PRIORITIES - 1)  // Highest application priority
+#define CONTROL_TASK_STACK_SIZE 4096
+#define COMMS_TASK_CORE 0
+#define COMMS_TASK_PRIORITY 2
+#define COMMS_TASK_STACK_SIZE 8192
+#define TX_TASK_CORE 0
+#define TX_TASK_PRIORITY 1                // Lowest: only copies queued bytes into the UART driver
+#define TX_TASK_STACK_SIZE 2048
+#define TX_TASK_IDLE_MS 10                // Wake-up period when no write notifies the task
+
+// Telemetry stream (binary frames, see telemetry/telemetry.h)
+#define TELEMETRY_RING_SIZE 64            // Samples buffered between control and drain tasks (power of two)
+#define TELEMETRY_DEFAULT_DECIMATION 0    // 0 = off until the "telemetry" command enables it
+#define TELEMETRY_DRAIN_PERIOD_MS 20
+#define TELEMETRY_TASK_CORE 0
+#define TELEMETRY_TASK_PRIORITY 1         // Below comms: commands are never delayed by telemetry
+#define TELEMETRY_TASK_STACK_SIZE 3072
+
+// Flight recorder (post-mortem window, see telemetry/flight_recorder.h)
+#define FLIGHT_RECORDER_SAMPLES 300       // Control ticks kept (3 s at BALANCE_LOOP_FREQ)
+#define FLIGHT_RECORDER_FILE "/flight.bin"  // LittleFS path of the persisted window
+
+// Log replay (recorded telemetry through the controller, see replay/log_replay.h)
+#define REPLAY_QUEUE_SIZE 128             // Samples buffered between comms and control tasks (power of two)
+#define REPLAY_SAMPLES_PER_TICK 64        // Replayed per control tick at most (motors are off while replaying)
+#define REPLAY_TOLERANCE 0.001            // |replayed - logged| motor output counted as a mismatch above this
 
 // Motor control settings
-#define MAX_MOTOR_SPEED 255
-#define DEFAULT_MOTOR_SPEED 102  // 0.4 * 255
-#define MIN_MOTOR_SPEED 50       // Minimum speed for reliable movement
+// Motor commands are normalized (-1.0 to 1.0 = full reverse to full forward) and
+// scaled to the active LEDC duty resolution by MotorDriver
+#define MAX_MOTOR_OUTPUT 1.0
 #define PWM_FREQUENCY 20000       // 20kHz PWM frequency for BTS7960
+#define PWM_RESOLUTION_BITS 11    // Duty steps = 2^bits; PWM_FREQUENCY * 2^bits must not exceed 80 MHz (APB)
+
+// Motor compensation (motor_control/motor_compensation.h): calibrated duty per |command|,
+// per motor and direction, so equal commands give equal wheel speeds past the deadband
+#define MOTOR_COMPENSATION_POINTS 9          // Breakpoints over |command| 0..1 (uniform; point 0 = deadband duty)
+#define MOTOR_COMPENSATION_RAMP 0.01         // |command| over which the duty ramps from 0 to the deadband (continuous at zero)
+#define MOTOR_COMPENSATION_NVS_NAMESPACE "motor_cal"  // Saved tables, loaded at boot
+
+// Motor calibration sweep ("motor_cal" command, wheels off the ground; motor_control/motor_calibrator.h)
+#define MOTOR_CALIBRATION_STEPS 20           // Duty steps per direction (deadband resolution 1/STEPS)
+#define MOTOR_CALIBRATION_SETTLE_MS 250      // Held at each duty before measuring
+#define MOTOR_CALIBRATION_MEASURE_MS 500     // Encoder travel window per step
+#define MOTOR_CALIBRATION_MIN_VELOCITY 2.0   // pulses/s: slower counts as stalled (deadband)
 
 // Encoder settings
 #define ENCODER_PULSES_PER_REV 8  // Low-res: 8 pulses/rev (encoder on output shaft)
 // OR #define ENCODER_PULSES_PER_REV 948  // High-res: 948 pulses/rev (encoder on motor shaft)
+#define ENCODER_USE_PCNT 0                  // 1 = hardware quadrature (PCNT), for the 948-PPR encoders
+#define ENCODER_LEFT_PCNT_UNIT 0
+#define ENCODER_RIGHT_PCNT_UNIT 1
+#define ENCODER_PCNT_LIMIT 30000            // Hardware counter wraps into the 64-bit total here
+#define ENCODER_PCNT_FILTER 100             // Glitch filter, APB cycles (80 MHz): 1.25 us
+#define ENCODER_VELOCITY_MIN_EDGES 4        // Edges per velocity window at speed (one quadrature cycle)
+#define ENCODER_VELOCITY_MAX_WINDOW_US 50000 // Slow wheel: accept fewer edges once the window is this old
+#define ENCODER_VELOCITY_TIMEOUT_US 250000   // No edge for this long: velocity is zero
 #define WHEEL_DIAMETER_MM 65      // Dagu RS034 wheel diameter
 #define WHEELBASE_MM 150          // Distance between wheels (adjust for your chassis)
 
+// Odometry (odometry/odometry.h): pose from encoder deltas every control tick
+#define ODOMETRY_GYRO_WEIGHT 0.995  // Heading: gyro yaw weight per tick vs encoder heading (0 = encoders only; 0.995 = 2 s at 100 Hz)
+#define IMU_YAW_SIGN 1              // +1 if the MPU6050 Z axis points up (counter-clockwise positive), -1 if mounted flipped
+
 // Command execution
-#define COMMAND_QUEUE_SIZE 50
+#define COMMAND_QUEUE_SIZE 64     // Power of two (lock-free SPSC ring)
 #define COMMAND_TIMEOUT_MS 5000   // Timeout for command execution
+#define PROGRAM_MAX_STEPS 16      // Segments in an uploaded "program" (4 bytes each, hex: fits one command line)
+#define PROGRAM_STAGING_SLOTS 4   // Uploaded programs queued ahead of their start (power of two)
 
 #endif // CONFIG_H
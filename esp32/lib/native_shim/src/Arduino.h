@@ -0,0 +1,104 @@
+#ifndef NATIVE_SHIM_ARDUINO_H
+#define NATIVE_SHIM_ARDUINO_H
+
+/**
+ * Minimal Arduino-ESP32 API for host builds (env:native).
+ * Only what the firmware under test uses: timing from a fake clock
+ * (native_shim.h), pin levels with CHANGE interrupts, and a Serial that
+ * records output.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#define IRAM_ATTR
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define CHANGE 0x03
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+// Same definition as the Arduino core (a macro: arguments may be evaluated twice)
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+using std::min;
+using std::max;
+using std::isnan;
+using std::isinf;
+
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+double ledcSetup(uint8_t channel, double frequency, uint8_t resolution_bits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t byte) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* buffer, size_t size) { return write(reinterpret_cast<const uint8_t*>(buffer), size); }
+    size_t print(const char* text);
+    size_t print(char c);
+    size_t print(int value);
+    size_t print(unsigned int value);
+    size_t print(long value);
+    size_t print(unsigned long value);
+    size_t print(double value, int digits = 2);
+    size_t println();
+    size_t println(const char* text);
+    size_t println(int value);
+    size_t println(unsigned long value);
+    size_t println(double value, int digits = 2);
+    size_t printf(const char* format, ...);
+};
+
+/**
+ * Serial stand-in: output is appended to a fixed capture buffer
+ * (native_shim::serialOutput()), never allocated; input is empty.
+ */
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    void flush() {}
+    void setRxBufferSize(size_t size) { (void)size; }
+    void setTxBufferSize(size_t size) { (void)size; }
+    void setTimeout(unsigned long ms) { (void)ms; }
+    int available() { return 0; }
+    int read() { return -1; }
+    int availableForWrite();
+    operator bool() const { return true; }
+    using Print::write;
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+};
+
+extern HardwareSerial Serial;
+
+#endif // NATIVE_SHIM_ARDUINO_H
@@ -0,0 +1,37 @@
+#ifndef NATIVE_SHIM_LITTLEFS_H
+#define NATIVE_SHIM_LITTLEFS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * LittleFS stand-in: files in per-thread memory (cleared by native_shim::reset()).
+ */
+class File {
+public:
+    File() : path_(nullptr), position_(0), writable_(false) {}
+    explicit operator bool() const { return path_ != nullptr; }
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t read(uint8_t* buffer, size_t size);
+    size_t size();
+    void close() { path_ = nullptr; }
+
+private:
+    friend class LittleFSFS;
+    const char* path_;  // Key in the in-memory file table
+    size_t position_;
+    bool writable_;
+};
+
+class LittleFSFS {
+public:
+    bool begin(bool format_on_fail = false, const char* base_path = "/littlefs");
+    void end() {}
+    File open(const char* path, const char* mode = "r");
+    bool exists(const char* path);
+    bool remove(const char* path);
+};
+
+extern LittleFSFS LittleFS;
+
+#endif // NATIVE_SHIM_LITTLEFS_H
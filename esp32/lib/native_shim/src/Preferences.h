@@ -0,0 +1,31 @@
+#ifndef NATIVE_SHIM_PREFERENCES_H
+#define NATIVE_SHIM_PREFERENCES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * NVS stand-in: namespaces and keys in per-thread memory
+ * (cleared by native_shim::reset()).
+ */
+class Preferences {
+public:
+    Preferences();
+    bool begin(const char* name, bool read_only = false);
+    void end();
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+    size_t putBytes(const char* key, const void* value, size_t length);
+    size_t getBytes(const char* key, void* buffer, size_t length);
+    size_t getBytesLength(const char* key);
+    size_t putUInt(const char* key, uint32_t value);
+    uint32_t getUInt(const char* key, uint32_t default_value = 0);
+
+private:
+    char name_[16];
+    bool open_;
+    bool read_only_;
+};
+
+#endif // NATIVE_SHIM_PREFERENCES_H
@@ -0,0 +1,17 @@
+#ifndef NATIVE_SHIM_LEDC_H
+#define NATIVE_SHIM_LEDC_H
+
+#include <stdint.h>
+#include "../esp_timer.h"
+
+typedef enum { LEDC_HIGH_SPEED_MODE = 0, LEDC_LOW_SPEED_MODE = 1, LEDC_SPEED_MODE_MAX } ledc_mode_t;
+typedef enum {
+    LEDC_CHANNEL_0 = 0, LEDC_CHANNEL_1, LEDC_CHANNEL_2, LEDC_CHANNEL_3,
+    LEDC_CHANNEL_4, LEDC_CHANNEL_5, LEDC_CHANNEL_6, LEDC_CHANNEL_7, LEDC_CHANNEL_MAX
+} ledc_channel_t;
+
+// Duty is recorded per channel (native_shim::ledcDuty)
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty);
+esp_err_t ledc_update_duty(ledc_mode_t mode, ledc_channel_t channel);
+
+#endif // NATIVE_SHIM_LEDC_H
@@ -0,0 +1,42 @@
+#ifndef NATIVE_SHIM_PCNT_H
+#define NATIVE_SHIM_PCNT_H
+
+#include <stdint.h>
+#include "../esp_timer.h"
+
+typedef enum { PCNT_UNIT_0, PCNT_UNIT_1, PCNT_UNIT_2, PCNT_UNIT_3, PCNT_UNIT_MAX = 8 } pcnt_unit_t;
+typedef enum { PCNT_CHANNEL_0, PCNT_CHANNEL_1 } pcnt_channel_t;
+typedef enum { PCNT_COUNT_DIS, PCNT_COUNT_INC, PCNT_COUNT_DEC } pcnt_count_mode_t;
+typedef enum { PCNT_MODE_KEEP, PCNT_MODE_REVERSE, PCNT_MODE_DISABLE } pcnt_ctrl_mode_t;
+typedef enum {
+    PCNT_EVT_THRES_1 = 0x04, PCNT_EVT_THRES_0 = 0x08, PCNT_EVT_L_LIM = 0x10,
+    PCNT_EVT_H_LIM = 0x20, PCNT_EVT_ZERO = 0x40
+} pcnt_evt_type_t;
+
+typedef struct {
+    int pulse_gpio_num;
+    int ctrl_gpio_num;
+    pcnt_ctrl_mode_t lctrl_mode;
+    pcnt_ctrl_mode_t hctrl_mode;
+    pcnt_count_mode_t pos_mode;
+    pcnt_count_mode_t neg_mode;
+    int16_t counter_h_lim;
+    int16_t counter_l_lim;
+    pcnt_unit_t unit;
+    pcnt_channel_t channel;
+} pcnt_config_t;
+
+// Counter values are set by the test (native_shim::setEncoderCount); limits never fire
+esp_err_t pcnt_unit_config(const pcnt_config_t* config);
+esp_err_t pcnt_get_counter_value(pcnt_unit_t unit, int16_t* count);
+esp_err_t pcnt_counter_pause(pcnt_unit_t unit);
+esp_err_t pcnt_counter_resume(pcnt_unit_t unit);
+esp_err_t pcnt_counter_clear(pcnt_unit_t unit);
+esp_err_t pcnt_set_filter_value(pcnt_unit_t unit, uint16_t value);
+esp_err_t pcnt_filter_enable(pcnt_unit_t unit);
+esp_err_t pcnt_event_enable(pcnt_unit_t unit, pcnt_evt_type_t event);
+esp_err_t pcnt_get_event_status(pcnt_unit_t unit, uint32_t* status);
+esp_err_t pcnt_isr_service_install(int flags);
+esp_err_t pcnt_isr_handler_add(pcnt_unit_t unit, void (*handler)(void* arg), void* arg);
+
+#endif // NATIVE_SHIM_PCNT_H
@@ -0,0 +1,30 @@
+#ifndef NATIVE_SHIM_ESP_TIMER_H
+#define NATIVE_SHIM_ESP_TIMER_H
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#define ESP_FAIL -1
+#endif
+
+typedef struct esp_timer* esp_timer_handle_t;
+typedef enum { ESP_TIMER_TASK } esp_timer_dispatch_t;
+typedef struct {
+    void (*callback)(void* arg);
+    void* arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char* name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+// Timers are never fired on the host: tests call the tick function themselves
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+
+// Fake clock (native_shim::setMicros / advanceMicros)
+int64_t esp_timer_get_time();
+
+#endif // NATIVE_SHIM_ESP_TIMER_H
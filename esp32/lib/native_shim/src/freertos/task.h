@@ -0,0 +1,24 @@
+#ifndef NATIVE_SHIM_TASK_H
+#define NATIVE_SHIM_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* arg);
+
+/**
+ * There is no scheduler on the host: tasks are not started and *handle is
+ * set to nullptr, so components fall back to their pre-task paths
+ * (e.g. TxRing writes straight to Serial).
+ */
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stack_depth, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);  // Advances the fake clock
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_woken);
+TickType_t xTaskGetTickCount();
+BaseType_t xPortGetCoreID();
+
+#endif // NATIVE_SHIM_TASK_H
@@ -0,0 +1,455 @@
+#include "native_shim.h"
+#include "Arduino.h"
+#include "Preferences.h"
+#include "LittleFS.h"
+#include "driver/ledc.h"
+#include "driver/pcnt.h"
+#include "soc/gpio_struct.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// ===== State =====
+// Per thread: each thread is its own simulated board (parallel simulations share nothing)
+
+typedef std::map<std::string, std::vector<uint8_t> > BlobTable;
+
+static const int PIN_COUNT = 40;
+
+struct PinInterrupt {
+    void (*handler)(void*);
+    void* arg;
+};
+
+static thread_local int64_t now_us = 0;
+static thread_local int16_t encoder_counts[PCNT_UNIT_MAX] = {};
+static thread_local uint32_t ledc_duty[LEDC_SPEED_MODE_MAX][LEDC_CHANNEL_MAX] = {};
+static thread_local uint8_t pin_levels[PIN_COUNT] = {};
+static thread_local PinInterrupt pin_interrupts[PIN_COUNT] = {};
+static thread_local char serial_capture[native_shim::SERIAL_CAPTURE_SIZE + 1];
+static thread_local size_t serial_length = 0;
+
+// Function-local so they exist before any static constructor in the firmware uses them
+static BlobTable& nvs() {
+    static thread_local BlobTable table;  // Key: "<namespace>/<key>"
+    return table;
+}
+
+static BlobTable& files() {
+    static thread_local BlobTable table;  // Key: path
+    return table;
+}
+
+HardwareSerial Serial;
+LittleFSFS LittleFS;
+thread_local volatile gpio_dev_t GPIO;
+
+namespace native_shim {
+
+void reset() {
+    now_us = 0;
+    memset(encoder_counts, 0, sizeof(encoder_counts));
+    memset(ledc_duty, 0, sizeof(ledc_duty));
+    memset(pin_levels, 0, sizeof(pin_levels));
+    memset(pin_interrupts, 0, sizeof(pin_interrupts));
+    clearSerialOutput();
+    nvs().clear();
+    files().clear();
+}
+
+void setMicros(int64_t value) {
+    now_us = value;
+}
+
+void advanceMicros(int64_t delta_us) {
+    now_us += delta_us;
+}
+
+void setEncoderCount(int unit, int16_t count) {
+    if (unit >= 0 && unit < PCNT_UNIT_MAX) {
+        encoder_counts[unit] = count;
+    }
+}
+
+void setPin(int pin, int level) {
+    if (pin < 0 || pin >= PIN_COUNT) {
+        return;
+    }
+    uint8_t value = level ? HIGH : LOW;
+    if (pin_levels[pin] == value) {
+        return;
+    }
+    pin_levels[pin] = value;
+    if (pin_interrupts[pin].handler != nullptr) {
+        pin_interrupts[pin].handler(pin_interrupts[pin].arg);  // CHANGE: runs inline, like an ISR
+    }
+}
+
+uint32_t ledcDuty(int mode, int channel) {
+    if (mode < 0 || mode >= LEDC_SPEED_MODE_MAX || channel < 0 || channel >= LEDC_CHANNEL_MAX) {
+        return 0;
+    }
+    return ledc_duty[mode][channel];
+}
+
+const char* serialOutput() {
+    serial_capture[serial_length] = '\0';
+    return serial_capture;
+}
+
+size_t serialOutputLength() {
+    return serial_length;
+}
+
+void clearSerialOutput() {
+    serial_length = 0;
+}
+
+}  // namespace native_shim
+
+// ===== Arduino core =====
+
+unsigned long millis() {
+    return (unsigned long)(now_us / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)now_us;
+}
+
+void delay(unsigned long ms) {
+    now_us += (int64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+    now_us += us;
+}
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    native_shim::setPin(pin, value);
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < PIN_COUNT ? pin_levels[pin] : LOW;
+}
+
+int digitalPinToInterrupt(uint8_t pin) { return pin; }
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int) {
+    // Every mode is treated as CHANGE (the only mode the firmware uses)
+    if (pin < PIN_COUNT) {
+        pin_interrupts[pin].handler = handler;
+        pin_interrupts[pin].arg = arg;
+    }
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin < PIN_COUNT) {
+        pin_interrupts[pin].handler = nullptr;
+    }
+}
+
+double ledcSetup(uint8_t channel, double frequency, uint8_t resolution_bits) {
+    if (channel >= 16 || resolution_bits == 0 || resolution_bits > 20) {
+        return 0.0;  // Same failure value as the core
+    }
+    return frequency;
+}
+
+void ledcAttachPin(uint8_t, uint8_t) {}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+    if (channel < LEDC_CHANNEL_MAX) {
+        ledc_duty[LEDC_HIGH_SPEED_MODE][channel] = duty;
+    }
+}
+
+// ===== Print / Serial =====
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (written < size && write(buffer[written])) {
+        written++;
+    }
+    return written;
+}
+
+size_t Print::print(const char* text) {
+    return write(text, strlen(text));
+}
+
+size_t Print::print(char c) {
+    return write((uint8_t)c);
+}
+
+size_t Print::printf(const char* format, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length < 0) {
+        return 0;
+    }
+    return write(text, min((size_t)length, sizeof(text) - 1));
+}
+
+size_t Print::print(int value) { return printf("%d", value); }
+size_t Print::print(unsigned int value) { return printf("%u", value); }
+size_t Print::print(long value) { return printf("%ld", value); }
+size_t Print::print(unsigned long value) { return printf("%lu", value); }
+size_t Print::print(double value, int digits) { return printf("%.*f", digits, value); }
+size_t Print::println() { return print("\r\n"); }
+size_t Print::println(const char* text) { return print(text) + println(); }
+size_t Print::println(int value) { return print(value) + println(); }
+size_t Print::println(unsigned long value) { return print(value) + println(); }
+size_t Print::println(double value, int digits) { return print(value, digits) + println(); }
+
+int HardwareSerial::availableForWrite() {
+    return 128;  // Hardware FIFO size: TxRing::drain() hands over chunks like on the device
+}
+
+size_t HardwareSerial::write(uint8_t byte) {
+    return write(&byte, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    size_t room = native_shim::SERIAL_CAPTURE_SIZE - serial_length;
+    size_t copied = min(size, room);
+    memcpy(serial_capture + serial_length, buffer, copied);
+    serial_length += copied;
+    return size;  // The UART accepts everything; the capture just stops growing
+}
+
+// ===== esp_timer =====
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t*, esp_timer_handle_t* handle) {
+    *handle = nullptr;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t, uint64_t) { return ESP_OK; }
+esp_err_t esp_timer_stop(esp_timer_handle_t) { return ESP_OK; }
+
+int64_t esp_timer_get_time() {
+    return now_us;
+}
+
+// ===== FreeRTOS =====
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t,
+                                   TaskHandle_t* handle, BaseType_t) {
+    if (handle != nullptr) {
+        *handle = nullptr;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t) {}
+
+void vTaskDelay(TickType_t ticks) {
+    now_us += (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
+void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t* higher_priority_woken) {
+    if (higher_priority_woken != nullptr) {
+        *higher_priority_woken = pdFALSE;
+    }
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)(now_us / (1000 * portTICK_PERIOD_MS));
+}
+
+BaseType_t xPortGetCoreID() { return 1; }
+
+// ===== LEDC / PCNT =====
+
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty) {
+    if (mode >= LEDC_SPEED_MODE_MAX || channel >= LEDC_CHANNEL_MAX) {
+        return ESP_FAIL;
+    }
+    ledc_duty[mode][channel] = duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t, ledc_channel_t) { return ESP_OK; }
+
+esp_err_t pcnt_unit_config(const pcnt_config_t*) { return ESP_OK; }
+
+esp_err_t pcnt_get_counter_value(pcnt_unit_t unit, int16_t* count) {
+    if (unit >= PCNT_UNIT_MAX) {
+        return ESP_FAIL;
+    }
+    *count = encoder_counts[unit];
+    return ESP_OK;
+}
+
+esp_err_t pcnt_counter_pause(pcnt_unit_t) { return ESP_OK; }
+esp_err_t pcnt_counter_resume(pcnt_unit_t) { return ESP_OK; }
+
+esp_err_t pcnt_counter_clear(pcnt_unit_t unit) {
+    if (unit < PCNT_UNIT_MAX) {
+        encoder_counts[unit] = 0;
+    }
+    return ESP_OK;
+}
+
+esp_err_t pcnt_set_filter_value(pcnt_unit_t, uint16_t) { return ESP_OK; }
+esp_err_t pcnt_filter_enable(pcnt_unit_t) { return ESP_OK; }
+esp_err_t pcnt_event_enable(pcnt_unit_t, pcnt_evt_type_t) { return ESP_OK; }
+
+esp_err_t pcnt_get_event_status(pcnt_unit_t, uint32_t* status) {
+    *status = 0;
+    return ESP_OK;
+}
+
+esp_err_t pcnt_isr_service_install(int) { return ESP_OK; }
+esp_err_t pcnt_isr_handler_add(pcnt_unit_t, void (*)(void*), void*) { return ESP_OK; }
+
+// ===== Preferences =====
+
+Preferences::Preferences() : open_(false), read_only_(false) {
+    name_[0] = '\0';
+}
+
+static std::string nvsKey(const char* name, const char* key) {
+    return std::string(name) + "/" + key;
+}
+
+bool Preferences::begin(const char* name, bool read_only) {
+    if (name == nullptr || strlen(name) >= sizeof(name_)) {
+        return false;  // NVS namespace names are at most 15 characters
+    }
+    strcpy(name_, name);
+    open_ = true;
+    read_only_ = read_only;
+    return true;
+}
+
+void Preferences::end() {
+    open_ = false;
+}
+
+bool Preferences::clear() {
+    if (!open_ || read_only_) {
+        return false;
+    }
+    std::string prefix = std::string(name_) + "/";
+    BlobTable& table = nvs();
+    for (BlobTable::iterator it = table.begin(); it != table.end(); ) {
+        if (it->first.compare(0, prefix.size(), prefix) == 0) {
+            it = table.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!open_ || read_only_) {
+        return false;
+    }
+    return nvs().erase(nvsKey(name_, key)) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    return open_ && nvs().count(nvsKey(name_, key)) > 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    if (!open_ || read_only_ || value == nullptr) {
+        return 0;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    nvs()[nvsKey(name_, key)].assign(bytes, bytes + length);
+    return length;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t length) {
+    size_t stored = getBytesLength(key);
+    if (stored == 0 || buffer == nullptr || length < stored) {
+        return 0;  // Like NVS: a short buffer reads nothing
+    }
+    memcpy(buffer, nvs()[nvsKey(name_, key)].data(), stored);
+    return stored;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!open_) {
+        return 0;
+    }
+    BlobTable::const_iterator it = nvs().find(nvsKey(name_, key));
+    return it == nvs().end() ? 0 : it->second.size();
+}
+
+size_t Preferences::putUInt(const char* key, uint32_t value) {
+    return putBytes(key, &value, sizeof(value));
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t default_value) {
+    uint32_t value;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : default_value;
+}
+
+// ===== LittleFS =====
+
+bool LittleFSFS::begin(bool, const char*) {
+    return true;
+}
+
+File LittleFSFS::open(const char* path, const char* mode) {
+    File file;
+    BlobTable& table = files();
+    BlobTable::iterator it = table.find(path);
+    if (mode[0] == 'w') {
+        if (it == table.end()) {
+            it = table.insert(BlobTable::value_type(path, std::vector<uint8_t>())).first;
+        }
+        it->second.clear();
+        file.writable_ = true;
+    } else if (it == table.end()) {
+        return file;  // Not found: evaluates false
+    }
+    file.path_ = it->first.c_str();
+    return file;
+}
+
+bool LittleFSFS::exists(const char* path) {
+    return files().count(path) > 0;
+}
+
+bool LittleFSFS::remove(const char* path) {
+    return files().erase(path) > 0;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (path_ == nullptr || !writable_) {
+        return 0;
+    }
+    std::vector<uint8_t>& data = files()[path_];
+    data.insert(data.end(), buffer, buffer + size);
+    return size;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    if (path_ == nullptr) {
+        return 0;
+    }
+    const std::vector<uint8_t>& data = files()[path_];
+    size_t count = position_ < data.size() ? min(size, data.size() - position_) : 0;
+    memcpy(buffer, data.data() + position_, count);
+    position_ += count;
+    return count;
+}
+
+size_t File::size() {
+    return path_ == nullptr ? 0 : files()[path_].size();
+}
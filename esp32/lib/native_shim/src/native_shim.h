@@ -0,0 +1,46 @@
+#ifndef NATIVE_SHIM_H
+#define NATIVE_SHIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Test controls for the host build (env:native).
+ * The firmware sees these through the Arduino/ESP-IDF stand-ins in this library.
+ *
+ * All state is per thread: each thread is a separate simulated board, so
+ * simulations can run in parallel (sim/sweep_main.cpp) without locking.
+ */
+namespace native_shim {
+
+/**
+ * Clock to 0; Serial capture, encoder counts, PWM duties, pin levels,
+ * interrupt handlers, NVS and files cleared (calling thread only).
+ */
+void reset();
+
+// Fake clock behind millis(), micros(), esp_timer_get_time() (vTaskDelay/delay advance it)
+void setMicros(int64_t now_us);
+void advanceMicros(int64_t delta_us);
+
+// PCNT counter value returned for a unit (16-bit, as the hardware)
+void setEncoderCount(int unit, int16_t count);
+
+// Drive an input pin: a level change runs the handler attached with attachInterruptArg
+void setPin(int pin, int level);
+
+// Last duty written to an LEDC channel
+uint32_t ledcDuty(int mode, int channel);
+
+/**
+ * Serial output since the last clear (NUL-terminated). Capture is a fixed
+ * buffer: output beyond SERIAL_CAPTURE_SIZE is dropped, never allocated.
+ */
+static const size_t SERIAL_CAPTURE_SIZE = 64 * 1024;
+const char* serialOutput();
+size_t serialOutputLength();
+void clearSerialOutput();
+
+}  // namespace native_shim
+
+#endif // NATIVE_SHIM_H
@@ -0,0 +1,18 @@
+#ifndef NATIVE_SHIM_GPIO_STRUCT_H
+#define NATIVE_SHIM_GPIO_STRUCT_H
+
+#include <stdint.h>
+
+// Output set/clear registers only (GPIO0-31 and GPIO32-39); plain per-thread memory on the host
+typedef struct {
+    uint32_t out;
+    uint32_t out_w1ts;
+    uint32_t out_w1tc;
+    union { struct { uint32_t data : 8; }; uint32_t val; } out1;
+    union { struct { uint32_t data : 8; }; uint32_t val; } out1_w1ts;
+    union { struct { uint32_t data : 8; }; uint32_t val; } out1_w1tc;
+} gpio_dev_t;
+
+extern thread_local volatile gpio_dev_t GPIO;
+
+#endif // NATIVE_SHIM_GPIO_STRUCT_H
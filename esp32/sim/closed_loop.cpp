@@ -0,0 +1,200 @@
+#include "closed_loop.h"
+#include <math.h>
+#include <native_shim.h>
+#include "../src/motor_control/motor_mixer.h"
+
+static const float GYRO_BIAS = 1.0f;         // deg/s, left for the Kalman filter to find
+static const float ACCEL_NOISE = 0.01f;      // g, uniform amplitude
+static const float GYRO_NOISE = 0.3f;        // deg/s, uniform amplitude
+static const float RAD_PER_DEG = 0.01745329252f;
+
+SimConfig SimConfig::defaults() {
+    SimConfig config;
+    config.kp = KP;
+    config.ki = KI;
+    config.kd = KD;
+    config.duration = 8.0f;
+    config.initial_pitch = 3.0f;
+    config.push_time = 2.0f;
+    config.push_impulse = 0.15f;
+    config.command_time = 4.0f;
+    config.velocity_command = 0.2f;
+    config.sensor_noise = true;
+    config.seed = 1;
+    config.plant = PlantParameters::rover();
+    return config;
+}
+
+float SimResult::score(const SimResult& result, float duration) {
+    if (result.fell) {
+        return 1000.0f + 100.0f * (duration - result.fall_time);
+    }
+    return result.rms_pitch + 10.0f * result.saturation + result.drift;
+}
+
+void ClosedLoopSim::QuadratureSignal::moveTo(long target) {
+    // Forward Gray sequence (A, B): 00 -> 01 -> 11 -> 10, which EncoderReader decodes as +1 per edge
+    while (count != target) {
+        count += target > count ? 1 : -1;
+        uint8_t phase = (uint8_t)(count & 3);
+        native_shim::setPin(pin_a, phase >= 2);
+        native_shim::setPin(pin_b, phase == 1 || phase == 2);
+    }
+}
+
+ClosedLoopSim::ClosedLoopSim(const SimConfig& config)
+    : config_(config),
+      plant_(config.plant),
+      controller_(config.kp, config.ki, config.kd),
+      left_motor_(MOTOR_LEFT_PWM, MOTOR_LEFT_R_EN, MOTOR_LEFT_L_EN, 0),
+      right_motor_(MOTOR_RIGHT_PWM, MOTOR_RIGHT_R_EN, MOTOR_RIGHT_L_EN, 1),
+      left_encoder_(ENCODER_LEFT_A, ENCODER_LEFT_B),
+      right_encoder_(ENCODER_RIGHT_A, ENCODER_RIGHT_B),
+#if IMU_ESTIMATOR == IMU_ESTIMATOR_KALMAN
+      filter_(IMU_KALMAN_Q_ANGLE, IMU_KALMAN_Q_BIAS, IMU_KALMAN_R_MEASURE, BALANCE_LOOP_DT),
+#else
+      filter_(control_t(IMU_COMPLEMENTARY_ALPHA)),
+#endif
+      noise_state_(config.seed),
+      ticks_(0), control_ticks_(0), balanced_ticks_(0), saturated_ticks_(0), pitch_square_sum_(0.0),
+      max_pitch_(0.0f), pitch_estimate_(0.0f), fell_(false), fall_time_(config.duration) {
+    // Fresh board for this thread, then the same bring-up as setup()
+    native_shim::reset();
+    left_motor_.begin();
+    right_motor_.begin();
+    left_encoder_.begin();
+    right_encoder_.begin();
+    left_signal_ = {ENCODER_LEFT_A, ENCODER_LEFT_B, 0};
+    right_signal_ = {ENCODER_RIGHT_A, ENCODER_RIGHT_B, 0};
+    plant_.reset(config.initial_pitch);
+}
+
+float ClosedLoopSim::noise() {
+    // Uniform [-1, 1] (same LCG as the host tests)
+    noise_state_ = noise_state_ * 1664525u + 1013904223u;
+    return (float)(noise_state_ >> 8) / (float)(1u << 23) - 1.0f;
+}
+
+float ClosedLoopSim::appliedDuty(MotorDriver& motor, int ledc_channel) const {
+    // What the H-bridge sees: the latched duty step, signed by the direction pins
+    float duty = (float)native_shim::ledcDuty(LEDC_HIGH_SPEED_MODE, ledc_channel) /
+                 (float)(1UL << motor.getPwmResolution());
+    return motor.getSpeed() < 0.0f ? -duty : duty;
+}
+
+long ClosedLoopSim::encoderCount(float wheel_travel) const {
+    // Shaft encoders measure the wheel against the body, so body pitch shows up as wheel motion
+    float revolutions = (wheel_travel / config_.plant.wheel_radius - plant_.getPitch() * RAD_PER_DEG) /
+                        (2.0f * (float)PI);
+    return lroundf(revolutions * ENCODER_PULSES_PER_REV);
+}
+
+bool ClosedLoopSim::tick() {
+    if (fell_) {
+        return false;
+    }
+    float time = ticks_ * BALANCE_LOOP_DT;
+    if (config_.push_time >= 0.0f && ticks_ == (int)(config_.push_time * BALANCE_LOOP_FREQ + 0.5f)) {
+        plant_.push(config_.push_impulse);
+    }
+    if (config_.command_time >= 0.0f && ticks_ == (int)(config_.command_time * BALANCE_LOOP_FREQ + 0.5f)) {
+        controller_.setVelocitySetpoint(config_.velocity_command);
+    }
+
+    // IMU: gravity plus the axle acceleration, in the body frame (g, deg/s)
+    float pitch_rad = plant_.getPitch() * RAD_PER_DEG;
+    float accel = plant_.getAcceleration() / config_.plant.gravity;
+    float accel_x = sinf(pitch_rad) + accel * cosf(pitch_rad);
+    float accel_z = cosf(pitch_rad) - accel * sinf(pitch_rad);
+    float gyro = plant_.getPitchRate();
+    if (config_.sensor_noise) {
+        accel_x += ACCEL_NOISE * noise();
+        accel_z += ACCEL_NOISE * noise();
+        gyro += GYRO_BIAS + GYRO_NOISE * noise();
+    }
+    pitch_estimate_ = (float)filter_.update(control_t(accel_x), control_t(accel_z), control_t(gyro),
+                                            control_t(BALANCE_LOOP_DT));
+#if IMU_ESTIMATOR == IMU_ESTIMATOR_KALMAN
+    float angular_velocity = gyro - (float)filter_.bias;  // As IMU::calculatePitch()
+#else
+    float angular_velocity = gyro;
+#endif
+
+    // From here on as balanceTick()
+    left_encoder_.update();
+    right_encoder_.update();
+    float avg_wheel_velocity = (left_encoder_.getVelocity() + right_encoder_.getVelocity()) / 2.0;
+    float avg_wheel_position = (left_encoder_.getPosition() + right_encoder_.getPosition()) / 2.0f;
+    controller_.update(pitch_estimate_, angular_velocity, avg_wheel_velocity, avg_wheel_position);
+
+    WheelSpeeds wheels = mixWheelSpeeds(controller_.getMotorOutput(), controller_.getRotationSetpoint());
+    MotorDriver::setSpeeds(left_motor_, wheels.left, right_motor_, wheels.right);
+    control_ticks_++;
+    if (fabsf(wheels.left) >= MAX_MOTOR_OUTPUT || fabsf(wheels.right) >= MAX_MOTOR_OUTPUT) {
+        saturated_ticks_++;
+    }
+
+    if (!controller_.isBalanced()) {
+        left_motor_.stop();
+        right_motor_.stop();
+        controller_.reset();
+        fell_ = true;
+        fall_time_ = time;
+        return false;
+    }
+
+    float true_pitch = plant_.getPitch();
+    pitch_square_sum_ += (double)true_pitch * true_pitch;
+    max_pitch_ = fmaxf(max_pitch_, fabsf(true_pitch));
+    balanced_ticks_++;
+
+    // Plant to the next tick, encoder edges at sub-tick resolution
+    float left_duty = appliedDuty(left_motor_, 0);
+    float right_duty = appliedDuty(right_motor_, 1);
+    const float dt = BALANCE_LOOP_DT / PLANT_SUBSTEPS;
+    for (int i = 0; i < PLANT_SUBSTEPS; i++) {
+        native_shim::advanceMicros(BALANCE_LOOP_PERIOD_US / PLANT_SUBSTEPS);
+        plant_.step(left_duty, right_duty, dt);
+        left_signal_.moveTo(encoderCount(plant_.getLeftTravel()));
+        right_signal_.moveTo(encoderCount(plant_.getRightTravel()));
+    }
+    ticks_++;
+    return true;
+}
+
+SimResult ClosedLoopSim::run() {
+    int total_ticks = (int)(config_.duration * BALANCE_LOOP_FREQ + 0.5f);
+    while (ticks_ < total_ticks && tick()) {
+    }
+
+    SimResult result;
+    result.fell = fell_;
+    result.fall_time = fall_time_;
+    result.rms_pitch = balanced_ticks_ > 0 ? (float)sqrt(pitch_square_sum_ / balanced_ticks_) : 0.0f;
+    result.max_pitch = fell_ ? fmaxf(max_pitch_, fabsf(plant_.getPitch())) : max_pitch_;
+    result.saturation = control_ticks_ > 0 ? (float)saturated_ticks_ / control_ticks_ : 0.0f;
+    result.drift = fabsf(plant_.getTravel());
+    result.cost = SimResult::score(result, config_.duration);
+    return result;
+}
+
+const PlantModel& ClosedLoopSim::getPlant() const {
+    return plant_;
+}
+
+BalanceController& ClosedLoopSim::getController() {
+    return controller_;
+}
+
+float ClosedLoopSim::getPitchEstimate() const {
+    return pitch_estimate_;
+}
+
+float ClosedLoopSim::getTime() const {
+    return ticks_ * BALANCE_LOOP_DT;
+}
+
+SimResult simulate(const SimConfig& config) {
+    ClosedLoopSim sim(config);
+    return sim.run();
+}
@@ -0,0 +1,143 @@
+#ifndef CLOSED_LOOP_H
+#define CLOSED_LOOP_H
+
+#include <stdint.h>
+#include "plant_model.h"
+#include "../src/balance/balance_controller.h"
+#include "../src/motor_control/motor_driver.h"
+#include "../src/sensors/encoder_reader.h"
+#include "../src/control/control_math.h"
+#include "../include/config.h"
+
+/**
+ * One closed-loop run: scenario, gains and plant.
+ */
+struct SimConfig {
+    float kp;                  // Balance PID gains (config.h scale: normalized output per degree)
+    float ki;
+    float kd;
+    float duration;            // s
+    float initial_pitch;       // deg
+    float push_time;           // s, < 0 = no push
+    float push_impulse;        // N s at the center of mass, positive = forward
+    float command_time;        // s, < 0 = no motion command
+    float velocity_command;    // setVelocitySetpoint() value sent at command_time
+    bool sensor_noise;         // Accelerometer/gyro noise and gyro bias
+    uint32_t seed;             // Noise seed (same seed = same noise, whatever the gains)
+    PlantParameters plant;
+
+    /**
+     * config.h gains, 3 degree initial tilt, a 0.15 N s push at 2 s and a
+     * drive command at 4 s, 8 s in total, with sensor noise.
+     */
+    static SimConfig defaults();
+};
+
+/**
+ * Summary of a run (angles are the true plant pitch, not the estimate).
+ */
+struct SimResult {
+    bool fell;            // isBalanced() tripped (main.cpp stops the motors)
+    float fall_time;      // s, duration when it did not fall
+    float rms_pitch;      // deg, over the ticks balanced
+    float max_pitch;      // deg, largest |pitch|
+    float saturation;     // Fraction of ticks with a wheel command at MAX_MOTOR_OUTPUT
+    float drift;          // m, |axle travel| at the end
+    float cost;           // Ranking score, lower is better (see score())
+
+    /**
+     * rms_pitch + 10 * saturation + drift; a fall always ranks below any
+     * run that stayed up, and an earlier fall below a later one.
+     */
+    static float score(const SimResult& result, float duration);
+};
+
+/**
+ * The firmware's control tick around a simulated rover.
+ *
+ * Each tick mirrors balanceTick() in main.cpp with the real objects:
+ * IMU samples from the plant (gravity plus axle acceleration, optional noise
+ * and gyro bias) through the configured pitch filter (IMU_ESTIMATOR), real
+ * interrupt-mode EncoderReaders fed quadrature edges from the wheel angle
+ * relative to the body, BalanceController::update(), mixWheelSpeeds() and
+ * MotorDriver::setSpeeds(), and the fall check. The PWM duty the drivers wrote
+ * (native_shim) is what the plant receives, so quantization and clamping
+ * match the device.
+ *
+ * The plant is integrated in PLANT_SUBSTEPS steps per control tick, with the
+ * shim clock advanced per step so encoder edges carry sub-tick timestamps.
+ * Uses the calling thread's shim state: one simulation per thread at a time.
+ */
+class ClosedLoopSim {
+public:
+    static const int PLANT_SUBSTEPS = 10;
+
+    explicit ClosedLoopSim(const SimConfig& config);
+
+    /**
+     * Run one control tick and advance the plant to the next.
+     *
+     * @return false once the rover has fallen (nothing more to simulate)
+     */
+    bool tick();
+
+    /**
+     * Run ticks until the configured duration or a fall.
+     */
+    SimResult run();
+
+    const PlantModel& getPlant() const;
+    BalanceController& getController();
+    float getPitchEstimate() const;  // deg, filter output fed to the controller
+    float getTime() const;           // s
+
+private:
+    /**
+     * Quadrature edges for a shim-driven encoder: moves the A/B pin pair
+     * through the Gray sequence one count at a time, so every count is one
+     * CHANGE interrupt, as on the wheel.
+     */
+    struct QuadratureSignal {
+        int pin_a;
+        int pin_b;
+        long count;
+        void moveTo(long target);
+    };
+
+    SimConfig config_;
+    PlantModel plant_;
+    BalanceController controller_;
+    MotorDriver left_motor_;
+    MotorDriver right_motor_;
+    EncoderReader left_encoder_;
+    EncoderReader right_encoder_;
+#if IMU_ESTIMATOR == IMU_ESTIMATOR_KALMAN
+    KalmanPitchFilter<control_t> filter_;
+#else
+    ComplementaryFilter<control_t> filter_;
+#endif
+    QuadratureSignal left_signal_;
+    QuadratureSignal right_signal_;
+    uint32_t noise_state_;
+
+    int ticks_;           // Plant steps completed
+    int control_ticks_;   // Controller updates (includes the tick that detected a fall)
+    int balanced_ticks_;
+    int saturated_ticks_;
+    double pitch_square_sum_;
+    float max_pitch_;
+    float pitch_estimate_;
+    bool fell_;
+    float fall_time_;
+
+    float noise();
+    float appliedDuty(MotorDriver& motor, int ledc_channel) const;
+    long encoderCount(float wheel_travel) const;
+};
+
+/**
+ * Convenience: construct, run, return the summary.
+ */
+SimResult simulate(const SimConfig& config);
+
+#endif // CLOSED_LOOP_H
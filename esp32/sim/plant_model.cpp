@@ -0,0 +1,134 @@
+#include "plant_model.h"
+#include <math.h>
+#include <string.h>
+#include "../include/config.h"
+
+static const float DEG_PER_RAD = 57.29577951f;
+
+PlantParameters PlantParameters::rover() {
+    PlantParameters p;
+    p.body_mass = 1.0f;
+    p.body_inertia = 0.01f;
+    p.com_height = 0.1f;
+    p.wheel_mass = 0.2f;
+    p.wheel_radius = WHEEL_DIAMETER_MM / 2000.0f;
+    p.wheelbase = WHEELBASE_MM / 1000.0f;
+    p.yaw_inertia = 0.01f;
+    p.stall_torque = 0.5f;
+    p.free_speed = 17.0f;          // ~160 rpm
+    p.motor_time_constant = 0.02f; // actuator_lag in step_response.m
+    p.rolling_friction = 0.05f;
+    p.gravity = 9.81f;
+    return p;
+}
+
+PlantModel::PlantModel(const PlantParameters& params)
+    : params_(params), acceleration_(0.0f), left_target_(0.0f), right_target_(0.0f) {
+    reset(0.0f);
+}
+
+void PlantModel::reset(float pitch_deg) {
+    memset(state_, 0, sizeof(state_));
+    state_[PITCH] = pitch_deg / DEG_PER_RAD;
+    acceleration_ = 0.0f;
+    left_target_ = 0.0f;
+    right_target_ = 0.0f;
+}
+
+void PlantModel::derivative(const float* s, float* rate) const {
+    const PlantParameters& p = params_;
+    float half_base = 0.5f * p.wheelbase;
+    float sin_pitch = sinf(s[PITCH]);
+    float cos_pitch = cosf(s[PITCH]);
+
+    // Motor torque from the duty and the wheel speed relative to the body (back EMF)
+    float left_speed = s[SPEED] + half_base * s[YAW_RATE];
+    float right_speed = s[SPEED] - half_base * s[YAW_RATE];
+    float left_torque = p.stall_torque * (s[LEFT_COMMAND] - (left_speed / p.wheel_radius - s[PITCH_RATE]) / p.free_speed);
+    float right_torque = p.stall_torque * (s[RIGHT_COMMAND] - (right_speed / p.wheel_radius - s[PITCH_RATE]) / p.free_speed);
+    float torque = left_torque + right_torque;
+
+    // Mass matrix [a11 a12; a21 a22] [x''; th''] = [b1; b2] (wheels as uniform discs)
+    float ml = p.body_mass * p.com_height;
+    float a11 = p.wheel_mass * 1.5f + p.body_mass;
+    float a12 = ml * cos_pitch;
+    float a22 = p.body_inertia + ml * p.com_height;
+    float b1 = torque / p.wheel_radius - p.rolling_friction * s[SPEED] + ml * sin_pitch * s[PITCH_RATE] * s[PITCH_RATE];
+    float b2 = -torque + ml * p.gravity * sin_pitch;
+    float det = a11 * a22 - a12 * a12;
+
+    rate[PITCH] = s[PITCH_RATE];
+    rate[PITCH_RATE] = (a11 * b2 - a12 * b1) / det;
+    rate[TRAVEL] = s[SPEED];
+    rate[SPEED] = (b1 * a22 - a12 * b2) / det;
+    rate[HEADING] = s[YAW_RATE];
+    rate[YAW_RATE] = half_base * ((left_torque - right_torque) / p.wheel_radius -
+                                   0.5f * p.rolling_friction * (left_speed - right_speed)) / p.yaw_inertia;
+    rate[LEFT_COMMAND] = (left_target_ - s[LEFT_COMMAND]) / p.motor_time_constant;
+    rate[RIGHT_COMMAND] = (right_target_ - s[RIGHT_COMMAND]) / p.motor_time_constant;
+}
+
+void PlantModel::step(float left, float right, float dt) {
+    left_target_ = left;
+    right_target_ = right;
+
+    float k1[STATE_SIZE], k2[STATE_SIZE], k3[STATE_SIZE], k4[STATE_SIZE], tmp[STATE_SIZE];
+    derivative(state_, k1);
+    for (int i = 0; i < STATE_SIZE; i++) tmp[i] = state_[i] + 0.5f * dt * k1[i];
+    derivative(tmp, k2);
+    for (int i = 0; i < STATE_SIZE; i++) tmp[i] = state_[i] + 0.5f * dt * k2[i];
+    derivative(tmp, k3);
+    for (int i = 0; i < STATE_SIZE; i++) tmp[i] = state_[i] + dt * k3[i];
+    derivative(tmp, k4);
+    for (int i = 0; i < STATE_SIZE; i++) {
+        state_[i] += dt / 6.0f * (k1[i] + 2.0f * k2[i] + 2.0f * k3[i] + k4[i]);
+    }
+    acceleration_ = k1[SPEED];
+}
+
+void PlantModel::push(float impulse) {
+    // Generalized impulse of a horizontal push at the COM: [J; J L cos(th)] = M(q) dq'
+    const PlantParameters& p = params_;
+    float ml = p.body_mass * p.com_height;
+    float cos_pitch = cosf(state_[PITCH]);
+    float a11 = p.wheel_mass * 1.5f + p.body_mass;
+    float a12 = ml * cos_pitch;
+    float a22 = p.body_inertia + ml * p.com_height;
+    float q1 = impulse;
+    float q2 = impulse * p.com_height * cos_pitch;
+    float det = a11 * a22 - a12 * a12;
+    state_[SPEED] += (q1 * a22 - a12 * q2) / det;
+    state_[PITCH_RATE] += (a11 * q2 - a12 * q1) / det;
+}
+
+float PlantModel::getPitch() const {
+    return state_[PITCH] * DEG_PER_RAD;
+}
+
+float PlantModel::getPitchRate() const {
+    return state_[PITCH_RATE] * DEG_PER_RAD;
+}
+
+float PlantModel::getTravel() const {
+    return state_[TRAVEL];
+}
+
+float PlantModel::getSpeed() const {
+    return state_[SPEED];
+}
+
+float PlantModel::getAcceleration() const {
+    return acceleration_;
+}
+
+float PlantModel::getHeading() const {
+    return state_[HEADING] * DEG_PER_RAD;
+}
+
+float PlantModel::getLeftTravel() const {
+    return state_[TRAVEL] + 0.5f * params_.wheelbase * state_[HEADING];
+}
+
+float PlantModel::getRightTravel() const {
+    return state_[TRAVEL] - 0.5f * params_.wheelbase * state_[HEADING];
+}
@@ -0,0 +1,93 @@
+#ifndef PLANT_MODEL_H
+#define PLANT_MODEL_H
+
+#include <stdint.h>
+
+/**
+ * Physical parameters of the rover for the plant model.
+ * Body values follow matlab_tuning/step_response.m; motor values are
+ * estimates for the Dagu RS034 gearmotors at 12 V. All SI units.
+ */
+struct PlantParameters {
+    float body_mass;           // kg (m)
+    float body_inertia;        // kg m^2 about the center of mass (I)
+    float com_height;          // m, axle to center of mass (L)
+    float wheel_mass;          // kg, both wheels (M)
+    float wheel_radius;        // m
+    float wheelbase;           // m
+    float yaw_inertia;         // kg m^2 about the vertical axis
+    float stall_torque;        // N m per wheel at full duty, standing still
+    float free_speed;          // rad/s wheel speed at full duty, no load
+    float motor_time_constant; // s, driver + winding lag (first order)
+    float rolling_friction;    // N s/m on wheel travel
+    float gravity;             // m/s^2
+
+    /**
+     * Defaults for the rover as built (config.h wheel size and wheelbase).
+     */
+    static PlantParameters rover();
+};
+
+/**
+ * Inverted pendulum on two wheels, integrated with RK4.
+ *
+ * State: pitch (rad, positive = leaning forward), pitch rate, wheel
+ * travel x and speed (m, positive = forward), heading and yaw rate
+ * (rad, positive = clockwise), and the two lagged motor commands.
+ *
+ * Full nonlinear pitch/travel dynamics (Lagrangian of a body on a rolling
+ * axle, torque reacting between body and wheels):
+ *   (M + m + Iw/r^2) x'' + m L cos(th) th'' - m L sin(th) th'^2 = tau / r - b x'
+ *   m L cos(th) x'' + (I + m L^2) th'' - m g L sin(th)            = -tau
+ * Each wheel's torque is a DC motor line: stall_torque * (u - w / free_speed),
+ * w being the wheel speed relative to the body, u the duty fraction (-1..1).
+ */
+class PlantModel {
+public:
+    explicit PlantModel(const PlantParameters& params);
+
+    /**
+     * Restart at rest with the given tilt.
+     *
+     * @param pitch_deg Initial pitch (degrees)
+     */
+    void reset(float pitch_deg);
+
+    /**
+     * Advance the plant with the motor duty held for dt (zero-order hold).
+     *
+     * @param left Left duty fraction (-1..1, positive = forward)
+     * @param right Right duty fraction
+     * @param dt Step (seconds); keep at or below 1 ms for the motor lag
+     */
+    void step(float left, float right, float dt);
+
+    /**
+     * Apply an impulsive push at the center of mass (changes velocities only).
+     *
+     * @param impulse N s, positive = forward
+     */
+    void push(float impulse);
+
+    float getPitch() const;          // degrees
+    float getPitchRate() const;      // degrees/sec
+    float getTravel() const;         // m, axle
+    float getSpeed() const;          // m/s, axle
+    float getAcceleration() const;   // m/s^2, axle, from the last step
+    float getHeading() const;        // degrees, clockwise
+    float getLeftTravel() const;     // m, left wheel contact point
+    float getRightTravel() const;    // m
+
+private:
+    enum StateIndex { PITCH, PITCH_RATE, TRAVEL, SPEED, HEADING, YAW_RATE, LEFT_COMMAND, RIGHT_COMMAND, STATE_SIZE };
+
+    PlantParameters params_;
+    float state_[STATE_SIZE];
+    float acceleration_;
+    float left_target_;   // Duty commands the lagged states move toward
+    float right_target_;
+
+    void derivative(const float* state, float* rate) const;
+};
+
+#endif // PLANT_MODEL_H
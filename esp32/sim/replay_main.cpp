@@ -0,0 +1,120 @@
+/**
+ * Log replay on the host: feeds a telemetry CSV (scripts/capture_telemetry.py,
+ * matlab_tuning/log_analysis.m layout) through the firmware BalanceController
+ * via LogReplay and compares the motor outputs with the logged ones.
+ *
+ *   pio run -e replay
+ *   .pio/build/replay/program rover_log.csv --out replayed.csv
+ *
+ * Gains default to config.h; pass the ones the log was recorded with.
+ * Exit status 1 if any sample mismatched, so it can gate a controller change.
+ */
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <native_shim.h>
+#include "../src/replay/log_replay.h"
+
+static void usage() {
+    printf("Usage: program LOG.csv [options]\n"
+           "  --kp X --ki X --kd X   Gains the log was recorded with (default config.h)\n"
+           "  --tolerance X          Mismatch threshold on motor output (default %g)\n"
+           "  --out PATH             Write time_ms, logged and replayed motor output per sample\n",
+           (double)REPLAY_TOLERANCE);
+}
+
+int main(int argc, char** argv) {
+    const char* log_path = nullptr;
+    const char* out_path = nullptr;
+    float kp = KP, ki = KI, kd = KD;
+    float tolerance = REPLAY_TOLERANCE;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg[0] != '-' && log_path == nullptr) {
+            log_path = arg;
+            continue;
+        }
+        if (value == nullptr) {
+            usage();
+            return 2;
+        } else if (strcmp(arg, "--kp") == 0) {
+            kp = (float)atof(value);
+        } else if (strcmp(arg, "--ki") == 0) {
+            ki = (float)atof(value);
+        } else if (strcmp(arg, "--kd") == 0) {
+            kd = (float)atof(value);
+        } else if (strcmp(arg, "--tolerance") == 0) {
+            tolerance = (float)atof(value);
+        } else if (strcmp(arg, "--out") == 0) {
+            out_path = value;
+        } else {
+            usage();
+            return 2;
+        }
+        i++;
+    }
+    if (log_path == nullptr) {
+        usage();
+        return 2;
+    }
+
+    FILE* log = fopen(log_path, "r");
+    if (log == nullptr) {
+        perror(log_path);
+        return 2;
+    }
+    FILE* out = nullptr;
+    if (out_path != nullptr) {
+        out = fopen(out_path, "w");
+        if (out == nullptr) {
+            perror(out_path);
+            return 2;
+        }
+        fprintf(out, "time_ms,logged_motor_output,replayed_motor_output\n");
+    }
+
+    native_shim::reset();
+    BalanceController controller(kp, ki, kd);
+    LogReplay replay(&controller, tolerance);
+    replay.begin();
+
+    char line[512];
+    unsigned long skipped = 0;
+    double busy_s = 0.0;
+    while (fgets(line, sizeof(line), log) != nullptr) {
+        TelemetrySample sample;
+        if (!LogReplay::parseCsv(line, sample)) {
+            skipped++;  // Header, comments, blank lines
+            continue;
+        }
+        auto start = std::chrono::steady_clock::now();
+        float output = replay.step(sample);
+        busy_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (out != nullptr) {
+            fprintf(out, "%lu,%.9g,%.9g\n", (unsigned long)sample.time_ms, (double)sample.motor_output,
+                    (double)output);
+        }
+    }
+    fclose(log);
+    if (out != nullptr) {
+        fclose(out);
+    }
+
+    uint32_t samples = replay.getSampleCount();
+    printf("%u samples (%.1f s of control), %lu rows skipped, %u gap ticks, %u falls\n", (unsigned)samples,
+           samples * (double)BALANCE_LOOP_DT, skipped, (unsigned)replay.getGapCount(),
+           (unsigned)replay.getFallCount());
+    printf("motor output: %u mismatches > %g, max error %.6f, rms %.6f\n", (unsigned)replay.getMismatchCount(),
+           (double)tolerance, (double)replay.getMaxError(), (double)replay.getRmsError());
+    if (replay.getFirstMismatch() != LogReplay::NO_MISMATCH) {
+        printf("first mismatch at sample %u\n", (unsigned)replay.getFirstMismatch());
+    }
+    if (samples > 0) {
+        printf("replay: %.0f ns/sample, %.0fx real time\n", busy_s * 1e9 / samples,
+               samples * (double)BALANCE_LOOP_DT / (busy_s > 0.0 ? busy_s : 1e-9));
+    }
+    return replay.getMismatchCount() > 0 ? 1 : 0;
+}
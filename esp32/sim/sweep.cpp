@@ -0,0 +1,52 @@
+#include "sweep.h"
+#include <atomic>
+#include <thread>
+
+float GainRange::value(int index) const {
+    return count > 1 ? min + (max - min) * index / (count - 1) : min;
+}
+
+std::vector<SimConfig> gainGrid(const SimConfig& base, const GainRange& kp, const GainRange& ki,
+                                const GainRange& kd) {
+    std::vector<SimConfig> configs;
+    configs.reserve((size_t)kp.count * ki.count * kd.count);
+    for (int p = 0; p < kp.count; p++) {
+        for (int i = 0; i < ki.count; i++) {
+            for (int d = 0; d < kd.count; d++) {
+                SimConfig config = base;
+                config.kp = kp.value(p);
+                config.ki = ki.value(i);
+                config.kd = kd.value(d);
+                configs.push_back(config);
+            }
+        }
+    }
+    return configs;
+}
+
+std::vector<SimResult> runSweep(const std::vector<SimConfig>& configs, unsigned threads) {
+    std::vector<SimResult> results(configs.size());
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < configs.size(); i = next.fetch_add(1)) {
+            results[i] = simulate(configs[i]);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();  // The calling thread works too
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    return results;
+}
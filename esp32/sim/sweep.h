@@ -0,0 +1,33 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stddef.h>
+#include <vector>
+#include "closed_loop.h"
+
+/**
+ * Gain grid: count values from min to max inclusive (count 1 = min only).
+ */
+struct GainRange {
+    float min;
+    float max;
+    int count;
+
+    float value(int index) const;
+};
+
+/**
+ * Expand kp x ki x kd over a base scenario (kp varies slowest).
+ */
+std::vector<SimConfig> gainGrid(const SimConfig& base, const GainRange& kp, const GainRange& ki,
+                                const GainRange& kd);
+
+/**
+ * Run every configuration, spread over threads (0 = one per host core).
+ * Each worker thread is its own simulated board (native_shim state is per
+ * thread) and pulls the next configuration from a shared counter, so
+ * results[i] belongs to configs[i] and does not depend on the thread count.
+ */
+std::vector<SimResult> runSweep(const std::vector<SimConfig>& configs, unsigned threads);
+
+#endif // SWEEP_H
@@ -0,0 +1,125 @@
+/**
+ * Balance gain sweep on the host: every kp/ki/kd combination of a grid runs
+ * through ClosedLoopSim (the firmware controller against the plant model),
+ * in parallel across host cores. Prints the best candidates and optionally
+ * writes every run to CSV.
+ *
+ *   pio run -e sim
+ *   .pio/build/sim/program --kp 0.05:0.4:20 --ki 0:0.01:10 --kd 0:0.03:13 --csv sweep.csv
+ *
+ * Gains are on the config.h scale (normalized output per degree); divide
+ * the MATLAB-scale values of matlab_tuning/ by 255.
+ */
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <numeric>
+#include "sweep.h"
+
+static void usage() {
+    printf("Usage: program [options]\n"
+           "  --kp MIN:MAX:N     Kp grid (default 0.05:0.4:20)\n"
+           "  --ki MIN:MAX:N     Ki grid (default 0:0.01:10)\n"
+           "  --kd MIN:MAX:N     Kd grid (default 0:0.03:13)\n"
+           "  --duration S       Seconds per run (default 8)\n"
+           "  --tilt DEG         Initial tilt (default 3)\n"
+           "  --push NS          Push at 2 s, N s (default 0.15, 0 = none)\n"
+           "  --no-noise         Ideal sensors\n"
+           "  --threads N        Worker threads (default: one per core)\n"
+           "  --top N            Candidates printed (default 10)\n"
+           "  --csv PATH         Write every run\n");
+}
+
+static bool parseRange(const char* text, GainRange& range) {
+    return sscanf(text, "%f:%f:%d", &range.min, &range.max, &range.count) == 3 && range.count >= 1;
+}
+
+int main(int argc, char** argv) {
+    SimConfig base = SimConfig::defaults();
+    GainRange kp = {0.05f, 0.4f, 20};
+    GainRange ki = {0.0f, 0.01f, 10};
+    GainRange kd = {0.0f, 0.03f, 13};
+    unsigned threads = 0;
+    int top = 10;
+    const char* csv_path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool ok = true;
+        if (strcmp(arg, "--no-noise") == 0) {
+            base.sensor_noise = false;
+            continue;
+        }
+        if (value == nullptr) {
+            ok = false;
+        } else if (strcmp(arg, "--kp") == 0) {
+            ok = parseRange(value, kp);
+        } else if (strcmp(arg, "--ki") == 0) {
+            ok = parseRange(value, ki);
+        } else if (strcmp(arg, "--kd") == 0) {
+            ok = parseRange(value, kd);
+        } else if (strcmp(arg, "--duration") == 0) {
+            base.duration = (float)atof(value);
+        } else if (strcmp(arg, "--tilt") == 0) {
+            base.initial_pitch = (float)atof(value);
+        } else if (strcmp(arg, "--push") == 0) {
+            base.push_impulse = (float)atof(value);
+        } else if (strcmp(arg, "--threads") == 0) {
+            threads = (unsigned)atoi(value);
+        } else if (strcmp(arg, "--top") == 0) {
+            top = atoi(value);
+        } else if (strcmp(arg, "--csv") == 0) {
+            csv_path = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            usage();
+            return 2;
+        }
+        i++;
+    }
+
+    std::vector<SimConfig> configs = gainGrid(base, kp, ki, kd);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SimResult> results = runSweep(configs, threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<size_t> order(results.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return results[a].cost < results[b].cost; });
+    size_t stable = std::count_if(results.begin(), results.end(), [](const SimResult& r) { return !r.fell; });
+
+    printf("%zu runs of %.1f s in %.2f s (%.0fx real time), %zu stayed up\n", results.size(),
+           (double)base.duration, seconds, results.size() * base.duration / seconds, stable);
+    printf("%10s %10s %10s %8s %8s %6s %7s %8s\n", "kp", "ki", "kd", "rms_deg", "max_deg", "sat", "drift_m", "cost");
+    for (int n = 0; n < top && n < (int)order.size(); n++) {
+        const SimConfig& c = configs[order[n]];
+        const SimResult& r = results[order[n]];
+        printf("%10.5f %10.5f %10.5f %8.3f %8.3f %6.3f %7.3f %8.3f%s\n", (double)c.kp, (double)c.ki, (double)c.kd,
+               (double)r.rms_pitch, (double)r.max_pitch, (double)r.saturation, (double)r.drift, (double)r.cost,
+               r.fell ? " fell" : "");
+    }
+
+    if (csv_path != nullptr) {
+        FILE* file = fopen(csv_path, "w");
+        if (file == nullptr) {
+            perror(csv_path);
+            return 1;
+        }
+        fprintf(file, "kp,ki,kd,fell,fall_time,rms_pitch,max_pitch,saturation,drift,cost\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            const SimConfig& c = configs[i];
+            const SimResult& r = results[i];
+            fprintf(file, "%.6g,%.6g,%.6g,%d,%.3f,%.4f,%.4f,%.4f,%.4f,%.4f\n", (double)c.kp, (double)c.ki,
+                    (double)c.kd, r.fell ? 1 : 0, (double)r.fall_time, (double)r.rms_pitch, (double)r.max_pitch,
+                    (double)r.saturation, (double)r.drift, (double)r.cost);
+        }
+        fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "autotuner.h"
+#include <math.h>
+
+static const uint32_t TIMEOUT_TICKS = (uint32_t)(AUTOTUNE_TIMEOUT_S * BALANCE_LOOP_FREQ);
+
+Autotuner::Autotuner()
+    : state_(STATE_IDLE), abort_reason_(ABORT_NONE), result_(),
+      target_angle_(0.0f), kd_(0.0f), relay_high_(false), tick_(0), cycle_start_tick_(0),
+      cycle_max_(0.0f), cycle_min_(0.0f), cycles_(0), period_ticks_sum_(0), amplitude_sum_(0.0f) {
+}
+
+void Autotuner::start(float target_angle, float kd) {
+    // result_ is left alone: it stays readable until the next run completes
+    target_angle_ = target_angle;
+    kd_ = kd;
+    relay_high_ = false;
+    tick_ = 0;
+    cycle_start_tick_ = 0;
+    cycle_max_ = 0.0f;
+    cycle_min_ = 0.0f;
+    cycles_ = 0;
+    period_ticks_sum_ = 0;
+    amplitude_sum_ = 0.0f;
+    abort_reason_ = ABORT_NONE;
+    state_.store(STATE_RUNNING, std::memory_order_release);
+}
+
+float Autotuner::update(float angle, float angular_velocity) {
+    float error = angle - target_angle_;
+    tick_++;
+
+    if (fabsf(error) > AUTOTUNE_MAX_TILT) {
+        abort(ABORT_TILT);
+        return 0.0f;
+    }
+    if (tick_ > TIMEOUT_TICKS) {
+        abort(ABORT_TIMEOUT);
+        return 0.0f;
+    }
+
+    // Relay with hysteresis; each rising switch closes one oscillation cycle
+    if (relay_high_ && error < -AUTOTUNE_HYSTERESIS) {
+        relay_high_ = false;
+    } else if (!relay_high_ && error > AUTOTUNE_HYSTERESIS) {
+        relay_high_ = true;
+        onRisingSwitch();
+        if (state_.load(std::memory_order_relaxed) != STATE_RUNNING) {
+            return 0.0f;  // Last cycle measured: PID takes over from this tick
+        }
+    }
+    cycle_max_ = fmaxf(cycle_max_, error);
+    cycle_min_ = fminf(cycle_min_, error);
+
+    // Same sign convention as the PID: lean forward => drive forward; +Kd * rate damps
+    float relay = relay_high_ ? AUTOTUNE_RELAY_AMPLITUDE : -AUTOTUNE_RELAY_AMPLITUDE;
+    return relay + kd_ * angular_velocity;
+}
+
+void Autotuner::onRisingSwitch() {
+    if (cycle_start_tick_ != 0) {
+        cycles_++;
+        if (cycles_ > AUTOTUNE_SETTLE_CYCLES) {
+            period_ticks_sum_ += tick_ - cycle_start_tick_;
+            amplitude_sum_ += (cycle_max_ - cycle_min_) * 0.5f;
+        }
+        if (cycles_ >= AUTOTUNE_SETTLE_CYCLES + AUTOTUNE_MEASURE_CYCLES) {
+            finish();
+            return;
+        }
+    }
+    cycle_start_tick_ = tick_;
+    cycle_max_ = 0.0f;
+    cycle_min_ = 0.0f;
+}
+
+void Autotuner::finish() {
+    float amplitude = amplitude_sum_ / AUTOTUNE_MEASURE_CYCLES;
+    float tu = (float)period_ticks_sum_ * BALANCE_LOOP_DT / AUTOTUNE_MEASURE_CYCLES;
+    float ku = 4.0f * AUTOTUNE_RELAY_AMPLITUDE / ((float)M_PI * amplitude);
+
+    result_.ku = ku;
+    result_.tu = tu;
+    result_.amplitude = amplitude;
+    result_.kp = 0.6f * ku;
+    result_.ki = 1.2f * ku / tu;
+    // Ku was measured with kd_ damping in the loop: never propose less than that
+    result_.kd = fmaxf(0.075f * ku * tu, kd_);
+    state_.store(STATE_DONE, std::memory_order_release);
+}
+
+void Autotuner::abort(AbortReason reason) {
+    if (state_.load(std::memory_order_relaxed) != STATE_RUNNING) {
+        return;
+    }
+    abort_reason_ = reason;
+    state_.store(STATE_ABORTED, std::memory_order_release);
+}
+
+bool Autotuner::isRunning() const {
+    return state_.load(std::memory_order_relaxed) == STATE_RUNNING;
+}
+
+Autotuner::State Autotuner::getState() const {
+    return (State)state_.load(std::memory_order_acquire);
+}
+
+Autotuner::AbortReason Autotuner::getAbortReason() const {
+    return abort_reason_;
+}
+
+uint8_t Autotuner::getCyclesCompleted() const {
+    return cycles_;
+}
+
+const Autotuner::Result& Autotuner::getResult() const {
+    return result_;
+}
+
+const char* Autotuner::stateName(State state) {
+    switch (state) {
+        case STATE_RUNNING:
+            return "running";
+        case STATE_DONE:
+            return "done";
+        case STATE_ABORTED:
+            return "aborted";
+        default:
+            return "idle";
+    }
+}
+
+const char* Autotuner::abortReasonName(AbortReason reason) {
+    switch (reason) {
+        case ABORT_TILT:
+            return "tilt";
+        case ABORT_TIMEOUT:
+            return "timeout";
+        case ABORT_STOPPED:
+            return "stopped";
+        default:
+            return "none";
+    }
+}
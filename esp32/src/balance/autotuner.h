@@ -0,0 +1,119 @@
+#ifndef AUTOTUNER_H
+#define AUTOTUNER_H
+
+#include <stdint.h>
+#include <atomic>
+#include "../include/config.h"
+
+/**
+ * Relay-feedback PID autotuner (Astrom-Hagglund) for the balance loop.
+ *
+ * While running it replaces the PID output with a relay on tilt error:
+ * +/-AUTOTUNE_RELAY_AMPLITUDE, switched with AUTOTUNE_HYSTERESIS, plus the
+ * active Kd damping term. An inverted pendulum has no phase crossover on its
+ * own, so the damping is what lets the relay settle into a limit cycle
+ * instead of falling. After AUTOTUNE_SETTLE_CYCLES the next
+ * AUTOTUNE_MEASURE_CYCLES give the ultimate period Tu and tilt amplitude a:
+ *
+ *   Ku = 4d / (pi a)
+ *   Kp = 0.6 Ku, Ki = 1.2 Ku / Tu, Kd = 0.075 Ku Tu   (Ziegler-Nichols PID)
+ *
+ * Kd is floored at the damping used during the run, since Ku was measured
+ * with it in the loop. ZN is aggressive on an unstable plant: treat the
+ * result as a starting point (Ki in particular usually comes down).
+ *
+ * The run aborts if tilt leaves +/-AUTOTUNE_MAX_TILT around the target or it
+ * takes longer than AUTOTUNE_TIMEOUT_S. Either way balancing resumes with the
+ * previous gains; candidate gains are only reported, never applied here.
+ *
+ * Threading: start()/update()/abort() run on the control task. getState()
+ * may be read from any task; the result is published before STATE_DONE.
+ *
+ * INTEGRATION POINT: BalanceController::update() hands the tick to update() while running
+ * INTEGRATION POINT: BalanceController "autotune" command starts it and applies the result
+ */
+class Autotuner {
+public:
+    enum State : uint8_t {
+        STATE_IDLE = 0,
+        STATE_RUNNING = 1,
+        STATE_DONE = 2,
+        STATE_ABORTED = 3
+    };
+
+    enum AbortReason : uint8_t {
+        ABORT_NONE = 0,
+        ABORT_TILT = 1,     // Tilt left +/-AUTOTUNE_MAX_TILT
+        ABORT_TIMEOUT = 2,  // No steady oscillation within AUTOTUNE_TIMEOUT_S
+        ABORT_STOPPED = 3   // STOP command or controller reset
+    };
+
+    struct Result {
+        float ku;         // Ultimate gain (motor output per degree)
+        float tu;         // Ultimate period (seconds)
+        float amplitude;  // Tilt amplitude of the limit cycle (degrees)
+        float kp;
+        float ki;
+        float kd;
+    };
+
+    Autotuner();
+
+    /**
+     * Begin a relay experiment (control task).
+     *
+     * @param target_angle Tilt the relay oscillates around (degrees)
+     * @param kd Derivative gain kept in the loop for damping
+     */
+    void start(float target_angle, float kd);
+
+    /**
+     * Run one control tick of the experiment (control task, while running).
+     *
+     * @param angle Tilt (degrees)
+     * @param angular_velocity Tilt rate (degrees/sec)
+     * @return Normalized motor output for this tick
+     */
+    float update(float angle, float angular_velocity);
+
+    /**
+     * End a running experiment without a result (control task).
+     */
+    void abort(AbortReason reason);
+
+    bool isRunning() const;
+    State getState() const;
+    AbortReason getAbortReason() const;
+    uint8_t getCyclesCompleted() const;
+
+    /**
+     * Identified plant and candidate gains. Valid when getState() == STATE_DONE.
+     */
+    const Result& getResult() const;
+
+    // Names for JSON responses
+    static const char* stateName(State state);
+    static const char* abortReasonName(AbortReason reason);
+
+private:
+    std::atomic<uint8_t> state_;
+    AbortReason abort_reason_;
+    Result result_;
+
+    // Experiment (control task only)
+    float target_angle_;
+    float kd_;
+    bool relay_high_;
+    uint32_t tick_;
+    uint32_t cycle_start_tick_;   // Tick of the last rising relay switch (0 = none yet)
+    float cycle_max_;
+    float cycle_min_;
+    volatile uint8_t cycles_;     // Complete cycles, settling included
+    uint32_t period_ticks_sum_;
+    float amplitude_sum_;
+
+    void onRisingSwitch();
+    void finish();
+};
+
+#endif // AUTOTUNER_H
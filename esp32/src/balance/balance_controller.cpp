@@ -6,21 +6,70 @@
 // Sign convention (LOCKED): positive pitch = lean forward, positive motor = wheels forward.
 // So: error = angle - target => lean forward => positive error => positive output.
 
+// Encoder pulses to meters (same convention as CommandHandler::pulsesToDistance)
+static const float METERS_PER_PULSE = (PI * WHEEL_DIAMETER_MM / 1000.0) / ENCODER_PULSES_PER_REV;
+
 BalanceController::BalanceController(float kp, float ki, float kd)
-    : kp_(kp), ki_(ki), kd_(kd), integral_(0.0), previous_error_(0.0),
+    : pid_(control_t(kp), control_t(ki), control_t(kd), control_t(INTEGRAL_LIMIT),
+           control_t(BALANCE_LOOP_DT)),
+      previous_error_(0.0),
       motor_output_(0.0), last_update_time_(0), last_angle_(0.0),
-      velocity_setpoint_(0.0), rotation_setpoint_(0.0) {
+      velocity_setpoint_(0.0), rotation_setpoint_(0.0),
+      velocity_profile_(VELOCITY_MAX_ACCEL, VELOCITY_MAX_JERK, BALANCE_LOOP_DT),
+      rotation_profile_(ROTATION_MAX_ACCEL, ROTATION_MAX_JERK, BALANCE_LOOP_DT),
+      velocity_pid_(control_t(VELOCITY_KP), control_t(VELOCITY_KI), control_t(0),
+                    control_t(VELOCITY_INTEGRAL_LIMIT),
+                    control_t(BALANCE_LOOP_DT * VELOCITY_LOOP_DECIMATION)),
+      target_tilt_(0.0), outer_tick_(0), holding_(false), hold_position_(0.0), wheel_feedback_(true),
+      gains_pending_(false), autotune_request_(AUTOTUNE_REQUEST_NONE) {
+    GainSchedule::Point initial = {0.0f, kp, ki, kd};
+    gains_.setPoints(&initial, 1);
+    requested_gains_ = gains_;
 }
 
-void BalanceController::update(float angle, float angular_velocity, float wheel_velocity) {
-    // CRITICAL: Run at 100 Hz. Fixed dt = 0.01 s. wheel_velocity unused (reserved for feedforward).
-    (void)wheel_velocity;
-
+void BalanceController::update(float angle, float angular_velocity, float wheel_velocity, float wheel_position) {
+    // CRITICAL: Run at BALANCE_LOOP_FREQ. Fixed dt = BALANCE_LOOP_DT.
+    applyRequests();
     last_angle_ = angle;
-
-    float balance_pid = calculatePID(angle, angular_velocity);
-    motor_output_ = balance_pid + velocity_setpoint_;
-    motor_output_ = constrain(motor_output_, -MAX_MOTOR_SPEED, MAX_MOTOR_SPEED);
+    if (!wheel_feedback_) {
+        wheel_velocity = 0.0f;  // Dead encoder: schedule at standstill, no outer loop
+        wheel_position = 0.0f;
+    }
+
+    // Advance setpoint profiles one tick toward their targets
+    velocity_setpoint_ = velocity_profile_.update();
+    rotation_setpoint_ = rotation_profile_.update();
+
+    // Scheduled gains follow the measured wheel speed (a single point is applied once, in setGainSchedule)
+    if (gains_.getCount() > 1) {
+        applyGains(gains_.lookup(fabsf(wheel_velocity) * METERS_PER_PULSE));
+    }
+
+    // Relay autotune replaces the PID while it runs; the PID resumes the tick it ends
+    bool relay_active = false;
+    if (autotuner_.isRunning()) {
+        motor_output_ = autotuner_.update(angle, angular_velocity);
+        relay_active = autotuner_.isRunning();
+        if (!relay_active) {
+            pid_.reset();
+        }
+    }
+
+    if (!relay_active) {
+        if (VELOCITY_LOOP_ENABLED && wheel_feedback_) {
+            // Outer loop at a decimated rate; the target tilt is held in between
+            if (++outer_tick_ >= VELOCITY_LOOP_DECIMATION) {
+                outer_tick_ = 0;
+                target_tilt_ = calculateTargetTilt(wheel_velocity, wheel_position);
+            }
+            motor_output_ = calculatePID(angle, angular_velocity);
+        } else {
+            // No cascade: the setpoint adds to the balance output open loop
+            float balance_pid = calculatePID(angle, angular_velocity);
+            motor_output_ = balance_pid + velocity_setpoint_;
+        }
+    }
+    motor_output_ = constrain(motor_output_, -MAX_MOTOR_OUTPUT, MAX_MOTOR_OUTPUT);
 
     last_update_time_ = millis();
 }
@@ -30,24 +79,36 @@ float BalanceController::getMotorOutput() {
 }
 
 void BalanceController::setVelocitySetpoint(float velocity) {
-    velocity_setpoint_ = velocity;
+    velocity_profile_.setTarget(velocity);
 }
 
 void BalanceController::setRotationSetpoint(float angular_velocity) {
-    rotation_setpoint_ = angular_velocity;
+    rotation_profile_.setTarget(angular_velocity);
 }
 
 void BalanceController::setNeutral() {
-    velocity_setpoint_ = 0.0;
-    rotation_setpoint_ = 0.0;
+    velocity_profile_.setTarget(0.0);
+    rotation_profile_.setTarget(0.0);
+}
+
+void BalanceController::overrideSetpoints(float velocity, float rotation) {
+    velocity_profile_.reset(velocity);
+    rotation_profile_.reset(rotation);
 }
 
 void BalanceController::reset() {
-    integral_ = 0.0;
+    pid_.reset();
     previous_error_ = 0.0;
     motor_output_ = 0.0;
     velocity_setpoint_ = 0.0;
     rotation_setpoint_ = 0.0;
+    velocity_profile_.reset();
+    rotation_profile_.reset();
+    velocity_pid_.reset();
+    target_tilt_ = 0.0;
+    outer_tick_ = 0;
+    holding_ = false;
+    autotuner_.abort(Autotuner::ABORT_STOPPED);
 }
 
 bool BalanceController::isBalanced() {
@@ -62,24 +123,131 @@ float BalanceController::getRotationSetpoint() const {
     return rotation_setpoint_;
 }
 
-float BalanceController::calculatePID(float angle, float angular_velocity) {
-    // Option A: error = angle - target => lean forward => positive output (wheels forward)
-    const float target_angle = BALANCE_ANGLE_OFFSET;
-    float error = angle - target_angle;
+float BalanceController::getVelocityTarget() const {
+    return velocity_profile_.getTarget();
+}
 
-    float p_term = kp_ * error;
+float BalanceController::getRotationTarget() const {
+    return rotation_profile_.getTarget();
+}
+
+float BalanceController::getTargetTilt() const {
+    return target_tilt_;
+}
+
+void BalanceController::startAutotune() {
+    reset();  // Relay runs from rest: no setpoints, outer loop or integral carried in
+    autotuner_.start(BALANCE_ANGLE_OFFSET, static_cast<float>(pid_.kd));
+}
 
-    integral_ += error * 0.01f;  // fixed dt = 0.01 (100 Hz)
-    limitIntegral();
-    float i_term = ki_ * integral_;
+void BalanceController::abortAutotune() {
+    autotune_request_.store(AUTOTUNE_REQUEST_NONE, std::memory_order_relaxed);  // STOP also cancels a pending start
+    autotuner_.abort(Autotuner::ABORT_STOPPED);
+}
 
-    // Derivative on measurement: -Kd * angular_velocity (no derivative kick)
-    float d_term = -kd_ * angular_velocity;
+const Autotuner& BalanceController::getAutotuner() const {
+    return autotuner_;
+}
 
-    previous_error_ = error;
-    return p_term + i_term + d_term;
+bool BalanceController::requestGainSchedule(const GainSchedule& schedule) {
+    if (gains_pending_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    requested_gains_ = schedule;  // update() reads it only while gains_pending_ is set
+    gains_pending_.store(true, std::memory_order_release);
+    return true;
 }
 
-void BalanceController::limitIntegral() {
-    integral_ = constrain(integral_, -INTEGRAL_LIMIT, INTEGRAL_LIMIT);
+void BalanceController::requestAutotuneStart() {
+    autotune_request_.store(AUTOTUNE_REQUEST_START, std::memory_order_release);
+}
+
+void BalanceController::requestAutotuneAbort() {
+    autotune_request_.store(AUTOTUNE_REQUEST_ABORT, std::memory_order_release);
+}
+
+bool BalanceController::loadGains() {
+    if (!requested_gains_.load()) {
+        return false;
+    }
+    gains_pending_.store(true, std::memory_order_release);
+    return true;
+}
+
+void BalanceController::applyRequests() {
+    // Gain table swap at the tick boundary: the PID never mixes old and new gains
+    if (gains_pending_.load(std::memory_order_acquire)) {
+        setGainSchedule(requested_gains_);
+        gains_pending_.store(false, std::memory_order_release);
+    }
+    
+    switch (autotune_request_.exchange(AUTOTUNE_REQUEST_NONE, std::memory_order_acquire)) {
+        case AUTOTUNE_REQUEST_START:
+            startAutotune();
+            break;
+        case AUTOTUNE_REQUEST_ABORT:
+            abortAutotune();
+            break;
+        default:
+            break;
+    }
+}
+
+void BalanceController::setWheelFeedback(bool available) {
+    wheel_feedback_ = available;
+    if (!available) {
+        velocity_pid_.reset();
+        target_tilt_ = 0.0;  // Upright at the calibrated offset
+        holding_ = false;
+    }
+}
+
+bool BalanceController::hasWheelFeedback() const {
+    return wheel_feedback_;
+}
+
+void BalanceController::setGainSchedule(const GainSchedule& schedule) {
+    gains_ = schedule;
+    applyGains(gains_.getPoint(0));  // Until the next tick looks up the speed-matched point
+}
+
+void BalanceController::applyGains(const GainSchedule::Point& gains) {
+    pid_.kp = control_t(gains.kp);
+    pid_.ki = control_t(gains.ki);
+    pid_.kd = control_t(gains.kd);
+}
+
+float BalanceController::calculateTargetTilt(float wheel_velocity, float wheel_position) {
+    float speed = wheel_velocity * METERS_PER_PULSE;
+    float position = wheel_position * METERS_PER_PULSE;
+    float target_speed = velocity_setpoint_ * VELOCITY_FULL_SCALE_MPS;
+
+    // Station keeping: once the commanded speed has ramped to zero, hold that spot
+    if (velocity_setpoint_ == 0.0f && velocity_profile_.isSettled()) {
+        if (!holding_) {
+            holding_ = true;
+            hold_position_ = position;
+        }
+        target_speed += POSITION_KP * (hold_position_ - position);
+    } else {
+        holding_ = false;
+    }
+
+    // Too slow => lean forward (positive tilt); the inner loop then drives the wheels under it
+    control_t tilt = velocity_pid_.compute(control_t(target_speed - speed), control_t(0));
+    return constrain(static_cast<float>(tilt), -VELOCITY_LOOP_MAX_TILT, VELOCITY_LOOP_MAX_TILT);
+}
+
+float BalanceController::calculatePID(float angle, float angular_velocity) {
+    // Option A: error = angle - target => lean forward => positive output (wheels forward)
+    // Target = calibrated upright + outer loop tilt (zero when the cascade is off)
+    const control_t target_angle(BALANCE_ANGLE_OFFSET + target_tilt_);
+    control_t error = control_t(angle) - target_angle;
+
+    // P + I (fixed dt = BALANCE_LOOP_DT, clamped) + D on measurement:
+    // +Kd * angular_velocity, the rate of the error (no derivative kick)
+    control_t output = pid_.compute(error, control_t(angular_velocity));
+
+    previous_error_ = static_cast<float>(error);
+    return static_cast<float>(output);
 }
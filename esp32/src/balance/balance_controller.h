@@ -1,11 +1,46 @@
 #ifndef BALANCE_CONTROLLER_H
 #define BALANCE_CONTROLLER_H
 
+#include "../control/control_math.h"
+#include "trajectory_generator.h"
+#include "gain_schedule.h"
+#include "autotuner.h"
+#include <atomic>
+
+class CommandContext;
+
 /**
  * PID-based balance controller for self-balancing rover.
  *
  * This controller maintains balance by continuously reading IMU data
  * and adjusting motor speeds based on the tilt angle.
+ *
+ * The PID runs in control_t (float or Q16.16, see CONTROL_USE_FIXED_POINT);
+ * the public interface stays float.
+ *
+ * Motion setpoints are profiled: commands set targets, and update() moves the
+ * applied setpoints toward them along jerk-limited ramps (TrajectoryGenerator),
+ * so a single command becomes a smooth motion instead of a step.
+ *
+ * Cascade (VELOCITY_LOOP_ENABLED): an outer PI loop on encoder wheel speed,
+ * run every VELOCITY_LOOP_DECIMATION ticks, turns the velocity setpoint into
+ * the target tilt of the inner pitch PID. With a zero setpoint it also holds
+ * the wheel position where the robot came to rest, so speeds and station
+ * keeping hold without corrections from the Pi. Without working encoders
+ * (setWheelFeedback(false)) the cascade is bypassed and the velocity
+ * setpoint is added to the output open loop, as with the cascade off.
+ *
+ * Gains come from a GainSchedule indexed by measured wheel speed, so gains
+ * tuned standing still can soften (or stiffen) during fast motion. The table
+ * is replaced with setGainSchedule() at a tick boundary.
+ *
+ * startAutotune() hands the loop to a relay experiment (Autotuner) that
+ * identifies the ultimate gain and period and proposes PID gains.
+ *
+ * The comms task changes gains and runs autotune through request*(): the
+ * requests are mailboxes that update() applies at the start of its next tick.
+ *
+ * INTEGRATION POINT: CommandHandler routes "gains" and "autotune" to the handle*Command() methods
  */
 class BalanceController {
 public:
@@ -20,26 +55,28 @@ public:
 
     /**
      * Update the controller with current sensor readings.
-     * Must be called at a consistent frequency (e.g., 100Hz).
+     * Must be called at BALANCE_LOOP_FREQ from the control task (integral uses fixed dt).
      * 
      * CRITICAL: This function must never be disabled during operation.
      *
      * @param angle Current tilt angle in degrees
      * @param angular_velocity Angular velocity in degrees/sec
-     * @param wheel_velocity Optional wheel velocity from encoders (for feedforward)
+     * @param wheel_velocity Average wheel velocity from encoders (pulses/sec)
+     * @param wheel_position Average wheel position from encoders (pulses)
      */
-    void update(float angle, float angular_velocity, float wheel_velocity = 0.0);
+    void update(float angle, float angular_velocity, float wheel_velocity = 0.0, float wheel_position = 0.0);
 
     /**
      * Get the computed motor output.
      *
-     * @return Motor speed adjustment (-255 to 255)
+     * @return Normalized motor command (-1.0 to 1.0)
      */
     float getMotorOutput();
 
     /**
      * Set velocity setpoint for forward/backward motion.
      * Motion commands modify this setpoint, which is added to balance control.
+     * The applied setpoint ramps to the new target (VELOCITY_MAX_ACCEL/JERK).
      * 
      * @param velocity Target velocity (positive = forward, negative = backward)
      */
@@ -47,6 +84,7 @@ public:
 
     /**
      * Set rotation setpoint for turning.
+     * The applied setpoint ramps to the new target (ROTATION_MAX_ACCEL/JERK).
      * 
      * @param angular_velocity Target angular velocity (positive = clockwise, negative = counterclockwise)
      */
@@ -54,12 +92,22 @@ public:
 
     /**
      * Return to neutral balance (no motion setpoints).
-     * Called by STOP command.
+     * Called by STOP command. Setpoints ramp down to zero.
      */
     void setNeutral();
 
+    /**
+     * Log replay: the next update() applies these setpoints as recorded
+     * instead of ramping (profiles and targets jump to them).
+     *
+     * @param velocity Profiled velocity setpoint from a log
+     * @param rotation Profiled rotation setpoint from a log
+     */
+    void overrideSetpoints(float velocity, float rotation);
+
     /**
      * Reset the controller state (clear integral, error history).
+     * Setpoints jump to zero immediately (no ramp).
      */
     void reset();
 
@@ -73,34 +121,144 @@ public:
     /**
      * Get current velocity setpoint.
      * 
-     * @return Velocity setpoint
+     * @return Velocity setpoint (profiled value applied this tick)
      */
     float getVelocitySetpoint() const;
 
     /**
      * Get current rotation setpoint.
      * 
-     * @return Rotation setpoint
+     * @return Rotation setpoint (profiled value applied this tick)
      */
     float getRotationSetpoint() const;
 
+    /**
+     * Get the velocity target the setpoint is ramping to.
+     */
+    float getVelocityTarget() const;
+
+    /**
+     * Get the rotation target the setpoint is ramping to.
+     */
+    float getRotationTarget() const;
+
+    /**
+     * Get the tilt the inner loop is holding (outer loop output, degrees).
+     */
+    float getTargetTilt() const;
+
+    /**
+     * Use the encoder readings passed to update() (default on). Off when an
+     * encoder failed to initialise: wheel speed and position are ignored, so
+     * the outer loop, station keeping and gain scheduling never act on a
+     * dead encoder. Call before the control task starts.
+     *
+     * @param available false to balance on the IMU alone
+     */
+    void setWheelFeedback(bool available);
+
+    /**
+     * Check whether update() uses the encoder readings.
+     */
+    bool hasWheelFeedback() const;
+
+    /**
+     * Replace the balance PID gain table (control task only, between ticks).
+     * The integral is kept, so a gain change does not kick the output to zero.
+     *
+     * @param schedule New speed-indexed gains
+     */
+    void setGainSchedule(const GainSchedule& schedule);
+
+    /**
+     * Start a relay autotune run (control task only). Drops motion setpoints;
+     * balancing resumes with the current gains when it finishes or aborts.
+     */
+    void startAutotune();
+
+    /**
+     * Abort a running autotune (control task only).
+     */
+    void abortAutotune();
+
+    /**
+     * Autotune state and result (state/result readable from any task).
+     */
+    const Autotuner& getAutotuner() const;
+
+    /**
+     * Post a gain table (comms task); update() swaps it in at the next tick.
+     *
+     * @param schedule New speed-indexed gains
+     * @return false if the previous table has not been applied yet
+     */
+    bool requestGainSchedule(const GainSchedule& schedule);
+
+    /**
+     * Start (or abort) a relay autotune run at the next tick (comms task).
+     */
+    void requestAutotuneStart();
+    void requestAutotuneAbort();
+
+    /**
+     * Load the gain table saved with "gains" {"save": true}; it replaces the
+     * constructor gains at the first tick. Call before the control task starts.
+     *
+     * @return true if a saved table was found
+     */
+    bool loadGains();
+
+    /**
+     * "gains" command: set, reset or save the gain table, or report it.
+     * See balance_controller_commands.cpp for the parameters and reply.
+     */
+    bool handleGainsCommand(CommandContext& context);
+
+    /**
+     * "autotune" command: start, abort, report or apply a relay autotune run.
+     */
+    bool handleAutotuneCommand(CommandContext& context);
+
 private:
-    float kp_, ki_, kd_;
-    float integral_;
+    PidKernel<control_t> pid_;  // Gains, integral (clamped to INTEGRAL_LIMIT), fixed dt
+    GainSchedule gains_;        // Source of pid_ gains (looked up per tick when scheduled)
     float previous_error_;
     float motor_output_;
     unsigned long last_update_time_;
     float last_angle_;  // For isBalanced() fall detection
 
     // Motion setpoints (modify balance, don't replace it)
-    float velocity_setpoint_;     // Forward/backward (motor units)
-    float rotation_setpoint_;     // L/R differential (motor units), applied in main
+    float velocity_setpoint_;     // Forward/backward (normalized motor output)
+    float rotation_setpoint_;     // L/R differential (normalized motor output), applied in main
+    TrajectoryGenerator velocity_profile_;  // Target -> velocity_setpoint_
+    TrajectoryGenerator rotation_profile_;  // Target -> rotation_setpoint_
+
+    // Outer loop (wheel speed -> target tilt)
+    PidKernel<control_t> velocity_pid_;  // PI on m/s error, integral clamped to VELOCITY_INTEGRAL_LIMIT
+    float target_tilt_;                  // degrees, held between outer loop runs
+    uint8_t outer_tick_;
+    bool holding_;                       // Station keeping at hold_position_
+    float hold_position_;                // meters
+    bool wheel_feedback_;                // Encoders usable (outer loop + gain schedule input)
+
+    Autotuner autotuner_;                // Relay experiment (replaces the PID while running)
+
+    // Gain table mailbox: requested_gains_ is the comms task's copy (last requested table);
+    // update() copies it into gains_ while gains_pending_ is set
+    std::atomic<bool> gains_pending_;
+    GainSchedule requested_gains_;
+
+    // Autotune mailbox: start/abort applied at the start of the next tick
+    enum AutotuneRequest : uint8_t { AUTOTUNE_REQUEST_NONE, AUTOTUNE_REQUEST_START, AUTOTUNE_REQUEST_ABORT };
+    std::atomic<uint8_t> autotune_request_;
     
-    // PID calculation
-    float calculatePID(float angle, float angular_velocity);
+    void applyRequests();
+    void sendGains(CommandContext& context, bool saved) const;
+    float calculateTargetTilt(float wheel_velocity, float wheel_position);
+    void applyGains(const GainSchedule::Point& gains);
     
-    // Integral windup protection
-    void limitIntegral();
+    // PID calculation (integral windup clamp lives in PidKernel)
+    float calculatePID(float angle, float angular_velocity);
 };
 
 #endif // BALANCE_CONTROLLER_H
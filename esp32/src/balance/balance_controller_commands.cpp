@@ -0,0 +1,147 @@
+#include "balance_controller.h"
+#include "../command_handler/command_context.h"
+#include <string.h>
+
+bool BalanceController::handleGainsCommand(CommandContext& context) {
+    // {"parameters": {"kp":..,"ki":..,"kd":..}}: one gain set at every speed (omitted = current
+    //     standing-still value)
+    // {"parameters": {"table": [[speed_mps, kp, ki, kd], ...]}}: speed-indexed, interpolated
+    // {"parameters": {"defaults": true}}: config.h gains
+    // Optional "save": true persists the result to NVS (loaded at boot).
+    // Applied by the control task at the next tick.
+    // Reply: {"success":true,"table":[[speed,kp,ki,kd],...],"saved":..}
+    JsonObject params = context.getParameters();
+    GainSchedule request = requested_gains_;
+    bool change = false;
+
+    if (params["defaults"] | false) {
+        request.setDefaults();
+        change = true;
+    } else if (!params["table"].isNull()) {
+        JsonArray table = params["table"];
+        GainSchedule::Point points[GainSchedule::MAX_POINTS];
+        size_t count = table.size();
+        bool valid = params["table"].is<JsonArray>() && count > 0 && count <= GainSchedule::MAX_POINTS;
+        for (size_t i = 0; valid && i < count; i++) {
+            JsonVariant row = table[i];
+            float values[4];
+            valid = row.size() == 4;
+            for (size_t k = 0; valid && k < 4; k++) {
+                valid = row[k].is<float>();
+                values[k] = row[k].as<float>();
+            }
+            if (valid) {
+                points[i].speed = values[0];
+                points[i].kp = values[1];
+                points[i].ki = values[2];
+                points[i].kd = values[3];
+            }
+        }
+        if (!valid || !request.setPoints(points, (uint8_t)count)) {
+            context.sendResponse(false, RESPONSE_INVALID_PARAMETER,
+                                 "Invalid gain table: rows of [speed, kp, ki, kd], increasing speed, no negative values");
+            return false;
+        }
+        change = true;
+    } else if (!params["kp"].isNull() || !params["ki"].isNull() || !params["kd"].isNull()) {
+        GainSchedule::Point point = requested_gains_.getPoint(0);
+        point.speed = 0.0f;
+        point.kp = params["kp"] | point.kp;
+        point.ki = params["ki"] | point.ki;
+        point.kd = params["kd"] | point.kd;
+        if (!request.setPoints(&point, 1)) {
+            context.sendResponse(false, RESPONSE_INVALID_PARAMETER, "Invalid gains (must be non-negative numbers)");
+            return false;
+        }
+        change = true;
+    }
+
+    if (change && !requestGainSchedule(request)) {
+        context.sendResponse(false, RESPONSE_BUSY, "Gain change already pending");
+        return false;
+    }
+
+    bool saved = false;
+    if (params["save"] | false) {
+        // Flash write stalls both cores for a few ms (one short NVS blob)
+        saved = (params["defaults"] | false) ? GainSchedule::erase() : requested_gains_.save();
+    }
+    sendGains(context, saved);
+    return true;
+}
+
+bool BalanceController::handleAutotuneCommand(CommandContext& context) {
+    // {"parameters": {"action": "start" | "abort" | "status" | "apply", "save": bool}}
+    // start: relay experiment from the next tick (drops queued motion; keep the robot clear)
+    // apply: post the identified gains as a single-point gain table ("save" persists them)
+    // Reply (start): plain response. Reply (abort/status): {"success":true,"state":..,"cycles":..,
+    //     "reason":.. (aborted) | "ku","tu","amplitude","kp","ki","kd" (done)}
+    // Reply (apply): same as "gains"
+    JsonObject params = context.getParameters();
+    const char* action = params["action"] | "status";
+    Autotuner::State state = autotuner_.getState();
+
+    if (strcmp(action, "start") == 0) {
+        if (state == Autotuner::STATE_RUNNING || context.isMotorsOwned()) {
+            context.sendResponse(false, RESPONSE_BUSY, "Autotune, replay or motor calibration running");
+            return false;
+        }
+        context.dropQueuedMotion();  // The relay needs the robot at rest
+        requestAutotuneStart();
+        context.sendResponse(true, RESPONSE_OK, "Autotune started");
+        return true;
+    } else if (strcmp(action, "abort") == 0) {
+        requestAutotuneAbort();
+    } else if (strcmp(action, "apply") == 0) {
+        if (state != Autotuner::STATE_DONE) {
+            context.sendResponse(false, RESPONSE_FAILED, "No autotune result to apply");
+            return false;
+        }
+        const Autotuner::Result& result = autotuner_.getResult();
+        GainSchedule::Point point = {0.0f, result.kp, result.ki, result.kd};
+        GainSchedule request;
+        if (!request.setPoints(&point, 1) || !requestGainSchedule(request)) {
+            context.sendResponse(false, RESPONSE_FAILED, "Autotune gains rejected (invalid or gain change pending)");
+            return false;
+        }
+        sendGains(context, (params["save"] | false) && requested_gains_.save());
+        return true;
+    } else if (strcmp(action, "status") != 0) {
+        context.sendResponse(false, RESPONSE_INVALID_PARAMETER, "Unknown autotune action", action);
+        return false;
+    }
+
+    StaticJsonDocument<256> doc;
+    doc["success"] = true;
+    doc["state"] = Autotuner::stateName(state);
+    doc["cycles"] = autotuner_.getCyclesCompleted();
+    if (state == Autotuner::STATE_ABORTED) {
+        doc["reason"] = Autotuner::abortReasonName(autotuner_.getAbortReason());
+    } else if (state == Autotuner::STATE_DONE) {
+        const Autotuner::Result& result = autotuner_.getResult();
+        doc["ku"] = result.ku;
+        doc["tu"] = result.tu;
+        doc["amplitude"] = result.amplitude;
+        doc["kp"] = result.kp;
+        doc["ki"] = result.ki;
+        doc["kd"] = result.kd;
+    }
+    context.sendJson(doc);
+    return true;
+}
+
+void BalanceController::sendGains(CommandContext& context, bool saved) const {
+    StaticJsonDocument<384> doc;
+    doc["success"] = true;
+    JsonArray table = doc.createNestedArray("table");
+    for (uint8_t i = 0; i < requested_gains_.getCount(); i++) {
+        const GainSchedule::Point& point = requested_gains_.getPoint(i);
+        JsonArray row = table.createNestedArray();
+        row.add(point.speed);
+        row.add(point.kp);
+        row.add(point.ki);
+        row.add(point.kd);
+    }
+    doc["saved"] = saved;
+    context.sendJson(doc);
+}
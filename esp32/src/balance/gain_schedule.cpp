@@ -0,0 +1,123 @@
+#include "gain_schedule.h"
+#include <Preferences.h>
+#include <math.h>
+#include <string.h>
+
+static const char* NVS_KEY = "table";
+static const uint8_t BLOB_VERSION = 1;
+
+// NVS layout: version, count, then MAX_POINTS points (unused ones zeroed)
+struct GainBlob {
+    uint8_t version;
+    uint8_t count;
+    GainSchedule::Point points[GainSchedule::MAX_POINTS];
+};
+
+GainSchedule::GainSchedule() {
+    setDefaults();
+}
+
+void GainSchedule::setDefaults() {
+    memset(points_, 0, sizeof(points_));
+    points_[0].speed = 0.0f;
+    points_[0].kp = KP;
+    points_[0].ki = KI;
+    points_[0].kd = KD;
+    count_ = 1;
+}
+
+bool GainSchedule::setPoints(const Point* points, uint8_t count) {
+    if (!isValid(points, count)) {
+        return false;
+    }
+    memset(points_, 0, sizeof(points_));
+    memcpy(points_, points, count * sizeof(Point));
+    count_ = count;
+    return true;
+}
+
+GainSchedule::Point GainSchedule::lookup(float speed) const {
+    if (speed <= points_[0].speed) {
+        return points_[0];
+    }
+    for (uint8_t i = 1; i < count_; i++) {
+        if (speed < points_[i].speed) {
+            const Point& lo = points_[i - 1];
+            const Point& hi = points_[i];
+            float t = (speed - lo.speed) / (hi.speed - lo.speed);
+            Point out;
+            out.speed = speed;
+            out.kp = lo.kp + t * (hi.kp - lo.kp);
+            out.ki = lo.ki + t * (hi.ki - lo.ki);
+            out.kd = lo.kd + t * (hi.kd - lo.kd);
+            return out;
+        }
+    }
+    return points_[count_ - 1];
+}
+
+uint8_t GainSchedule::getCount() const {
+    return count_;
+}
+
+const GainSchedule::Point& GainSchedule::getPoint(uint8_t index) const {
+    return points_[index];
+}
+
+bool GainSchedule::load() {
+    Preferences prefs;
+    if (!prefs.begin(GAIN_SCHEDULE_NVS_NAMESPACE, true)) {
+        return false;  // Namespace not created yet: nothing saved
+    }
+    GainBlob blob;
+    bool ok = prefs.getBytesLength(NVS_KEY) == sizeof(blob) &&
+              prefs.getBytes(NVS_KEY, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+    if (!ok || blob.version != BLOB_VERSION) {
+        return false;
+    }
+    return setPoints(blob.points, blob.count);
+}
+
+bool GainSchedule::save() const {
+    GainBlob blob;
+    memset(&blob, 0, sizeof(blob));
+    blob.version = BLOB_VERSION;
+    blob.count = count_;
+    memcpy(blob.points, points_, sizeof(points_));
+
+    Preferences prefs;
+    if (!prefs.begin(GAIN_SCHEDULE_NVS_NAMESPACE, false)) {
+        return false;
+    }
+    bool ok = prefs.putBytes(NVS_KEY, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+    return ok;
+}
+
+bool GainSchedule::erase() {
+    Preferences prefs;
+    if (!prefs.begin(GAIN_SCHEDULE_NVS_NAMESPACE, false)) {
+        return false;
+    }
+    bool ok = !prefs.isKey(NVS_KEY) || prefs.remove(NVS_KEY);
+    prefs.end();
+    return ok;
+}
+
+bool GainSchedule::isValid(const Point* points, uint8_t count) {
+    if (count == 0 || count > MAX_POINTS) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        const Point& p = points[i];
+        if (!isfinite(p.speed) || !isfinite(p.kp) || !isfinite(p.ki) || !isfinite(p.kd) ||
+            p.speed < 0.0f || p.kp < 0.0f || p.ki < 0.0f || p.kd < 0.0f) {
+            return false;
+        }
+        if (i > 0 && !(p.speed > points[i - 1].speed)) {
+            return false;  // Speeds must strictly increase (no zero-width segments)
+        }
+    }
+    return true;
+}
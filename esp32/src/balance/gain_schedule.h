@@ -0,0 +1,88 @@
+#ifndef GAIN_SCHEDULE_H
+#define GAIN_SCHEDULE_H
+
+#include <stdint.h>
+#include "../include/config.h"
+
+/**
+ * Speed-indexed balance PID gains.
+ *
+ * Up to GAIN_SCHEDULE_MAX_POINTS breakpoints, sorted by wheel speed (m/s,
+ * magnitude). lookup() interpolates linearly between neighbours and holds the
+ * end values outside the table, so a single point is a plain fixed gain set.
+ * The default is one point at 0 m/s with KP/KI/KD from config.h.
+ *
+ * load()/save() keep the table in NVS (GAIN_SCHEDULE_NVS_NAMESPACE), so gains
+ * tuned over serial survive a reboot without reflashing.
+ *
+ * INTEGRATION POINT: BalanceController looks up gains every tick
+ * INTEGRATION POINT: BalanceController "gains" command edits and saves it; loadGains() reads it at boot
+ */
+class GainSchedule {
+public:
+    static const uint8_t MAX_POINTS = GAIN_SCHEDULE_MAX_POINTS;
+
+    struct Point {
+        float speed;  // |wheel speed| in m/s
+        float kp;
+        float ki;
+        float kd;
+    };
+
+    /**
+     * Start with the config.h defaults (one point: KP, KI, KD at 0 m/s).
+     */
+    GainSchedule();
+
+    /**
+     * Restore the config.h defaults.
+     */
+    void setDefaults();
+
+    /**
+     * Replace the table.
+     *
+     * @param points Breakpoints, strictly increasing speed starting at >= 0
+     * @param count 1 to MAX_POINTS
+     * @return false (table unchanged) if the points are invalid or any gain is negative
+     */
+    bool setPoints(const Point* points, uint8_t count);
+
+    /**
+     * Gains for a wheel speed (linear interpolation, clamped at the ends).
+     *
+     * @param speed |wheel speed| in m/s
+     */
+    Point lookup(float speed) const;
+
+    uint8_t getCount() const;
+    const Point& getPoint(uint8_t index) const;
+
+    /**
+     * Load the table saved in NVS.
+     *
+     * @return true if a valid table was found (otherwise the table is unchanged)
+     */
+    bool load();
+
+    /**
+     * Save the table to NVS. The flash write stalls both cores for a few
+     * milliseconds; call from the comms task.
+     *
+     * @return true if written
+     */
+    bool save() const;
+
+    /**
+     * Remove the saved table (the next boot uses the config.h defaults).
+     */
+    static bool erase();
+
+private:
+    Point points_[MAX_POINTS];
+    uint8_t count_;
+
+    static bool isValid(const Point* points, uint8_t count);
+};
+
+#endif // GAIN_SCHEDULE_H
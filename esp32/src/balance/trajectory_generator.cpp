@@ -0,0 +1,72 @@
+#include "trajectory_generator.h"
+#include <math.h>
+
+TrajectoryGenerator::TrajectoryGenerator(float max_rate, float max_jerk, float dt)
+    : max_rate_(max_rate), max_jerk_(max_jerk), dt_(dt),
+      target_(0.0f), value_(0.0f), rate_(0.0f) {
+}
+
+void TrajectoryGenerator::setTarget(float target) {
+    target_ = target;
+}
+
+float TrajectoryGenerator::update() {
+    float error = target_ - value_;
+    if (error == 0.0f && rate_ == 0.0f) {
+        return value_;
+    }
+
+    // Fastest rate that can still be ramped to zero by the target:
+    // ramping rate r down by j*dt per tick covers r^2 / 2j + r*dt / 2
+    float desired = max_rate_;
+    if (max_jerk_ > 0.0f) {
+        float half_step = 0.5f * max_jerk_ * dt_;
+        float braking = sqrtf(half_step * half_step + 2.0f * max_jerk_ * fabsf(error)) - half_step;
+        if (braking < desired) {
+            desired = braking;
+        }
+    }
+    desired = error > 0.0f ? desired : -desired;
+
+    if (max_jerk_ > 0.0f) {
+        float step = max_jerk_ * dt_;
+        if (desired > rate_ + step) {
+            desired = rate_ + step;
+        } else if (desired < rate_ - step) {
+            desired = rate_ - step;
+        }
+    }
+    rate_ = desired;
+
+    // Land exactly on the target instead of overshooting by a partial tick
+    float delta = rate_ * dt_;
+    if ((error > 0.0f && delta >= error) || (error < 0.0f && delta <= error)) {
+        value_ = target_;
+        rate_ = 0.0f;
+    } else {
+        value_ += delta;
+    }
+    return value_;
+}
+
+void TrajectoryGenerator::reset(float value) {
+    target_ = value;
+    value_ = value;
+    rate_ = 0.0f;
+}
+
+float TrajectoryGenerator::getValue() const {
+    return value_;
+}
+
+float TrajectoryGenerator::getTarget() const {
+    return target_;
+}
+
+float TrajectoryGenerator::getRate() const {
+    return rate_;
+}
+
+bool TrajectoryGenerator::isSettled() const {
+    return value_ == target_ && rate_ == 0.0f;
+}
@@ -0,0 +1,60 @@
+#ifndef TRAJECTORY_GENERATOR_H
+#define TRAJECTORY_GENERATOR_H
+
+/**
+ * Jerk-limited setpoint profile generator (one axis).
+ *
+ * setTarget() records where the setpoint should go; update() advances the
+ * setpoint by one control tick. The setpoint's rate of change is limited to
+ * max_rate and the change of that rate to max_jerk, and the rate is shaped
+ * so the setpoint lands on the target without overshoot (S-curve). With
+ * max_jerk = 0 the profile is trapezoidal (rate limit only).
+ *
+ * Float only: setpoints are outside the fixed-point control kernel.
+ * Not thread-safe: call from the control task only.
+ */
+class TrajectoryGenerator {
+public:
+    /**
+     * @param max_rate Maximum setpoint rate (units per second)
+     * @param max_jerk Maximum change of rate (units per second^2), 0 = unlimited
+     * @param dt Update period (seconds)
+     */
+    TrajectoryGenerator(float max_rate, float max_jerk, float dt);
+
+    /**
+     * Set the value the profile moves toward.
+     */
+    void setTarget(float target);
+
+    /**
+     * Advance one tick.
+     *
+     * @return Profiled setpoint
+     */
+    float update();
+
+    /**
+     * Jump to a value immediately (target = value, rate = 0).
+     */
+    void reset(float value = 0.0f);
+
+    float getValue() const;
+    float getTarget() const;
+    float getRate() const;
+
+    /**
+     * Check whether the setpoint has reached its target.
+     */
+    bool isSettled() const;
+
+private:
+    float max_rate_;
+    float max_jerk_;
+    float dt_;
+    float target_;
+    float value_;
+    float rate_;
+};
+
+#endif // TRAJECTORY_GENERATOR_H
@@ -0,0 +1,54 @@
+#include "command_context.h"
+#include "command_handler.h"
+#include "../replay/log_replay.h"
+#include "../motor_control/motor_calibrator.h"
+#include "../comms/tx_ring.h"
+#include "../include/config.h"
+
+CommandContext::CommandContext(CommandHandler& handler, JsonObject parameters)
+    : handler_(handler), parameters_(parameters) {
+}
+
+JsonObject CommandContext::getParameters() const {
+    return parameters_;
+}
+
+void CommandContext::sendResponse(bool success, ResponseCode code, const char* message, const char* detail) {
+    handler_.sendResponse(success, code, message, detail);
+}
+
+void CommandContext::sendJson(JsonDocument& doc) {
+    handler_.writeJson(doc);
+}
+
+void CommandContext::sendFrames(const uint8_t* data, size_t length) {
+    // Keeps SERIAL_TX_RESPONSE_RESERVE free, so replies to later commands still fit
+    TxRing* tx_ring = handler_.tx_ring_;
+    if (tx_ring == nullptr) {
+        Serial.write(data, length);
+        return;
+    }
+    while (!tx_ring->write(data, length, SERIAL_TX_RESPONSE_RESERVE)) {
+        vTaskDelay(1);
+    }
+}
+
+void CommandContext::dropQueuedMotion() {
+    // Position first: the control task reads it once it sees the flag
+    handler_.drop_position_.store(handler_.command_queue_.producerPosition(), std::memory_order_relaxed);
+    handler_.drop_pending_.store(true, std::memory_order_release);
+}
+
+bool CommandContext::isMotorsOwned() const {
+    return (handler_.log_replay_ != nullptr && handler_.log_replay_->isActive()) ||
+           (handler_.motor_calibrator_ != nullptr &&
+            handler_.motor_calibrator_->getState() == MotorCalibrator::STATE_RUNNING);
+}
+
+unsigned long CommandContext::getMotionTimeouts() const {
+    return handler_.motion_timeouts_;
+}
+
+unsigned long CommandContext::getTxDroppedCount() const {
+    return handler_.tx_ring_ != nullptr ? handler_.tx_ring_->getDroppedCount() : 0;
+}
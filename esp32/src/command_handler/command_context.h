@@ -0,0 +1,97 @@
+#ifndef COMMAND_CONTEXT_H
+#define COMMAND_CONTEXT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "response_codes.h"
+
+class CommandHandler;
+
+/**
+ * One JSON command as a subsystem's handler sees it: the parameters, and
+ * the replies and queue hooks that belong to the CommandHandler.
+ *
+ * Replies go out in the request's format and carry its sequence number
+ * and the cumulative ACK, so a handler never deals with link state.
+ * Contexts live on the comms task's stack for the length of one command.
+ *
+ * INTEGRATION POINT: CommandHandler::processCommand() dispatches through its JsonCommand table
+ */
+class CommandContext {
+public:
+    CommandContext(CommandHandler& handler, JsonObject parameters);
+
+    /**
+     * Command parameters (a null object when absent: every read falls back
+     * to its default).
+     */
+    JsonObject getParameters() const;
+
+    /**
+     * Plain reply, as CommandHandler::sendResponse().
+     */
+    void sendResponse(bool success, ResponseCode code, const char* message = nullptr,
+                      const char* detail = nullptr);
+
+    /**
+     * Reply with a JSON document ("seq" and "ack" are added).
+     */
+    void sendJson(JsonDocument& doc);
+
+    /**
+     * Queue raw frames after the reply, waiting for TX room instead of
+     * dropping them (bulk dumps that outrun the UART).
+     *
+     * @param data Whole frames
+     * @param length Bytes
+     */
+    void sendFrames(const uint8_t* data, size_t length);
+
+    /**
+     * Drop motion queued before this command, and any running pattern,
+     * at the next control tick; balancing returns to neutral. Unlike STOP,
+     * an autotune run and the sequence numbering are left alone.
+     */
+    void dropQueuedMotion();
+
+    /**
+     * Check whether a log replay or a motor sweep has taken the motors
+     * (balancing is suspended).
+     */
+    bool isMotorsOwned() const;
+
+    unsigned long getMotionTimeouts() const;  // Motion segments ended by their timeout
+    unsigned long getTxDroppedCount() const;  // Messages the TX ring dropped (0 without a ring)
+
+private:
+    CommandHandler& handler_;
+    JsonObject parameters_;
+};
+
+/**
+ * Entry of the CommandHandler's id-indexed JSON command table: a handler
+ * bound to the object that owns it. A null owner answers NOT_AVAILABLE
+ * (optional component not attached).
+ */
+struct JsonCommand {
+    bool (*function)(void* owner, CommandContext& context);
+    void* owner;
+};
+
+template <typename T, bool (T::*Method)(CommandContext&)>
+bool callJsonCommand(void* owner, CommandContext& context) {
+    return (static_cast<T*>(owner)->*Method)(context);
+}
+
+/**
+ * Bind a member handler, e.g. bindJsonCommand<LoopStats, &LoopStats::handleCommand>(stats).
+ *
+ * @param owner Object the handler runs on (nullptr: not attached yet)
+ */
+template <typename T, bool (T::*Method)(CommandContext&)>
+JsonCommand bindJsonCommand(T* owner) {
+    JsonCommand command = {&callJsonCommand<T, Method>, owner};
+    return command;
+}
+
+#endif // COMMAND_CONTEXT_H
@@ -2,8 +2,79 @@
 #include "../balance/balance_controller.h"
 #include "../motor_control/motor_driver.h"
 #include "../sensors/encoder_reader.h"
+#include "../timing/loop_stats.h"
+#include "../telemetry/telemetry.h"
+#include "../telemetry/flight_recorder.h"
+#include "../replay/log_replay.h"
+#include "../motor_control/motor_calibrator.h"
+#include "../motor_control/pwm_control.h"
+#include "../odometry/odometry.h"
+#include "../comms/binary_protocol.h"
+#include "../comms/json_line_writer.h"
+#include "../comms/tx_ring.h"
+#include "command_table.h"
 #include "../include/config.h"
 
+static const int BINARY_PROTOCOL_VERSION = 4;  // 2: sequence numbers in motion and response frames; 3: wheel_velocity in telemetry; 4: odometry pose
+
+// Plain replies: success, code, seq/ack, two numeric fields, and debug text in verbose builds
+static const size_t RESPONSE_LINE_SIZE = SERIAL_RESPONSE_VERBOSE ? 288 : 96;
+
+// Sequence numbers run 1..65535 and wrap to 1 (0 = unsequenced)
+static uint16_t nextSequence(uint16_t seq) {
+    return seq == 0xFFFF ? 1 : (uint16_t)(seq + 1);
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Program defaults for absent parameters (steps carry their own targets)
+// {steps, step_count, repetitions, mirror_left, speed, duration s, distance m, angle deg, default repetitions}
+static const MotionPattern PROGRAM_DEFAULTS = {nullptr, 0, 0, false, 0.4f, 1.0f, 0.5f, 90.0f, 1};
+
+static_assert((PROGRAM_STAGING_SLOTS & (PROGRAM_STAGING_SLOTS - 1)) == 0,
+              "PROGRAM_STAGING_SLOTS must be a power of two (free-running slot counters)");
+
+const CommandHandler::Handler CommandHandler::HANDLERS[COMMAND_ID_LIMIT] = {
+    nullptr,                                       // 0x00 COMMAND_UNKNOWN
+    &CommandHandler::executePrimitiveCommand,      // 0x01 COMMAND_MOVE_FORWARD
+    &CommandHandler::executePrimitiveCommand,      // 0x02 COMMAND_MOVE_BACKWARD
+    &CommandHandler::executePrimitiveCommand,      // 0x03 COMMAND_ROTATE_CLOCKWISE
+    &CommandHandler::executePrimitiveCommand,      // 0x04 COMMAND_ROTATE_COUNTERCLOCKWISE
+    nullptr,                                       // 0x05 COMMAND_STOP (bypass, never dispatched)
+    nullptr, nullptr, nullptr, nullptr, nullptr,   // 0x06 - 0x0A
+    nullptr, nullptr, nullptr, nullptr, nullptr,   // 0x0B - 0x0F
+    &CommandHandler::executeIntermediateCommand,   // 0x10 COMMAND_TURN_LEFT
+    &CommandHandler::executeIntermediateCommand,   // 0x11 COMMAND_TURN_RIGHT
+    &CommandHandler::executeIntermediateCommand,   // 0x12 COMMAND_MOVE_FORWARD_FOR_TIME
+    &CommandHandler::executeIntermediateCommand,   // 0x13 COMMAND_MOVE_BACKWARD_FOR_TIME
+    &CommandHandler::executeIntermediateCommand,   // 0x14 COMMAND_MAKE_SQUARE
+    &CommandHandler::executeIntermediateCommand,   // 0x15 COMMAND_MAKE_CIRCLE
+    &CommandHandler::executeIntermediateCommand,   // 0x16 COMMAND_MAKE_STAR
+    &CommandHandler::executeIntermediateCommand,   // 0x17 COMMAND_ZIGZAG
+    &CommandHandler::executeIntermediateCommand,   // 0x18 COMMAND_SPIN
+    &CommandHandler::executeIntermediateCommand,   // 0x19 COMMAND_DANCE
+    nullptr, nullptr, nullptr,                     // 0x1A - 0x1C
+    nullptr, nullptr, nullptr,                     // 0x1D - 0x1F
+    nullptr,                                       // 0x20 COMMAND_BINARY_MODE (link control)
+    nullptr,                                       // 0x21 COMMAND_JSON_MODE (link control)
+    nullptr,                                       // 0x22 COMMAND_STATS (diagnostic)
+    nullptr,                                       // 0x23 COMMAND_TELEMETRY (diagnostic)
+    nullptr,                                       // 0x24 COMMAND_RECORDER (diagnostic)
+    nullptr,                                       // 0x25 COMMAND_PWM (configuration)
+    nullptr,                                       // 0x26 COMMAND_GAINS (configuration)
+    nullptr,                                       // 0x27 COMMAND_AUTOTUNE (configuration)
+    nullptr,                                       // 0x28 COMMAND_SYNC (link control)
+    nullptr,                                       // 0x29 COMMAND_PROGRAM (staged upload)
+    nullptr,                                       // 0x2A COMMAND_REPLAY (diagnostic)
+    nullptr,                                       // 0x2B COMMAND_REPLAY_SAMPLE (replay stream)
+    nullptr                                        // 0x2C COMMAND_MOTOR_CAL (configuration)
+};
+
 CommandHandler::CommandHandler(BalanceController* balance_controller,
                                MotorDriver* left_motor,
                                MotorDriver* right_motor,
@@ -14,7 +85,34 @@ CommandHandler::CommandHandler(BalanceController* balance_controller,
       right_motor_(right_motor),
       left_encoder_(left_encoder),
       right_encoder_(right_encoder),
-      queue_head_(0), queue_tail_(0), queue_size_(0) {
+      flight_recorder_(nullptr), tx_ring_(nullptr),
+      log_replay_(nullptr), odometry_(nullptr), motor_calibrator_(nullptr),
+      binary_link_(false), binary_response_(false), current_command_(COMMAND_UNKNOWN),
+      sequenced_(false), ack_seq_(0), current_seq_(0), awaiting_sync_(false),
+      stop_pending_(false), stop_position_(0), drop_pending_(false), drop_position_(0),
+      program_head_(0), program_tail_(0),
+      active_pattern_(nullptr), step_index_(0), repeats_left_(0), segment_kind_(SEGMENT_TIMED),
+      segment_ticks_(0), segment_tick_limit_(0), segment_target_(0.0),
+      segment_left_start_(0), segment_right_start_(0), segment_heading_start_(0.0f), motion_timeouts_(0) {
+    active_params_ = CommandParams();
+    program_pattern_ = PROGRAM_DEFAULTS;
+
+    // JSON commands: each subsystem answers its own; optional ones get an owner when attached
+    for (uint8_t i = 0; i < COMMAND_ID_LIMIT; i++) {
+        json_commands_[i].function = nullptr;
+        json_commands_[i].owner = nullptr;
+    }
+    json_commands_[COMMAND_STATS] = bindJsonCommand<LoopStats, &LoopStats::handleCommand>(nullptr);
+    json_commands_[COMMAND_TELEMETRY] = bindJsonCommand<Telemetry, &Telemetry::handleCommand>(nullptr);
+    json_commands_[COMMAND_RECORDER] = bindJsonCommand<FlightRecorder, &FlightRecorder::handleCommand>(nullptr);
+    json_commands_[COMMAND_PWM] = bindJsonCommand<PwmControl, &PwmControl::handleCommand>(nullptr);
+    json_commands_[COMMAND_GAINS] =
+        bindJsonCommand<BalanceController, &BalanceController::handleGainsCommand>(balance_controller);
+    json_commands_[COMMAND_AUTOTUNE] =
+        bindJsonCommand<BalanceController, &BalanceController::handleAutotuneCommand>(balance_controller);
+    json_commands_[COMMAND_PROGRAM] = bindJsonCommand<CommandHandler, &CommandHandler::handleProgram>(this);
+    json_commands_[COMMAND_REPLAY] = bindJsonCommand<LogReplay, &LogReplay::handleCommand>(nullptr);
+    json_commands_[COMMAND_MOTOR_CAL] = bindJsonCommand<MotorCalibrator, &MotorCalibrator::handleCommand>(nullptr);
 }
 
 void CommandHandler::begin() {
@@ -22,174 +120,542 @@ void CommandHandler::begin() {
     Serial.println("Command handler initialized");
 }
 
-bool CommandHandler::processCommand(const String& json_string) {
+bool CommandHandler::processCommand(const char* json, size_t length) {
+    binary_response_ = false;
+    current_command_ = COMMAND_UNKNOWN;
+    current_seq_ = 0;
+
     StaticJsonDocument<512> doc;
-    DeserializationError error = deserializeJson(doc, json_string);
+    DeserializationError error = deserializeJson(doc, json, length);
     
     if (error) {
-        sendResponse(false, "JSON parse error: " + String(error.c_str()));
+        sendResponse(false, RESPONSE_PARSE_ERROR, "JSON parse error", error.c_str());
         return false;
     }
     
     // Validate basic structure
     if (!validateCommand(doc)) {
-        sendResponse(false, "Missing or invalid command/parameters");
+        sendResponse(false, RESPONSE_INVALID_COMMAND, "Missing or invalid command/parameters");
         return false;
     }
     
-    String command = doc["command"].as<String>();
+    const char* command = doc["command"];
+    CommandId id = command_table::lookup(command);  // One hash + one strcmp
     int priority = doc["priority"] | 0;
+    current_command_ = id;
     
-    // STOP command bypass (immediate, highest priority)
-    if (command == "stop" || priority == 100) {
+    // STOP command bypass (immediate, highest priority, never sequenced or held for a gap)
+    if (id == COMMAND_STOP || priority == 100) {
         executeStop();
-        sendResponse(true, "Emergency stop executed");
+        sendResponse(true, RESPONSE_OK, "Emergency stop executed");
         return true;
     }
     
-    // Get parameters object (treat missing as empty)
-    JsonObject params = doc["parameters"] | doc.createNestedObject("parameters");
+    // Sequence restart: the Pi's next sequenced command is 1
+    if (id == COMMAND_SYNC) {
+        sequenced_ = true;
+        ack_seq_ = 0;
+        awaiting_sync_ = false;
+        char line[RESPONSE_LINE_SIZE];
+        JsonLineWriter writer(line, sizeof(line));
+        beginReply(writer, true, RESPONSE_OK);
+        writer.add("window", (int32_t)MAX_QUEUE_SIZE);
+        transmit(line, writer.finish());
+        return true;
+    }
     
-    // Route to handler based on command type
-    if (command == "move_forward" || command == "move_backward" ||
-        command == "rotate_clockwise" || command == "rotate_counterclockwise") {
-        return executePrimitiveCommand(command, params);
+    current_seq_ = doc["seq"] | 0;
+    if (current_seq_ != 0 && !acceptSequence()) {
+        return false;
     }
     
-    if (command == "turn_left" || command == "turn_right" ||
-        command == "move_forward_for_time" || command == "move_backward_for_time" ||
-        command == "make_square" || command == "make_circle" || command == "make_star" ||
-        command == "zigzag" || command == "spin" || command == "dance") {
-        return executeIntermediateCommand(command, params);
+    // Parameters object (a null object when absent: every read falls back to its default).
+    // Not `doc["parameters"] | doc.createNestedObject(...)`: the fallback is evaluated
+    // first and replaces the parameters with an empty object
+    JsonObject params = doc["parameters"].as<JsonObject>();
+    
+    // Configuration, diagnostics and uploads: answered by the subsystem that owns them
+    const JsonCommand& json_command = json_commands_[id];
+    if (json_command.function != nullptr) {
+        if (json_command.owner == nullptr) {
+            sendResponse(false, RESPONSE_NOT_AVAILABLE, "Not available (component not attached)", command);
+            return false;
+        }
+        CommandContext context(*this, params);
+        return json_command.function(json_command.owner, context);
     }
     
-    sendResponse(false, "Unknown command: " + command);
-    return false;
+    // Link handshake: Pi sends binary frames from now on (responses follow the request format)
+    if (id == COMMAND_BINARY_MODE) {
+        binary_link_ = true;
+        StaticJsonDocument<96> reply;
+        reply["success"] = true;
+        reply["protocol"] = BINARY_PROTOCOL_VERSION;
+        writeJson(reply);
+        return true;
+    }
+    if (id == COMMAND_JSON_MODE) {
+        binary_link_ = false;
+        sendResponse(true, RESPONSE_OK, "JSON link");
+        return true;
+    }
+    
+    if (id == COMMAND_UNKNOWN) {
+        sendResponse(false, RESPONSE_UNKNOWN_COMMAND, "Unknown command", command);
+        return false;
+    }
+    
+    CommandParams cmd_params;
+    if (!extractParams(params, cmd_params)) {
+        return false;
+    }
+    return dispatchCommand(id, cmd_params);
 }
 
-bool CommandHandler::executePrimitiveCommand(const String& command, JsonObject params) {
-    // Extract and validate speed parameter
-    float speed = params["speed"] | 0.4;  // Default 0.4
-    float original_speed = speed;
+bool CommandHandler::processFrame(uint8_t opcode, const uint8_t* payload, size_t length) {
+    binary_response_ = true;
+    CommandId id = static_cast<CommandId>(opcode);
+    current_command_ = id;
+    current_seq_ = 0;
+    
+    // STOP command bypass (immediate, highest priority)
+    if (id == COMMAND_STOP) {
+        executeStop();
+        sendResponse(true, RESPONSE_OK);
+        return true;
+    }
+    
+    if (id == COMMAND_JSON_MODE) {
+        binary_link_ = false;
+        sendResponse(true, RESPONSE_OK);
+        return true;
+    }
+    
+    // Log replay stream: queued for the control task, not answered (the Pi paces with "replay" status)
+    if (id == COMMAND_REPLAY_SAMPLE) {
+        if (log_replay_ == nullptr || length != sizeof(TelemetrySample)) {
+            return false;
+        }
+        TelemetrySample sample;
+        memcpy(&sample, payload, sizeof(sample));  // Wire layout is the struct layout (little-endian, packed)
+        return log_replay_->post(sample);
+    }
+    
+    // COMMAND_UNKNOWN: frame rejected by the decoder (bad CRC or opcode)
+    if (id == COMMAND_UNKNOWN) {
+        sendResponse(false, RESPONSE_INVALID_COMMAND);
+        return false;
+    }
+    
+    // Payload size is fixed per opcode and already checked by FrameDecoder
+    if (length != FRAME_COMMAND_PAYLOAD_SIZE) {
+        sendResponse(false, RESPONSE_INVALID_COMMAND);
+        return false;
+    }
     
+    CommandParams params;
+    params.speed = readFloatLE(payload);
+    params.duration = readFloatLE(payload + 4);
+    params.angle = readFloatLE(payload + 8);
+    params.distance = readFloatLE(payload + 12);
+    params.repetitions = payload[16];
+    params.direction = payload[17];
+    current_seq_ = (uint16_t)(payload[18] | (payload[19] << 8));
+    if (current_seq_ != 0 && !acceptSequence()) {
+        return false;
+    }
+    return dispatchCommand(id, params);
+}
+
+bool CommandHandler::dispatchCommand(CommandId command, const CommandParams& params) {
+    // Route to handler based on command id
+    Handler handler = command < COMMAND_ID_LIMIT ? HANDLERS[command] : nullptr;
+    if (handler == nullptr) {
+        sendResponse(false, RESPONSE_UNKNOWN_COMMAND, "Unknown command", command_table::nameOf(command));
+        return false;
+    }
+    return (this->*handler)(command, params);
+}
+
+bool CommandHandler::extractParams(JsonObject params, CommandParams& out) {
     // Validate speed type
     if (!params["speed"].is<float>() && !params["speed"].isNull()) {
-        sendResponse(false, "Invalid speed type (must be numeric)");
+        sendResponse(false, RESPONSE_INVALID_PARAMETER, "Invalid speed type (must be numeric)");
         return false;
     }
     
+    out.speed = params["speed"] | NAN;
+    out.duration = params["duration"] | NAN;
+    out.angle = params["angle"] | NAN;
+    
+    // Pattern size parameters share one slot; commands use at most one of them
+    out.distance = NAN;
+    static const char* const DISTANCE_KEYS[] = {"side_length", "radius", "size", "segment_length"};
+    for (const char* key : DISTANCE_KEYS) {
+        if (!params[key].isNull()) {
+            out.distance = params[key] | NAN;
+            break;
+        }
+    }
+    
+    int repetitions = params["repetitions"] | 0;
+    out.repetitions = (uint8_t)constrain(repetitions, 0, 255);
+    const char* direction = params["direction"] | "left";
+    out.direction = (strcmp(direction, "right") == 0) ? 1 : 0;
+    return true;
+}
+
+bool CommandHandler::executePrimitiveCommand(CommandId command, const CommandParams& params) {
+    // Extract speed parameter
+    float speed = isnan(params.speed) ? 0.4f : params.speed;  // Default 0.4
+    float original_speed = speed;
+    
     // Clamp speed to valid range [0.0, 1.0]
     speed = constrain(speed, 0.0f, 1.0f);
-    float motor_speed = speedToMotorValue(speed);
     
-    // Build response message with clamping info if needed
-    String response_msg;
+    // Debug text only (SERIAL_RESPONSE_VERBOSE); clamping is reported as numeric fields
+    const char* message;
     bool clamped = (speed != original_speed);
     
-    if (command == "move_forward") {
-        balance_controller_->setVelocitySetpoint(motor_speed);
-        response_msg = "Moving forward";
-        if (clamped) {
-            response_msg += " (speed clamped " + String(original_speed, 2) + " -> " + String(speed, 2) + ")";
-        }
-        sendResponse(true, response_msg);
-        return true;
-    }
-    
-    if (command == "move_backward") {
-        balance_controller_->setVelocitySetpoint(-motor_speed);
-        response_msg = "Moving backward";
-        if (clamped) {
-            response_msg += " (speed clamped " + String(original_speed, 2) + " -> " + String(speed, 2) + ")";
-        }
-        sendResponse(true, response_msg);
-        return true;
+    if (command == COMMAND_MOVE_FORWARD) {
+        message = "Moving forward";
+    } else if (command == COMMAND_MOVE_BACKWARD) {
+        message = "Moving backward";
+    } else if (command == COMMAND_ROTATE_CLOCKWISE) {
+        message = "Rotating clockwise";
+    } else if (command == COMMAND_ROTATE_COUNTERCLOCKWISE) {
+        message = "Rotating counterclockwise";
+    } else {
+        return false;
     }
     
-    if (command == "rotate_clockwise") {
-        balance_controller_->setRotationSetpoint(motor_speed);
-        response_msg = "Rotating clockwise";
-        if (clamped) {
-            response_msg += " (speed clamped " + String(original_speed, 2) + " -> " + String(speed, 2) + ")";
-        }
-        sendResponse(true, response_msg);
-        return true;
+    // Setpoint is applied by the control task on its next tick
+    CommandParams queued = params;
+    queued.speed = speed;
+    if (!enqueueCommand(command, queued)) {
+        sendResponse(false, RESPONSE_QUEUE_FULL, "Command queue full");
+        return false;
     }
     
-    if (command == "rotate_counterclockwise") {
-        balance_controller_->setRotationSetpoint(-motor_speed);
-        response_msg = "Rotating counterclockwise";
-        if (clamped) {
-            response_msg += " (speed clamped " + String(original_speed, 2) + " -> " + String(speed, 2) + ")";
-        }
-        sendResponse(true, response_msg);
+    if (clamped && !binary_response_) {
+        // {"success":true,"code":1,"speed":1.00,"requested":1.50}
+        char line[RESPONSE_LINE_SIZE];
+        JsonLineWriter writer(line, sizeof(line));
+        beginReply(writer, true, RESPONSE_CLAMPED);
+        writer.add("speed", speed, 2);
+        writer.add("requested", original_speed, 2);
+#if SERIAL_RESPONSE_VERBOSE
+        writer.add("message", message);
+#endif
+        transmit(line, writer.finish());
         return true;
     }
-    
-    return false;
+    sendResponse(true, clamped ? RESPONSE_CLAMPED : RESPONSE_OK, message);
+    return true;
 }
 
-bool CommandHandler::executeIntermediateCommand(const String& command, JsonObject params) {
-    // TODO: Execute intermediate commands
-    // 
+bool CommandHandler::executeIntermediateCommand(CommandId command, const CommandParams& params) {
     // Time-based commands: Track duration, clear setpoint when complete
     // Angle-based commands: Use encoder feedback to achieve target angle
     // Pattern commands: Execute sequence of primitives
-    
-    if (command == "turn_left" || command == "turn_right") {
-        // Angle-based turning - not yet implemented (requires processQueue)
-        sendResponse(false, "Command not implemented yet: " + command);
+    // All run on the control task from a pre-compiled MotionPattern (motion_patterns.cpp)
+    if (motionPatternFor(command) == nullptr) {
+        sendResponse(false, RESPONSE_NOT_IMPLEMENTED, "Intermediate command not yet implemented", command_table::nameOf(command));
         return false;
     }
     
-    if (command == "move_forward_for_time" || command == "move_backward_for_time") {
-        // Time-based movement - not yet implemented (requires processQueue)
-        sendResponse(false, "Command not implemented yet: " + command);
-        return false;
+    // Clamp speed to valid range [0.0, 1.0] (absent speed uses the pattern default)
+    CommandParams queued = params;
+    if (!isnan(queued.speed)) {
+        queued.speed = constrain(queued.speed, 0.0f, 1.0f);
     }
     
-    // TODO: Implement pattern commands (square, circle, star, zigzag, spin, dance)
-    // These expand to sequences of primitive commands
+    if (!enqueueCommand(command, queued)) {
+        sendResponse(false, RESPONSE_QUEUE_FULL, "Command queue full");
+        return false;
+    }
     
-    sendResponse(false, "Intermediate command not yet implemented: " + command);
-    return false;
+    sendResponse(true, RESPONSE_OK, "Executing", command_table::nameOf(command));
+    return true;
 }
 
 void CommandHandler::executeStop() {
-    // TODO: Immediate stop - highest priority
-    // 1. Clear command queue
+    // Immediate stop - highest priority (applied by the next control tick)
+    // 1. Clear command queue (everything queued before this STOP)
     // 2. Return balance controller to neutral (clear all setpoints)
     // 3. Balance loop continues running
     
-    clearQueue();
-    balance_controller_->setNeutral();
+    stop_position_.store(command_queue_.producerPosition(), std::memory_order_relaxed);
+    stop_pending_.store(true, std::memory_order_release);
     
-    Serial.println("STOP command executed - returning to neutral balance");
+    // Sequenced commands still on the wire were sent before the STOP: none may run after it
+    awaiting_sync_ = sequenced_;
+    
+    // A running motor sweep owns the motors (update() is not called): abort it
+    if (motor_calibrator_ != nullptr) {
+        motor_calibrator_->requestAbort();
+    }
+    
+    // Freeze the lead-up to the stop (RAM only: flash writes would stall balancing)
+    if (flight_recorder_ != nullptr) {
+        flight_recorder_->trigger(FlightRecorder::TRIGGER_STOP);
+    }
+    
+#if SERIAL_RESPONSE_VERBOSE
+    if (!binary_link_) {
+        print("STOP command executed - returning to neutral balance");
+    }
+#endif
+}
+
+void CommandHandler::sendResponse(bool success, ResponseCode code, const char* message, const char* detail) {
+    if (binary_response_) {
+        acknowledge(code);
+        uint8_t payload[FRAME_RESPONSE_PAYLOAD_SIZE] = {
+            (uint8_t)(success ? 1 : 0), (uint8_t)current_command_, (uint8_t)code,
+            (uint8_t)(current_seq_ & 0xFF), (uint8_t)(current_seq_ >> 8),
+            (uint8_t)(ack_seq_ & 0xFF), (uint8_t)(ack_seq_ >> 8)};
+        uint8_t frame[FRAME_RESPONSE_PAYLOAD_SIZE + FRAME_OVERHEAD];
+        size_t size = encodeFrame(FRAME_OP_RESPONSE, payload, sizeof(payload), frame);
+        transmit(frame, size);
+        return;
+    }
+
+    // {"success":false,"code":4,"seq":7,"ack":6} (+ "message"/"detail" text in verbose builds)
+    char line[RESPONSE_LINE_SIZE];
+    JsonLineWriter writer(line, sizeof(line));
+    beginReply(writer, success, code);
+#if SERIAL_RESPONSE_VERBOSE
+    if (message != nullptr) {
+        writer.add("message", message);
+    }
+    if (detail != nullptr) {
+        writer.add("detail", detail);
+    }
+#else
+    (void)message;
+    (void)detail;
+#endif
+    transmit(line, writer.finish());
+}
+
+void CommandHandler::rejectOverlongLine() {
+    // The line never parsed: no command id or sequence number to echo
+    binary_response_ = false;
+    current_command_ = COMMAND_UNKNOWN;
+    current_seq_ = 0;
+    sendResponse(false, RESPONSE_LINE_TOO_LONG, "Command line too long");
+}
+
+bool CommandHandler::acceptSequence() {
+    // Go-back-N receiver: only the next number is executed, so commands run in send order
+    uint16_t expected = nextSequence(ack_seq_);
+    sequenced_ = true;
+    if (awaiting_sync_) {
+        // The Pi syncs before its first command after STOP; anything before that predates it
+        sendResponse(false, RESPONSE_OUT_OF_ORDER, "Stopped, sync before sending");
+        return false;
+    }
+    if (current_seq_ == expected) {
+        return true;
+    }
+    // Within half the sequence space behind the ACK: a resend of something already handled
+    uint16_t behind = (uint16_t)(((uint32_t)ack_seq_ + 0xFFFF - current_seq_) % 0xFFFF);
+    if (ack_seq_ != 0 && behind < 0x8000) {
+        sendResponse(true, RESPONSE_DUPLICATE, "Duplicate sequence number");
+    } else {
+        sendResponse(false, RESPONSE_OUT_OF_ORDER, "Sequence gap, resend from ack + 1");
+    }
+    return false;
+}
+
+void CommandHandler::acknowledge(ResponseCode code) {
+    // Cumulative ACK: the expected command is delivered once answered, whatever the outcome,
+    // except when the Pi must resend it (queue full)
+    if (current_seq_ != 0 && current_seq_ == nextSequence(ack_seq_) &&
+        code != RESPONSE_QUEUE_FULL && code != RESPONSE_DUPLICATE && code != RESPONSE_OUT_OF_ORDER) {
+        ack_seq_ = current_seq_;
+    }
+}
+
+void CommandHandler::beginReply(JsonLineWriter& writer, bool success, ResponseCode code) {
+    acknowledge(code);
+    writer.add("success", success);
+    writer.add("code", (int32_t)code);
+    if (current_seq_ != 0) {
+        writer.add("seq", (int32_t)current_seq_);
+    }
+    if (sequenced_) {
+        writer.add("ack", (int32_t)ack_seq_);
+    }
 }
 
-void CommandHandler::sendResponse(bool success, const String& message) {
-    StaticJsonDocument<200> doc;
-    doc["success"] = success;
-    if (message.length() > 0) {
-        doc["message"] = message;
+void CommandHandler::setTxRing(TxRing* tx_ring) {
+    tx_ring_ = tx_ring;
+}
+
+void CommandHandler::print(const char* text) {
+    if (tx_ring_ != nullptr) {
+        tx_ring_->println(text);
+    } else {
+        Serial.println(text);
+    }
+}
+
+bool CommandHandler::transmit(const void* data, size_t length) {
+    // One ring write per message: the telemetry task queues frames concurrently,
+    // and whole messages are never interleaved (the ring drops rather than splits)
+    if (length == 0) {
+        return false;  // Formatter overflow: nothing coherent to send
+    }
+    if (tx_ring_ == nullptr) {
+        Serial.write(static_cast<const uint8_t*>(data), length);
+        return true;
+    }
+    return tx_ring_->write(data, length);
+}
+
+void CommandHandler::writeJson(JsonDocument& doc) {
+    acknowledge(RESPONSE_OK);
+    if (current_seq_ != 0) {
+        doc["seq"] = current_seq_;
+    }
+    if (sequenced_) {
+        doc["ack"] = ack_seq_;
+    }
+    char buffer[1024];
+    size_t length = serializeJson(doc, buffer, sizeof(buffer) - 2);
+    buffer[length++] = '\r';
+    buffer[length++] = '\n';
+    transmit(buffer, length);
+}
+
+void CommandHandler::setLoopStats(LoopStats* loop_stats) {
+    json_commands_[COMMAND_STATS].owner = loop_stats;
+}
+
+void CommandHandler::setTelemetry(Telemetry* telemetry) {
+    json_commands_[COMMAND_TELEMETRY].owner = telemetry;
+}
+
+void CommandHandler::setFlightRecorder(FlightRecorder* flight_recorder) {
+    flight_recorder_ = flight_recorder;
+    json_commands_[COMMAND_RECORDER].owner = flight_recorder;
+}
+
+bool CommandHandler::handleProgram(CommandContext& context) {
+    // {"parameters": {"steps": "<hex>", "repetitions": n, "speed": s}}
+    // steps: PROGRAM_STEP_SIZE bytes per segment (motion_patterns.h), hex encoded, so a
+    // whole routine arrives in one line and runs on board with no further traffic.
+    // Parsed into a staging slot here; the control task copies it out when the program
+    // reaches the front of the queue, after which the slot takes another upload. With
+    // every slot waiting, the upload is refused as QUEUE_FULL (the Pi resends it).
+    // Reply: {"success":true,"code":0,"steps":n}
+    JsonObject params = context.getParameters();
+    CommandParams program_params;
+    if (!extractParams(params, program_params)) {
+        return false;
+    }
+    if (!isnan(program_params.speed)) {
+        program_params.speed = constrain(program_params.speed, 0.0f, 1.0f);
+    }
+    
+    const char* hex = params["steps"] | "";
+    size_t length = strlen(hex);
+    size_t count = length / (2 * PROGRAM_STEP_SIZE);
+    if (count == 0 || count > PROGRAM_MAX_STEPS || length != count * 2 * PROGRAM_STEP_SIZE) {
+        sendResponse(false, RESPONSE_INVALID_PARAMETER, "steps must be hex, PROGRAM_MAX_STEPS segments at most");
+        return false;
+    }
+    uint32_t head = program_head_.load(std::memory_order_relaxed);
+    if (head - program_tail_.load(std::memory_order_acquire) >= PROGRAM_STAGING_SLOTS) {
+        sendResponse(false, RESPONSE_QUEUE_FULL, "Program staging full");
+        return false;
+    }
+    uint8_t slot_index = (uint8_t)(head % PROGRAM_STAGING_SLOTS);
+    StagedProgram& slot = program_staging_[slot_index];
+    
+    for (size_t i = 0; i < count; i++) {
+        uint8_t bytes[PROGRAM_STEP_SIZE];
+        bool valid = true;
+        for (size_t b = 0; b < PROGRAM_STEP_SIZE; b++) {
+            int high = hexValue(hex[(i * PROGRAM_STEP_SIZE + b) * 2]);
+            int low = hexValue(hex[(i * PROGRAM_STEP_SIZE + b) * 2 + 1]);
+            valid = valid && high >= 0 && low >= 0;
+            bytes[b] = (uint8_t)((high << 4) | low);
+        }
+        if (!valid || !decodeProgramStep(bytes, slot.steps[i])) {
+            sendResponse(false, RESPONSE_INVALID_PARAMETER, "Invalid program step");
+            return false;
+        }
+    }
+    slot.count = (uint8_t)count;
+    slot.repetitions = program_params.repetitions > 0 ? program_params.repetitions : 1;
+    slot.position = command_queue_.producerPosition();
+    
+    // Published before the push: the control task may pop or discard the command straight away
+    program_head_.store(head + 1, std::memory_order_release);
+    if (!enqueueCommand(COMMAND_PROGRAM, program_params, slot_index)) {
+        program_head_.store(head, std::memory_order_release);  // Never queued, so never released
+        sendResponse(false, RESPONSE_QUEUE_FULL, "Command queue full");
+        return false;
     }
     
-    serializeJson(doc, Serial);
-    Serial.println();
+    char line[RESPONSE_LINE_SIZE];
+    JsonLineWriter writer(line, sizeof(line));
+    beginReply(writer, true, RESPONSE_OK);
+    writer.add("steps", (int32_t)count);
+    transmit(line, writer.finish());
+    return true;
+}
+
+void CommandHandler::setLogReplay(LogReplay* log_replay) {
+    log_replay_ = log_replay;
+    json_commands_[COMMAND_REPLAY].owner = log_replay;
+}
+
+void CommandHandler::setOdometry(Odometry* odometry) {
+    odometry_ = odometry;
+}
+
+void CommandHandler::setMotorCalibrator(MotorCalibrator* motor_calibrator) {
+    motor_calibrator_ = motor_calibrator;
+    json_commands_[COMMAND_MOTOR_CAL].owner = motor_calibrator;
+}
+
+void CommandHandler::setPwmControl(PwmControl* pwm_control) {
+    json_commands_[COMMAND_PWM].owner = pwm_control;
+}
+
+bool CommandHandler::isBinaryLink() const {
+    return binary_link_;
 }
 
 void CommandHandler::update() {
-    // TODO: Update command execution
-    // Check time-based commands for completion
-    // Check angle-based commands for completion
-    // Process next command in queue when current completes
+    // Runs in lockstep with the balance loop (one call per control tick):
+    // STOP first, then the active segment or the next queued command
+    
+    // STOP preempts the queue: checked before any queued command runs
+    if (stop_pending_.exchange(false, std::memory_order_acquire)) {
+        discardQueued(stop_position_.load(std::memory_order_relaxed));
+        active_pattern_ = nullptr;
+        balance_controller_->setNeutral();
+        balance_controller_->abortAutotune();
+    }
+    
+    // A replay, motor sweep or autotune run takes the motors: motion queued before it is dropped
+    if (drop_pending_.exchange(false, std::memory_order_acquire)) {
+        discardQueued(drop_position_.load(std::memory_order_relaxed));
+        active_pattern_ = nullptr;
+        balance_controller_->setNeutral();
+    }
     
     processQueue();
 }
 
 bool CommandHandler::validateCommand(JsonDocument& doc) {
     // Validate command field (required, must be string)
-    if (!doc.containsKey("command") || !doc["command"].is<String>()) {
+    if (!doc.containsKey("command") || !doc["command"].is<const char*>()) {
         return false;
     }
     
@@ -203,58 +669,230 @@ bool CommandHandler::validateCommand(JsonDocument& doc) {
         return false;
     }
     
+    // Validate sequence number (optional, but if present must be 1-65535)
+    if (doc.containsKey("seq") && (!doc["seq"].is<uint16_t>() || doc["seq"].as<uint16_t>() == 0)) {
+        return false;
+    }
+    
     return true;
 }
 
 void CommandHandler::clearQueue() {
-    queue_head_ = 0;
-    queue_tail_ = 0;
-    queue_size_ = 0;
+    // Consumer side only (control task, or before tasks start)
+    command_queue_.clear();
+    program_tail_.store(program_head_.load(std::memory_order_acquire), std::memory_order_release);
 }
 
-bool CommandHandler::enqueueCommand(const String& command, float speed, float duration, float angle) {
-    // Add command to FIFO queue with copied primitives
-    if (queue_size_ >= MAX_QUEUE_SIZE) {
-        return false;
+void CommandHandler::discardQueued(uint32_t position) {
+    // Consumer side only: drops commands pushed before position. Staged programs whose
+    // command is among them will never be popped, so their slots are released here.
+    command_queue_.discardUntil(position);
+    uint32_t tail = program_tail_.load(std::memory_order_relaxed);
+    uint32_t head = program_head_.load(std::memory_order_acquire);
+    while (tail != head && (int32_t)(program_staging_[tail % PROGRAM_STAGING_SLOTS].position - position) < 0) {
+        tail++;
     }
-    
-    Command& cmd = command_queue_[queue_tail_];
+    program_tail_.store(tail, std::memory_order_release);
+}
+
+bool CommandHandler::enqueueCommand(CommandId command, const CommandParams& params, uint8_t program_slot) {
+    // Add command to FIFO queue with copied primitives (producer side only)
+    Command cmd;
     cmd.type = command;
     cmd.start_time = millis();
-    cmd.speed = speed;
-    cmd.duration = duration;
-    cmd.angle = angle;
+    cmd.params = params;
     cmd.target_angle = 0.0;  // Calculated when execution starts
     cmd.target_distance = 0.0;
-    
-    queue_tail_ = (queue_tail_ + 1) % MAX_QUEUE_SIZE;
-    queue_size_++;
-    return true;
+    cmd.program_slot = program_slot;
+    return command_queue_.push(cmd);
 }
 
 void CommandHandler::processQueue() {
-    // TODO: Process command queue
-    // Check if current command is complete
-    // Move to next command if complete
-    // Clear setpoints when all commands done
+    // A running pattern owns the setpoints until its last segment ends
+    if (active_pattern_ != nullptr) {
+        stepMotion();
+        return;
+    }
+    
+    // At most one command starts per tick, so transitions cost O(1) per tick
+    Command cmd;
+    if (command_queue_.pop(cmd)) {
+        applyCommand(cmd);
+    }
+}
+
+void CommandHandler::applyCommand(const Command& cmd) {
+    // Control task only: the sole writer of balance controller setpoints
+    const CommandParams& params = cmd.params;
+    switch (cmd.type) {
+        // Primitives hold their setpoint until changed, unless given a target
+        case COMMAND_MOVE_FORWARD:
+            if (!isnan(params.duration)) {
+                startPattern(motionPatternFor(COMMAND_MOVE_FORWARD_FOR_TIME), params);
+            } else {
+                balance_controller_->setVelocitySetpoint(speedToMotorValue(params.speed));
+            }
+            break;
+        case COMMAND_MOVE_BACKWARD:
+            if (!isnan(params.duration)) {
+                startPattern(motionPatternFor(COMMAND_MOVE_BACKWARD_FOR_TIME), params);
+            } else {
+                balance_controller_->setVelocitySetpoint(-speedToMotorValue(params.speed));
+            }
+            break;
+        case COMMAND_ROTATE_CLOCKWISE:
+            if (!isnan(params.angle)) {
+                startPattern(motionPatternFor(COMMAND_TURN_RIGHT), params);
+            } else {
+                balance_controller_->setRotationSetpoint(speedToMotorValue(params.speed));
+            }
+            break;
+        case COMMAND_ROTATE_COUNTERCLOCKWISE:
+            if (!isnan(params.angle)) {
+                startPattern(motionPatternFor(COMMAND_TURN_LEFT), params);
+            } else {
+                balance_controller_->setRotationSetpoint(-speedToMotorValue(params.speed));
+            }
+            break;
+        case COMMAND_PROGRAM: {
+            // Copy out of its staging slot (the oldest), then free the slot for another upload
+            const StagedProgram& staged = program_staging_[cmd.program_slot];
+            memcpy(program_steps_, staged.steps, staged.count * sizeof(MotionStep));
+            program_pattern_.steps = program_steps_;
+            program_pattern_.step_count = staged.count;
+            program_pattern_.repetitions = staged.repetitions;
+            program_tail_.store(program_tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            startPattern(&program_pattern_, params);
+            break;
+        }
+        default:
+            startPattern(motionPatternFor(cmd.type), params);
+            break;
+    }
+}
+
+void CommandHandler::startPattern(const MotionPattern* pattern, const CommandParams& params) {
+    if (pattern == nullptr) {
+        return;
+    }
+    
+    // Resolve defaults once; steps only read active_params_
+    active_params_ = params;
+    if (isnan(active_params_.speed)) active_params_.speed = pattern->default_speed;
+    if (isnan(active_params_.duration)) active_params_.duration = pattern->default_duration;
+    if (isnan(active_params_.distance)) active_params_.distance = pattern->default_distance;
+    if (isnan(active_params_.angle)) active_params_.angle = pattern->default_angle;
+    
+    uint8_t repetitions = pattern->repetitions;
+    if (repetitions == 0) {
+        repetitions = params.repetitions > 0 ? params.repetitions : pattern->default_repetitions;
+    }
+    
+    active_pattern_ = pattern;
+    step_index_ = 0;
+    repeats_left_ = repetitions;
+    startStep();
+}
+
+void CommandHandler::startStep() {
+    const MotionStep& step = active_pattern_->steps[step_index_];
+    const CommandParams& p = active_params_;
+    
+    float value = step.scale;
+    switch (step.target) {
+        case TARGET_DURATION: value *= p.duration; break;
+        case TARGET_DISTANCE: value *= p.distance; break;
+        case TARGET_ANGLE: value *= p.angle; break;
+        case TARGET_FIXED: break;
+    }
+    
+    float speed = step.speed > 0.0f ? step.speed : p.speed;
+    float velocity = step.drive * speedToMotorValue(speed);
+    float rotation = step.turn * speedToMotorValue(speed);
+    if (step.arc && p.distance > 0.0f) {
+        // Wheel speeds v * (1 +/- W / 2R): differential arc of radius R
+        rotation = step.turn * fabs(velocity) * (WHEELBASE_MM / 1000.0f) / (2.0f * p.distance);
+    }
+    if (active_pattern_->mirror_left && p.direction == 0) {
+        rotation = -rotation;
+    }
+    balance_controller_->setVelocitySetpoint(velocity);
+    balance_controller_->setRotationSetpoint(rotation);
+    
+    segment_kind_ = step.kind;
+    segment_ticks_ = 0;
+    segment_target_ = fabs(value);
+    if (step.kind == SEGMENT_TIMED) {
+        segment_tick_limit_ = (uint32_t)(segment_target_ * BALANCE_LOOP_FREQ + 0.5f);
+    } else {
+        // Encoder segments end on target; the timeout guards a stalled or missing encoder
+        segment_tick_limit_ = (uint32_t)COMMAND_TIMEOUT_MS * BALANCE_LOOP_FREQ / 1000;
+        segment_left_start_ = left_encoder_->getPosition();
+        segment_right_start_ = right_encoder_->getPosition();
+        segment_heading_start_ = odometry_ != nullptr ? odometry_->getHeading() : 0.0f;
+    }
+}
+
+void CommandHandler::stepMotion() {
+    segment_ticks_++;
+    
+    bool done = false;
+    if (segment_kind_ == SEGMENT_TIMED) {
+        done = segment_ticks_ >= segment_tick_limit_;
+    } else {
+        long left = left_encoder_->getPosition() - segment_left_start_;
+        long right = right_encoder_->getPosition() - segment_right_start_;
+        float progress;
+        if (segment_kind_ == SEGMENT_DISTANCE) {
+            progress = fabs(pulsesToDistance((left + right) / 2));
+        } else if (odometry_ != nullptr) {
+            progress = fabs(odometry_->getHeading() - segment_heading_start_);  // Gyro-fused: finer than one pulse
+        } else {
+            progress = fabs(pulsesToAngle(left, right));
+        }
+        done = progress >= segment_target_;
+        
+        if (!done && segment_ticks_ >= segment_tick_limit_) {
+            // Target never reached: abandon the pattern rather than drive on blind
+            motion_timeouts_++;
+            finishMotion();
+            return;
+        }
+    }
+    
+    if (!done) {
+        return;
+    }
+    
+    // Constant-time transition: next step, next repetition, or finished
+    step_index_++;
+    if (step_index_ >= active_pattern_->step_count) {
+        step_index_ = 0;
+        if (--repeats_left_ == 0) {
+            finishMotion();
+            return;
+        }
+    }
+    startStep();
+}
+
+void CommandHandler::finishMotion() {
+    // Clear setpoints when the pattern is done
+    active_pattern_ = nullptr;
+    balance_controller_->setNeutral();
 }
 
 float CommandHandler::speedToMotorValue(float speed) {
-    // Convert speed (0.0-1.0) to motor value (-255 to 255)
-    return constrain(speed * MAX_MOTOR_SPEED, -MAX_MOTOR_SPEED, MAX_MOTOR_SPEED);
+    // Command speed (0.0-1.0) is already a normalized motor output; only clamp it
+    return constrain(speed, -MAX_MOTOR_OUTPUT, MAX_MOTOR_OUTPUT);
 }
 
 float CommandHandler::pulsesToDistance(long pulses) {
-    // TODO: Convert encoder pulses to distance in meters
-    // Formula: distance = (pulses / pulses_per_rev) * wheel_circumference
-    float wheel_circumference = PI * WHEEL_DIAMETER_MM / 1000.0;  // meters
-    return (pulses / (float)ENCODER_PULSES_PER_REV) * wheel_circumference;
+    // distance = pulses / pulses_per_rev * wheel_circumference (constant folded at compile time)
+    return pulses * Odometry::METERS_PER_PULSE;
 }
 
 float CommandHandler::pulsesToAngle(long left_pulses, long right_pulses) {
-    // TODO: Convert encoder difference to rotation angle
-    // Formula: angle = (right_pulses - left_pulses) / wheelbase * 180 / PI
-    long pulse_diff = right_pulses - left_pulses;
-    float distance_diff = pulsesToDistance(pulse_diff);
-    return (distance_diff / (WHEELBASE_MM / 1000.0)) * 180.0 / PI;
+    // angle = (right - left) distance / wheelbase, in degrees (constant folded at compile time)
+    return (right_pulses - left_pulses) * Odometry::DEGREES_PER_PULSE_DIFFERENCE;
 }
@@ -4,21 +4,71 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include "../include/config.h"
+#include "command_ids.h"
+#include "response_codes.h"
+#include "motion_patterns.h"
+#include "command_context.h"
+#include "../comms/spsc_queue.h"
+#include <atomic>
 
 // Forward declarations
 class BalanceController;
 class MotorDriver;
 class EncoderReader;
+class LoopStats;
+class Telemetry;
+class FlightRecorder;
+class TxRing;
+class LogReplay;
+class Odometry;
+class MotorCalibrator;
+class PwmControl;
+class JsonLineWriter;
 
 /**
  * Command handler for parsing and executing commands from Raspberry Pi.
- * Commands are received as newline-delimited JSON over serial.
+ * Commands are received as newline-delimited JSON over serial, or as
+ * binary frames (comms/binary_protocol.h) after the "binary_mode" handshake.
+ * Both formats decode into CommandParams and share the same handlers.
+ *
+ * Pipelining: after "sync", commands may carry a sequence number ("seq" in
+ * JSON, the last payload field in frames). Only the next number is executed
+ * (go-back-N): a gap is answered OUT_OF_ORDER, a resend DUPLICATE. Every
+ * reply carries the cumulative "ack", the last number handled in order, so
+ * the Pi can keep several commands in flight and resend from ack + 1.
+ * STOP and unsequenced commands bypass the numbering. After a STOP every
+ * sequenced command is dropped (OUT_OF_ORDER) until the next "sync", so a
+ * resend burst the Pi wrote before it knew about the STOP never runs.
+ *
+ * Configuration, diagnostics and uploads are JSON commands routed through
+ * an id-indexed JsonCommand table to the subsystem that owns them (stats to
+ * LoopStats, gains and autotune to BalanceController, and so on; each
+ * subsystem's handlers live in its *_commands.cpp). Optional subsystems fill
+ * their slot when attached; until then the command answers NOT_AVAILABLE.
+ *
+ * Threading: processCommand()/processFrame()/executeStop() run on the comms
+ * task (producer); update() runs on the control task (consumer). They share
+ * only a lock-free SPSC queue and atomic STOP/drop mailboxes, so setpoints
+ * are written by the control task alone.
  * 
  * INTEGRATION POINT: Commands modify balance controller setpoints
  * INTEGRATION POINT: STOP command clears queue and returns to neutral balance
  */
 class CommandHandler {
 public:
+    /**
+     * Command parameters copied out of JSON or a binary frame.
+     * Absent float parameters are NAN so handlers apply their own defaults.
+     */
+    struct CommandParams {
+        float speed;
+        float duration;       // seconds
+        float angle;          // degrees
+        float distance;       // meters (side_length, radius, size, segment_length)
+        uint8_t repetitions;  // zigzag (0 = default)
+        uint8_t direction;    // make_circle: 0 = left, 1 = right
+    };
+
     /**
      * Initialize command handler with required components.
      * 
@@ -40,89 +90,267 @@ public:
     void begin();
 
     /**
-     * Parse and execute a command from JSON string.
+     * Parse and execute a command from JSON text.
      * All inputs must be validated to prevent malformed commands.
+     * The text is only read during the call (no copy is kept).
      *
-     * @param json_string JSON command string
+     * @param json JSON command text (need not be NUL-terminated)
+     * @param length Length of json in bytes
      * @return true if command executed successfully
      */
-    bool processCommand(const String& json_string);
+    bool processCommand(const char* json, size_t length);
+
+    /**
+     * Execute a command from a decoded binary frame (CRC already checked).
+     * The response is sent as a binary frame.
+     *
+     * @param opcode Frame opcode (a CommandId value; COMMAND_UNKNOWN rejects a corrupt frame)
+     * @param payload Fixed-size little-endian payload
+     * @param length Payload length in bytes
+     * @return true if command executed successfully
+     */
+    bool processFrame(uint8_t opcode, const uint8_t* payload, size_t length);
 
     /**
      * Execute a primitive movement command.
      * Commands modify balance controller setpoints, don't replace balance control.
      *
-     * @param command Command type (e.g., "move_forward", "rotate_clockwise")
+     * @param command Command id (e.g., COMMAND_MOVE_FORWARD)
      * @param params Command parameters (speed, angle, duration, etc.)
      * @return true if command valid and executed
      */
-    bool executePrimitiveCommand(const String& command, JsonObject params);
+    bool executePrimitiveCommand(CommandId command, const CommandParams& params);
 
     /**
      * Execute an intermediate command.
      * Intermediate commands may expand to multiple primitives or use encoders.
      *
-     * @param command Command type (e.g., "turn_left", "move_forward_for_time")
+     * @param command Command id (e.g., COMMAND_TURN_LEFT)
      * @param params Command parameters
      * @return true if command valid and executed
      */
-    bool executeIntermediateCommand(const String& command, JsonObject params);
+    bool executeIntermediateCommand(CommandId command, const CommandParams& params);
 
     /**
      * Execute STOP command immediately.
-     * Clears command queue and returns balance controller to neutral.
+     * Posts to the STOP mailbox: the next control tick discards every command
+     * queued before the STOP and returns balance controller to neutral.
      * Balance loop continues running.
      */
     void executeStop();
 
     /**
      * Send response back to Raspberry Pi.
+     * Uses the format of the request being handled: a JSON line
+     * {"success":..,"code":..} formatted into a stack buffer, or a
+     * FRAME_OP_RESPONSE frame carrying {success, command id}.
+     * No heap, and never waits on the UART (queued to the TX ring).
      *
      * @param success Whether command succeeded
-     * @param message Optional message
+     * @param code Status code (response_codes.h)
+     * @param message Debug text, sent only when SERIAL_RESPONSE_VERBOSE is 1
+     * @param detail Debug text appended as "detail" (e.g. the unknown command name)
+     */
+    void sendResponse(bool success, ResponseCode code, const char* message = nullptr,
+                      const char* detail = nullptr);
+
+    /**
+     * Answer a command line that was dropped for exceeding SERIAL_MAX_LINE_LENGTH.
+     * Sent as an unsequenced JSON failure carrying the current ACK.
+     */
+    void rejectOverlongLine();
+
+    /**
+     * Attach balance loop timing stats for the "stats" command.
+     * Optional: without it, "stats" reports an error.
+     *
+     * @param loop_stats Loop timing probe written by the control task
+     */
+    void setLoopStats(LoopStats* loop_stats);
+
+    /**
+     * Attach the telemetry stream for the "telemetry" command.
+     * Optional: without it, "telemetry" reports an error.
+     *
+     * @param telemetry Telemetry stream fed by the control task
      */
-    void sendResponse(bool success, const String& message = "");
+    void setTelemetry(Telemetry* telemetry);
+
+    /**
+     * Attach the flight recorder: STOP freezes it, "recorder" dumps it.
+     * Optional: without it, "recorder" reports an error.
+     *
+     * @param flight_recorder Post-mortem recorder fed by the control task
+     */
+    void setFlightRecorder(FlightRecorder* flight_recorder);
+
+    /**
+     * Attach the serial TX ring that responses are queued to.
+     * Optional: without it, responses are written to Serial directly
+     * (blocking when the UART TX buffer is full).
+     *
+     * @param tx_ring Ring drained by the TX task
+     */
+    void setTxRing(TxRing* tx_ring);
+
+    /**
+     * Attach log replay for the "replay" command and replay sample frames.
+     * Optional: without it, "replay" reports an error and samples are ignored.
+     *
+     * @param log_replay Replay source serviced by the control task
+     */
+    void setLogReplay(LogReplay* log_replay);
+
+    /**
+     * Attach odometry: angle segments (turns, spins, pattern corners) then end
+     * on the fused heading instead of the raw encoder difference.
+     * Optional: without it, angle segments use the encoders alone.
+     *
+     * @param odometry Pose estimate updated by the control task
+     */
+    void setOdometry(Odometry* odometry);
+
+    /**
+     * Attach the motor calibrator for the "motor_cal" command; STOP aborts
+     * a running sweep.
+     * Optional: without it, "motor_cal" reports an error.
+     *
+     * @param motor_calibrator Sweep serviced by the control task
+     */
+    void setMotorCalibrator(MotorCalibrator* motor_calibrator);
+
+    /**
+     * Attach run-time PWM reconfiguration for the "pwm" command.
+     * Optional: without it, "pwm" reports an error.
+     *
+     * @param pwm_control PWM change applied by the control task
+     */
+    void setPwmControl(PwmControl* pwm_control);
+
+    /**
+     * Check whether the Pi has switched the link to binary framing.
+     * Informational text output is suppressed while binary framing is on.
+     */
+    bool isBinaryLink() const;
 
     /**
      * Update command execution (for time-based commands).
-     * Should be called periodically to check command completion.
+     * Called once per control tick on the control task: applies a pending
+     * STOP first, then queued commands. Never blocks or prints.
      */
     void update();
 
 private:
+    friend class CommandContext;  // Replies and queue hooks for subsystem handlers
+
     BalanceController* balance_controller_;
     MotorDriver* left_motor_;
     MotorDriver* right_motor_;
     EncoderReader* left_encoder_;
     EncoderReader* right_encoder_;
+    FlightRecorder* flight_recorder_;
+    TxRing* tx_ring_;
+    LogReplay* log_replay_;
+    Odometry* odometry_;
+    MotorCalibrator* motor_calibrator_;
+
+    // Link state
+    bool binary_link_;          // "binary_mode" handshake done
+    bool binary_response_;      // Current request arrived as a frame
+    CommandId current_command_; // Echoed in binary responses
+
+    // Sequencing (comms task only)
+    bool sequenced_;            // Pi uses sequence numbers: replies carry "ack"
+    uint16_t ack_seq_;          // Last sequence number handled in order (0 = none since sync)
+    uint16_t current_seq_;      // Sequence number of the request being handled (0 = none)
+    bool awaiting_sync_;        // STOP since the last "sync": sequenced commands are dropped
+
+    // Handler table indexed by CommandId (nullptr = not a queueable command)
+    typedef bool (CommandHandler::*Handler)(CommandId command, const CommandParams& params);
+    static const Handler HANDLERS[COMMAND_ID_LIMIT];
+
+    // JSON command table indexed by CommandId (function nullptr = not a JSON command;
+    // owner nullptr = optional subsystem not attached). Owners differ per rover, so
+    // unlike HANDLERS it is filled in by the constructor and the setters.
+    JsonCommand json_commands_[COMMAND_ID_LIMIT];
 
     // Command queue (FIFO) with copied primitives (safe for persistence)
     struct Command {
-        String type;
+        CommandId type;
         unsigned long start_time;
         // Copied parameters (no JsonObject lifetime issues)
-        float speed;
-        float duration;
-        float angle;
+        CommandParams params;
         float target_angle;  // For angle-based commands (encoder target)
         float target_distance;  // For distance-based commands (if needed)
+        uint8_t program_slot;   // COMMAND_PROGRAM: index into program_staging_
     };
     
     static const int MAX_QUEUE_SIZE = COMMAND_QUEUE_SIZE;
-    Command command_queue_[MAX_QUEUE_SIZE];
-    int queue_head_;
-    int queue_tail_;
-    int queue_size_;
+    SpscQueue<Command, MAX_QUEUE_SIZE> command_queue_;  // comms task -> control task
+
+    // STOP mailbox: queue position at the time of STOP (commands after it survive)
+    std::atomic<bool> stop_pending_;
+    std::atomic<uint32_t> stop_position_;
+
+    // Drop mailbox (CommandContext::dropQueuedMotion): the queue part of STOP alone,
+    // posted when a replay, motor sweep or autotune run takes over
+    std::atomic<bool> drop_pending_;
+    std::atomic<uint32_t> drop_position_;
+
+    // Program staging ring: the comms task fills slot program_head_ and queues COMMAND_PROGRAM
+    // with its index; the control task copies it out when that command starts (or drops it
+    // when discarded) and advances program_tail_. Programs leave the queue in order, so
+    // slots free in order.
+    struct StagedProgram {
+        MotionStep steps[PROGRAM_MAX_STEPS];
+        uint8_t count;
+        uint8_t repetitions;
+        uint32_t position;                     // Queue position of its COMMAND_PROGRAM
+    };
+    StagedProgram program_staging_[PROGRAM_STAGING_SLOTS];
+    std::atomic<uint32_t> program_head_;       // Slots filled (comms task)
+    std::atomic<uint32_t> program_tail_;       // Slots released (control task)
+
+    // Motion executor (control task only): steps through a const MotionPattern
+    const MotionPattern* active_pattern_;  // nullptr = idle (a built-in table or program_pattern_)
+    MotionStep program_steps_[PROGRAM_MAX_STEPS];  // Running uploaded program
+    MotionPattern program_pattern_;
+    CommandParams active_params_;          // Defaults already applied
+    uint8_t step_index_;
+    uint8_t repeats_left_;
+    MotionSegmentKind segment_kind_;
+    uint32_t segment_ticks_;               // Control ticks spent in segment
+    uint32_t segment_tick_limit_;          // TIMED: duration; encoder segments: timeout
+    float segment_target_;                 // Meters or degrees
+    long segment_left_start_;
+    long segment_right_start_;
+    float segment_heading_start_;          // Odometry heading at segment start (degrees)
+    unsigned long motion_timeouts_;
 
     bool validateCommand(JsonDocument& doc);
+    bool extractParams(JsonObject params, CommandParams& out);
+    bool dispatchCommand(CommandId command, const CommandParams& params);
     void clearQueue();
-    bool enqueueCommand(const String& command, float speed, float duration, float angle);
+    void discardQueued(uint32_t position);  // discardUntil + release a dropped staged program
+    bool enqueueCommand(CommandId command, const CommandParams& params, uint8_t program_slot = 0);
     void processQueue();
+    void applyCommand(const Command& cmd);
+    void startPattern(const MotionPattern* pattern, const CommandParams& params);
+    void startStep();
+    void stepMotion();
+    void finishMotion();
+    bool handleProgram(CommandContext& context);
+    void writeJson(JsonDocument& doc);  // Adds seq/ack
+    bool acceptSequence();              // false: out of order or duplicate (already answered)
+    void acknowledge(ResponseCode code);
+    void beginReply(JsonLineWriter& writer, bool success, ResponseCode code);
+    bool transmit(const void* data, size_t length);  // One whole message; false if dropped
+    void print(const char* text);                    // Status line (not a response)
     
     // Helper functions
-    float speedToMotorValue(float speed);  // Convert 0.0-1.0 to -255 to 255
-    float pulsesToDistance(long pulses);   // Convert encoder pulses to distance
-    float pulsesToAngle(long left_pulses, long right_pulses);  // Convert encoder diff to angle
+    float speedToMotorValue(float speed);  // Clamp 0.0-1.0 command speed to a normalized motor output
+    float pulsesToDistance(long pulses);   // Encoder pulses to meters
+    float pulsesToAngle(long left_pulses, long right_pulses);  // Encoder difference to degrees (counter-clockwise positive)
 };
 
 #endif // COMMAND_HANDLER_H
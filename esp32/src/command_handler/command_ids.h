@@ -0,0 +1,52 @@
+#ifndef COMMAND_IDS_H
+#define COMMAND_IDS_H
+
+#include <stdint.h>
+
+/**
+ * Command identifiers.
+ * Values double as binary frame opcodes (see comms/binary_protocol.h),
+ * so existing values must never be renumbered.
+ */
+enum CommandId : uint8_t {
+    COMMAND_UNKNOWN = 0x00,
+
+    // Primitive commands
+    COMMAND_MOVE_FORWARD = 0x01,
+    COMMAND_MOVE_BACKWARD = 0x02,
+    COMMAND_ROTATE_CLOCKWISE = 0x03,
+    COMMAND_ROTATE_COUNTERCLOCKWISE = 0x04,
+    COMMAND_STOP = 0x05,
+
+    // Intermediate commands
+    COMMAND_TURN_LEFT = 0x10,
+    COMMAND_TURN_RIGHT = 0x11,
+    COMMAND_MOVE_FORWARD_FOR_TIME = 0x12,
+    COMMAND_MOVE_BACKWARD_FOR_TIME = 0x13,
+    COMMAND_MAKE_SQUARE = 0x14,
+    COMMAND_MAKE_CIRCLE = 0x15,
+    COMMAND_MAKE_STAR = 0x16,
+    COMMAND_ZIGZAG = 0x17,
+    COMMAND_SPIN = 0x18,
+    COMMAND_DANCE = 0x19,
+
+    // Link control and diagnostics
+    COMMAND_BINARY_MODE = 0x20,   // JSON handshake: enable binary framing
+    COMMAND_JSON_MODE = 0x21,     // Binary frame: return to JSON-only link
+    COMMAND_STATS = 0x22,         // JSON only
+    COMMAND_TELEMETRY = 0x23,     // JSON only
+    COMMAND_RECORDER = 0x24,      // JSON only
+    COMMAND_PWM = 0x25,           // JSON only
+    COMMAND_GAINS = 0x26,         // JSON only
+    COMMAND_AUTOTUNE = 0x27,      // JSON only
+    COMMAND_SYNC = 0x28,          // JSON only: restart command sequence numbering
+    COMMAND_PROGRAM = 0x29,       // JSON only: upload and run a segment sequence
+    COMMAND_REPLAY = 0x2A,        // JSON only: log replay start/stop/status
+    COMMAND_REPLAY_SAMPLE = 0x2B, // Binary frame only: one recorded TelemetrySample, never answered
+    COMMAND_MOTOR_CAL = 0x2C      // JSON only: motor compensation sweep start/abort/status/save/clear
+};
+
+// One past the highest id: size of id-indexed tables
+static const uint8_t COMMAND_ID_LIMIT = COMMAND_MOTOR_CAL + 1;
+
+#endif // COMMAND_IDS_H
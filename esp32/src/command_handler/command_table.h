@@ -0,0 +1,163 @@
+#ifndef COMMAND_TABLE_H
+#define COMMAND_TABLE_H
+
+#include <stdint.h>
+#include <string.h>
+#include "command_ids.h"
+
+/**
+ * Compile-time command name table.
+ *
+ * JSON command names are mapped to CommandId with a perfect hash: an FNV-1a
+ * seed is searched at compile time so every name lands in its own slot of
+ * COMMAND_SLOT_COUNT. A lookup is one hash, one table read and one strcmp
+ * to reject unknown names. Adding a name re-runs the seed search; the
+ * static_asserts fail the build if no perfect seed exists.
+ *
+ * Written for C++11 constexpr (single-return recursion) to match the
+ * Arduino toolchain default.
+ */
+namespace command_table {
+
+constexpr const char* const NAMES[] = {
+    "move_forward",
+    "move_backward",
+    "rotate_clockwise",
+    "rotate_counterclockwise",
+    "stop",
+    "turn_left",
+    "turn_right",
+    "move_forward_for_time",
+    "move_backward_for_time",
+    "make_square",
+    "make_circle",
+    "make_star",
+    "zigzag",
+    "spin",
+    "dance",
+    "binary_mode",
+    "json_mode",
+    "stats",
+    "telemetry",
+    "recorder",
+    "pwm",
+    "gains",
+    "autotune",
+    "sync",
+    "program",
+    "replay",
+    "motor_cal"
+};
+
+constexpr CommandId IDS[] = {
+    COMMAND_MOVE_FORWARD,
+    COMMAND_MOVE_BACKWARD,
+    COMMAND_ROTATE_CLOCKWISE,
+    COMMAND_ROTATE_COUNTERCLOCKWISE,
+    COMMAND_STOP,
+    COMMAND_TURN_LEFT,
+    COMMAND_TURN_RIGHT,
+    COMMAND_MOVE_FORWARD_FOR_TIME,
+    COMMAND_MOVE_BACKWARD_FOR_TIME,
+    COMMAND_MAKE_SQUARE,
+    COMMAND_MAKE_CIRCLE,
+    COMMAND_MAKE_STAR,
+    COMMAND_ZIGZAG,
+    COMMAND_SPIN,
+    COMMAND_DANCE,
+    COMMAND_BINARY_MODE,
+    COMMAND_JSON_MODE,
+    COMMAND_STATS,
+    COMMAND_TELEMETRY,
+    COMMAND_RECORDER,
+    COMMAND_PWM,
+    COMMAND_GAINS,
+    COMMAND_AUTOTUNE,
+    COMMAND_SYNC,
+    COMMAND_PROGRAM,
+    COMMAND_REPLAY,
+    COMMAND_MOTOR_CAL
+};
+
+constexpr int NAME_COUNT = sizeof(NAMES) / sizeof(NAMES[0]);
+constexpr int COMMAND_SLOT_COUNT = 128;  // Power of two, at least 4x the names (seed search depth)
+constexpr uint8_t EMPTY_SLOT = 0xFF;
+
+static_assert(NAME_COUNT == sizeof(IDS) / sizeof(IDS[0]), "NAMES and IDS must align");
+static_assert(NAME_COUNT <= COMMAND_SLOT_COUNT / 4, "Grow COMMAND_SLOT_COUNT to keep the seed search short");
+
+constexpr uint32_t fnv1a(const char* s, uint32_t h) {
+    return *s == '\0' ? h : fnv1a(s + 1, (h ^ (uint8_t)*s) * 16777619u);
+}
+
+constexpr uint8_t slotOf(const char* name, uint32_t seed) {
+    return (uint8_t)((fnv1a(name, 2166136261u ^ seed) >> 16) & (COMMAND_SLOT_COUNT - 1));
+}
+
+// True if NAMES[i] collides with any NAMES[j], j < i
+constexpr bool collides(uint32_t seed, int i, int j) {
+    return j >= i ? false
+                  : (slotOf(NAMES[j], seed) == slotOf(NAMES[i], seed)) || collides(seed, i, j + 1);
+}
+
+constexpr bool isPerfect(uint32_t seed, int i) {
+    return i >= NAME_COUNT ? true : !collides(seed, i, 0) && isPerfect(seed, i + 1);
+}
+
+constexpr uint32_t findSeed(uint32_t seed) {
+    return isPerfect(seed, 0) ? seed : findSeed(seed + 1);
+}
+
+constexpr uint32_t SEED = findSeed(0);
+static_assert(isPerfect(SEED, 0), "Command name hash is not collision-free");
+
+constexpr uint8_t indexForSlot(uint8_t slot, int i) {
+    return i >= NAME_COUNT ? EMPTY_SLOT
+                           : slotOf(NAMES[i], SEED) == slot ? (uint8_t)i : indexForSlot(slot, i + 1);
+}
+
+// Slot -> NAMES index, generated from an index pack 0..COMMAND_SLOT_COUNT-1
+template <uint8_t... Slots> struct SlotList {};
+template <uint8_t N, uint8_t... Slots> struct MakeSlots : MakeSlots<N - 1, N - 1, Slots...> {};
+template <uint8_t... Slots> struct MakeSlots<0, Slots...> { typedef SlotList<Slots...> type; };
+
+template <typename List> struct SlotTable;
+template <uint8_t... Slots> struct SlotTable<SlotList<Slots...>> {
+    static constexpr uint8_t index[sizeof...(Slots)] = {indexForSlot(Slots, 0)...};
+};
+template <uint8_t... Slots>
+constexpr uint8_t SlotTable<SlotList<Slots...>>::index[sizeof...(Slots)];
+
+typedef SlotTable<MakeSlots<COMMAND_SLOT_COUNT>::type> Slots;
+
+/**
+ * Map a JSON command name to its id.
+ *
+ * @param name NUL-terminated command name
+ * @return Command id, or COMMAND_UNKNOWN
+ */
+inline CommandId lookup(const char* name) {
+    uint8_t index = Slots::index[slotOf(name, SEED)];
+    if (index == EMPTY_SLOT || strcmp(name, NAMES[index]) != 0) {
+        return COMMAND_UNKNOWN;
+    }
+    return IDS[index];
+}
+
+/**
+ * Get the JSON name of a command id (for messages).
+ *
+ * @return Command name, or "unknown"
+ */
+inline const char* nameOf(CommandId id) {
+    for (int i = 0; i < NAME_COUNT; i++) {
+        if (IDS[i] == id) {
+            return NAMES[i];
+        }
+    }
+    return "unknown";
+}
+
+}  // namespace command_table
+
+#endif // COMMAND_TABLE_H
@@ -0,0 +1,112 @@
+#include "motion_patterns.h"
+
+// Defaults match pi/command_parser/parser.py so partial commands behave the same
+
+static const MotionStep TURN_LEFT_STEPS[] = {
+    {SEGMENT_ANGLE, 0, -1, false, TARGET_ANGLE, 1.0f, 0.0f},
+};
+
+static const MotionStep TURN_RIGHT_STEPS[] = {
+    {SEGMENT_ANGLE, 0, 1, false, TARGET_ANGLE, 1.0f, 0.0f},
+};
+
+static const MotionStep FORWARD_FOR_TIME_STEPS[] = {
+    {SEGMENT_TIMED, 1, 0, false, TARGET_DURATION, 1.0f, 0.0f},
+};
+
+static const MotionStep BACKWARD_FOR_TIME_STEPS[] = {
+    {SEGMENT_TIMED, -1, 0, false, TARGET_DURATION, 1.0f, 0.0f},
+};
+
+// Side, then 90 degree right turn (x4)
+static const MotionStep SQUARE_STEPS[] = {
+    {SEGMENT_DISTANCE, 1, 0, false, TARGET_DISTANCE, 1.0f, 0.0f},
+    {SEGMENT_ANGLE, 0, 1, false, TARGET_FIXED, 90.0f, 0.0f},
+};
+
+// One full turn on an arc of radius distance
+static const MotionStep CIRCLE_STEPS[] = {
+    {SEGMENT_ANGLE, 1, 1, true, TARGET_FIXED, 360.0f, 0.0f},
+};
+
+// Point, then 144 degree right turn (x5)
+static const MotionStep STAR_STEPS[] = {
+    {SEGMENT_DISTANCE, 1, 0, false, TARGET_DISTANCE, 1.0f, 0.0f},
+    {SEGMENT_ANGLE, 0, 1, false, TARGET_FIXED, 144.0f, 0.0f},
+};
+
+// Left leg then right leg, heading restored at the end of each repetition
+static const MotionStep ZIGZAG_STEPS[] = {
+    {SEGMENT_ANGLE, 0, -1, false, TARGET_ANGLE, 1.0f, 0.0f},
+    {SEGMENT_DISTANCE, 1, 0, false, TARGET_DISTANCE, 1.0f, 0.0f},
+    {SEGMENT_ANGLE, 0, 1, false, TARGET_ANGLE, 2.0f, 0.0f},
+    {SEGMENT_DISTANCE, 1, 0, false, TARGET_DISTANCE, 1.0f, 0.0f},
+    {SEGMENT_ANGLE, 0, -1, false, TARGET_ANGLE, 1.0f, 0.0f},
+};
+
+static const MotionStep SPIN_STEPS[] = {
+    {SEGMENT_TIMED, 0, 1, false, TARGET_DURATION, 1.0f, 0.0f},
+};
+
+static const MotionStep DANCE_STEPS[] = {
+    {SEGMENT_TIMED, 1, 0, false, TARGET_FIXED, 0.5f, 0.0f},
+    {SEGMENT_TIMED, -1, 0, false, TARGET_FIXED, 0.5f, 0.0f},
+    {SEGMENT_ANGLE, 0, 1, false, TARGET_FIXED, 180.0f, 0.0f},
+    {SEGMENT_ANGLE, 0, -1, false, TARGET_FIXED, 180.0f, 0.0f},
+    {SEGMENT_TIMED, 1, 1, false, TARGET_FIXED, 0.5f, 0.0f},
+    {SEGMENT_TIMED, 1, -1, false, TARGET_FIXED, 0.5f, 0.0f},
+    {SEGMENT_ANGLE, 0, 1, false, TARGET_FIXED, 360.0f, 0.0f},
+};
+
+#define STEPS(table) table, (uint8_t)(sizeof(table) / sizeof(table[0]))
+
+// {steps, step_count, repetitions, mirror_left, speed, duration s, distance m, angle deg, default repetitions}
+static const MotionPattern TURN_LEFT_PATTERN = {STEPS(TURN_LEFT_STEPS), 1, false, 0.4f, 1.0f, 0.5f, 90.0f, 1};
+static const MotionPattern TURN_RIGHT_PATTERN = {STEPS(TURN_RIGHT_STEPS), 1, false, 0.4f, 1.0f, 0.5f, 90.0f, 1};
+static const MotionPattern FORWARD_FOR_TIME_PATTERN = {STEPS(FORWARD_FOR_TIME_STEPS), 1, false, 0.4f, 1.0f, 0.5f, 90.0f, 1};
+static const MotionPattern BACKWARD_FOR_TIME_PATTERN = {STEPS(BACKWARD_FOR_TIME_STEPS), 1, false, 0.4f, 1.0f, 0.5f, 90.0f, 1};
+static const MotionPattern SQUARE_PATTERN = {STEPS(SQUARE_STEPS), 4, false, 0.4f, 1.0f, 0.5f, 90.0f, 1};
+static const MotionPattern CIRCLE_PATTERN = {STEPS(CIRCLE_STEPS), 1, true, 0.4f, 1.0f, 0.5f, 90.0f, 1};
+static const MotionPattern STAR_PATTERN = {STEPS(STAR_STEPS), 5, false, 0.4f, 1.0f, 0.5f, 90.0f, 1};
+static const MotionPattern ZIGZAG_PATTERN = {STEPS(ZIGZAG_STEPS), 0, false, 0.4f, 1.0f, 0.3f, 45.0f, 4};
+static const MotionPattern SPIN_PATTERN = {STEPS(SPIN_STEPS), 1, false, 0.5f, 2.0f, 0.5f, 90.0f, 1};
+static const MotionPattern DANCE_PATTERN = {STEPS(DANCE_STEPS), 2, false, 0.4f, 1.0f, 0.5f, 90.0f, 1};
+
+#undef STEPS
+
+const MotionPattern* motionPatternFor(CommandId command) {
+    switch (command) {
+        case COMMAND_TURN_LEFT: return &TURN_LEFT_PATTERN;
+        case COMMAND_TURN_RIGHT: return &TURN_RIGHT_PATTERN;
+        case COMMAND_MOVE_FORWARD_FOR_TIME: return &FORWARD_FOR_TIME_PATTERN;
+        case COMMAND_MOVE_BACKWARD_FOR_TIME: return &BACKWARD_FOR_TIME_PATTERN;
+        case COMMAND_MAKE_SQUARE: return &SQUARE_PATTERN;
+        case COMMAND_MAKE_CIRCLE: return &CIRCLE_PATTERN;
+        case COMMAND_MAKE_STAR: return &STAR_PATTERN;
+        case COMMAND_ZIGZAG: return &ZIGZAG_PATTERN;
+        case COMMAND_SPIN: return &SPIN_PATTERN;
+        case COMMAND_DANCE: return &DANCE_PATTERN;
+        default: return nullptr;
+    }
+}
+
+static int8_t signOf2Bit(uint8_t bits) {
+    return (bits & 0x02) ? (int8_t)bits - 4 : (int8_t)bits;  // 0b11 = -1
+}
+
+bool decodeProgramStep(const uint8_t* bytes, MotionStep& out) {
+    uint8_t kind = bytes[0] & 0x03;
+    int8_t drive = signOf2Bit((bytes[0] >> 2) & 0x03);
+    int8_t turn = signOf2Bit((bytes[0] >> 4) & 0x03);
+    if (kind > SEGMENT_ANGLE || drive < -1 || turn < -1 || (bytes[0] & 0xC0) != 0 || bytes[1] > 100) {
+        return false;
+    }
+    out.kind = static_cast<MotionSegmentKind>(kind);
+    out.drive = drive;
+    out.turn = turn;
+    out.arc = false;
+    out.target = TARGET_FIXED;
+    out.scale = (uint16_t)(bytes[2] | (bytes[3] << 8)) / 100.0f;
+    out.speed = bytes[1] / 100.0f;
+    return true;
+}
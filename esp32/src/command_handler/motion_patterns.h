@@ -0,0 +1,79 @@
+#ifndef MOTION_PATTERNS_H
+#define MOTION_PATTERNS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "command_ids.h"
+
+/**
+ * Pre-compiled motion patterns for intermediate commands.
+ *
+ * A pattern is a const array of steps. Step magnitudes are filled from the
+ * command parameters when the step starts, so the executor never parses or
+ * allocates: a step transition is one table read and a few multiplies.
+ *
+ * The built-in routines live in flash (motion_patterns.cpp), so they run
+ * from a single command name. Other sequences are uploaded with "program"
+ * and decoded into the same step format (decodeProgramStep).
+ */
+
+enum MotionSegmentKind : uint8_t {
+    SEGMENT_TIMED,     // Ends after a number of control ticks
+    SEGMENT_DISTANCE,  // Ends when average wheel travel reaches target (meters)
+    SEGMENT_ANGLE      // Ends when encoder heading change reaches target (degrees)
+};
+
+enum MotionTarget : uint8_t {
+    TARGET_FIXED,      // Target is scale itself
+    TARGET_DURATION,   // duration parameter (seconds) * scale
+    TARGET_DISTANCE,   // distance parameter (meters) * scale
+    TARGET_ANGLE       // angle parameter (degrees) * scale
+};
+
+struct MotionStep {
+    MotionSegmentKind kind;
+    int8_t drive;        // Velocity setpoint sign: +1 forward, -1 backward, 0 none
+    int8_t turn;         // Rotation setpoint sign: +1 clockwise, -1 counterclockwise, 0 none
+    bool arc;            // Rotation = velocity * wheelbase / (2 * distance) (circle of radius distance)
+    MotionTarget target;
+    float scale;
+    float speed;         // Step speed 0.0-1.0 (0 = speed parameter)
+};
+
+struct MotionPattern {
+    const MotionStep* steps;
+    uint8_t step_count;
+    uint8_t repetitions;       // Passes through steps (0 = from repetitions parameter)
+    bool mirror_left;          // Negate turns when direction is "left"
+    // Defaults for absent parameters
+    float default_speed;
+    float default_duration;    // seconds
+    float default_distance;    // meters
+    float default_angle;       // degrees
+    uint8_t default_repetitions;
+};
+
+/**
+ * Get the pattern executed for a command id.
+ *
+ * @param command Intermediate command id
+ * @return Pattern, or nullptr if the command has none
+ */
+const MotionPattern* motionPatternFor(CommandId command);
+
+// Uploaded program step, little-endian:
+//   [0] bits 0-1 kind (MotionSegmentKind), bits 2-3 drive, bits 4-5 turn (2-bit two's complement)
+//   [1] speed, percent (0 = program speed parameter)
+//   [2..3] uint16 target: hundredths of a second, meter or degree
+static const size_t PROGRAM_STEP_SIZE = 4;
+
+/**
+ * Decode one uploaded program step into a fixed-target MotionStep.
+ *
+ * @param bytes PROGRAM_STEP_SIZE bytes
+ * @param out Decoded step
+ * @return false if a field is out of range (unknown kind, speed > 100%)
+ */
+bool decodeProgramStep(const uint8_t* bytes, MotionStep& out);
+
+#endif // MOTION_PATTERNS_H
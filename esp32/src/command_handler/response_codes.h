@@ -0,0 +1,29 @@
+#ifndef RESPONSE_CODES_H
+#define RESPONSE_CODES_H
+
+#include <stdint.h>
+
+/**
+ * Status codes carried in the "code" field of JSON responses.
+ * Sent as numbers so replies need no text formatting; the Pi maps them
+ * back to names (pi/command_parser/command_schema.py ResponseCode).
+ * Existing values must never be renumbered.
+ */
+enum ResponseCode : uint8_t {
+    RESPONSE_OK = 0,
+    RESPONSE_CLAMPED = 1,             // Accepted with speed clamped (see "requested")
+    RESPONSE_PARSE_ERROR = 2,         // Not valid JSON
+    RESPONSE_INVALID_COMMAND = 3,     // Missing or mistyped command/parameters/priority
+    RESPONSE_UNKNOWN_COMMAND = 4,
+    RESPONSE_INVALID_PARAMETER = 5,
+    RESPONSE_NOT_IMPLEMENTED = 6,
+    RESPONSE_QUEUE_FULL = 7,
+    RESPONSE_BUSY = 8,                // Same change already pending or running
+    RESPONSE_NOT_AVAILABLE = 9,       // Optional component not attached
+    RESPONSE_LINE_TOO_LONG = 10,      // Line exceeded SERIAL_MAX_LINE_LENGTH (dropped)
+    RESPONSE_FAILED = 11,             // Valid request that could not be carried out
+    RESPONSE_DUPLICATE = 12,          // Sequence number already acknowledged: not executed again
+    RESPONSE_OUT_OF_ORDER = 13        // Sequence gap: dropped, resend from "ack" + 1
+};
+
+#endif // RESPONSE_CODES_H
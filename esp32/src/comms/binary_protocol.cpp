@@ -0,0 +1,141 @@
+#include "binary_protocol.h"
+#include <string.h>
+
+uint16_t crc16Ccitt(const uint8_t* data, size_t length, uint16_t crc) {
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+int framePayloadSize(uint8_t opcode) {
+    switch (opcode) {
+        case COMMAND_MOVE_FORWARD:
+        case COMMAND_MOVE_BACKWARD:
+        case COMMAND_ROTATE_CLOCKWISE:
+        case COMMAND_ROTATE_COUNTERCLOCKWISE:
+        case COMMAND_TURN_LEFT:
+        case COMMAND_TURN_RIGHT:
+        case COMMAND_MOVE_FORWARD_FOR_TIME:
+        case COMMAND_MOVE_BACKWARD_FOR_TIME:
+        case COMMAND_MAKE_SQUARE:
+        case COMMAND_MAKE_CIRCLE:
+        case COMMAND_MAKE_STAR:
+        case COMMAND_ZIGZAG:
+        case COMMAND_SPIN:
+        case COMMAND_DANCE:
+            return FRAME_COMMAND_PAYLOAD_SIZE;
+        case COMMAND_STOP:
+        case COMMAND_JSON_MODE:
+            return 0;
+        case FRAME_OP_RESPONSE:
+            return FRAME_RESPONSE_PAYLOAD_SIZE;
+        case FRAME_OP_TELEMETRY:
+        case FRAME_OP_RECORDER:
+        case COMMAND_REPLAY_SAMPLE:
+            return FRAME_TELEMETRY_PAYLOAD_SIZE;
+        default:
+            return -1;
+    }
+}
+
+size_t encodeFrame(uint8_t opcode, const uint8_t* payload, size_t length, uint8_t* out) {
+    out[0] = FRAME_START;
+    out[1] = opcode;
+    if (length > 0) {
+        memcpy(out + 2, payload, length);
+    }
+    uint16_t crc = crc16Ccitt(out + 1, length + 1);
+    out[2 + length] = (uint8_t)(crc & 0xFF);
+    out[3 + length] = (uint8_t)(crc >> 8);
+    return length + FRAME_OVERHEAD;
+}
+
+float readFloatLE(const uint8_t* bytes) {
+    uint32_t bits = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+                    ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void writeFloatLE(uint8_t* bytes, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bytes[0] = (uint8_t)bits;
+    bytes[1] = (uint8_t)(bits >> 8);
+    bytes[2] = (uint8_t)(bits >> 16);
+    bytes[3] = (uint8_t)(bits >> 24);
+}
+
+FrameDecoder::FrameDecoder()
+    : state_(IDLE), opcode_(0), expected_(0), received_(0), crc_(0xFFFF),
+      crc_low_(0), error_count_(0) {
+}
+
+FrameDecoder::Status FrameDecoder::push(uint8_t byte) {
+    switch (state_) {
+        case IDLE:
+            if (byte != FRAME_START) {
+                return NOT_FRAME;
+            }
+            state_ = OPCODE;
+            return IN_FRAME;
+
+        case OPCODE: {
+            int size = framePayloadSize(byte);
+            if (size < 0) {
+                state_ = IDLE;
+                error_count_++;
+                return FRAME_ERROR;
+            }
+            opcode_ = byte;
+            expected_ = (size_t)size;
+            received_ = 0;
+            crc_ = crc16Ccitt(&byte, 1);
+            state_ = expected_ > 0 ? PAYLOAD : CRC_LOW;
+            return IN_FRAME;
+        }
+
+        case PAYLOAD:
+            payload_[received_++] = byte;
+            if (received_ == expected_) {
+                crc_ = crc16Ccitt(payload_, expected_, crc_);
+                state_ = CRC_LOW;
+            }
+            return IN_FRAME;
+
+        case CRC_LOW:
+            crc_low_ = byte;
+            state_ = CRC_HIGH;
+            return IN_FRAME;
+
+        case CRC_HIGH:
+            state_ = IDLE;
+            if ((uint16_t)(crc_low_ | ((uint16_t)byte << 8)) != crc_) {
+                error_count_++;
+                return FRAME_ERROR;
+            }
+            return FRAME_READY;
+    }
+    return NOT_FRAME;
+}
+
+uint8_t FrameDecoder::opcode() const {
+    return opcode_;
+}
+
+const uint8_t* FrameDecoder::payload() const {
+    return payload_;
+}
+
+size_t FrameDecoder::payloadLength() const {
+    return expected_;
+}
+
+unsigned long FrameDecoder::getErrorCount() const {
+    return error_count_;
+}
@@ -0,0 +1,101 @@
+#ifndef BINARY_PROTOCOL_H
+#define BINARY_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../command_handler/command_ids.h"
+
+/**
+ * Compact binary framing used alongside newline-delimited JSON.
+ *
+ * Frame: [FRAME_START][opcode][payload][crc16 lo][crc16 hi]
+ * - Payload size is fixed per opcode (framePayloadSize), little-endian fields
+ * - CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over opcode + payload
+ * - Command opcodes are CommandId values; device -> Pi opcodes have bit 7 set
+ *
+ * FRAME_START never occurs in ASCII JSON, so both formats share one stream.
+ * Mirror of pi/serial_comm/binary_protocol.py: keep the two in sync.
+ */
+
+static const uint8_t FRAME_START = 0xA5;
+static const uint8_t FRAME_OP_RESPONSE = 0x80;   // ESP32 -> Pi: {uint8 success, command, code; uint16 seq, ack}
+static const uint8_t FRAME_OP_TELEMETRY = 0x81;  // ESP32 -> Pi: TelemetrySample (telemetry/telemetry.h)
+static const uint8_t FRAME_OP_RECORDER = 0x82;   // ESP32 -> Pi: TelemetrySample from a flight recorder dump
+
+// COMMAND_REPLAY_SAMPLE carries a TelemetrySample (FRAME_TELEMETRY_PAYLOAD_SIZE) for log replay.
+// Motion command payload: float speed, duration, angle, distance; uint8 repetitions, direction;
+// uint16 seq (0 = unsequenced). STOP and JSON_MODE carry no payload and are never sequenced.
+static const size_t FRAME_COMMAND_PAYLOAD_SIZE = 20;
+static const size_t FRAME_RESPONSE_PAYLOAD_SIZE = 7;
+static const size_t FRAME_TELEMETRY_PAYLOAD_SIZE = 52;
+static const size_t FRAME_MAX_PAYLOAD_SIZE = 64;
+static const size_t FRAME_OVERHEAD = 4;  // start + opcode + crc16
+
+/**
+ * CRC-16/CCITT-FALSE.
+ *
+ * @param data Bytes to checksum
+ * @param length Number of bytes
+ * @param crc Running CRC (0xFFFF to start)
+ * @return Updated CRC
+ */
+uint16_t crc16Ccitt(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+/**
+ * Get the fixed payload size for an opcode.
+ *
+ * @return Payload size in bytes, or -1 if the opcode is not a valid frame
+ */
+int framePayloadSize(uint8_t opcode);
+
+/**
+ * Encode a complete frame into out (must hold length + FRAME_OVERHEAD bytes).
+ *
+ * @return Number of bytes written
+ */
+size_t encodeFrame(uint8_t opcode, const uint8_t* payload, size_t length, uint8_t* out);
+
+float readFloatLE(const uint8_t* bytes);
+void writeFloatLE(uint8_t* bytes, float value);
+
+/**
+ * Byte-at-a-time frame decoder.
+ * Bytes outside a frame are reported as NOT_FRAME so the caller can hand
+ * them to the JSON line reader.
+ */
+class FrameDecoder {
+public:
+    enum Status {
+        NOT_FRAME,     // Byte is not part of a frame (JSON text)
+        IN_FRAME,      // Byte consumed, frame incomplete
+        FRAME_READY,   // Frame complete and CRC valid: opcode()/payload() available
+        FRAME_ERROR    // Frame dropped (unknown opcode or bad CRC)
+    };
+
+    FrameDecoder();
+
+    /**
+     * Feed one received byte.
+     */
+    Status push(uint8_t byte);
+
+    uint8_t opcode() const;
+    const uint8_t* payload() const;
+    size_t payloadLength() const;
+
+    unsigned long getErrorCount() const;
+
+private:
+    enum State { IDLE, OPCODE, PAYLOAD, CRC_LOW, CRC_HIGH };
+
+    State state_;
+    uint8_t opcode_;
+    uint8_t payload_[FRAME_MAX_PAYLOAD_SIZE];
+    size_t expected_;
+    size_t received_;
+    uint16_t crc_;
+    uint8_t crc_low_;
+    unsigned long error_count_;
+};
+
+#endif // BINARY_PROTOCOL_H
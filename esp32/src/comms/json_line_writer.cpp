@@ -0,0 +1,113 @@
+#include "json_line_writer.h"
+#include <math.h>
+
+static const uint8_t MAX_DECIMALS = 6;
+static const uint32_t POW10[MAX_DECIMALS + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+JsonLineWriter::JsonLineWriter(char* buffer, size_t capacity)
+    : buffer_(buffer), capacity_(capacity), length_(0), overflow_(false) {
+    put('{');
+}
+
+void JsonLineWriter::add(const char* key, bool value) {
+    putKey(key);
+    putText(value ? "true" : "false");
+}
+
+void JsonLineWriter::add(const char* key, int32_t value) {
+    putKey(key);
+    if (value < 0) {
+        put('-');
+    }
+    putUnsigned(value < 0 ? 0u - (uint32_t)value : (uint32_t)value, 1);
+}
+
+void JsonLineWriter::add(const char* key, float value, uint8_t decimals) {
+    putKey(key);
+    float magnitude = fabsf(value);
+    if (!isfinite(value) || magnitude >= 4.0e9f) {
+        putText("null");
+        return;
+    }
+    if (decimals > MAX_DECIMALS) {
+        decimals = MAX_DECIMALS;
+    }
+
+    uint32_t whole = (uint32_t)magnitude;
+    uint32_t fraction = (uint32_t)((magnitude - (float)whole) * POW10[decimals] + 0.5f);
+    if (fraction >= POW10[decimals]) {
+        whole++;  // Rounded up into the next integer (0.999 -> 1.00)
+        fraction = 0;
+    }
+    if (value < 0.0f && (whole != 0 || fraction != 0)) {
+        put('-');
+    }
+    putUnsigned(whole, 1);
+    if (decimals > 0) {
+        put('.');
+        putUnsigned(fraction, decimals);
+    }
+}
+
+void JsonLineWriter::add(const char* key, const char* text) {
+    putKey(key);
+    put('"');
+    for (const char* p = text; *p != '\0'; p++) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            put('\\');
+            put(c);
+        } else if ((unsigned char)c < 0x20) {
+            put(' ');  // Control characters never appear in our messages; keep the line intact
+        } else {
+            put(c);
+        }
+    }
+    put('"');
+}
+
+size_t JsonLineWriter::finish() {
+    put('}');
+    put('\r');
+    put('\n');
+    return overflow_ ? 0 : length_;
+}
+
+void JsonLineWriter::put(char c) {
+    if (length_ < capacity_) {
+        buffer_[length_++] = c;
+    } else {
+        overflow_ = true;
+    }
+}
+
+void JsonLineWriter::putText(const char* text) {
+    while (*text != '\0') {
+        put(*text++);
+    }
+}
+
+void JsonLineWriter::putUnsigned(uint32_t value, uint8_t min_digits) {
+    char digits[10];
+    uint8_t count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count < min_digits && count < sizeof(digits)) {
+        digits[count++] = '0';
+    }
+    while (count > 0) {
+        put(digits[--count]);
+    }
+}
+
+void JsonLineWriter::putKey(const char* key) {
+    if (length_ > 1) {
+        put(',');
+    }
+    put('"');
+    putText(key);
+    put('"');
+    put(':');
+}
@@ -0,0 +1,44 @@
+#ifndef JSON_LINE_WRITER_H
+#define JSON_LINE_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Flat JSON object formatter for fixed-shape replies.
+ * Writes {"key":value,...}\r\n straight into a caller-supplied buffer:
+ * no heap, no printf, no document tree. Floats are printed in fixed point
+ * with a given number of decimals (NaN and infinity become null).
+ * If the buffer runs out, finish() reports 0 instead of a truncated line.
+ *
+ * INTEGRATION POINT: CommandHandler::sendResponse() formats every plain reply here
+ */
+class JsonLineWriter {
+public:
+    JsonLineWriter(char* buffer, size_t capacity);
+
+    void add(const char* key, bool value);
+    void add(const char* key, int32_t value);
+    void add(const char* key, float value, uint8_t decimals);
+    void add(const char* key, const char* text);  // Escaped
+
+    /**
+     * Close the object and append "\r\n".
+     *
+     * @return Line length in bytes, or 0 if it did not fit
+     */
+    size_t finish();
+
+private:
+    char* buffer_;
+    size_t capacity_;
+    size_t length_;
+    bool overflow_;
+
+    void put(char c);
+    void putText(const char* text);
+    void putUnsigned(uint32_t value, uint8_t min_digits);
+    void putKey(const char* key);
+};
+
+#endif // JSON_LINE_WRITER_H
@@ -0,0 +1,58 @@
+#include "line_reader.h"
+
+LineReader::LineReader()
+    : length_(0), line_ready_(false), discarding_(false), overflow_count_(0) {
+    buffer_[0] = '\0';
+}
+
+bool LineReader::push(char c) {
+    if (line_ready_) {
+        length_ = 0;
+        line_ready_ = false;
+    }
+
+    if (c == '\n') {
+        if (discarding_) {
+            // End of an overlong line: resynchronized, nothing to deliver
+            discarding_ = false;
+            length_ = 0;
+            return false;
+        }
+        buffer_[length_] = '\0';
+        line_ready_ = true;
+        return true;
+    }
+
+    if (c == '\r' || discarding_) {
+        return false;
+    }
+
+    if (length_ >= MAX_LINE_LENGTH) {
+        discarding_ = true;
+        length_ = 0;
+        overflow_count_++;
+        return false;
+    }
+
+    buffer_[length_++] = c;
+    return false;
+}
+
+const char* LineReader::line() const {
+    return buffer_;
+}
+
+size_t LineReader::length() const {
+    return length_;
+}
+
+unsigned long LineReader::getOverflowCount() const {
+    return overflow_count_;
+}
+
+void LineReader::reset() {
+    length_ = 0;
+    line_ready_ = false;
+    discarding_ = false;
+    buffer_[0] = '\0';
+}
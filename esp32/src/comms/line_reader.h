@@ -0,0 +1,60 @@
+#ifndef LINE_READER_H
+#define LINE_READER_H
+
+#include <Arduino.h>
+#include "../include/config.h"
+
+/**
+ * Fixed-capacity newline line assembler for serial commands.
+ * No heap: bytes are copied into a static buffer of SERIAL_MAX_LINE_LENGTH.
+ * A line longer than that is discarded up to its newline and counted as
+ * an overflow, so the next line is parsed cleanly.
+ *
+ * INTEGRATION POINT: main.cpp comms task drains Serial in bulk and feeds push()
+ * INTEGRATION POINT: CommandHandler::processCommand() receives line()/length()
+ */
+class LineReader {
+public:
+    static const size_t MAX_LINE_LENGTH = SERIAL_MAX_LINE_LENGTH;
+
+    LineReader();
+
+    /**
+     * Feed one received byte.
+     * '\r' is ignored; '\n' completes the line.
+     *
+     * @param c Received byte
+     * @return true when a complete line is ready in line()/length().
+     *         The view stays valid until the next push().
+     */
+    bool push(char c);
+
+    /**
+     * Get the completed line (NUL-terminated, newline stripped).
+     */
+    const char* line() const;
+
+    /**
+     * Get length of the completed line (excluding terminator).
+     */
+    size_t length() const;
+
+    /**
+     * Get number of lines discarded for exceeding MAX_LINE_LENGTH.
+     */
+    unsigned long getOverflowCount() const;
+
+    /**
+     * Drop any partial line.
+     */
+    void reset();
+
+private:
+    char buffer_[MAX_LINE_LENGTH + 1];
+    size_t length_;
+    bool line_ready_;      // Last push() completed a line; next push() starts a new one
+    bool discarding_;      // Overflowed: skip bytes until the next newline
+    unsigned long overflow_count_;
+};
+
+#endif // LINE_READER_H
@@ -0,0 +1,116 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/**
+ * Fixed-capacity single-producer/single-consumer lock-free queue.
+ *
+ * One task (the producer) calls push(); one task (the consumer) calls
+ * pop()/front()/discardUntil(). Head and tail are free-running counters:
+ * each is written by one side only and published with release/acquire
+ * ordering, so neither side ever blocks or takes a lock. Safe across cores.
+ *
+ * @tparam T Trivially copyable item type
+ * @tparam N Capacity, power of two
+ */
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : head_(0), tail_(0) {}
+
+    /**
+     * Append an item (producer only).
+     *
+     * @return false if the queue is full
+     */
+    bool push(const T& item) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) >= N) {
+            return false;
+        }
+        items_[tail & (N - 1)] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Remove the oldest item (consumer only).
+     *
+     * @return false if the queue is empty
+     */
+    bool pop(T& item) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items_[head & (N - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Peek at the oldest item without removing it (consumer only).
+     *
+     * @return Pointer valid until the next pop, or nullptr if empty
+     */
+    const T* front() const {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &items_[head & (N - 1)];
+    }
+
+    /**
+     * Producer position: number of items ever pushed.
+     * Pass to discardUntil() to drop everything pushed so far.
+     */
+    uint32_t producerPosition() const {
+        return tail_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Drop items up to a producer position (consumer only).
+     * Items pushed after that position are kept.
+     */
+    void discardUntil(uint32_t position) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if ((int32_t)(position - head) > 0) {
+            head_.store(position, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Drop all queued items (consumer only).
+     */
+    void clear() {
+        discardUntil(producerPosition());
+    }
+
+    /**
+     * Number of queued items (approximate while the other side is active).
+     */
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    static size_t capacity() {
+        return N;
+    }
+
+private:
+    T items_[N];
+    std::atomic<uint32_t> head_;  // Written by consumer only
+    std::atomic<uint32_t> tail_;  // Written by producer only
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,92 @@
+#include "tx_ring.h"
+#include <string.h>
+
+static_assert((TxRing::CAPACITY & (TxRing::CAPACITY - 1)) == 0, "SERIAL_TX_RING_SIZE must be a power of two");
+
+TxRing::TxRing()
+    : head_(0), tail_(0), dropped_(0), task_(nullptr) {
+    mux_ = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void TxRing::begin() {
+    if (task_ == nullptr) {
+        xTaskCreatePinnedToCore(txTask, "serial_tx", TX_TASK_STACK_SIZE, this,
+                                TX_TASK_PRIORITY, &task_, TX_TASK_CORE);
+    }
+}
+
+bool TxRing::write(const void* data, size_t length, size_t reserve) {
+    if (task_ == nullptr) {
+        Serial.write(static_cast<const uint8_t*>(data), length);  // Setup: no TX task yet
+        return true;
+    }
+
+    bool queued = false;
+    portENTER_CRITICAL(&mux_);
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    size_t free = CAPACITY - (head - tail_.load(std::memory_order_acquire));
+    if (length + reserve <= free) {
+        // At most two copies: up to the end of the buffer, then from the start
+        size_t index = head & (CAPACITY - 1);
+        size_t first = min(length, CAPACITY - index);
+        memcpy(buffer_ + index, data, first);
+        memcpy(buffer_, static_cast<const uint8_t*>(data) + first, length - first);
+        head_.store(head + length, std::memory_order_release);
+        queued = true;
+    } else {
+        dropped_++;
+    }
+    portEXIT_CRITICAL(&mux_);
+
+    if (queued) {
+        xTaskNotifyGive(task_);
+    }
+    return queued;
+}
+
+bool TxRing::println(const char* text) {
+    // Bounded copy so the line and its terminator go in as one message
+    char line[SERIAL_MAX_LINE_LENGTH + 2];
+    size_t length = strnlen(text, SERIAL_MAX_LINE_LENGTH);
+    memcpy(line, text, length);
+    line[length++] = '\r';
+    line[length++] = '\n';
+    return write(line, length);
+}
+
+size_t TxRing::getFree() const {
+    return CAPACITY - (head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire));
+}
+
+unsigned long TxRing::getDroppedCount() const {
+    return dropped_;
+}
+
+void TxRing::drain() {
+    for (;;) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        size_t pending = head_.load(std::memory_order_acquire) - tail;
+        if (pending == 0) {
+            return;
+        }
+        // Hand the driver only what fits in its TX buffer: Serial.write() then never blocks
+        size_t index = tail & (CAPACITY - 1);
+        size_t chunk = min(pending, CAPACITY - index);
+        int room = Serial.availableForWrite();
+        if (room <= 0) {
+            vTaskDelay(1);  // UART busy: wait for the FIFO to drain
+            continue;
+        }
+        chunk = min(chunk, (size_t)room);
+        Serial.write(buffer_ + index, chunk);
+        tail_.store(tail + chunk, std::memory_order_release);
+    }
+}
+
+void TxRing::txTask(void* arg) {
+    TxRing* ring = static_cast<TxRing*>(arg);
+    for (;;) {
+        ring->drain();
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TX_TASK_IDLE_MS));
+    }
+}
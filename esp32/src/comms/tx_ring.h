@@ -0,0 +1,75 @@
+#ifndef TX_RING_H
+#define TX_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "../include/config.h"
+
+/**
+ * Non-blocking serial transmit ring.
+ *
+ * Any task queues whole messages (a JSON line, a batch of frames) with
+ * write(): the bytes are copied into a static ring under a short spinlock,
+ * or the message is dropped and counted if it does not fit. It is never
+ * split, so messages from different tasks cannot interleave on the wire.
+ * A low-priority task owns the UART and hands it only what the driver's TX
+ * buffer can take without blocking (availableForWrite()).
+ *
+ * Before begin() starts the task, write() goes straight to Serial, so setup
+ * output needs no special handling.
+ *
+ * INTEGRATION POINT: main.cpp starts the task before the comms and telemetry tasks
+ * INTEGRATION POINT: CommandHandler responses, Telemetry frames and status prints queue here
+ */
+class TxRing {
+public:
+    static const size_t CAPACITY = SERIAL_TX_RING_SIZE;
+
+    TxRing();
+
+    /**
+     * Start the TX task on TX_TASK_CORE.
+     */
+    void begin();
+
+    /**
+     * Queue a message (any task except ISRs). Never blocks.
+     *
+     * @param data Message bytes
+     * @param length Message length
+     * @param reserve Free space that must remain afterwards (lets bulk
+     *        streams leave room for command responses)
+     * @return false if the message did not fit (dropped whole, counted)
+     */
+    bool write(const void* data, size_t length, size_t reserve = 0);
+
+    /**
+     * Queue a text line, terminated with "\r\n" like Serial.println().
+     *
+     * @return false if the line did not fit
+     */
+    bool println(const char* text);
+
+    /**
+     * Bytes that can be queued right now.
+     */
+    size_t getFree() const;
+
+    /**
+     * Messages dropped because the ring was full.
+     */
+    unsigned long getDroppedCount() const;
+
+private:
+    uint8_t buffer_[CAPACITY];
+    std::atomic<uint32_t> head_;  // Free-running: producers (under mux_)
+    std::atomic<uint32_t> tail_;  // Free-running: TX task only
+    portMUX_TYPE mux_;            // Serializes producers; the TX task never takes it
+    volatile unsigned long dropped_;
+    TaskHandle_t task_;
+
+    void drain();
+    static void txTask(void* arg);
+};
+
+#endif // TX_RING_H
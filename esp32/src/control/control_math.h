@@ -0,0 +1,222 @@
+#ifndef CONTROL_MATH_H
+#define CONTROL_MATH_H
+
+#include <stdint.h>
+#include <math.h>
+#include "fixed_point.h"
+#include "../include/config.h"
+
+/**
+ * Numeric kernels shared by the pitch filter and balance PID.
+ * Everything is templated on the numeric type T (float or Q16_16) so both
+ * builds run the same code path; control_t picks one at compile time.
+ *
+ * INTEGRATION POINT: IMU uses ComplementaryFilter or KalmanPitchFilter, BalanceController uses PidKernel
+ */
+#if CONTROL_USE_FIXED_POINT
+typedef Q16_16 control_t;
+#else
+typedef float control_t;
+#endif
+
+/**
+ * num/den as T. The Q16_16 specialization stays integer-only.
+ */
+template <typename T>
+inline T ratioOf(int32_t num, int32_t den) {
+    return T((float)num / (float)den);
+}
+
+template <>
+inline Q16_16 ratioOf<Q16_16>(int32_t num, int32_t den) {
+    return Q16_16::fromRatio(num, den);
+}
+
+template <typename T>
+inline T clampValue(T value, T low, T high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
+template <typename T>
+inline T absValue(T value) {
+    return value < T(0) ? -value : value;
+}
+
+/**
+ * atan2(y, x) in degrees, polynomial approximation (max error ~0.09 deg).
+ * atan(z) ~= 45z - z(z - 1)(14.02 + 3.80z) on [0, 1], octants by symmetry.
+ */
+template <typename T>
+T approxAtan2Deg(T y, T x) {
+    const T zero(0);
+    T abs_y = absValue(y);
+    T abs_x = absValue(x);
+    if (abs_x == zero && abs_y == zero) {
+        return zero;
+    }
+
+    bool steep = abs_y > abs_x;
+    T z = steep ? abs_x / abs_y : abs_y / abs_x;  // 0..1, no overflow
+    T angle = z * (T(45.0f) - (z - T(1.0f)) * (T(14.02f) + T(3.80f) * z));
+
+    if (steep) {
+        angle = T(90.0f) - angle;
+    }
+    if (x < zero) {
+        angle = T(180.0f) - angle;
+    }
+    return y < zero ? -angle : angle;
+}
+
+/**
+ * Complementary pitch filter:
+ * pitch = alpha * (pitch + gyro * dt) + (1 - alpha) * accel_pitch
+ * Primed with the accelerometer angle on the first update.
+ */
+template <typename T>
+struct ComplementaryFilter {
+    T alpha;
+    T angle;
+    bool primed;
+
+    explicit ComplementaryFilter(T filter_alpha)
+        : alpha(filter_alpha), angle(0), primed(false) {}
+
+    /**
+     * @param accel_x Forward acceleration (any unit, ratio only)
+     * @param accel_z Vertical acceleration (same unit as accel_x)
+     * @param gyro Pitch rate (degrees/sec)
+     * @param dt Time since previous update (seconds)
+     * @return Filtered pitch angle (degrees)
+     */
+    T update(T accel_x, T accel_z, T gyro, T dt) {
+        T accel_angle = approxAtan2Deg(accel_x, accel_z);
+        if (!primed) {
+            angle = accel_angle;
+            primed = true;
+            return angle;
+        }
+        angle = alpha * (angle + gyro * dt) + (T(1.0f) - alpha) * accel_angle;
+        return angle;
+    }
+
+    void reset() {
+        angle = T(0);
+        primed = false;
+    }
+};
+
+/**
+ * Two-state Kalman pitch filter: state = (pitch, gyro bias), measurement =
+ * accelerometer pitch. Model: pitch += (gyro - bias) * dt, bias constant.
+ *
+ * For a fixed loop rate the covariance converges to a constant, so the
+ * constructor iterates the Riccati recursion once (float, at startup) and
+ * keeps only the steady-state gains. update() is then one prediction and two
+ * multiply-adds. The prediction uses the measured dt; the gains assume
+ * design_dt, which the sample clock holds to within a sample.
+ *
+ * Noise densities:
+ * q_angle (deg^2/s), q_bias ((deg/s)^2/s), r_measure (deg^2 per update).
+ */
+template <typename T>
+struct KalmanPitchFilter {
+    T k_angle;        // Steady-state gain on the innovation (pitch)
+    T k_bias;         // Steady-state gain on the innovation (bias, negative)
+    float variance;   // Steady-state pitch variance after an update (deg^2)
+    T angle;
+    T bias;           // Gyro bias estimate (degrees/sec)
+    bool primed;
+
+    KalmanPitchFilter(float q_angle, float q_bias, float r_measure, float design_dt)
+        : k_angle(0), k_bias(0), variance(0.0f), angle(0), bias(0), primed(false) {
+        // P = F P F' + Q, K = P H' / (H P H' + R), P = (I - K H) P with F = [1 -dt; 0 1], H = [1 0]
+        float p00 = 0.0f, p01 = 0.0f, p10 = 0.0f, p11 = 0.0f;
+        float k0 = 0.0f, k1 = 0.0f;
+        for (int i = 0; i < 20000; i++) {
+            float dt = design_dt;
+            float a00 = p00 + dt * (dt * p11 - p01 - p10 + q_angle);
+            float a01 = p01 - dt * p11;
+            float a10 = p10 - dt * p11;
+            float a11 = p11 + q_bias * dt;
+            float s = a00 + r_measure;
+            float n0 = a00 / s;
+            float n1 = a10 / s;
+            p00 = a00 - n0 * a00;
+            p01 = a01 - n0 * a01;
+            p10 = a10 - n1 * a00;
+            p11 = a11 - n1 * a01;
+            bool settled = i > 0 && fabsf(n0 - k0) < 1e-9f && fabsf(n1 - k1) < 1e-9f;
+            k0 = n0;
+            k1 = n1;
+            if (settled) {
+                break;
+            }
+        }
+        k_angle = T(k0);
+        k_bias = T(k1);
+        variance = p00;
+    }
+
+    /**
+     * @param accel_x Forward acceleration (any unit, ratio only)
+     * @param accel_z Vertical acceleration (same unit as accel_x)
+     * @param gyro Pitch rate (degrees/sec, raw: bias included)
+     * @param dt Time since previous update (seconds)
+     * @return Filtered pitch angle (degrees)
+     */
+    T update(T accel_x, T accel_z, T gyro, T dt) {
+        T accel_angle = approxAtan2Deg(accel_x, accel_z);
+        if (!primed) {
+            angle = accel_angle;
+            primed = true;
+            return angle;
+        }
+        angle = angle + (gyro - bias) * dt;
+        T innovation = accel_angle - angle;
+        angle = angle + k_angle * innovation;
+        bias = bias + k_bias * innovation;
+        return angle;
+    }
+
+    void reset() {
+        angle = T(0);
+        bias = T(0);
+        primed = false;
+    }
+};
+
+/**
+ * PID step with fixed dt, clamped integral and derivative on measurement.
+ * output = kp * error + ki * integral + kd * rate
+ */
+template <typename T>
+struct PidKernel {
+    T kp, ki, kd;
+    T integral;
+    T integral_limit;
+    T dt;
+
+    PidKernel(T p, T i, T d, T limit, T step)
+        : kp(p), ki(i), kd(d), integral(0), integral_limit(limit), dt(step) {}
+
+    /**
+     * D on measurement: with error = measurement - target, d(error)/dt is
+     * +rate, so +Kd * rate damps (and a target step gives no derivative kick).
+     * Positive Kd always damps, as in the MATLAB pid() models.
+     *
+     * @param error Setpoint error (measurement - target)
+     * @param rate Measurement rate of change (derivative term input)
+     * @return Controller output
+     */
+    T compute(T error, T rate) {
+        integral = clampValue(integral + error * dt, -integral_limit, integral_limit);
+        return kp * error + ki * integral + kd * rate;
+    }
+
+    void reset() {
+        integral = T(0);
+    }
+};
+
+#endif // CONTROL_MATH_H
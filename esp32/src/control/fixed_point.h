@@ -0,0 +1,73 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+/**
+ * Q16.16 signed fixed-point number (16 integer bits, 16 fraction bits).
+ * Range +/-32768 with 1/65536 resolution; enough for angles in degrees,
+ * rates in deg/s and motor units. All arithmetic is integer-only;
+ * products and quotients go through a 64-bit intermediate.
+ *
+ * Drop-in numeric type for the templates in control_math.h, so the same
+ * code compiles for float or fixed point (see CONTROL_USE_FIXED_POINT).
+ */
+class Q16_16 {
+public:
+    static const int FRACTION_BITS = 16;
+    static const int32_t ONE = (int32_t)1 << FRACTION_BITS;
+
+    constexpr Q16_16() : raw_(0) {}
+    constexpr Q16_16(int value) : raw_((int32_t)value * ONE) {}
+    constexpr Q16_16(float value) : raw_((int32_t)(value * ONE + (value >= 0 ? 0.5f : -0.5f))) {}
+    constexpr Q16_16(double value) : raw_((int32_t)(value * ONE + (value >= 0 ? 0.5 : -0.5))) {}
+
+    /**
+     * Build from a raw Q16.16 bit pattern.
+     */
+    static constexpr Q16_16 fromRaw(int32_t raw) { return Q16_16(raw, RawTag()); }
+
+    /**
+     * Exact num/den without going through float.
+     */
+    static Q16_16 fromRatio(int32_t num, int32_t den) {
+        return fromRaw(den == 0 ? 0 : (int32_t)(((int64_t)num << FRACTION_BITS) / den));
+    }
+
+    constexpr int32_t raw() const { return raw_; }
+    explicit operator float() const { return (float)raw_ / ONE; }
+
+    Q16_16 operator-() const { return fromRaw(-raw_); }
+    Q16_16 operator+(Q16_16 other) const { return fromRaw(raw_ + other.raw_); }
+    Q16_16 operator-(Q16_16 other) const { return fromRaw(raw_ - other.raw_); }
+    Q16_16 operator*(Q16_16 other) const {
+        return fromRaw((int32_t)(((int64_t)raw_ * other.raw_) >> FRACTION_BITS));
+    }
+    Q16_16 operator/(Q16_16 other) const {
+        // Division by zero saturates instead of trapping
+        if (other.raw_ == 0) {
+            return fromRaw(raw_ >= 0 ? INT32_MAX : INT32_MIN);
+        }
+        return fromRaw((int32_t)(((int64_t)raw_ << FRACTION_BITS) / other.raw_));
+    }
+
+    Q16_16& operator+=(Q16_16 other) { raw_ += other.raw_; return *this; }
+    Q16_16& operator-=(Q16_16 other) { raw_ -= other.raw_; return *this; }
+    Q16_16& operator*=(Q16_16 other) { return *this = *this * other; }
+    Q16_16& operator/=(Q16_16 other) { return *this = *this / other; }
+
+    bool operator==(Q16_16 other) const { return raw_ == other.raw_; }
+    bool operator!=(Q16_16 other) const { return raw_ != other.raw_; }
+    bool operator<(Q16_16 other) const { return raw_ < other.raw_; }
+    bool operator<=(Q16_16 other) const { return raw_ <= other.raw_; }
+    bool operator>(Q16_16 other) const { return raw_ > other.raw_; }
+    bool operator>=(Q16_16 other) const { return raw_ >= other.raw_; }
+
+private:
+    struct RawTag {};
+    constexpr Q16_16(int32_t raw, RawTag) : raw_(raw) {}
+
+    int32_t raw_;
+};
+
+#endif // FIXED_POINT_H
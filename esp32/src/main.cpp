@@ -1,10 +1,22 @@
 #include <Arduino.h>
 #include <Wire.h>
+#include <esp_timer.h>
 #include "balance/balance_controller.h"
 #include "motor_control/motor_driver.h"
+#include "motor_control/motor_mixer.h"
+#include "motor_control/motor_calibrator.h"
+#include "motor_control/pwm_control.h"
 #include "sensors/imu.h"
 #include "sensors/encoder_reader.h"
+#include "odometry/odometry.h"
 #include "command_handler/command_handler.h"
+#include "timing/loop_stats.h"
+#include "telemetry/telemetry.h"
+#include "telemetry/flight_recorder.h"
+#include "replay/log_replay.h"
+#include "comms/line_reader.h"
+#include "comms/binary_protocol.h"
+#include "comms/tx_ring.h"
 #include "../include/config.h"
 
 // Global objects
@@ -12,19 +24,241 @@ BalanceController balanceController(KP, KI, KD);
 MotorDriver leftMotor(MOTOR_LEFT_PWM, MOTOR_LEFT_R_EN, MOTOR_LEFT_L_EN, 0);  // LEDC channel 0
 MotorDriver rightMotor(MOTOR_RIGHT_PWM, MOTOR_RIGHT_R_EN, MOTOR_RIGHT_L_EN, 1);  // LEDC channel 1
 IMU imu;
+#if ENCODER_USE_PCNT
+EncoderReader leftEncoder(ENCODER_LEFT_A, ENCODER_LEFT_B, ENCODER_LEFT_PCNT_UNIT);
+EncoderReader rightEncoder(ENCODER_RIGHT_A, ENCODER_RIGHT_B, ENCODER_RIGHT_PCNT_UNIT);
+#else
 EncoderReader leftEncoder(ENCODER_LEFT_A, ENCODER_LEFT_B);
 EncoderReader rightEncoder(ENCODER_RIGHT_A, ENCODER_RIGHT_B);
+#endif
+Odometry odometry;
 CommandHandler commandHandler(&balanceController, &leftMotor, &rightMotor, &leftEncoder, &rightEncoder);
+LoopStats loopStats(BALANCE_LOOP_PERIOD_US);
+Telemetry telemetry;
+FlightRecorder flightRecorder;
+LogReplay logReplay(&balanceController);
+MotorCalibrator motorCalibrator(&balanceController, &leftMotor, &rightMotor, &leftEncoder, &rightEncoder);
+PwmControl pwmControl(&leftMotor, &rightMotor);
 
 // State variables
-String serialBuffer = "";
-unsigned long lastBalanceUpdate = 0;
-bool balance_active = false;
+TxRing txRing;  // All serial output after setup; drained by the TX task
+LineReader lineReader;
+FrameDecoder frameDecoder;
+volatile bool balance_active = false;
+TelemetrySample tickSample;  // Filled by balanceTick, recorded by controlTask (control task only)
+
+// Task handles (control task runs alone on CONTROL_TASK_CORE, comms on COMMS_TASK_CORE)
+TaskHandle_t controlTaskHandle = nullptr;
+TaskHandle_t commsTaskHandle = nullptr;
+esp_timer_handle_t balanceTimer = nullptr;
+
+// Events raised by the control task, reported by the comms task.
+// The control task never prints: a blocking UART write would delay the next tick.
+volatile bool fall_detected = false;
+volatile unsigned long imu_failure_count = 0;
+
+/**
+ * One balance control tick: IMU -> commands -> encoders/odometry -> PID -> motors -> fall check.
+ * Runs only on the control task, once per esp_timer period.
+ * Each stage is timed into loopStats (esp_timer_get_time, 1 us resolution).
+ */
+void balanceTick() {
+    int64_t t0 = esp_timer_get_time();
+
+    // Update IMU readings
+    if (!imu.update()) {
+        imu_failure_count++;
+    }
+    int64_t t1 = esp_timer_get_time();
+    loopStats.recordStage(LoopStats::STAGE_IMU, (uint32_t)(t1 - t0));
+
+    // Apply STOP / queued commands (setpoints change only on this task)
+    commandHandler.update();
+    pwmControl.service();
+
+    // Get sensor data
+    float angle = imu.getPitchAngle();
+    float angular_velocity = imu.getAngularVelocity();
+
+    // Get encoder velocities and positions (outer loop feedback): one estimate per tick
+    leftEncoder.update();
+    rightEncoder.update();
+    float left_velocity = leftEncoder.getVelocity();
+    float right_velocity = rightEncoder.getVelocity();
+    float avg_wheel_velocity = (left_velocity + right_velocity) / 2.0;
+    float avg_wheel_position = (leftEncoder.getPosition() + rightEncoder.getPosition()) / 2.0f;
+
+    // Pose: encoder deltas since last tick, heading fused with the gyro yaw rate
+    odometry.update(leftEncoder.getPosition(), rightEncoder.getPosition(), imu.getYawRate(), imu.getSampleDt());
+
+    int64_t t_pid = esp_timer_get_time();
+    loopStats.recordStage(LoopStats::STAGE_INPUT, (uint32_t)(t_pid - t1));
+
+    // Update balance controller
+    balanceController.update(angle, angular_velocity, avg_wheel_velocity, avg_wheel_position);
+    int64_t t2 = esp_timer_get_time();
+    loopStats.recordStage(LoopStats::STAGE_PID, (uint32_t)(t2 - t_pid));
+
+    // Balance output already includes velocity_setpoint; main applies rotation as L/R diff
+    float motorOutput = balanceController.getMotorOutput();
+    float rot = balanceController.getRotationSetpoint();
+    WheelSpeeds wheels = mixWheelSpeeds(motorOutput, rot);
+    MotorDriver::setSpeeds(leftMotor, wheels.left, rightMotor, wheels.right);  // Both latch on the same PWM period
+    int64_t t3 = esp_timer_get_time();
+
+    tickSample.time_ms = (uint32_t)(t0 / 1000);
+    tickSample.angle = angle;
+    tickSample.angular_velocity = angular_velocity;
+    tickSample.motor_output = motorOutput;
+    tickSample.velocity_setpoint = balanceController.getVelocitySetpoint();
+    tickSample.rotation_setpoint = rot;
+    tickSample.left_position = leftEncoder.getPosition();
+    tickSample.right_position = rightEncoder.getPosition();
+    tickSample.wheel_velocity = avg_wheel_velocity;
+    tickSample.x = odometry.getX();
+    tickSample.y = odometry.getY();
+    tickSample.heading = odometry.getHeading();
+    loopStats.recordStage(LoopStats::STAGE_MOTOR, (uint32_t)(t3 - t2));
+
+    // Check if robot has fallen
+    if (!balanceController.isBalanced()) {
+        leftMotor.stop();
+        rightMotor.stop();
+        balanceController.reset();  // Drop setpoints without a ramp and clear the integral
+        if (balance_active) {
+            fall_detected = true;
+            flightRecorder.trigger(FlightRecorder::TRIGGER_FALL);  // Frozen after this tick's sample
+        }
+        balance_active = false;
+    }
+    loopStats.recordStage(LoopStats::STAGE_FALL, (uint32_t)(esp_timer_get_time() - t3));
+}
+
+static inline uint16_t saturateU16(int64_t value) {
+    return value > UINT16_MAX ? UINT16_MAX : (uint16_t)value;
+}
+
+/**
+ * esp_timer callback: wake the control task for the next tick.
+ * Runs in the esp_timer task, so it only signals and returns.
+ */
+void onBalanceTimer(void* arg) {
+    (void)arg;
+    xTaskNotifyGive(controlTaskHandle);
+}
+
+/**
+ * Balance control task, pinned to CONTROL_TASK_CORE at CONTROL_TASK_PRIORITY.
+ * CRITICAL: Balance control loop - runs at fixed BALANCE_LOOP_FREQ.
+ * This task must never be disabled during operation.
+ */
+void controlTask(void* arg) {
+    (void)arg;
+    int64_t last_start = esp_timer_get_time();
+    bool suspended = false;  // Replay or calibration owned the previous tick
+    for (;;) {
+        uint32_t notifications = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int64_t start = esp_timer_get_time();
+        loopStats.beginTick(start, notifications);
+        if (logReplay.service()) {
+            // Replay mode: recorded samples drive the controller, the motors stay off
+            leftMotor.stop();
+            rightMotor.stop();
+            loopStats.endTick(esp_timer_get_time());
+            last_start = start;
+            suspended = true;
+            continue;
+        }
+        if (motorCalibrator.service()) {
+            // Calibration sweep: the calibrator drives the motors, balancing is suspended
+            loopStats.endTick(esp_timer_get_time());
+            last_start = start;
+            suspended = true;
+            continue;
+        }
+        if (suspended) {
+            // imu.update() did not run meanwhile: its filters must not integrate the gap as one dt
+            imu.resync();
+            suspended = false;
+        }
+        balanceTick();
+        int64_t end = esp_timer_get_time();
+        loopStats.endTick(end);
+
+        // Telemetry: struct copy into a lock-free ring; the drain task does the I/O
+        tickSample.tick_us = saturateU16(end - start);
+        tickSample.interval_us = saturateU16(start - last_start);
+        telemetry.record(tickSample);
+        flightRecorder.record(tickSample);
+        last_start = start;
+    }
+}
+
+/**
+ * Serial command and status task, pinned to COMMS_TASK_CORE.
+ * Runs off the control core; output is queued to the TX ring, so a full
+ * UART TX FIFO never stalls command handling.
+ */
+void commsTask(void* arg) {
+    (void)arg;
+    unsigned long reported_imu_failures = 0;
+    unsigned long reported_line_overflows = 0;
+    static uint8_t rx_chunk[SERIAL_RX_CHUNK_SIZE];
+
+    for (;;) {
+        // Process serial commands (non-blocking): copy out of the UART RX ring in bulk
+        int available = Serial.available();
+        while (available > 0) {
+            size_t count = Serial.readBytes(rx_chunk, min((size_t)available, sizeof(rx_chunk)));
+            for (size_t i = 0; i < count; i++) {
+                // Binary frames and JSON lines share the stream (FRAME_START is never ASCII)
+                switch (frameDecoder.push(rx_chunk[i])) {
+                    case FrameDecoder::NOT_FRAME:
+                        if (lineReader.push((char)rx_chunk[i])) {
+                            // Process complete command (view into lineReader, no copy)
+                            commandHandler.processCommand(lineReader.line(), lineReader.length());
+                        }
+                        break;
+                    case FrameDecoder::FRAME_READY:
+                        commandHandler.processFrame(frameDecoder.opcode(), frameDecoder.payload(),
+                                                    frameDecoder.payloadLength());
+                        break;
+                    case FrameDecoder::FRAME_ERROR:
+                        // Corrupt frame: NAK with COMMAND_UNKNOWN so the Pi can resend
+                        commandHandler.processFrame(COMMAND_UNKNOWN, nullptr, 0);
+                        break;
+                    case FrameDecoder::IN_FRAME:
+                        break;
+                }
+            }
+            available = Serial.available();
+        }
+
+        // Overlong line was dropped: answer it so the Pi is not left waiting
+        if (lineReader.getOverflowCount() != reported_line_overflows) {
+            reported_line_overflows = lineReader.getOverflowCount();
+            commandHandler.rejectOverlongLine();
+        }
+
+        // Report control task events
+        if (fall_detected) {
+            fall_detected = false;
+            txRing.println("ERROR: Robot fallen - emergency stop");
+        }
+        flightRecorder.service();  // Persists a fall snapshot (motors are already off)
+        if (imu_failure_count != reported_imu_failures) {
+            reported_imu_failures = imu_failure_count;
+            txRing.println("WARNING: IMU update failed");
+        }
+
+        vTaskDelay(1);  // Yield; serial RX is buffered by the UART driver
+    }
+}
 
 void setup() {
     // Initialize serial communication
-    Serial.begin(SERIAL_BAUDRATE);
-    delay(1000);  // Wait for serial monitor
+    Serial.setRxBufferSize(SERIAL_RX_BUFFER_SIZE);  // Must precede begin()
+    Serial.begin(SERIAL_BAUDRATE);  // No wait for a monitor: boot must not stall on the host
     Serial.println("Voice Rover ESP32 Initializing...");
 
     // Initialize I2C for IMU
@@ -38,87 +272,95 @@ void setup() {
     }
     Serial.println("IMU initialized");
 
-    // Calibrate IMU (robot must be level and stationary)
-    Serial.println("Calibrating IMU... Place robot level and stationary");
-    delay(2000);
-    imu.calibrate();
-    Serial.println("IMU calibrated");
+    // Encoders and motors come up while the IMU FIFO fills (no settle delays on the boot path)
+    bool left_encoder_ok = leftEncoder.begin();
+    bool right_encoder_ok = rightEncoder.begin();
+    if (!left_encoder_ok || !right_encoder_ok) {
+        // The outer loop would chase a dead encoder: balance on the IMU alone, setpoints open loop
+        Serial.println("ERROR: Encoder PCNT configuration failed! Velocity/position loop disabled");
+        balanceController.setWheelFeedback(false);
+    } else {
+        Serial.println("Encoders initialized");
+    }
 
-    // Initialize encoders
-    leftEncoder.begin();
-    rightEncoder.begin();
-    Serial.println("Encoders initialized");
+    if (!leftMotor.begin() || !rightMotor.begin()) {
+        Serial.println("ERROR: Motor PWM configuration failed!");
+    } else {
+        Serial.println("Motors initialized");
+    }
+    if (motorCalibrator.load()) {
+        Serial.println("Motor compensation loaded from flash");
+    }
 
-    // Initialize motors
-    leftMotor.begin();
-    rightMotor.begin();
-    Serial.println("Motors initialized");
+    // Warm boot: reuse the stored calibration. Otherwise calibrate (robot level and stationary) and store it.
+    if (imu.loadCalibration()) {
+        Serial.println("IMU calibration loaded from flash");
+    } else {
+        Serial.println("Calibrating IMU... Keep robot level and stationary");
+        bool calibrated = false;
+        for (int attempt = 0; attempt < IMU_CALIBRATION_ATTEMPTS && !calibrated; attempt++) {
+            calibrated = imu.calibrate();
+        }
+        if (!calibrated) {
+            Serial.println("WARNING: IMU calibration failed (robot moving?), running uncalibrated");
+        } else if (!imu.saveCalibration()) {
+            Serial.println("WARNING: IMU calibration not saved");
+        } else {
+            Serial.println("IMU calibrated");
+        }
+    }
 
     // Initialize command handler
     commandHandler.begin();
+    commandHandler.setLoopStats(&loopStats);
+    commandHandler.setTelemetry(&telemetry);
+    commandHandler.setFlightRecorder(&flightRecorder);
+    commandHandler.setTxRing(&txRing);
+    commandHandler.setLogReplay(&logReplay);
+    commandHandler.setOdometry(&odometry);
+    commandHandler.setMotorCalibrator(&motorCalibrator);
+    commandHandler.setPwmControl(&pwmControl);
+    motorCalibrator.setOdometry(&odometry);
     Serial.println("Command handler initialized");
 
+    // Gains saved with "gains" {"save": true} replace the config.h defaults at the first tick
+    if (balanceController.loadGains()) {
+        Serial.println("Balance gains loaded from flash");
+    }
+
+    // Mount flash for the flight recorder (a failed mount keeps RAM-only recording)
+    if (!flightRecorder.begin()) {
+        Serial.println("WARNING: Flight recorder flash unavailable");
+    }
+
     Serial.println("Voice Rover ESP32 Ready - Entering balance mode");
     balance_active = true;
-}
 
-void loop() {
-    // CRITICAL: Balance control loop - runs at fixed 100Hz frequency
-    // This loop must never be disabled during operation
-    unsigned long currentTime = millis();
-    if (currentTime - lastBalanceUpdate >= (1000 / BALANCE_LOOP_FREQ)) {
-        lastBalanceUpdate = currentTime;
-
-        // Update IMU readings
-        if (!imu.update()) {
-            Serial.println("WARNING: IMU update failed");
-        }
+    // Start tasks, then the timer that drives the control task (serial output is queued from here on)
+    txRing.begin();
+    xTaskCreatePinnedToCore(controlTask, "balance", CONTROL_TASK_STACK_SIZE, nullptr,
+                            CONTROL_TASK_PRIORITY, &controlTaskHandle, CONTROL_TASK_CORE);
+    xTaskCreatePinnedToCore(commsTask, "comms", COMMS_TASK_STACK_SIZE, nullptr,
+                            COMMS_TASK_PRIORITY, &commsTaskHandle, COMMS_TASK_CORE);
+    telemetry.begin(&txRing);
 
-        // Get sensor data
-        float angle = imu.getPitchAngle();
-        float angular_velocity = imu.getAngularVelocity();
-        
-        // Get encoder velocities (optional, for feedforward)
-        float left_velocity = leftEncoder.getVelocity();
-        float right_velocity = rightEncoder.getVelocity();
-        float avg_wheel_velocity = (left_velocity + right_velocity) / 2.0;
-
-        // Update balance controller
-        balanceController.update(angle, angular_velocity, avg_wheel_velocity);
-
-        // Balance output already includes velocity_setpoint; main applies rotation as L/R diff
-        float motorOutput = balanceController.getMotorOutput();
-        float rot = balanceController.getRotationSetpoint();
-        int left_speed = (int)(motorOutput + rot);
-        int right_speed = (int)(motorOutput - rot);
-        left_speed = constrain(left_speed, -MAX_MOTOR_SPEED, MAX_MOTOR_SPEED);
-        right_speed = constrain(right_speed, -MAX_MOTOR_SPEED, MAX_MOTOR_SPEED);
-        leftMotor.setSpeed(left_speed);
-        rightMotor.setSpeed(right_speed);
-
-        // Check if robot has fallen
-        if (!balanceController.isBalanced()) {
-            Serial.println("ERROR: Robot fallen - emergency stop");
-            leftMotor.stop();
-            rightMotor.stop();
-            balanceController.setNeutral();
-            balance_active = false;
-        }
-    }
-
-    // Process serial commands (non-blocking)
-    while (Serial.available() > 0) {
-        char c = Serial.read();
-        if (c == '\n') {
-            // Process complete command
-            commandHandler.processCommand(serialBuffer);
-            serialBuffer = "";
-        } else {
-            serialBuffer += c;
-        }
+    const esp_timer_create_args_t timer_args = {
+        .callback = &onBalanceTimer,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "balance_tick",
+        .skip_unhandled_events = true,
+    };
+    if (esp_timer_create(&timer_args, &balanceTimer) != ESP_OK ||
+        esp_timer_start_periodic(balanceTimer, BALANCE_LOOP_PERIOD_US) != ESP_OK) {
+        txRing.println("ERROR: Balance timer start failed!");
+        leftMotor.stop();
+        rightMotor.stop();
+        while(1) delay(100);  // Halt: no control loop means no balance
     }
+}
 
-    // Update encoders (for velocity calculation)
-    leftEncoder.update();
-    rightEncoder.update();
+void loop() {
+    // All work runs in controlTask/commsTask; free the Arduino loop task on the control core
+    vTaskDelete(NULL);
 }
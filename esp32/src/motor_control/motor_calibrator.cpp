@@ -0,0 +1,269 @@
+#include "motor_calibrator.h"
+#include "motor_driver.h"
+#include "../balance/balance_controller.h"
+#include "../sensors/encoder_reader.h"
+#include "../odometry/odometry.h"
+#include <math.h>
+
+static const uint8_t COUNT = MOTOR_CALIBRATION_STEPS + 1;  // Duty steps per direction, 0 included
+static const uint32_t SETTLE_TICKS = (uint32_t)MOTOR_CALIBRATION_SETTLE_MS * 1000 / BALANCE_LOOP_PERIOD_US;
+static const uint32_t MEASURE_TICKS = (uint32_t)MOTOR_CALIBRATION_MEASURE_MS * 1000 / BALANCE_LOOP_PERIOD_US;
+static const float MEASURE_SCALE = 1.0f / (MEASURE_TICKS * BALANCE_LOOP_DT);  // pulses -> pulses/sec
+static const char* const KEYS[2] = {"left", "right"};
+
+static_assert(SETTLE_TICKS > 0 && MEASURE_TICKS > 0, "Motor calibration windows are shorter than a control tick");
+
+MotorCalibrator::MotorCalibrator(BalanceController* controller, MotorDriver* left_motor, MotorDriver* right_motor,
+                                 EncoderReader* left_encoder, EncoderReader* right_encoder)
+    : controller_(controller), left_motor_(left_motor), right_motor_(right_motor),
+      left_encoder_(left_encoder), right_encoder_(right_encoder), odometry_(nullptr), request_(REQUEST_NONE),
+      state_(STATE_IDLE), abort_reason_(ABORT_NONE), steps_done_(0), reference_(0.0f), tick_(0),
+      left_start_(0), right_start_(0), published_seq_(0) {
+    for (uint8_t m = 0; m < 2; m++) {
+        for (uint8_t d = 0; d < 2; d++) {
+            peak_[m][d] = 0.0f;
+        }
+    }
+}
+
+void MotorCalibrator::setOdometry(Odometry* odometry) {
+    odometry_ = odometry;
+}
+
+bool MotorCalibrator::load() {
+    MotorCompensation left, right;
+    if (!left.load(KEYS[0]) || !right.load(KEYS[1])) {
+        return false;  // Half a calibration would add a mismatch: run both raw
+    }
+    apply(left, right);
+    return true;
+}
+
+bool MotorCalibrator::save() const {
+    MotorCompensation left, right;
+    getCompensation(left, right);
+    if (left.isIdentity() || right.isIdentity()) {
+        return false;
+    }
+    return left.save(KEYS[0]) && right.save(KEYS[1]);
+}
+
+bool MotorCalibrator::erase() {
+    bool left = MotorCompensation::erase(KEYS[0]);
+    bool right = MotorCompensation::erase(KEYS[1]);
+    return left && right;
+}
+
+void MotorCalibrator::requestStart() {
+    request_.store(REQUEST_START, std::memory_order_release);
+}
+
+void MotorCalibrator::requestAbort() {
+    request_.store(REQUEST_ABORT, std::memory_order_release);
+}
+
+void MotorCalibrator::requestClear() {
+    request_.store(REQUEST_CLEAR, std::memory_order_release);
+}
+
+bool MotorCalibrator::service() {
+    bool running = state_.load(std::memory_order_relaxed) == STATE_RUNNING;
+    switch (request_.exchange(REQUEST_NONE, std::memory_order_acquire)) {
+        case REQUEST_START:
+            if (!running) {
+                begin();
+                running = true;
+            }
+            break;
+        case REQUEST_ABORT:
+            if (running) {
+                abort(ABORT_STOPPED);
+                return true;  // This tick still belongs to the sweep (motors already off)
+            }
+            break;
+        case REQUEST_CLEAR:
+            if (!running) {
+                MotorCompensation identity;
+                apply(identity, identity);
+            }
+            break;
+        default:
+            break;
+    }
+    if (!running) {
+        return false;
+    }
+    stepSweep();
+    return true;
+}
+
+void MotorCalibrator::begin() {
+    previous_[0] = left_motor_->getCompensation();
+    previous_[1] = right_motor_->getCompensation();
+    MotorCompensation identity;  // Sweep raw duties
+    apply(identity, identity);
+    abort_reason_ = ABORT_NONE;
+    steps_done_ = 0;
+    tick_ = 0;
+    state_.store(STATE_RUNNING, std::memory_order_release);
+}
+
+void MotorCalibrator::stepSweep() {
+    uint8_t step = steps_done_;
+    uint8_t direction = step / COUNT;  // 0 forward, 1 reverse
+    uint8_t k = step % COUNT;
+    left_encoder_->update();
+    right_encoder_->update();
+
+    if (tick_ == 0) {
+        float duty = (float)k / MOTOR_CALIBRATION_STEPS;
+        if (direction == 1) {
+            duty = -duty;
+        }
+        MotorDriver::setSpeeds(*left_motor_, duty, *right_motor_, duty);
+    }
+    tick_++;
+    if (tick_ == SETTLE_TICKS) {
+        left_start_ = left_encoder_->getPosition();
+        right_start_ = right_encoder_->getPosition();
+    }
+    if (tick_ < SETTLE_TICKS + MEASURE_TICKS) {
+        return;
+    }
+
+    speeds_[0][direction][k] = labs(left_encoder_->getPosition() - left_start_) * MEASURE_SCALE;
+    speeds_[1][direction][k] = labs(right_encoder_->getPosition() - right_start_) * MEASURE_SCALE;
+    tick_ = 0;
+    steps_done_ = step + 1;
+    if (step + 1 == TOTAL_STEPS) {
+        finish();
+    }
+}
+
+void MotorCalibrator::finish() {
+    // Reference: the slowest maximum, which every motor and direction can reach
+    float reference = INFINITY;
+    for (uint8_t m = 0; m < 2; m++) {
+        for (uint8_t d = 0; d < 2; d++) {
+            float peak = 0.0f;
+            for (uint8_t k = 0; k < COUNT; k++) {
+                peak = fmaxf(peak, speeds_[m][d][k]);
+            }
+            peak_[m][d] = peak;
+            reference = fminf(reference, peak);
+        }
+    }
+    reference_ = reference;
+
+    MotorCompensation fitted[2];
+    float curves[2][2][MotorCompensation::POINTS];
+    bool ok = reference >= MOTOR_CALIBRATION_MIN_VELOCITY;
+    for (uint8_t m = 0; ok && m < 2; m++) {
+        for (uint8_t d = 0; ok && d < 2; d++) {
+            ok = MotorCompensation::fitCurve(speeds_[m][d], MOTOR_CALIBRATION_STEPS, MOTOR_CALIBRATION_MIN_VELOCITY,
+                                             reference, curves[m][d]);
+        }
+        ok = ok && fitted[m].setCurves(curves[m][0], curves[m][1]);
+    }
+    if (!ok) {
+        abort(ABORT_NO_MOTION);
+        return;
+    }
+    apply(fitted[0], fitted[1]);
+    end();
+    state_.store(STATE_DONE, std::memory_order_release);  // Results published
+}
+
+void MotorCalibrator::abort(AbortReason reason) {
+    apply(previous_[0], previous_[1]);
+    abort_reason_ = reason;
+    end();
+    state_.store(STATE_ABORTED, std::memory_order_release);
+}
+
+void MotorCalibrator::end() {
+    MotorDriver::setSpeeds(*left_motor_, 0.0f, *right_motor_, 0.0f);
+    controller_->reset();
+    if (odometry_ != nullptr) {
+        // The wheels turned on a stand: the rover did not move
+        odometry_->rebase(left_encoder_->getPosition(), right_encoder_->getPosition());
+    }
+}
+
+void MotorCalibrator::apply(const MotorCompensation& left, const MotorCompensation& right) {
+    left_motor_->setCompensation(left);
+    right_motor_->setCompensation(right);
+
+    // Seqlock: odd while the copy is written, so a reader never keeps a torn map
+    uint32_t seq = published_seq_.load(std::memory_order_relaxed);
+    published_seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    published_[0] = left;
+    published_[1] = right;
+    published_seq_.store(seq + 2, std::memory_order_release);
+}
+
+MotorCalibrator::State MotorCalibrator::getState() const {
+    return (State)state_.load(std::memory_order_acquire);
+}
+
+MotorCalibrator::AbortReason MotorCalibrator::getAbortReason() const {
+    return abort_reason_;
+}
+
+uint8_t MotorCalibrator::getStepsDone() const {
+    return steps_done_;
+}
+
+bool MotorCalibrator::isCompensated() const {
+    MotorCompensation left, right;
+    getCompensation(left, right);
+    return !left.isIdentity() && !right.isIdentity();
+}
+
+void MotorCalibrator::getCompensation(MotorCompensation& left, MotorCompensation& right) const {
+    for (;;) {
+        uint32_t seq = published_seq_.load(std::memory_order_acquire);
+        if ((seq & 1) != 0) {
+            continue;  // Control task is mid-copy
+        }
+        left = published_[0];
+        right = published_[1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (published_seq_.load(std::memory_order_relaxed) == seq) {
+            return;
+        }
+    }
+}
+
+float MotorCalibrator::getPeakSpeed(bool right, bool reverse) const {
+    return peak_[right ? 1 : 0][reverse ? 1 : 0];
+}
+
+float MotorCalibrator::getReferenceSpeed() const {
+    return reference_;
+}
+
+const char* MotorCalibrator::stateName(State state) {
+    switch (state) {
+        case STATE_RUNNING:
+            return "running";
+        case STATE_DONE:
+            return "done";
+        case STATE_ABORTED:
+            return "aborted";
+        default:
+            return "idle";
+    }
+}
+
+const char* MotorCalibrator::abortReasonName(AbortReason reason) {
+    switch (reason) {
+        case ABORT_STOPPED:
+            return "stopped";
+        case ABORT_NO_MOTION:
+            return "no_motion";
+        default:
+            return "none";
+    }
+}
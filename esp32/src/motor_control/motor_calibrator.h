@@ -0,0 +1,170 @@
+#ifndef MOTOR_CALIBRATOR_H
+#define MOTOR_CALIBRATOR_H
+
+#include <stdint.h>
+#include <atomic>
+#include "motor_compensation.h"
+#include "../include/config.h"
+
+class BalanceController;
+class MotorDriver;
+class EncoderReader;
+class Odometry;
+class CommandContext;
+
+/**
+ * On-device motor sweep that fits each motor's MotorCompensation.
+ *
+ * With the wheels off the ground, both motors step through duty k / STEPS,
+ * k = 0..MOTOR_CALIBRATION_STEPS, forward and then reverse (the k = 0 step
+ * stops the wheels between directions). Each step is held for
+ * MOTOR_CALIBRATION_SETTLE_MS, then the encoder travel over
+ * MOTOR_CALIBRATION_MEASURE_MS gives the wheel speed. The four speed curves
+ * are inverted at shares of the slowest maximum (MotorCompensation::fitCurve)
+ * and applied to the motors; "save" persists them. A run takes about
+ * 2 * (STEPS + 1) * (SETTLE + MEASURE), ~30 s with the defaults. With the
+ * 8-PPR output-shaft encoders a window sees only a handful of pulses, so the
+ * fit is coarse; the 948-PPR encoders (or a longer window) resolve it finely.
+ *
+ * While running, the control task calls service() instead of balanceTick():
+ * the sweep owns the motors (compensation off), balancing is suspended, and
+ * the balance controller is reset when the run ends so it restarts clean,
+ * and the attached odometry is rebased so the sweep's wheel travel (and
+ * its left/right mismatch) never reaches the pose.
+ * An abort (request or STOP) restores the previous maps.
+ *
+ * Threading: request*() from any task; service() on the control task.
+ * getState() may be read from any task; results are published before
+ * STATE_DONE. The motors' maps change only on the control task, which
+ * publishes a copy after each change; other tasks read that copy
+ * (getCompensation(), isCompensated(), save()), never the motors' own maps.
+ *
+ * INTEGRATION POINT: main.cpp controlTask runs service() and loads the saved maps at boot
+ * INTEGRATION POINT: CommandHandler routes the "motor_cal" command to handleCommand()
+ */
+class MotorCalibrator {
+public:
+    enum State : uint8_t {
+        STATE_IDLE = 0,
+        STATE_RUNNING = 1,
+        STATE_DONE = 2,
+        STATE_ABORTED = 3
+    };
+
+    enum AbortReason : uint8_t {
+        ABORT_NONE = 0,
+        ABORT_STOPPED = 1,    // Abort request or STOP command
+        ABORT_NO_MOTION = 2   // A wheel never turned (check wiring, encoders, the stand)
+    };
+
+    static const uint8_t TOTAL_STEPS = 2 * (MOTOR_CALIBRATION_STEPS + 1);
+
+    MotorCalibrator(BalanceController* controller, MotorDriver* left_motor, MotorDriver* right_motor,
+                    EncoderReader* left_encoder, EncoderReader* right_encoder);
+
+    /**
+     * Apply the maps saved in NVS to both motors (before the control task starts).
+     *
+     * @return true if both motors were calibrated from NVS
+     */
+    bool load();
+
+    /**
+     * Attach the pose to rebase when a run ends (optional; before the control task starts).
+     *
+     * @param odometry Odometry updated from the same encoders
+     */
+    void setOdometry(Odometry* odometry);
+
+    /**
+     * Save both motors' maps to NVS (comms task; flash write stalls both
+     * cores for a few milliseconds).
+     *
+     * @return false if the motors are uncompensated or the write failed
+     */
+    bool save() const;
+
+    /**
+     * Remove the saved maps (the next boot runs uncompensated).
+     */
+    static bool erase();
+
+    void requestStart();
+    void requestAbort();
+    void requestClear();  // Back to raw duty (identity maps) at the next tick, unless running
+
+    /**
+     * Control task, once per tick: apply requests, then run one sweep tick.
+     *
+     * @return true while the sweep owns the motors (balanceTick() must not run)
+     */
+    bool service();
+
+    State getState() const;
+    AbortReason getAbortReason() const;
+    uint8_t getStepsDone() const;
+    bool isCompensated() const;  // Motors run calibrated maps
+
+    /**
+     * Both motors' maps as last applied (any task; retries while the control
+     * task is publishing a change, a copy of a few hundred bytes).
+     *
+     * @param left Receives the left motor's map
+     * @param right Receives the right motor's map
+     */
+    void getCompensation(MotorCompensation& left, MotorCompensation& right) const;
+
+    /**
+     * Sweep maximum of one motor and direction, and the reference speed
+     * (slowest maximum) a full command maps to. Valid when STATE_DONE.
+     *
+     * @return Wheel speed in encoder pulses/sec
+     */
+    float getPeakSpeed(bool right, bool reverse) const;
+    float getReferenceSpeed() const;
+
+    // Names for JSON responses
+    static const char* stateName(State state);
+    static const char* abortReasonName(AbortReason reason);
+
+    /**
+     * "motor_cal" command: start, abort, report, save or clear a calibration (comms task).
+     */
+    bool handleCommand(CommandContext& context);
+
+private:
+    enum Request : uint8_t { REQUEST_NONE, REQUEST_START, REQUEST_ABORT, REQUEST_CLEAR };
+
+    BalanceController* controller_;
+    MotorDriver* left_motor_;
+    MotorDriver* right_motor_;
+    EncoderReader* left_encoder_;
+    EncoderReader* right_encoder_;
+    Odometry* odometry_;
+    std::atomic<uint8_t> request_;
+    std::atomic<uint8_t> state_;
+    AbortReason abort_reason_;
+    volatile uint8_t steps_done_;
+
+    // Sweep (control task only): [motor][direction][duty step] speeds, pulses/sec
+    float speeds_[2][2][MOTOR_CALIBRATION_STEPS + 1];
+    float peak_[2][2];
+    float reference_;
+    uint32_t tick_;                // Ticks into the current step
+    long left_start_;              // Encoder positions at the start of the measuring window
+    long right_start_;
+    MotorCompensation previous_[2];  // Maps before the run (restored on abort)
+
+    // Copy of the motors' maps for other tasks; the sequence is odd while it is written
+    MotorCompensation published_[2];
+    std::atomic<uint32_t> published_seq_;
+
+    void begin();
+    void stepSweep();
+    void finish();
+    void abort(AbortReason reason);
+    void end();                    // Motors off, controller reset, odometry rebased
+    void apply(const MotorCompensation& left, const MotorCompensation& right);  // Set and publish
+};
+
+#endif // MOTOR_CALIBRATOR_H
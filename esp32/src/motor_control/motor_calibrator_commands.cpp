@@ -0,0 +1,85 @@
+#include "motor_calibrator.h"
+#include "../balance/balance_controller.h"
+#include "../command_handler/command_context.h"
+#include <string.h>
+
+bool MotorCalibrator::handleCommand(CommandContext& context) {
+    // {"parameters": {"action": "start" | "abort" | "status" | "save" | "clear"}} (default "status")
+    // start: duty sweep of both motors from the next tick, balancing suspended (wheels off the ground)
+    // save: persist the fitted maps; clear: back to raw duty and erase the saved maps
+    // Reply (start/save/clear): plain response. Reply (abort/status): {"success":true,"state":..,
+    //     "step":..,"steps":..,"compensated":..,"reason":.. (aborted) | "reference":..,"peak":{..} (done),
+    //     "left":{"forward":[..],"reverse":[..]},"right":{..} (compensated)}
+    JsonObject params = context.getParameters();
+    const char* action = params["action"] | "status";
+    State state = getState();
+    bool running = state == STATE_RUNNING;
+    
+    if (strcmp(action, "start") == 0) {
+        if (context.isMotorsOwned() || controller_->getAutotuner().getState() == Autotuner::STATE_RUNNING) {
+            context.sendResponse(false, RESPONSE_BUSY, "Calibration, replay or autotune running");
+            return false;
+        }
+        context.dropQueuedMotion();  // Applied when balancing resumes
+        requestStart();
+        context.sendResponse(true, RESPONSE_OK, "Motor calibration started, keep the wheels off the ground");
+        return true;
+    } else if (strcmp(action, "abort") == 0) {
+        requestAbort();
+    } else if (strcmp(action, "save") == 0 || strcmp(action, "clear") == 0) {
+        if (running) {
+            context.sendResponse(false, RESPONSE_BUSY, "Motor calibration running");
+            return false;
+        }
+        if (action[0] == 's') {
+            bool saved = save();
+            context.sendResponse(saved, saved ? RESPONSE_OK : RESPONSE_FAILED,
+                                 saved ? "Motor compensation saved" : "No motor compensation to save");
+            return saved;
+        }
+        requestClear();
+        bool erased = erase();
+        context.sendResponse(erased, erased ? RESPONSE_OK : RESPONSE_FAILED,
+                             erased ? "Motor compensation cleared" : "Saved motor compensation not erased");
+        return erased;
+    } else if (strcmp(action, "status") != 0) {
+        context.sendResponse(false, RESPONSE_INVALID_PARAMETER, "Unknown motor_cal action", action);
+        return false;
+    }
+    
+    StaticJsonDocument<1024> doc;
+    doc["success"] = true;
+    doc["state"] = stateName(state);
+    doc["step"] = getStepsDone();
+    doc["steps"] = TOTAL_STEPS;
+    MotorCompensation maps[2];  // Published by the control task; the motors' own maps are its alone
+    getCompensation(maps[0], maps[1]);
+    bool compensated = !maps[0].isIdentity() && !maps[1].isIdentity();
+    doc["compensated"] = compensated;
+    if (state == STATE_ABORTED) {
+        doc["reason"] = abortReasonName(getAbortReason());
+    } else if (state == STATE_DONE) {
+        doc["reference"] = getReferenceSpeed();
+        JsonObject peak = doc.createNestedObject("peak");
+        for (uint8_t m = 0; m < 2; m++) {
+            JsonArray speeds = peak.createNestedArray(m == 0 ? "left" : "right");
+            speeds.add(getPeakSpeed(m == 1, false));
+            speeds.add(getPeakSpeed(m == 1, true));
+        }
+    }
+    if (compensated && !running) {
+        for (uint8_t m = 0; m < 2; m++) {
+            const MotorCompensation& map = maps[m];
+            JsonObject motor = doc.createNestedObject(m == 0 ? "left" : "right");
+            for (uint8_t d = 0; d < 2; d++) {
+                JsonArray curve = motor.createNestedArray(d == 0 ? "forward" : "reverse");
+                const float* duties = map.getCurve(d == 1);
+                for (uint8_t i = 0; i < MotorCompensation::POINTS; i++) {
+                    curve.add(duties[i]);
+                }
+            }
+        }
+    }
+    context.sendJson(doc);
+    return true;
+}
@@ -0,0 +1,150 @@
+#include "motor_compensation.h"
+#include <Preferences.h>
+#include <math.h>
+#include <string.h>
+
+static const uint8_t BLOB_VERSION = 1;
+static const float SEGMENTS = (float)(MotorCompensation::POINTS - 1);
+static const float RAMP_SCALE = (float)(1.0 / MOTOR_COMPENSATION_RAMP);
+
+// NVS layout (one key per motor): version, then both curves
+struct CompensationBlob {
+    uint8_t version;
+    float forward[MotorCompensation::POINTS];
+    float reverse[MotorCompensation::POINTS];
+};
+
+MotorCompensation::MotorCompensation() {
+    setIdentity();
+}
+
+void MotorCompensation::setIdentity() {
+    for (uint8_t i = 0; i < POINTS; i++) {
+        forward_[i] = i / SEGMENTS;
+        reverse_[i] = i / SEGMENTS;
+    }
+    identity_ = true;
+}
+
+bool MotorCompensation::isIdentity() const {
+    return identity_;
+}
+
+bool MotorCompensation::setCurves(const float* forward, const float* reverse) {
+    if (!isValid(forward) || !isValid(reverse)) {
+        return false;
+    }
+    memcpy(forward_, forward, sizeof(forward_));
+    memcpy(reverse_, reverse, sizeof(reverse_));
+    identity_ = false;
+    return true;
+}
+
+float MotorCompensation::apply(float speed) const {
+    if (identity_) {
+        return speed;
+    }
+    const float* curve = speed < 0.0f ? reverse_ : forward_;
+    float magnitude = fabsf(speed);
+    float duty;
+    if (magnitude < MOTOR_COMPENSATION_RAMP) {
+        // Scale the duty at the ramp's end down to zero: continuous through the deadband
+        float x = MOTOR_COMPENSATION_RAMP * SEGMENTS;
+        duty = (curve[0] + x * (curve[1] - curve[0])) * (magnitude * RAMP_SCALE);
+    } else {
+        float x = magnitude * SEGMENTS;
+        int i = (int)x;
+        duty = i >= POINTS - 1 ? curve[POINTS - 1] : curve[i] + (x - i) * (curve[i + 1] - curve[i]);
+    }
+    return speed < 0.0f ? -duty : duty;
+}
+
+const float* MotorCompensation::getCurve(bool reverse) const {
+    return reverse ? reverse_ : forward_;
+}
+
+bool MotorCompensation::fitCurve(const float* speeds, uint8_t steps, float min_speed, float reference,
+                                 float* curve) {
+    // Deadband: first duty whose (running maximum) speed counts as moving
+    int first = -1;
+    float peak = 0.0f;
+    for (int k = 0; k <= steps; k++) {
+        peak = fmaxf(peak, speeds[k]);
+        if (first < 0 && peak >= min_speed) {
+            first = k;
+        }
+    }
+    if (steps == 0 || first < 0 || !(reference > 0.0f) || peak < reference) {
+        return false;
+    }
+
+    // Each point: invert the speed curve at its share of the reference speed
+    float out[POINTS];
+    out[0] = first / (float)steps;
+    for (uint8_t i = 1; i < POINTS; i++) {
+        float target = reference * (i / SEGMENTS);
+        float below = 0.0f;  // Running maximum before step k
+        float duty = 1.0f;
+        for (int k = 0; k <= steps; k++) {
+            float speed = fmaxf(below, speeds[k]);
+            if (speed >= target) {
+                duty = k <= first ? out[0] : ((k - 1) + (target - below) / (speed - below)) / steps;
+                break;
+            }
+            below = speed;
+        }
+        out[i] = fmaxf(duty, out[i - 1]);
+    }
+    memcpy(curve, out, sizeof(out));
+    return true;
+}
+
+bool MotorCompensation::load(const char* key) {
+    Preferences prefs;
+    if (!prefs.begin(MOTOR_COMPENSATION_NVS_NAMESPACE, true)) {
+        return false;  // Namespace not created yet: nothing saved
+    }
+    CompensationBlob blob;
+    bool ok = prefs.getBytesLength(key) == sizeof(blob) &&
+              prefs.getBytes(key, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+    if (!ok || blob.version != BLOB_VERSION) {
+        return false;
+    }
+    return setCurves(blob.forward, blob.reverse);
+}
+
+bool MotorCompensation::save(const char* key) const {
+    CompensationBlob blob;
+    memset(&blob, 0, sizeof(blob));
+    blob.version = BLOB_VERSION;
+    memcpy(blob.forward, forward_, sizeof(forward_));
+    memcpy(blob.reverse, reverse_, sizeof(reverse_));
+
+    Preferences prefs;
+    if (!prefs.begin(MOTOR_COMPENSATION_NVS_NAMESPACE, false)) {
+        return false;
+    }
+    bool ok = prefs.putBytes(key, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+    return ok;
+}
+
+bool MotorCompensation::erase(const char* key) {
+    Preferences prefs;
+    if (!prefs.begin(MOTOR_COMPENSATION_NVS_NAMESPACE, false)) {
+        return false;
+    }
+    bool ok = !prefs.isKey(key) || prefs.remove(key);
+    prefs.end();
+    return ok;
+}
+
+bool MotorCompensation::isValid(const float* curve) {
+    for (uint8_t i = 0; i < POINTS; i++) {
+        if (!(curve[i] >= 0.0f && curve[i] <= 1.0f) || (i > 0 && curve[i] < curve[i - 1])) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,110 @@
+#ifndef MOTOR_COMPENSATION_H
+#define MOTOR_COMPENSATION_H
+
+#include <stdint.h>
+#include "../include/config.h"
+
+/**
+ * Command-to-duty map for one motor: deadband, forward/reverse asymmetry
+ * and the mismatch against the other motor, from a calibration sweep.
+ *
+ * Each direction has MOTOR_COMPENSATION_POINTS duties on a uniform
+ * |command| grid (0, 1/(N-1), ... 1). Point 0 is the deadband: the duty at
+ * which the wheel starts turning. Points past it are the duties giving
+ * i/(N-1) of the reference wheel speed, the slowest of the four
+ * motor/direction maxima, so both wheels run at the same speed in both
+ * directions for the same command (full command gives up the headroom of
+ * the stronger motor). Below MOTOR_COMPENSATION_RAMP the duty ramps
+ * linearly from 0 to the deadband, so the map stays continuous through zero
+ * and a controller output hovering at 0 does not kick the wheels.
+ *
+ * apply() is the per-write cost: one multiply, an index and one lerp. The
+ * identity map (the default) returns the command unchanged, so uncalibrated
+ * motors behave exactly as before.
+ *
+ * load()/save() keep the map in NVS (MOTOR_COMPENSATION_NVS_NAMESPACE), one
+ * key per motor.
+ *
+ * INTEGRATION POINT: MotorDriver applies it in stageSpeed()
+ * INTEGRATION POINT: MotorCalibrator fits it from an encoder sweep
+ */
+class MotorCompensation {
+public:
+    static const uint8_t POINTS = MOTOR_COMPENSATION_POINTS;
+
+    /**
+     * Start as the identity map.
+     */
+    MotorCompensation();
+
+    /**
+     * Restore the identity map (duty = command).
+     */
+    void setIdentity();
+
+    bool isIdentity() const;
+
+    /**
+     * Replace the map.
+     *
+     * @param forward POINTS duties (0..1, non-decreasing) for positive commands
+     * @param reverse POINTS duties for negative commands (magnitudes)
+     * @return false (map unchanged) if either curve is invalid
+     */
+    bool setCurves(const float* forward, const float* reverse);
+
+    /**
+     * Duty for a command (control task, every motor write).
+     *
+     * @param speed Normalized command (-1.0 to 1.0)
+     * @return Normalized duty, same sign as speed
+     */
+    float apply(float speed) const;
+
+    /**
+     * Curve for one direction (POINTS duties, point 0 = deadband).
+     */
+    const float* getCurve(bool reverse) const;
+
+    /**
+     * Fit one curve from a sweep: speeds[k] is the wheel speed measured at
+     * duty k / steps, k = 0..steps (any unit, magnitude).
+     *
+     * @param speeds steps + 1 measured speeds (read as their running maximum)
+     * @param steps Duty steps in the sweep
+     * @param min_speed Slower than this counts as stalled
+     * @param reference Speed a full command maps to (at most the sweep maximum)
+     * @param curve POINTS duties out
+     * @return false if the wheel never reached reference (curve untouched)
+     */
+    static bool fitCurve(const float* speeds, uint8_t steps, float min_speed, float reference, float* curve);
+
+    /**
+     * Load the map saved under key.
+     *
+     * @return true if a valid map was found (otherwise the map is unchanged)
+     */
+    bool load(const char* key);
+
+    /**
+     * Save the map under key. The flash write stalls both cores for a few
+     * milliseconds; call from the comms task.
+     *
+     * @return true if written
+     */
+    bool save(const char* key) const;
+
+    /**
+     * Remove the map saved under key (the next boot runs uncompensated).
+     */
+    static bool erase(const char* key);
+
+private:
+    float forward_[POINTS];
+    float reverse_[POINTS];
+    bool identity_;
+
+    static bool isValid(const float* curve);
+};
+
+#endif // MOTOR_COMPENSATION_H
@@ -1,64 +1,161 @@
 #include "motor_driver.h"
+#include <soc/gpio_struct.h>
 #include "../include/config.h"
 
+static const uint32_t LEDC_SOURCE_CLOCK_HZ = 80000000;  // APB clock feeding the LEDC timers
+static const uint8_t LEDC_MAX_RESOLUTION_BITS = 16;
+static const uint32_t DUTY_UNKNOWN = 0xFFFFFFFF;         // Forces the next duty write
+
+// Single-store pin writes: GPIO0-31 and GPIO32-39 live in separate set/clear registers
+static inline void IRAM_ATTR gpioSet(int pin) {
+    if (pin < 32) {
+        GPIO.out_w1ts = (1UL << pin);
+    } else {
+        GPIO.out1_w1ts.val = (1UL << (pin - 32));
+    }
+}
+
+static inline void IRAM_ATTR gpioClear(int pin) {
+    if (pin < 32) {
+        GPIO.out_w1tc = (1UL << pin);
+    } else {
+        GPIO.out1_w1tc.val = (1UL << (pin - 32));
+    }
+}
+
 MotorDriver::MotorDriver(int pwm_pin, int r_en_pin, int l_en_pin, int ledc_channel)
     : pwm_pin_(pwm_pin), r_en_pin_(r_en_pin), l_en_pin_(l_en_pin),
-      ledc_channel_(ledc_channel), current_speed_(0) {
+      ledc_channel_(ledc_channel), current_speed_(0.0),
+      pwm_frequency_(PWM_FREQUENCY), pwm_resolution_(PWM_RESOLUTION_BITS),
+      full_duty_((float)(1UL << PWM_RESOLUTION_BITS)),
+      direction_(DIRECTION_STOP), duty_(0),
+      // Arduino channels 0-7 are the high-speed group, 8-15 the low-speed group
+      ledc_mode_((ledc_mode_t)(ledc_channel / 8)),
+      ledc_hw_channel_((ledc_channel_t)(ledc_channel % 8)) {
 }
 
-void MotorDriver::begin() {
+bool MotorDriver::begin() {
     // Setup enable pins as outputs
     pinMode(r_en_pin_, OUTPUT);
     pinMode(l_en_pin_, OUTPUT);
 
-    // Configure LEDC for ESP32 PWM
-    // Resolution: 8-bit (0-255)
-    // Frequency: 20kHz (from config.h)
-    ledcSetup(ledc_channel_, PWM_FREQUENCY, 8);
+    // Configure LEDC for ESP32 PWM (frequency and resolution from config.h)
+    bool ok = configurePwm(PWM_FREQUENCY, PWM_RESOLUTION_BITS);
     ledcAttachPin(pwm_pin_, ledc_channel_);
 
     stop();
+    return ok;
 }
 
-void MotorDriver::setSpeed(int speed) {
-    // Clamp to valid range
-    speed = constrain(speed, -MAX_MOTOR_SPEED, MAX_MOTOR_SPEED);
-    
-    if (speed == 0) {
-        stop();
-        return;
+bool MotorDriver::isValidPwm(uint32_t frequency_hz, uint8_t resolution_bits) {
+    // The timer counts 2^bits source-clock cycles per PWM period
+    return frequency_hz > 0 && resolution_bits >= 1 && resolution_bits <= LEDC_MAX_RESOLUTION_BITS &&
+           ((uint64_t)frequency_hz << resolution_bits) <= LEDC_SOURCE_CLOCK_HZ;
+}
+
+bool MotorDriver::configurePwm(uint32_t frequency_hz, uint8_t resolution_bits) {
+    if (!isValidPwm(frequency_hz, resolution_bits) ||
+        ledcSetup(ledc_channel_, frequency_hz, resolution_bits) == 0) {
+        return false;
+    }
+    pwm_frequency_ = frequency_hz;
+    pwm_resolution_ = resolution_bits;
+    full_duty_ = (float)(1UL << resolution_bits);
+
+    // Same normalized speed, new duty scale
+    duty_ = DUTY_UNKNOWN;
+    setSpeed(current_speed_);
+    return true;
+}
+
+void MotorDriver::setCompensation(const MotorCompensation& compensation) {
+    compensation_ = compensation;
+    setSpeed(current_speed_);
+}
+
+const MotorCompensation& MotorDriver::getCompensation() const {
+    return compensation_;
+}
+
+uint32_t MotorDriver::getPwmFrequency() const {
+    return pwm_frequency_;
+}
+
+uint8_t MotorDriver::getPwmResolution() const {
+    return pwm_resolution_;
+}
+
+void MotorDriver::setSpeed(float speed) {
+    if (stageSpeed(speed)) {
+        latchDuty();
+    }
+}
+
+void MotorDriver::setSpeeds(MotorDriver& left, float left_speed, MotorDriver& right, float right_speed) {
+    bool left_changed = left.stageSpeed(left_speed);
+    bool right_changed = right.stageSpeed(right_speed);
+    if (left_changed) {
+        left.latchDuty();
+    }
+    if (right_changed) {
+        right.latchDuty();
     }
+}
+
+bool MotorDriver::stageSpeed(float speed) {
+    // Clamp to valid range
+    speed = constrain(speed, -MAX_MOTOR_OUTPUT, MAX_MOTOR_OUTPUT);
+    current_speed_ = speed;
     
-    // Set direction based on sign
-    setDirection(speed > 0);
+    // Calibrated duty (identity when uncompensated), scaled to the active resolution (nearest step)
+    float output = compensation_.apply(speed);
+    uint32_t duty = (uint32_t)(fabsf(output) * full_duty_ + 0.5f);
     
-    // Write PWM duty cycle using LEDC
-    ledcWrite(ledc_channel_, abs(speed));
+    // Set direction based on sign (a zero duty = both enables LOW, as stop())
+    Direction direction = duty == 0 ? DIRECTION_STOP : (output > 0 ? DIRECTION_FORWARD : DIRECTION_REVERSE);
+    if (direction != direction_) {
+        setDirection(direction);
+    }
     
-    current_speed_ = speed;
+    if (duty == duty_) {
+        return false;
+    }
+    ledc_set_duty(ledc_mode_, ledc_hw_channel_, duty);
+    duty_ = duty;
+    return true;
+}
+
+void MotorDriver::latchDuty() {
+    // New duty takes effect at the channel's next PWM period
+    ledc_update_duty(ledc_mode_, ledc_hw_channel_);
 }
 
 void MotorDriver::stop() {
     // BTS7960 stop: Both enables LOW, PWM duty 0
-    digitalWrite(r_en_pin_, LOW);
-    digitalWrite(l_en_pin_, LOW);
-    ledcWrite(ledc_channel_, 0);
-    current_speed_ = 0;
+    setDirection(DIRECTION_STOP);
+    ledc_set_duty(ledc_mode_, ledc_hw_channel_, 0);
+    ledc_update_duty(ledc_mode_, ledc_hw_channel_);
+    duty_ = 0;
+    current_speed_ = 0.0;
 }
 
-int MotorDriver::getSpeed() {
+float MotorDriver::getSpeed() {
     return current_speed_;
 }
 
-void MotorDriver::setDirection(bool forward) {
+void MotorDriver::setDirection(Direction direction) {
     // BTS7960 direction control:
     // Forward: R_EN=HIGH, L_EN=LOW
     // Reverse: R_EN=LOW, L_EN=HIGH
-    if (forward) {
-        digitalWrite(r_en_pin_, HIGH);
-        digitalWrite(l_en_pin_, LOW);
+    if (direction == DIRECTION_FORWARD) {
+        gpioClear(l_en_pin_);
+        gpioSet(r_en_pin_);
+    } else if (direction == DIRECTION_REVERSE) {
+        gpioClear(r_en_pin_);
+        gpioSet(l_en_pin_);
     } else {
-        digitalWrite(r_en_pin_, LOW);
-        digitalWrite(l_en_pin_, HIGH);
+        gpioClear(r_en_pin_);
+        gpioClear(l_en_pin_);
     }
+    direction_ = direction;
 }
@@ -2,10 +2,26 @@
 #define MOTOR_DRIVER_H
 
 #include <Arduino.h>
+#include <driver/ledc.h>
+#include "motor_compensation.h"
 
 /**
  * Motor driver interface for controlling DC motors.
  * Supports PWM speed control and direction switching.
+ *
+ * Speeds are normalized (-1.0 to 1.0) and scaled to the active LEDC duty
+ * resolution, so the PWM frequency/bit-depth trade-off can change without
+ * touching the controller. At 20 kHz the 80 MHz LEDC clock allows up to
+ * 11 bits (2048 steps); 8 bits leaves the balance output on 256 steps.
+ *
+ * setSpeed() is the per-tick fast path: direction and duty are cached, so an
+ * unchanged command touches no hardware. Direction pins are written with
+ * single GPIO set/clear register stores, duty with the LEDC driver's
+ * stage/latch pair; setSpeeds() latches both wheels together.
+ *
+ * An attached MotorCompensation maps each command to its calibrated duty
+ * (deadband, direction asymmetry, left/right mismatch) before scaling;
+ * getSpeed() still reports the command.
  */
 class MotorDriver {
 public:
@@ -20,45 +36,115 @@ public:
     MotorDriver(int pwm_pin, int r_en_pin, int l_en_pin, int ledc_channel);
 
     /**
-     * Initialize motor driver hardware (setup pins, LEDC PWM).
+     * Initialize motor driver hardware (setup pins, LEDC PWM at
+     * PWM_FREQUENCY / PWM_RESOLUTION_BITS).
+     *
+     * @return false if the LEDC timer could not be configured
      */
-    void begin();
+    bool begin();
+
+    /**
+     * Reconfigure PWM frequency and duty resolution.
+     * Call from the task that drives the motor (the current speed is
+     * re-applied at the new resolution).
+     *
+     * @param frequency_hz PWM frequency
+     * @param resolution_bits Duty resolution (duty steps = 2^bits)
+     * @return false if the combination is invalid or the timer rejected it
+     */
+    bool configurePwm(uint32_t frequency_hz, uint8_t resolution_bits);
+
+    /**
+     * Check a frequency/resolution pair against the LEDC clock limit.
+     */
+    static bool isValidPwm(uint32_t frequency_hz, uint8_t resolution_bits);
 
     /**
      * Set motor speed and direction.
+     * Skips the direction and duty writes that would not change anything.
      *
-     * @param speed Motor speed (-255 to 255)
+     * @param speed Normalized speed (-1.0 to 1.0)
      *              Negative values = reverse, positive = forward
      */
-    void setSpeed(int speed);
+    void setSpeed(float speed);
+
+    /**
+     * Set both motors and latch their new duties back to back.
+     * Channels on the same LEDC timer (e.g. 0 and 1) then switch at the same
+     * PWM period boundary, so the wheels never run a period on mismatched
+     * commands.
+     *
+     * @param left Left motor
+     * @param left_speed Left speed (-1.0 to 1.0)
+     * @param right Right motor
+     * @param right_speed Right speed (-1.0 to 1.0)
+     */
+    static void setSpeeds(MotorDriver& left, float left_speed, MotorDriver& right, float right_speed);
 
     /**
      * Stop the motor immediately.
      * Unconditional safety stop - callable from anywhere.
+     * Writes every pin and the duty regardless of the cached state.
      */
     void stop();
 
     /**
      * Get current motor speed.
      *
-     * @return Current speed (-255 to 255)
+     * @return Current normalized speed (-1.0 to 1.0)
      */
-    int getSpeed();
+    float getSpeed();
+
+    /**
+     * Replace the command-to-duty map (call from the task that drives the
+     * motor; the current speed is re-applied through the new map).
+     *
+     * @param compensation Calibrated map, or identity for raw duty
+     */
+    void setCompensation(const MotorCompensation& compensation);
+
+    const MotorCompensation& getCompensation() const;
+
+    uint32_t getPwmFrequency() const;
+    uint8_t getPwmResolution() const;
 
 private:
+    enum Direction : uint8_t { DIRECTION_STOP, DIRECTION_FORWARD, DIRECTION_REVERSE };
+
     int pwm_pin_;
     int r_en_pin_;  // Right enable (forward direction)
     int l_en_pin_;  // Left enable (reverse direction)
     int ledc_channel_;  // LEDC channel for this motor
-    int current_speed_;
+    float current_speed_;
+
+    // PWM configuration
+    uint32_t pwm_frequency_;
+    uint8_t pwm_resolution_;
+    float full_duty_;  // Duty value for 100% (2^bits)
+    MotorCompensation compensation_;
+
+    // Hardware state as last written (fast path skips matching writes)
+    Direction direction_;
+    uint32_t duty_;
+    ledc_mode_t ledc_mode_;
+    ledc_channel_t ledc_hw_channel_;
 
     /**
      * Set motor direction using BTS7960 enable pins.
      * Forward: R_EN=HIGH, L_EN=LOW
      * Reverse: R_EN=LOW, L_EN=HIGH
      * Stop: R_EN=LOW, L_EN=LOW
+     * The active pin is cleared before the other is set (never both HIGH).
+     */
+    void setDirection(Direction direction);
+
+    /**
+     * Apply direction and stage the duty for speed.
+     *
+     * @return true if the staged duty must be latched with ledc_update_duty
      */
-    void setDirection(bool forward);
+    bool stageSpeed(float speed);
+    void latchDuty();
 };
 
 #endif // MOTOR_DRIVER_H
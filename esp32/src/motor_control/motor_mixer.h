@@ -0,0 +1,33 @@
+#ifndef MOTOR_MIXER_H
+#define MOTOR_MIXER_H
+
+#include <Arduino.h>
+#include "../include/config.h"
+
+/**
+ * Wheel speeds for one control tick.
+ */
+struct WheelSpeeds {
+    float left;
+    float right;
+};
+
+/**
+ * Balance output -> wheel speeds.
+ * The balance output already includes the velocity setpoint; rotation is
+ * applied as a left/right differential (positive = clockwise: left wheel
+ * faster), each wheel clamped to MAX_MOTOR_OUTPUT.
+ *
+ * INTEGRATION POINT: balanceTick() in main.cpp and the plant simulator (sim/) drive the motors through this
+ *
+ * @param motor_output BalanceController::getMotorOutput()
+ * @param rotation BalanceController::getRotationSetpoint()
+ */
+inline WheelSpeeds mixWheelSpeeds(float motor_output, float rotation) {
+    WheelSpeeds speeds;
+    speeds.left = constrain(motor_output + rotation, -MAX_MOTOR_OUTPUT, MAX_MOTOR_OUTPUT);
+    speeds.right = constrain(motor_output - rotation, -MAX_MOTOR_OUTPUT, MAX_MOTOR_OUTPUT);
+    return speeds;
+}
+
+#endif // MOTOR_MIXER_H
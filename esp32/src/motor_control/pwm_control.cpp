@@ -0,0 +1,25 @@
+#include "pwm_control.h"
+#include "motor_driver.h"
+
+PwmControl::PwmControl(MotorDriver* left_motor, MotorDriver* right_motor)
+    : left_motor_(left_motor), right_motor_(right_motor),
+      pending_(false), frequency_request_(0), resolution_request_(0) {
+}
+
+bool PwmControl::request(uint32_t frequency_hz, uint8_t resolution_bits) {
+    if (pending_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    frequency_request_ = frequency_hz;
+    resolution_request_ = resolution_bits;
+    pending_.store(true, std::memory_order_release);
+    return true;
+}
+
+void PwmControl::service() {
+    if (pending_.load(std::memory_order_acquire)) {
+        left_motor_->configurePwm(frequency_request_, resolution_request_);
+        right_motor_->configurePwm(frequency_request_, resolution_request_);
+        pending_.store(false, std::memory_order_release);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef PWM_CONTROL_H
+#define PWM_CONTROL_H
+
+#include <stdint.h>
+#include <atomic>
+
+class MotorDriver;
+class CommandContext;
+
+/**
+ * Run-time PWM reconfiguration of both motors.
+ *
+ * Both channels share one LEDC timer, so frequency and resolution change
+ * together. The comms task posts a change with request(); the control task
+ * applies it between ticks in service(), since MotorDriver::configurePwm()
+ * must run on the task that drives the motors.
+ *
+ * INTEGRATION POINT: main.cpp balanceTick() calls service() every tick
+ * INTEGRATION POINT: CommandHandler routes the "pwm" command to handleCommand()
+ */
+class PwmControl {
+public:
+    PwmControl(MotorDriver* left_motor, MotorDriver* right_motor);
+
+    /**
+     * Post a PWM change (comms task).
+     *
+     * @param frequency_hz PWM frequency (checked with MotorDriver::isValidPwm())
+     * @param resolution_bits Duty resolution
+     * @return false if the previous change has not been applied yet
+     */
+    bool request(uint32_t frequency_hz, uint8_t resolution_bits);
+
+    /**
+     * Apply a pending change to both motors (control task, between ticks).
+     */
+    void service();
+
+    /**
+     * "pwm" command: post a frequency/resolution change, or report the current one.
+     */
+    bool handleCommand(CommandContext& context);
+
+private:
+    MotorDriver* left_motor_;
+    MotorDriver* right_motor_;
+
+    // Mailbox: the request fields are read only while pending_ is set
+    std::atomic<bool> pending_;
+    uint32_t frequency_request_;
+    uint8_t resolution_request_;
+};
+
+#endif // PWM_CONTROL_H
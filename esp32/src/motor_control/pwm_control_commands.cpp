@@ -0,0 +1,43 @@
+#include "pwm_control.h"
+#include "motor_driver.h"
+#include "../command_handler/command_context.h"
+
+bool PwmControl::handleCommand(CommandContext& context) {
+    // {"parameters": {"frequency": Hz, "resolution": bits}}: applied by the control task
+    // at the next tick; either field may be omitted to keep its current value.
+    // Reply: {"success":true,"frequency":..,"resolution":..,"steps":..} (requested values)
+    JsonObject params = context.getParameters();
+    uint32_t frequency = left_motor_->getPwmFrequency();
+    uint8_t resolution = left_motor_->getPwmResolution();
+    
+    bool change = !params["frequency"].isNull() || !params["resolution"].isNull();
+    if (change) {
+        if ((!params["frequency"].isNull() && !params["frequency"].is<unsigned long>()) ||
+            (!params["resolution"].isNull() && !params["resolution"].is<int>())) {
+            context.sendResponse(false, RESPONSE_INVALID_PARAMETER, "Invalid frequency/resolution (must be integers)");
+            return false;
+        }
+        if (!params["frequency"].isNull()) {
+            frequency = params["frequency"].as<unsigned long>();
+        }
+        int bits = params["resolution"].isNull() ? (int)resolution : params["resolution"].as<int>();
+        if (bits < 0 || bits > 255 || !MotorDriver::isValidPwm(frequency, (uint8_t)bits)) {
+            context.sendResponse(false, RESPONSE_INVALID_PARAMETER,
+                                 "Unsupported PWM: frequency * 2^resolution must not exceed 80 MHz");
+            return false;
+        }
+        resolution = (uint8_t)bits;
+        if (!request(frequency, resolution)) {
+            context.sendResponse(false, RESPONSE_BUSY, "PWM change already pending");
+            return false;
+        }
+    }
+    
+    StaticJsonDocument<128> doc;
+    doc["success"] = true;
+    doc["frequency"] = frequency;
+    doc["resolution"] = resolution;
+    doc["steps"] = 1UL << resolution;
+    context.sendJson(doc);
+    return true;
+}
@@ -0,0 +1,69 @@
+#include "odometry.h"
+#include <math.h>
+
+static const float RAD_PER_DEG = (float)(PI / 180.0);
+
+constexpr float Odometry::METERS_PER_PULSE;
+constexpr float Odometry::DEGREES_PER_PULSE_DIFFERENCE;
+
+Odometry::Odometry(float gyro_weight)
+    : gyro_weight_(gyro_weight) {
+    reset(0, 0);
+}
+
+void Odometry::reset(long left_position, long right_position) {
+    left_start_ = left_position;
+    right_start_ = right_position;
+    left_previous_ = left_position;
+    right_previous_ = right_position;
+    x_ = 0.0f;
+    y_ = 0.0f;
+    heading_ = 0.0f;
+}
+
+void Odometry::rebase(long left_position, long right_position) {
+    // Shift the reset positions too: the encoder heading is taken from them
+    left_start_ += left_position - left_previous_;
+    right_start_ += right_position - right_previous_;
+    left_previous_ = left_position;
+    right_previous_ = right_position;
+}
+
+void Odometry::update(long left_position, long right_position, float yaw_rate, float dt) {
+    long left_delta = left_position - left_previous_;
+    long right_delta = right_position - right_previous_;
+    left_previous_ = left_position;
+    right_previous_ = right_position;
+
+    // Encoder heading from the total difference since reset: exact, nothing accumulates
+    float encoder_heading = ((right_position - right_start_) - (left_position - left_start_)) *
+                            DEGREES_PER_PULSE_DIFFERENCE;
+    float previous_heading = heading_;
+    float heading = encoder_heading;
+    if (gyro_weight_ > 0.0f && !isnan(yaw_rate)) {
+        heading = gyro_weight_ * (previous_heading + yaw_rate * dt) + (1.0f - gyro_weight_) * encoder_heading;
+    }
+    heading_ = heading;
+
+    // Most ticks at low encoder resolution see no pulse: skip the trigonometry
+    long travel_pulses = left_delta + right_delta;
+    if (travel_pulses == 0) {
+        return;
+    }
+    float distance = travel_pulses * (0.5f * METERS_PER_PULSE);
+    float mid_heading = 0.5f * (previous_heading + heading) * RAD_PER_DEG;
+    x_ = x_ + distance * cosf(mid_heading);
+    y_ = y_ + distance * sinf(mid_heading);
+}
+
+float Odometry::getX() const {
+    return x_;
+}
+
+float Odometry::getY() const {
+    return y_;
+}
+
+float Odometry::getHeading() const {
+    return heading_;
+}
@@ -0,0 +1,87 @@
+#ifndef ODOMETRY_H
+#define ODOMETRY_H
+
+#include <Arduino.h>
+#include "../include/config.h"
+
+/**
+ * Dead-reckoned pose (x, y, heading) from the wheel encoders, updated
+ * incrementally once per control tick.
+ *
+ * Each update() takes the encoder pulse deltas since the previous tick:
+ * their mean moves the rover along the mid-tick heading, their difference
+ * turns it. Per-pulse distances are compile-time constants, so a tick costs
+ * a few multiplies, plus one sin/cos pair only when a wheel moved.
+ *
+ * Heading optionally fuses the gyro yaw rate: a complementary filter with
+ * ODOMETRY_GYRO_WEIGHT per tick follows the integrated gyro short term
+ * (smooth, no wheel slip, no encoder quantization) and the encoder heading
+ * long term (no gyro bias drift). Weight 0 or a NAN yaw rate keeps the
+ * encoder heading alone.
+ *
+ * Frame: origin and x axis at the boot (or reset()) pose, y to the left.
+ * Heading is in degrees, counter-clockwise positive, and not wrapped to
+ * +/-180 so multi-turn spins keep counting.
+ * Written by the control task only; readers see individually consistent
+ * values, as with LoopStats.
+ *
+ * INTEGRATION POINT: main.cpp balanceTick updates it after the encoders
+ * INTEGRATION POINT: CommandHandler angle segments, telemetry pose fields
+ * INTEGRATION POINT: MotorCalibrator rebases it when a sweep ends
+ */
+class Odometry {
+public:
+    // Wheel travel per encoder pulse, and heading change per pulse of left/right difference
+    static constexpr float METERS_PER_PULSE = (float)(PI * WHEEL_DIAMETER_MM / 1000.0 / ENCODER_PULSES_PER_REV);
+    static constexpr float DEGREES_PER_PULSE_DIFFERENCE =
+        (float)(WHEEL_DIAMETER_MM / (double)WHEELBASE_MM * 180.0 / ENCODER_PULSES_PER_REV);
+
+    /**
+     * @param gyro_weight Gyro share of the heading per update (0 = encoders only)
+     */
+    explicit Odometry(float gyro_weight = ODOMETRY_GYRO_WEIGHT);
+
+    /**
+     * Move the origin to the current pose.
+     *
+     * @param left_position Left encoder position now (pulses)
+     * @param right_position Right encoder position now (pulses)
+     */
+    void reset(long left_position, long right_position);
+
+    /**
+     * Ignore the wheel travel since the last update(): x, y and heading are
+     * kept, and the next update() starts from these positions. For travel
+     * that moved no rover (a motor sweep on a stand), control task only.
+     *
+     * @param left_position Left encoder position now (pulses)
+     * @param right_position Right encoder position now (pulses)
+     */
+    void rebase(long left_position, long right_position);
+
+    /**
+     * Advance the pose by one control tick (control task only).
+     *
+     * @param left_position Left encoder position (pulses, EncoderReader::getPosition())
+     * @param right_position Right encoder position (pulses)
+     * @param yaw_rate Gyro yaw rate (degrees/sec, counter-clockwise positive; NAN = none)
+     * @param dt Time the yaw rate covers (seconds, IMU::getSampleDt())
+     */
+    void update(long left_position, long right_position, float yaw_rate, float dt);
+
+    float getX() const;        // meters
+    float getY() const;        // meters
+    float getHeading() const;  // degrees, counter-clockwise positive, unwrapped
+
+private:
+    float gyro_weight_;
+    long left_start_;          // Encoder positions at reset()
+    long right_start_;
+    long left_previous_;       // Encoder positions at the previous update()
+    long right_previous_;
+    volatile float x_;
+    volatile float y_;
+    volatile float heading_;   // Fused (degrees)
+};
+
+#endif // ODOMETRY_H
@@ -0,0 +1,221 @@
+#include "log_replay.h"
+#include <esp_timer.h>
+#include <math.h>
+#include <stdlib.h>
+
+static const int CSV_REQUIRED_COLUMNS = 6;
+static const int CSV_COLUMNS = 11;
+
+LogReplay::LogReplay(BalanceController* controller, float tolerance)
+    : controller_(controller), tolerance_(tolerance), request_(REQUEST_NONE), start_position_(0),
+      active_(false), dropped_(0) {
+    clearCounters();
+}
+
+void LogReplay::begin() {
+    controller_->reset();
+    clearCounters();
+}
+
+void LogReplay::clearCounters() {
+    samples_ = 0;
+    mismatches_ = 0;
+    first_mismatch_ = NO_MISMATCH;
+    gaps_ = 0;
+    falls_ = 0;
+    max_update_us_ = 0;
+    max_error_ = 0.0f;
+    square_error_sum_ = 0.0;
+    update_us_sum_ = 0;
+    has_previous_ = false;
+    previous_time_ms_ = 0;
+    previous_position_ = 0.0f;
+    derived_velocity_ = 0.0f;
+}
+
+float LogReplay::step(const TelemetrySample& sample) {
+    float wheel_position = (sample.left_position + sample.right_position) / 2.0f;
+
+    if (has_previous_) {
+        // Ticks missing between samples (decimated or dropped telemetry)
+        uint32_t elapsed_ms = sample.time_ms - previous_time_ms_;
+        uint32_t period_ms = BALANCE_LOOP_PERIOD_US / 1000;
+        if (elapsed_ms * 2 > period_ms * 3) {
+            gaps_ += (elapsed_ms + period_ms / 2) / period_ms - 1;
+        }
+        // Older logs: velocity from the position step over the logged interval
+        float dt = sample.interval_us > 0 ? sample.interval_us / 1000000.0f : elapsed_ms / 1000.0f;
+        if (dt > 0.0f) {
+            derived_velocity_ = (wheel_position - previous_position_) / dt;
+        }
+    }
+    has_previous_ = true;
+    previous_time_ms_ = sample.time_ms;
+    previous_position_ = wheel_position;
+    float wheel_velocity = isnan(sample.wheel_velocity) ? derived_velocity_ : sample.wheel_velocity;
+
+    // Same inputs as balanceTick(), with the setpoints as they were applied on the rover
+    controller_->overrideSetpoints(sample.velocity_setpoint, sample.rotation_setpoint);
+    int64_t start = esp_timer_get_time();
+    controller_->update(sample.angle, sample.angular_velocity, wheel_velocity, wheel_position);
+    uint32_t update_us = (uint32_t)(esp_timer_get_time() - start);
+    float output = controller_->getMotorOutput();
+    if (!controller_->isBalanced()) {
+        controller_->reset();  // As main.cpp after a fall
+        falls_++;
+    }
+
+    float error = fabsf(output - sample.motor_output);
+    if (error > tolerance_) {
+        if (first_mismatch_ == NO_MISMATCH) {
+            first_mismatch_ = samples_;
+        }
+        mismatches_++;
+    }
+    if (error > max_error_) {
+        max_error_ = error;
+    }
+    square_error_sum_ += (double)error * error;
+    update_us_sum_ += update_us;
+    if (update_us > max_update_us_) {
+        max_update_us_ = update_us;
+    }
+    samples_++;
+    return output;
+}
+
+bool LogReplay::post(const TelemetrySample& sample) {
+    if (!queue_.push(sample)) {
+        dropped_++;
+        return false;
+    }
+    return true;
+}
+
+void LogReplay::requestStart() {
+    dropped_ = 0;
+    start_position_.store(queue_.producerPosition(), std::memory_order_relaxed);
+    request_.store(REQUEST_START, std::memory_order_release);
+}
+
+void LogReplay::requestStop() {
+    request_.store(REQUEST_STOP, std::memory_order_release);
+}
+
+bool LogReplay::service() {
+    switch (request_.exchange(REQUEST_NONE, std::memory_order_acquire)) {
+        case REQUEST_START:
+            queue_.discardUntil(start_position_.load(std::memory_order_relaxed));
+            begin();
+            active_.store(true, std::memory_order_release);
+            break;
+        case REQUEST_STOP:
+            if (active_.load(std::memory_order_relaxed)) {
+                controller_->reset();
+                active_.store(false, std::memory_order_release);
+                return true;  // This tick still belongs to replay (motors already off)
+            }
+            break;
+        default:
+            break;
+    }
+    if (!active_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    TelemetrySample sample;
+    for (int i = 0; i < REPLAY_SAMPLES_PER_TICK && queue_.pop(sample); i++) {
+        step(sample);
+    }
+    return true;
+}
+
+bool LogReplay::isActive() const {
+    return active_.load(std::memory_order_acquire);
+}
+
+uint32_t LogReplay::getSampleCount() const {
+    return samples_;
+}
+
+uint32_t LogReplay::getMismatchCount() const {
+    return mismatches_;
+}
+
+uint32_t LogReplay::getFirstMismatch() const {
+    return first_mismatch_;
+}
+
+uint32_t LogReplay::getGapCount() const {
+    return gaps_;
+}
+
+uint32_t LogReplay::getFallCount() const {
+    return falls_;
+}
+
+unsigned long LogReplay::getDroppedCount() const {
+    return dropped_;
+}
+
+float LogReplay::getMaxError() const {
+    return max_error_;
+}
+
+float LogReplay::getRmsError() const {
+    uint32_t samples = samples_;
+    return samples > 0 ? (float)sqrt(square_error_sum_ / samples) : 0.0f;
+}
+
+uint32_t LogReplay::getMaxUpdateUs() const {
+    return max_update_us_;
+}
+
+float LogReplay::getMeanUpdateUs() const {
+    uint32_t samples = samples_;
+    return samples > 0 ? (float)update_us_sum_ / samples : 0.0f;
+}
+
+float LogReplay::getTolerance() const {
+    return tolerance_;
+}
+
+bool LogReplay::parseCsv(const char* line, TelemetrySample& sample) {
+    float values[CSV_COLUMNS];
+    int columns = 0;
+    const char* p = line;
+    while (columns < CSV_COLUMNS) {
+        char* end;
+        float value = strtof(p, &end);
+        if (end == p) {
+            break;  // Not a number: header text, comment or end of row
+        }
+        values[columns++] = value;
+        while (*end == ' ' || *end == '\t') {
+            end++;
+        }
+        if (*end != ',') {
+            break;
+        }
+        p = end + 1;
+    }
+    if (columns < CSV_REQUIRED_COLUMNS) {
+        return false;
+    }
+    for (int i = columns; i < CSV_COLUMNS; i++) {
+        values[i] = 0.0f;
+    }
+
+    sample.time_ms = (uint32_t)values[0];
+    sample.angle = values[1];
+    sample.angular_velocity = values[2];
+    sample.motor_output = values[3];
+    sample.velocity_setpoint = values[4];
+    sample.rotation_setpoint = values[5];
+    sample.left_position = (int32_t)lroundf(values[6]);
+    sample.right_position = (int32_t)lroundf(values[7]);
+    sample.tick_us = (uint16_t)values[8];
+    sample.interval_us = (uint16_t)values[9];
+    sample.wheel_velocity = columns > 10 ? values[10] : NAN;
+    return true;
+}
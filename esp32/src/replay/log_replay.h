@@ -0,0 +1,149 @@
+#ifndef LOG_REPLAY_H
+#define LOG_REPLAY_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "../balance/balance_controller.h"
+#include "../comms/spsc_queue.h"
+#include "../telemetry/telemetry.h"
+#include "../include/config.h"
+
+class CommandContext;
+
+/**
+ * Recorded telemetry replayed through the balance controller.
+ *
+ * Stands in for IMU and EncoderReader: each TelemetrySample (a CSV row from
+ * scripts/capture_telemetry.py, or a frame from scripts/replay_log.py) is fed
+ * to BalanceController::update() exactly as balanceTick() fed the live
+ * readings (angle, rate, average wheel velocity and position, with the
+ * logged profiled setpoints applied as recorded), and the resulting motor
+ * output is compared with the logged one. A controller change that alters
+ * behaviour shows up as mismatches; its cost shows up in the update time.
+ *
+ * Replay is exact for a log recorded from boot at decimation 1 with the same
+ * gains. A log that starts mid-run (integral unknown) mismatches until the
+ * state has washed out; missing ticks (decimated logs) are counted as gaps.
+ * Logs without wheel_velocity (older captures) get it from position steps.
+ *
+ * On the host, call begin() then step() per sample. On the ESP32, the comms
+ * task post()s samples and start/stop requests and the control task runs
+ * service() instead of balanceTick(): the motors stay off and up to
+ * REPLAY_SAMPLES_PER_TICK samples are replayed per tick, as fast as the link
+ * delivers them. Counters are written by the control task only; readers see
+ * individually consistent values, as with LoopStats.
+ *
+ * INTEGRATION POINT: main.cpp controlTask runs service() while isActive()
+ * INTEGRATION POINT: CommandHandler routes the "replay" command to handleCommand() and posts sample frames
+ */
+class LogReplay {
+public:
+    static const uint32_t NO_MISMATCH = 0xFFFFFFFF;
+
+    /**
+     * @param controller Controller the samples are fed to (reset on begin)
+     * @param tolerance |replayed - logged| motor output above which a sample mismatches
+     */
+    explicit LogReplay(BalanceController* controller, float tolerance = REPLAY_TOLERANCE);
+
+    /**
+     * Reset the controller and the counters for a new log.
+     */
+    void begin();
+
+    /**
+     * Replay one sample (the caller's task owns the controller).
+     *
+     * @return Motor output the controller computed for it
+     */
+    float step(const TelemetrySample& sample);
+
+    /**
+     * Queue a sample for the control task (comms task only). Never blocks.
+     *
+     * @return false if the queue was full (counted in getDroppedCount())
+     */
+    bool post(const TelemetrySample& sample);
+
+    /**
+     * Ask the control task to start replaying at its next tick (comms task):
+     * begin(), samples queued before the request dropped, motors held off.
+     */
+    void requestStart();
+
+    /**
+     * Ask the control task to stop replaying at its next tick (any task).
+     * The controller is reset so balancing restarts from a clean state.
+     */
+    void requestStop();
+
+    /**
+     * Control task, once per tick: apply start/stop requests, then replay
+     * queued samples while active.
+     *
+     * @return true while replay mode is active (balanceTick() must not run)
+     */
+    bool service();
+
+    bool isActive() const;
+
+    uint32_t getSampleCount() const;
+    uint32_t getMismatchCount() const;
+    uint32_t getFirstMismatch() const;     // Sample index, NO_MISMATCH if none
+    uint32_t getGapCount() const;          // Missing ticks between consecutive samples
+    uint32_t getFallCount() const;         // Fall resets replayed (as main.cpp after a fall)
+    unsigned long getDroppedCount() const; // Samples lost to a full queue
+    float getMaxError() const;
+    float getRmsError() const;
+    uint32_t getMaxUpdateUs() const;       // Longest BalanceController::update(), us
+    float getMeanUpdateUs() const;
+    float getTolerance() const;
+
+    /**
+     * Parse one CSV row in the capture_telemetry.py column order. The first
+     * six columns (log_analysis.m layout) are required; missing extras are 0,
+     * except wheel_velocity, which is NAN (step() then derives it).
+     *
+     * @param line Row text (a header row or a comment fails to parse)
+     * @param sample Filled on success
+     * @return true if the row holds a sample
+     */
+    static bool parseCsv(const char* line, TelemetrySample& sample);
+
+    /**
+     * "replay" command: start, stop or report a replay (comms task).
+     */
+    bool handleCommand(CommandContext& context);
+
+private:
+    enum Request : uint8_t { REQUEST_NONE, REQUEST_START, REQUEST_STOP };
+
+    BalanceController* controller_;
+    float tolerance_;
+    SpscQueue<TelemetrySample, REPLAY_QUEUE_SIZE> queue_;  // comms task -> control task
+    std::atomic<uint8_t> request_;
+    std::atomic<uint32_t> start_position_;  // Queue position at the start request
+    std::atomic<bool> active_;
+    volatile unsigned long dropped_;
+
+    // Counters (written by the replaying task)
+    volatile uint32_t samples_;
+    volatile uint32_t mismatches_;
+    volatile uint32_t first_mismatch_;
+    volatile uint32_t gaps_;
+    volatile uint32_t falls_;
+    volatile uint32_t max_update_us_;
+    volatile float max_error_;
+    double square_error_sum_;
+    uint64_t update_us_sum_;
+
+    // Previous sample, for gaps and the derived wheel velocity
+    bool has_previous_;
+    uint32_t previous_time_ms_;
+    float previous_position_;
+    float derived_velocity_;
+
+    void clearCounters();
+};
+
+#endif // LOG_REPLAY_H
@@ -0,0 +1,49 @@
+#include "log_replay.h"
+#include "../command_handler/command_context.h"
+#include <string.h>
+
+bool LogReplay::handleCommand(CommandContext& context) {
+    // {"parameters": {"action": "start" | "stop" | "status"}} (default "status")
+    // start: from the next tick the control task holds the motors off and feeds
+    //     COMMAND_REPLAY_SAMPLE frames to the balance controller (keep the robot on a stand)
+    // stop: balancing resumes from a reset controller
+    // Reply (status/stop): {"success":true,"active":..,"samples":..,"dropped":..,"gaps":..,
+    //     "falls":..,"mismatches":..,"first_mismatch":.. (if any),"tolerance":..,"max_error":..,"rms_error":..,
+    //     "max_update_us":..,"mean_update_us":..}
+    JsonObject params = context.getParameters();
+    const char* action = params["action"] | "status";
+    if (strcmp(action, "start") == 0) {
+        if (context.isMotorsOwned()) {
+            context.sendResponse(false, RESPONSE_BUSY, "Replay or motor calibration running");
+            return false;
+        }
+        context.dropQueuedMotion();  // Applied when balancing resumes
+        requestStart();
+        context.sendResponse(true, RESPONSE_OK, "Replay started, motors off");
+        return true;
+    } else if (strcmp(action, "stop") == 0) {
+        requestStop();
+    } else if (strcmp(action, "status") != 0) {
+        context.sendResponse(false, RESPONSE_INVALID_PARAMETER, "Unknown replay action", action);
+        return false;
+    }
+    
+    StaticJsonDocument<384> doc;
+    doc["success"] = true;
+    doc["active"] = isActive();
+    doc["samples"] = getSampleCount();
+    doc["dropped"] = getDroppedCount();
+    doc["gaps"] = getGapCount();
+    doc["falls"] = getFallCount();
+    doc["mismatches"] = getMismatchCount();
+    if (getFirstMismatch() != NO_MISMATCH) {
+        doc["first_mismatch"] = getFirstMismatch();
+    }
+    doc["tolerance"] = getTolerance();
+    doc["max_error"] = getMaxError();
+    doc["rms_error"] = getRmsError();
+    doc["max_update_us"] = getMaxUpdateUs();
+    doc["mean_update_us"] = getMeanUpdateUs();
+    context.sendJson(doc);
+    return true;
+}
@@ -1,49 +1,167 @@
 #include "encoder_reader.h"
 
-EncoderReader::EncoderReader(int pinA, int pinB)
-    : pin_a_(pinA), pin_b_(pinB), position_(0), velocity_(0.0),
-      last_update_time_(0), last_position_(0) {
+#if ENCODER_PCNT_LIMIT > 32767
+#error "ENCODER_PCNT_LIMIT must fit the 16-bit PCNT counter"
+#endif
+
+EncoderReader::EncoderReader(int pinA, int pinB, int pcnt_unit)
+    : pin_a_(pinA), pin_b_(pinB), pcnt_unit_(pcnt_unit), position_(0), edge_count_(0),
+      last_edge_us_(0), pcnt_overflow_(0), pcnt_last_count_(0),
+      velocity_(0.0), window_position_(0), window_edge_count_(0), window_edge_us_(0) {
+    mux_ = portMUX_INITIALIZER_UNLOCKED;
 }
 
-void EncoderReader::begin() {
+bool EncoderReader::begin() {
     pinMode(pin_a_, INPUT_PULLUP);
     pinMode(pin_b_, INPUT_PULLUP);
     
+    // Open the first window now so the first edge does not divide by boot time
+    last_edge_us_ = esp_timer_get_time();
+    window_edge_us_ = last_edge_us_;
+    
+    if (pcnt_unit_ != NO_PCNT) {
+        return beginPcnt();
+    }
+    
     // Use attachInterruptArg to pass 'this' to each ISR
     // This allows multiple encoder instances to work independently
     attachInterruptArg(digitalPinToInterrupt(pin_a_), isrA, this, CHANGE);
     attachInterruptArg(digitalPinToInterrupt(pin_b_), isrB, this, CHANGE);
+    return true;
+}
+
+bool EncoderReader::beginPcnt() {
+    pcnt_unit_t unit = (pcnt_unit_t)pcnt_unit_;
+    
+    // 4x quadrature: each channel counts both edges of one pin, the other pin sets direction.
+    // Signs match handlePulse(): A edge with A == B counts forward, B edge with A == B backward.
+    pcnt_config_t config = {};
+    config.unit = unit;
+    config.counter_h_lim = ENCODER_PCNT_LIMIT;
+    config.counter_l_lim = -ENCODER_PCNT_LIMIT;
+    config.lctrl_mode = PCNT_MODE_REVERSE;
+    config.hctrl_mode = PCNT_MODE_KEEP;
+    
+    config.channel = PCNT_CHANNEL_0;
+    config.pulse_gpio_num = pin_a_;
+    config.ctrl_gpio_num = pin_b_;
+    config.pos_mode = PCNT_COUNT_INC;
+    config.neg_mode = PCNT_COUNT_DEC;
+    if (pcnt_unit_config(&config) != ESP_OK) {
+        return false;
+    }
     
-    last_update_time_ = millis();
-    last_position_ = position_;
+    config.channel = PCNT_CHANNEL_1;
+    config.pulse_gpio_num = pin_b_;
+    config.ctrl_gpio_num = pin_a_;
+    config.pos_mode = PCNT_COUNT_DEC;
+    config.neg_mode = PCNT_COUNT_INC;
+    if (pcnt_unit_config(&config) != ESP_OK) {
+        return false;
+    }
+    
+    // Glitch filter: pulses shorter than ENCODER_PCNT_FILTER APB cycles are ignored
+    pcnt_set_filter_value(unit, ENCODER_PCNT_FILTER);
+    pcnt_filter_enable(unit);
+    
+    // The counter clears itself at either limit; the ISR carries the wrap into 64 bits
+    pcnt_event_enable(unit, PCNT_EVT_H_LIM);
+    pcnt_event_enable(unit, PCNT_EVT_L_LIM);
+    pcnt_counter_pause(unit);
+    pcnt_counter_clear(unit);
+    
+    static bool isr_service_installed = false;  // One service shared by all units
+    if (!isr_service_installed) {
+        if (pcnt_isr_service_install(0) != ESP_OK) {
+            return false;
+        }
+        isr_service_installed = true;
+    }
+    if (pcnt_isr_handler_add(unit, pcntOverflowIsr, this) != ESP_OK) {
+        return false;
+    }
+    return pcnt_counter_resume(unit) == ESP_OK;
+}
+
+int64_t EncoderReader::readPcnt() const {
+    // Retry if an overflow lands between reading the total and the counter
+    int64_t overflow;
+    int16_t count;
+    do {
+        overflow = pcnt_overflow_;
+        pcnt_get_counter_value((pcnt_unit_t)pcnt_unit_, &count);
+    } while (overflow != pcnt_overflow_);
+    return overflow + count;
 }
 
 long EncoderReader::getPosition() const {
+    if (pcnt_unit_ != NO_PCNT) {
+        return (long)readPcnt();
+    }
     return position_;
 }
 
-float EncoderReader::getVelocity() {
-    update();  // Update velocity calculation
+float EncoderReader::getVelocity() const {
     return velocity_;
 }
 
 void EncoderReader::reset() {
+    if (pcnt_unit_ != NO_PCNT) {
+        pcnt_counter_clear((pcnt_unit_t)pcnt_unit_);
+        pcnt_overflow_ = 0;
+        pcnt_last_count_ = 0;
+    }
+    portENTER_CRITICAL(&mux_);
     position_ = 0;
-    last_position_ = 0;
+    portEXIT_CRITICAL(&mux_);
+    window_position_ = 0;
     velocity_ = 0.0;
 }
 
 void EncoderReader::update() {
-    // TODO: Calculate velocity from position change
-    // velocity = (position - last_position) / time_delta
-    
-    unsigned long current_time = millis();
-    float dt = (current_time - last_update_time_) / 1000.0;
-    
-    if (dt > 0) {
-        velocity_ = (position_ - last_position_) / dt;
-        last_position_ = position_;
-        last_update_time_ = current_time;
+    if (pcnt_unit_ != NO_PCNT) {
+        // No per-edge timestamps in hardware: this call is the edge time for new counts
+        int64_t count = readPcnt();
+        if (count != pcnt_last_count_) {
+            int64_t delta = count - pcnt_last_count_;
+            portENTER_CRITICAL(&mux_);
+            position_ = (long)count;
+            edge_count_ += (uint32_t)(delta < 0 ? -delta : delta);
+            last_edge_us_ = esp_timer_get_time();
+            portEXIT_CRITICAL(&mux_);
+            pcnt_last_count_ = count;
+        }
+    }
+
+    // Position, edge count and edge time must come from the same edge
+    portENTER_CRITICAL(&mux_);
+    long position = position_;
+    uint32_t edges = edge_count_;
+    int64_t edge_us = last_edge_us_;
+    portEXIT_CRITICAL(&mux_);
+    int64_t now_us = esp_timer_get_time();
+
+    uint32_t window_edges = edges - window_edge_count_;
+    if (window_edges >= ENCODER_VELOCITY_MIN_EDGES ||
+        (window_edges > 0 && now_us - window_edge_us_ >= ENCODER_VELOCITY_MAX_WINDOW_US)) {
+        // Edge-to-edge period: independent of when in the tick this runs
+        int64_t window_us = edge_us - window_edge_us_;
+        if (window_us > 0) {
+            velocity_ = (float)(position - window_position_) * 1000000.0f / (float)window_us;
+        }
+        window_position_ = position;
+        window_edge_count_ = edges;
+        window_edge_us_ = edge_us;
+        return;
+    }
+
+    // Window still open: less than one pulse since edge_us bounds the speed
+    int64_t idle_us = now_us - edge_us;
+    if (idle_us >= ENCODER_VELOCITY_TIMEOUT_US) {
+        velocity_ = 0.0;
+    } else if (idle_us > 0) {
+        float bound = 1000000.0f / (float)idle_us;
+        velocity_ = constrain(velocity_, -bound, bound);
     }
 }
 
@@ -63,21 +181,33 @@ void IRAM_ATTR EncoderReader::handlePulse(bool channelA) {
     // Read both pin states to determine direction
     bool a_state = digitalRead(pin_a_);
     bool b_state = digitalRead(pin_b_);
+    int64_t now_us = esp_timer_get_time();  // IRAM-safe, 1 us resolution
     
     // Quadrature logic: direction depends on which channel leads
+    int step;
     if (channelA) {
         // Channel A changed
-        if (a_state == b_state) {
-            position_++;  // Forward
-        } else {
-            position_--;  // Reverse
-        }
+        step = (a_state == b_state) ? 1 : -1;  // Forward : Reverse
     } else {
         // Channel B changed
-        if (a_state == b_state) {
-            position_--;  // Reverse
-        } else {
-            position_++;  // Forward
-        }
+        step = (a_state == b_state) ? -1 : 1;  // Reverse : Forward
+    }
+    
+    portENTER_CRITICAL_ISR(&mux_);
+    position_ += step;
+    edge_count_++;
+    last_edge_us_ = now_us;
+    portEXIT_CRITICAL_ISR(&mux_);
+}
+
+void EncoderReader::pcntOverflowIsr(void* arg) {
+    // Called from the PCNT ISR service (not IRAM): the count is held at zero until it runs
+    EncoderReader* encoder = static_cast<EncoderReader*>(arg);
+    uint32_t status = 0;
+    pcnt_get_event_status((pcnt_unit_t)encoder->pcnt_unit_, &status);
+    if (status & PCNT_EVT_H_LIM) {
+        encoder->pcnt_overflow_ += ENCODER_PCNT_LIMIT;
+    } else if (status & PCNT_EVT_L_LIM) {
+        encoder->pcnt_overflow_ -= ENCODER_PCNT_LIMIT;
     }
 }
@@ -2,10 +2,30 @@
 #define ENCODER_READER_H
 
 #include <Arduino.h>
+#include <driver/pcnt.h>
+#include "../include/config.h"
 
 /**
  * Quadrature encoder reader for Dagu RS034 encoders.
  * Reads encoder pulses via interrupts and calculates position/velocity.
+ *
+ * Velocity comes from edge timing, not from a position delta per call: the
+ * ISR timestamps every edge (esp_timer, 1 us), and update() divides the
+ * pulses in a window by the time between the window's first and last edges.
+ * The window adapts to speed: it closes after ENCODER_VELOCITY_MIN_EDGES
+ * edges, or after any edge once ENCODER_VELOCITY_MAX_WINDOW_US has passed.
+ * Between edges the estimate decays (the wheel cannot be faster than one
+ * pulse per time since the last edge) and reaches zero after
+ * ENCODER_VELOCITY_TIMEOUT_US.
+ *
+ * Counting runs in one of two modes, chosen per instance:
+ * - Interrupt mode: CHANGE interrupts on both channels decode quadrature in
+ *   software and timestamp each edge. Fine for the 8-PPR output-shaft encoders.
+ * - PCNT mode: an ESP32 pulse counter unit decodes 4x quadrature in hardware
+ *   with a glitch filter; only counter overflows (every ENCODER_PCNT_LIMIT
+ *   counts) interrupt the CPU. Counts are accumulated into 64 bits. Edge time
+ *   is then the update() call that saw the count change, which at 948 PPR is
+ *   many counts per window. Use for the motor-shaft encoders.
  * 
  * INTEGRATION POINT: Balance controller uses getVelocity() for feedback
  * INTEGRATION POINT: Command handler uses getPosition() for distance/angle tracking
@@ -17,30 +37,35 @@ public:
      * 
      * @param pinA Encoder channel A pin (must support interrupts)
      * @param pinB Encoder channel B pin (must support interrupts)
+     * @param pcnt_unit PCNT unit for hardware decoding, or NO_PCNT for interrupt mode
      */
-    EncoderReader(int pinA, int pinB);
+    EncoderReader(int pinA, int pinB, int pcnt_unit = NO_PCNT);
+
+    static const int NO_PCNT = -1;
 
     /**
-     * Setup encoder pins and attach interrupts.
+     * Setup encoder pins and attach interrupts (or configure the PCNT unit).
      * Must be called in setup().
+     *
+     * @return false if the PCNT unit could not be configured
      */
-    void begin();
+    bool begin();
 
     /**
      * Get current encoder position (total pulses).
      * Positive = forward, Negative = backward
+     * PCNT mode: overflow total plus one counter register read.
      * 
      * @return Position in pulses
      */
     long getPosition() const;
 
     /**
-     * Get current wheel velocity.
-     * Calculated from position change over time.
+     * Get current wheel velocity as of the last update().
      * 
      * @return Velocity in pulses per second
      */
-    float getVelocity();
+    float getVelocity() const;
 
     /**
      * Reset encoder position to zero.
@@ -48,18 +73,31 @@ public:
     void reset();
 
     /**
-     * Update velocity calculation.
-     * Should be called periodically (e.g., every balance loop cycle).
+     * Update velocity estimate.
+     * Call exactly once per balance loop tick, from the control task.
      */
     void update();
 
 private:
     int pin_a_;
     int pin_b_;
+    int pcnt_unit_;               // NO_PCNT = interrupt mode
+
+    // Written by the ISR; read together under mux_
     volatile long position_;      // Current position (pulses)
+    volatile uint32_t edge_count_;  // Total edges seen (either direction)
+    volatile int64_t last_edge_us_;
+    portMUX_TYPE mux_;
+
+    // PCNT mode: counts wrapped out of the 16-bit hardware counter (written by the overflow ISR)
+    volatile int64_t pcnt_overflow_;
+    int64_t pcnt_last_count_;     // Control task only: count at the previous update()
+
+    // Velocity window (control task only)
     float velocity_;              // Calculated velocity (pulses/sec)
-    unsigned long last_update_time_;
-    long last_position_;
+    long window_position_;
+    uint32_t window_edge_count_;
+    int64_t window_edge_us_;      // Edge that opened the current window
     
     /**
      * Static ISR trampolines for attachInterruptArg.
@@ -73,6 +111,10 @@ private:
      * Implements minimal quadrature decoding for direction.
      */
     void IRAM_ATTR handlePulse(bool channelA);
+
+    bool beginPcnt();
+    int64_t readPcnt() const;
+    static void pcntOverflowIsr(void* arg);
 };
 
 #endif // ENCODER_READER_H
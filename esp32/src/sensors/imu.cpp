@@ -1,28 +1,101 @@
 #include "imu.h"
+#include <Preferences.h>
+#include <math.h>
+#include <string.h>
+
+#if IMU_USE_FIFO
+// MPU6050 registers (datasheet RM-MPU-6000A)
+static const uint8_t REG_SMPLRT_DIV = 0x19;
+static const uint8_t REG_CONFIG = 0x1A;
+static const uint8_t REG_GYRO_CONFIG = 0x1B;
+static const uint8_t REG_ACCEL_CONFIG = 0x1C;
+static const uint8_t REG_FIFO_EN = 0x23;
+static const uint8_t REG_USER_CTRL = 0x6A;
+static const uint8_t REG_PWR_MGMT_1 = 0x6B;
+static const uint8_t REG_FIFO_COUNT_H = 0x72;
+static const uint8_t REG_FIFO_R_W = 0x74;
+
+static const uint8_t FIFO_EN_YG_ZG_ACCEL = 0x38;  // YG_FIFO_EN | ZG_FIFO_EN | ACCEL_FIFO_EN
+static const uint8_t USER_CTRL_FIFO_EN = 0x40;
+static const uint8_t USER_CTRL_FIFO_RESET = 0x04;
+static const uint8_t PWR_MGMT_1_CLK_PLL_XGYRO = 0x01;
+static const uint8_t GYRO_CONFIG_500_DPS = 0x08;
+static const uint8_t ACCEL_CONFIG_4_G = 0x08;
+
+// Sensitivities as integer ratios so the fixed-point build never converts through float
+static const int32_t GYRO_LSB_PER_DPS_X10 = 655;  // +/-500 deg/s: 65.5 LSB per deg/s
+static const int32_t ACCEL_LSB_PER_G = 8192;      // +/-4 g
+
+// Averaging works on int32 sums of int16 samples: bounding the sample count keeps the
+// sums, the x10 gyro scaling and the n * LSB divisors all inside int32
+static_assert((int64_t)IMU_MAX_AVERAGED_SAMPLES * 32768 * 10 < INT32_MAX &&
+              (int64_t)IMU_MAX_AVERAGED_SAMPLES * ACCEL_LSB_PER_G < INT32_MAX,
+              "IMU_MAX_AVERAGED_SAMPLES too large for int32 averaging");
+
+// FIFO frame in register order: ACCEL_X, ACCEL_Y, ACCEL_Z, GYRO_Y, GYRO_Z (big-endian int16).
+// ACCEL_FIFO_EN always pushes all three axes; Y is read and discarded.
+static const uint16_t FIFO_FRAME_SIZE = 10;
+static const uint16_t FIFO_CAPACITY = 1024;
+static const uint16_t FIFO_MAX_BURST_FRAMES = 12;  // 120 bytes: fits the 128-byte Wire buffer
+// Time the FIFO covers before it overflows: 102 frames = ~102 ms at 1 kHz
+static const uint32_t FIFO_HOLD_MS = (uint32_t)(FIFO_CAPACITY / FIFO_FRAME_SIZE) * 1000 / IMU_SAMPLE_RATE_HZ;
+static_assert(FIFO_HOLD_MS > 1, "IMU FIFO overflows within one acquisition pass");
+
+#if IMU_SAMPLE_RATE_HZ > 1000 || (1000 % IMU_SAMPLE_RATE_HZ) != 0
+#error "IMU_SAMPLE_RATE_HZ must divide the 1 kHz DLPF gyro output rate"
+#endif
+#endif
 
 IMU::IMU()
-    : pitch_angle_(0.0), angular_velocity_(0.0), pitch_offset_(0.0),
-      calibrated_(false), valid_(false), last_update_time_(0), alpha_(0.98) {
+    : accel_x_(0), accel_z_(1), gyro_y_(0), gyro_z_(0.0f), sample_dt_(0), last_sample_us_(0),
+      pitch_angle_(0.0), angular_velocity_(0.0), pitch_offset_(0.0),
+      gyro_offset_(0), yaw_offset_(0.0f), temperature_(NAN),
+      calibrated_(false), valid_(false), last_update_time_(0),
+#if IMU_ESTIMATOR == IMU_ESTIMATOR_KALMAN
+      filter_(IMU_KALMAN_Q_ANGLE, IMU_KALMAN_Q_BIAS, IMU_KALMAN_R_MEASURE, BALANCE_LOOP_DT) {
+#else
+      filter_(control_t(IMU_COMPLEMENTARY_ALPHA)) {
+#endif
+#if IMU_USE_FIFO
+    totals_ = SampleTotals();
+    consumed_ = SampleTotals();
+    sample_mux_ = portMUX_INITIALIZER_UNLOCKED;
+    acq_task_ = nullptr;
+    fifo_overflows_ = 0;
+#endif
 }
 
 bool IMU::begin() {
-    // TODO: Initialize MPU6050 sensor
-    // - Initialize I2C communication
-    // - Check sensor connection
-    // - Configure sensor (range, sample rate)
-    // - Set valid_ flag
-    
-    if (!mpu_.begin()) {
+    // Adafruit begin() resets the sensor and checks WHO_AM_I on the shared Wire bus
+    if (!mpu_.begin(IMU_I2C_ADDRESS, &Wire)) {
         Serial.println("ERROR: MPU6050 not found!");
         valid_ = false;
         return false;
     }
-    
-    // TODO: Configure sensor settings
-    // mpu_.setAccelerometerRange(MPU6050_RANGE_2_G);
-    // mpu_.setGyroRange(MPU6050_RANGE_250_DEG);
-    // mpu_.setFilterBandwidth(MPU6050_BAND_21_HZ);
-    
+
+    // Die temperature for the calibration check (read before the FIFO task owns the bus)
+    if (mpu_.getEvent(&accel_, &gyro_, &temp_)) {
+        temperature_ = temp_.temperature;
+    }
+
+#if IMU_USE_FIFO
+    if (!configureFifo()) {
+        Serial.println("ERROR: MPU6050 FIFO configuration failed!");
+        valid_ = false;
+        return false;
+    }
+
+    if (acq_task_ == nullptr) {
+        xTaskCreatePinnedToCore(acquisitionTask, "imu_acq", IMU_ACQ_TASK_STACK_SIZE, this,
+                                IMU_ACQ_TASK_PRIORITY, &acq_task_, IMU_ACQ_TASK_CORE);
+    }
+#else
+    mpu_.setAccelerometerRange(MPU6050_RANGE_4_G);
+    mpu_.setGyroRange(MPU6050_RANGE_500_DEG);
+    mpu_.setFilterBandwidth(MPU6050_BAND_94_HZ);
+#endif
+
+    last_sample_us_ = esp_timer_get_time();
     valid_ = true;
     return true;
 }
@@ -31,22 +104,75 @@ bool IMU::update() {
     if (!valid_) {
         return false;
     }
-    
-    // TODO: Read sensor data
-    // mpu_.getEvent(&accel_, &gyro_, &temp_);
-    
-    // TODO: Calculate pitch angle using complementary filter
-    // calculatePitch();
-    
-    // TODO: Calculate angular velocity from gyroscope
-    // angular_velocity_ = gyro_.gyro.y;  // Adjust axis as needed
-    
+
+#if IMU_USE_FIFO
+    // Copy totals under the spinlock (a few words; never waits on I2C)
+    SampleTotals now;
+    portENTER_CRITICAL(&sample_mux_);
+    now = totals_;
+    portEXIT_CRITICAL(&sample_mux_);
+
+    uint32_t samples = now.count - consumed_.count;
+    if (samples == 0) {
+        // No new sample yet this tick: hold values, next update covers the gap
+        sample_dt_ = control_t(0);
+        return (esp_timer_get_time() - last_sample_us_) < IMU_STALE_TIMEOUT_US;
+    }
+
+    if (samples > IMU_MAX_AVERAGED_SAMPLES) {
+        // Backlog from a long gap in update() calls: too old to average into one tick
+        // (and its sums would overflow). Drop it; the next update covers new samples only
+        consumed_ = now;
+        last_sample_us_ = now.last_sample_us;
+        sample_dt_ = control_t(0);
+        return (esp_timer_get_time() - last_sample_us_) < IMU_STALE_TIMEOUT_US;
+    }
+
+    // Average of every sample since the previous update (wrapping differences)
+    int32_t n = (int32_t)samples;
+    accel_x_ = ratioOf<control_t>((int32_t)(now.accel_x - consumed_.accel_x), n * ACCEL_LSB_PER_G);
+    accel_z_ = ratioOf<control_t>((int32_t)(now.accel_z - consumed_.accel_z), n * ACCEL_LSB_PER_G);
+    gyro_y_ = ratioOf<control_t>((int32_t)(now.gyro_y - consumed_.gyro_y) * 10, n * GYRO_LSB_PER_DPS_X10);
+    gyro_z_ = (float)(int32_t)(now.gyro_z - consumed_.gyro_z) * 10.0f / (float)(n * GYRO_LSB_PER_DPS_X10);
+    sample_dt_ = ratioOf<control_t>(n, IMU_SAMPLE_RATE_HZ);
+    last_sample_us_ = now.last_sample_us;
+    consumed_ = now;
+#else
+    // Blocking I2C transaction for accel, gyro and temperature
+    if (!mpu_.getEvent(&accel_, &gyro_, &temp_)) {
+        return false;
+    }
+    accel_x_ = control_t(accel_.acceleration.x / SENSORS_GRAVITY_STANDARD);
+    accel_z_ = control_t(accel_.acceleration.z / SENSORS_GRAVITY_STANDARD);
+    gyro_y_ = control_t((float)(gyro_.gyro.y * RAD_TO_DEG));
+    gyro_z_ = (float)(gyro_.gyro.z * RAD_TO_DEG);
+    int64_t now_us = esp_timer_get_time();
+    sample_dt_ = ratioOf<control_t>((int32_t)(now_us - last_sample_us_), 1000000);
+    last_sample_us_ = now_us;
+#endif
+
+    // Calculate pitch angle and rate with the selected estimator
+    gyro_y_ = gyro_y_ - gyro_offset_;
+    gyro_z_ = IMU_YAW_SIGN * gyro_z_ - yaw_offset_;
+    calculatePitch();
+
     last_update_time_ = millis();
     return true;
 }
 
+void IMU::resync() {
+#if IMU_USE_FIFO
+    portENTER_CRITICAL(&sample_mux_);
+    consumed_ = totals_;
+    portEXIT_CRITICAL(&sample_mux_);
+    last_sample_us_ = consumed_.last_sample_us;
+#else
+    last_sample_us_ = esp_timer_get_time();
+#endif
+    sample_dt_ = control_t(0);
+}
+
 float IMU::getPitchAngle() const {
-    // TODO: Return calibrated pitch angle
     return pitch_angle_ - pitch_offset_;
 }
 
@@ -54,56 +180,261 @@ float IMU::getAngularVelocity() const {
     return angular_velocity_;
 }
 
+float IMU::getYawRate() const {
+    return gyro_z_;
+}
+
 bool IMU::isCalibrated() const {
     return calibrated_;
 }
 
-void IMU::calibrate() {
-    // TODO: Implement calibration
-    // - Robot must be stationary and level
-    // - Take multiple readings
-    // - Calculate average offset
-    // - Set pitch_offset_
-    // - Set calibrated_ = true
-    
-    Serial.println("IMU Calibration: Place robot level and stationary");
-    delay(2000);
-    
-    // Example calibration (replace with actual implementation):
-    // float sum = 0.0;
-    // for (int i = 0; i < 100; i++) {
-    //     update();
-    //     sum += pitch_angle_;
-    //     delay(10);
-    // }
-    // pitch_offset_ = sum / 100.0;
-    // calibrated_ = true;
-    
-    Serial.println("IMU Calibration complete");
+bool IMU::calibrate() {
+    // Average raw accelerometer pitch and gyro rates over IMU_CALIBRATION_UPDATES updates
+    gyro_offset_ = control_t(0);
+    yaw_offset_ = 0.0f;
+    float angle_sum = 0.0f, angle_sq = 0.0f, gyro_sum = 0.0f, gyro_sq = 0.0f, yaw_sum = 0.0f, yaw_sq = 0.0f;
+    int samples = 0;
+    for (int i = 0; i < IMU_CALIBRATION_UPDATES * 2 && samples < IMU_CALIBRATION_UPDATES; i++) {
+        delay(BALANCE_LOOP_PERIOD_US / 1000);
+        if (!update() || sample_dt_ == control_t(0)) {
+            continue;
+        }
+        float angle = static_cast<float>(approxAtan2Deg(accel_x_, accel_z_));
+        float gyro = static_cast<float>(gyro_y_);
+        angle_sum += angle;
+        angle_sq += angle * angle;
+        gyro_sum += gyro;
+        gyro_sq += gyro * gyro;
+        yaw_sum += gyro_z_;
+        yaw_sq += gyro_z_ * gyro_z_;
+        samples++;
+    }
+    if (samples < IMU_CALIBRATION_UPDATES) {
+        return false;  // Sensor stopped delivering samples
+    }
+
+    float angle_mean = angle_sum / samples;
+    float gyro_mean = gyro_sum / samples;
+    float angle_std = sqrtf(fmaxf(angle_sq / samples - angle_mean * angle_mean, 0.0f));
+    float gyro_std = sqrtf(fmaxf(gyro_sq / samples - gyro_mean * gyro_mean, 0.0f));
+    float yaw_mean = yaw_sum / samples;
+    float yaw_std = sqrtf(fmaxf(yaw_sq / samples - yaw_mean * yaw_mean, 0.0f));
+    if (angle_std > IMU_CALIBRATION_MAX_ANGLE_STD || gyro_std > IMU_CALIBRATION_MAX_GYRO_STD ||
+        yaw_std > IMU_CALIBRATION_MAX_GYRO_STD) {
+        return false;  // Robot moved: offsets would be wrong
+    }
+
+    pitch_offset_ = angle_mean;
+    gyro_offset_ = control_t(gyro_mean);
+    yaw_offset_ = yaw_mean;
+    filter_.reset();  // Re-prime from the accelerometer with the bias removed
+    calibrated_ = true;
+    return true;
+}
+
+// NVS layout of the calibration (key "cal")
+struct ImuCalibration {
+    uint8_t version;
+    float pitch_offset;   // degrees
+    float gyro_offset;    // degrees/sec
+    float temperature;    // deg C at calibration
+    float yaw_offset;     // degrees/sec (gyro Z, after IMU_YAW_SIGN)
+};
+static const uint8_t CALIBRATION_VERSION = 2;  // 2: yaw_offset appended
+static const char* CALIBRATION_KEY = "cal";
+
+bool IMU::loadCalibration() {
+    Preferences prefs;
+    if (!prefs.begin(IMU_CALIBRATION_NVS_NAMESPACE, true)) {
+        return false;
+    }
+    ImuCalibration cal;
+    bool ok = prefs.getBytesLength(CALIBRATION_KEY) == sizeof(cal) &&
+              prefs.getBytes(CALIBRATION_KEY, &cal, sizeof(cal)) == sizeof(cal);
+    prefs.end();
+
+    // Gyro bias drifts with temperature: only trust a calibration taken near the current die temperature
+    if (!ok || cal.version != CALIBRATION_VERSION ||
+        !isfinite(cal.pitch_offset) || !isfinite(cal.gyro_offset) || !isfinite(cal.yaw_offset) ||
+        !isfinite(temperature_) || !(fabsf(cal.temperature - temperature_) <= IMU_CALIBRATION_TEMP_TOLERANCE)) {
+        return false;
+    }
+    pitch_offset_ = cal.pitch_offset;
+    gyro_offset_ = control_t(cal.gyro_offset);
+    yaw_offset_ = cal.yaw_offset;
+    filter_.reset();
+    calibrated_ = true;
+    return true;
+}
+
+bool IMU::saveCalibration() const {
+    if (!calibrated_ || !isfinite(temperature_)) {
+        return false;
+    }
+    ImuCalibration cal;
+    memset(&cal, 0, sizeof(cal));
+    cal.version = CALIBRATION_VERSION;
+    cal.pitch_offset = pitch_offset_;
+    cal.gyro_offset = static_cast<float>(gyro_offset_);
+    cal.temperature = temperature_;
+    cal.yaw_offset = yaw_offset_;
+
+    Preferences prefs;
+    if (!prefs.begin(IMU_CALIBRATION_NVS_NAMESPACE, false)) {
+        return false;
+    }
+    bool ok = prefs.putBytes(CALIBRATION_KEY, &cal, sizeof(cal)) == sizeof(cal);
+    prefs.end();
+    return ok;
 }
 
 bool IMU::isValid() const {
     return valid_;
 }
 
+float IMU::getSampleDt() const {
+    return static_cast<float>(sample_dt_);
+}
+
+unsigned long IMU::getFifoOverflowCount() const {
+#if IMU_USE_FIFO
+    return fifo_overflows_;
+#else
+    return 0;
+#endif
+}
+
 void IMU::calculatePitch() {
-    // TODO: Implement complementary filter
-    // 
+#if IMU_ESTIMATOR == IMU_ESTIMATOR_KALMAN
+    // Two-state Kalman filter (pitch, gyro bias), steady-state gains for BALANCE_LOOP_DT:
+    // predict pitch += (gyro - bias) * dt, then correct both with the accelerometer pitch
+    // (polynomial atan2). The reported rate is bias-corrected, so the D term sees no offset.
+    pitch_angle_ = static_cast<float>(filter_.update(accel_x_, accel_z_, gyro_y_, sample_dt_));
+    angular_velocity_ = static_cast<float>(gyro_y_ - filter_.bias);  // Adjust axis as needed
+#else
     // Complementary filter combines:
     // - Accelerometer: Good for low frequencies (steady state)
     // - Gyroscope: Good for high frequencies (dynamic)
-    // 
-    // Formula:
+    //
     // pitch = alpha * (pitch + gyro * dt) + (1 - alpha) * accel_pitch
-    // 
+    //
     // Where:
-    // - accel_pitch = atan2(accel_x, accel_z) * 180/PI
+    // - accel_pitch = atan2(accel_x, accel_z) in degrees (polynomial approximation)
     // - gyro = gyro_y (angular velocity)
-    // - dt = time delta since last update
-    // - alpha = filter coefficient (typically 0.95-0.98)
-    
-    // Example implementation:
-    // float dt = (millis() - last_update_time_) / 1000.0;
-    // float accel_pitch = atan2(accel_.acceleration.x, accel_.acceleration.z) * 180.0 / PI;
-    // pitch_angle_ = alpha_ * (pitch_angle_ + angular_velocity_ * dt) + (1 - alpha_) * accel_pitch;
+    // - dt = sample time covered by this update (sensor clock in FIFO mode)
+    // - alpha = filter coefficient (IMU_COMPLEMENTARY_ALPHA)
+    pitch_angle_ = static_cast<float>(filter_.update(accel_x_, accel_z_, gyro_y_, sample_dt_));
+    angular_velocity_ = static_cast<float>(gyro_y_);  // Adjust axis as needed
+#endif
+}
+
+float IMU::getGyroBias() const {
+#if IMU_ESTIMATOR == IMU_ESTIMATOR_KALMAN
+    return static_cast<float>(gyro_offset_ + filter_.bias);
+#else
+    return static_cast<float>(gyro_offset_);
+#endif
+}
+
+float IMU::getPitchVariance() const {
+#if IMU_ESTIMATOR == IMU_ESTIMATOR_KALMAN
+    return filter_.variance;
+#else
+    return NAN;
+#endif
+}
+
+#if IMU_USE_FIFO
+bool IMU::configureFifo() {
+    // Sample clock: 1 kHz gyro output (DLPF on) divided down to IMU_SAMPLE_RATE_HZ
+    bool ok = writeRegister(REG_PWR_MGMT_1, PWR_MGMT_1_CLK_PLL_XGYRO) &&
+              writeRegister(REG_CONFIG, IMU_DLPF_CFG) &&
+              writeRegister(REG_SMPLRT_DIV, (1000 / IMU_SAMPLE_RATE_HZ) - 1) &&
+              writeRegister(REG_GYRO_CONFIG, GYRO_CONFIG_500_DPS) &&
+              writeRegister(REG_ACCEL_CONFIG, ACCEL_CONFIG_4_G) &&
+              writeRegister(REG_FIFO_EN, FIFO_EN_YG_ZG_ACCEL);
+    return ok && resetFifo();
+}
+
+bool IMU::resetFifo() {
+    // FIFO must be disabled while reset; re-enable to start filling from a frame boundary
+    return writeRegister(REG_USER_CTRL, 0x00) &&
+           writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_RESET) &&
+           writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_EN);
+}
+
+void IMU::drainFifo() {
+    uint8_t count_bytes[2];
+    if (!readRegisters(REG_FIFO_COUNT_H, count_bytes, sizeof(count_bytes))) {
+        return;
+    }
+    uint16_t count = ((uint16_t)count_bytes[0] << 8) | count_bytes[1];
+
+    // A full FIFO has dropped samples and may be misaligned: restart on a frame boundary
+    if (count >= FIFO_CAPACITY - FIFO_FRAME_SIZE) {
+        fifo_overflows_++;
+        resetFifo();
+        return;
+    }
+
+    uint16_t frames = count / FIFO_FRAME_SIZE;
+    uint8_t buffer[FIFO_MAX_BURST_FRAMES * FIFO_FRAME_SIZE];
+    while (frames > 0) {
+        uint16_t batch = frames < FIFO_MAX_BURST_FRAMES ? frames : FIFO_MAX_BURST_FRAMES;
+        if (!readRegisters(REG_FIFO_R_W, buffer, batch * FIFO_FRAME_SIZE)) {
+            return;
+        }
+
+        uint32_t accel_x = 0, accel_z = 0, gyro_y = 0, gyro_z = 0;
+        for (uint16_t i = 0; i < batch; i++) {
+            const uint8_t* frame = buffer + i * FIFO_FRAME_SIZE;
+            accel_x += (uint32_t)(int32_t)(int16_t)((frame[0] << 8) | frame[1]);
+            accel_z += (uint32_t)(int32_t)(int16_t)((frame[4] << 8) | frame[5]);
+            gyro_y += (uint32_t)(int32_t)(int16_t)((frame[6] << 8) | frame[7]);
+            gyro_z += (uint32_t)(int32_t)(int16_t)((frame[8] << 8) | frame[9]);
+        }
+
+        int64_t now_us = esp_timer_get_time();
+        portENTER_CRITICAL(&sample_mux_);
+        totals_.accel_x += accel_x;
+        totals_.accel_z += accel_z;
+        totals_.gyro_y += gyro_y;
+        totals_.gyro_z += gyro_z;
+        totals_.count += batch;
+        totals_.last_sample_us = now_us;
+        portEXIT_CRITICAL(&sample_mux_);
+
+        frames -= batch;
+    }
+}
+
+bool IMU::writeRegister(uint8_t reg, uint8_t value) {
+    Wire.beginTransmission(IMU_I2C_ADDRESS);
+    Wire.write(reg);
+    Wire.write(value);
+    return Wire.endTransmission() == 0;
+}
+
+bool IMU::readRegisters(uint8_t reg, uint8_t* buffer, size_t length) {
+    Wire.beginTransmission(IMU_I2C_ADDRESS);
+    Wire.write(reg);
+    if (Wire.endTransmission(false) != 0) {
+        return false;
+    }
+    if (Wire.requestFrom((uint8_t)IMU_I2C_ADDRESS, (uint8_t)length) != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        buffer[i] = Wire.read();
+    }
+    return true;
+}
+
+void IMU::acquisitionTask(void* arg) {
+    IMU* imu = static_cast<IMU*>(arg);
+    for (;;) {
+        imu->drainFifo();
+        vTaskDelay(1);  // 1 ms: ~1 sample per pass at 1 kHz, far inside FIFO_HOLD_MS
+    }
 }
+#endif
@@ -4,12 +4,25 @@
 #include <Arduino.h>
 #include <Adafruit_MPU6050.h>
 #include <Wire.h>
+#include "../include/config.h"
+#include "../control/control_math.h"
 
 /**
  * IMU sensor interface for MPU6050.
  * Provides pitch angle and angular velocity for balance control.
+ *
+ * With IMU_USE_FIFO, the sensor samples at IMU_SAMPLE_RATE_HZ into its
+ * hardware FIFO (accel + gyro Y and Z only) and a background task on
+ * IMU_ACQ_TASK_CORE drains it over I2C. update() then only copies running
+ * totals under a spinlock, so the control task never waits on the bus.
+ * Without it, update() falls back to a blocking Adafruit getEvent().
+ *
+ * IMU_ESTIMATOR selects the pitch estimator: a fixed-alpha complementary
+ * filter, or a two-state Kalman filter that also tracks gyro bias. Both take
+ * dt from the sample timestamps (the sensor clock in FIFO mode).
  * 
  * INTEGRATION POINT: Balance controller uses getPitchAngle() and getAngularVelocity()
+ * INTEGRATION POINT: Odometry fuses getYawRate() into the heading
  */
 class IMU {
 public:
@@ -34,6 +47,13 @@ public:
      */
     bool update();
 
+    /**
+     * Discard the samples taken while update() was not called (log replay,
+     * motor calibration), so the next update() covers one tick, not the gap.
+     * Control task only; call when it resumes balancing.
+     */
+    void resync();
+
     /**
      * Get current pitch angle in degrees.
      * Positive = leaning forward, Negative = leaning backward
@@ -49,6 +69,15 @@ public:
      */
     float getAngularVelocity() const;
 
+    /**
+     * Get yaw rate in degrees/second, calibration bias removed.
+     * Positive = turning left (counter-clockwise seen from above, IMU_YAW_SIGN).
+     * Averaged over the same samples as the pitch inputs (getSampleDt()).
+     * 
+     * @return Yaw rate (degrees/sec)
+     */
+    float getYawRate() const;
+
     /**
      * Check if IMU is calibrated.
      * 
@@ -58,11 +87,30 @@ public:
 
     /**
      * Calibrate IMU on level surface.
-     * Robot must be stationary and level when called.
+     * Robot must be stationary and level when called. Averages
+     * IMU_CALIBRATION_UPDATES updates (blocking, ~1 s) into the pitch offset
+     * and gyro bias; rejects the run if the readings show motion.
+     * Call after begin() and before the control task starts.
      * 
-     * TODO: Implement calibration routine
+     * @return true if calibrated (offsets applied)
      */
-    void calibrate();
+    bool calibrate();
+
+    /**
+     * Apply the calibration saved in NVS.
+     * Rejected if missing, from another layout, or taken more than
+     * IMU_CALIBRATION_TEMP_TOLERANCE away from the die temperature read by begin().
+     * 
+     * @return true if calibrated from NVS
+     */
+    bool loadCalibration();
+
+    /**
+     * Save the current calibration to NVS (flash write: call before balancing starts).
+     * 
+     * @return true if written
+     */
+    bool saveCalibration() const;
 
     /**
      * Check if IMU data is valid.
@@ -71,27 +119,99 @@ public:
      */
     bool isValid() const;
 
+    /**
+     * Get the time span covered by the last update().
+     * In FIFO mode this comes from the sensor sample clock (samples / rate).
+     * 
+     * @return Sample dt in seconds
+     */
+    float getSampleDt() const;
+
+    /**
+     * Get number of hardware FIFO overflows (samples dropped).
+     * 
+     * @return Overflow count (always 0 without IMU_USE_FIFO)
+     */
+    unsigned long getFifoOverflowCount() const;
+
+    /**
+     * Get the estimated gyro bias (already removed from getAngularVelocity()).
+     * Calibration offset, plus the Kalman filter's running estimate.
+     * 
+     * @return Bias in degrees/sec
+     */
+    float getGyroBias() const;
+
+    /**
+     * Get the steady-state pitch variance of the Kalman filter.
+     * 
+     * @return Variance in degrees^2 (NAN with the complementary filter)
+     */
+    float getPitchVariance() const;
+
 private:
     Adafruit_MPU6050 mpu_;
     sensors_event_t accel_, gyro_, temp_;
+
+    // Pitch filter inputs from the last update() (averaged over all FIFO samples in FIFO mode)
+    control_t accel_x_;           // Forward acceleration (g)
+    control_t accel_z_;           // Vertical acceleration (g)
+    control_t gyro_y_;            // Pitch rate (degrees/sec)
+    float gyro_z_;                // Yaw rate (degrees/sec; odometry only, so float in both builds)
+    control_t sample_dt_;         // Time covered by this update (seconds)
+    int64_t last_sample_us_;      // Timestamp of newest sample (esp_timer_get_time)
     
     float pitch_angle_;           // Calculated pitch angle (degrees)
     float angular_velocity_;      // Angular velocity (degrees/sec)
-    float pitch_offset_;          // Calibration offset
+    float pitch_offset_;          // Calibration offset (degrees)
+    control_t gyro_offset_;       // Calibration gyro bias, removed before the estimator (degrees/sec)
+    float yaw_offset_;            // Calibration yaw rate bias, after IMU_YAW_SIGN (degrees/sec)
+    float temperature_;           // Die temperature at begin() (deg C)
     bool calibrated_;
     bool valid_;
     unsigned long last_update_time_;
     
-    // Complementary filter parameters
-    float alpha_;  // Filter coefficient (0.0-1.0)
+    // Pitch estimator (IMU_ESTIMATOR), float or Q16.16 per control_t
+#if IMU_ESTIMATOR == IMU_ESTIMATOR_KALMAN
+    KalmanPitchFilter<control_t> filter_;
+#else
+    ComplementaryFilter<control_t> filter_;  // alpha = IMU_COMPLEMENTARY_ALPHA
+#endif
     
     /**
-     * Calculate pitch angle from accelerometer and gyroscope.
-     * Uses complementary filter to combine sensor data.
-     * 
-     * TODO: Implement complementary filter or Kalman filter
+     * Calculate pitch angle and angular velocity from accelerometer and gyroscope.
+     * Uses the selected estimator to combine sensor data.
      */
     void calculatePitch();
+
+#if IMU_USE_FIFO
+    // Running totals of raw FIFO samples, published by the acquisition task.
+    // Unsigned so they wrap; update() takes differences since its last read.
+    struct SampleTotals {
+        uint32_t accel_x;
+        uint32_t accel_z;
+        uint32_t gyro_y;
+        uint32_t gyro_z;
+        uint32_t count;
+        int64_t last_sample_us;
+    };
+    SampleTotals totals_;         // Written by acquisition task (under sample_mux_)
+    SampleTotals consumed_;       // Totals at last update() (control task only)
+    portMUX_TYPE sample_mux_;
+    TaskHandle_t acq_task_;
+    volatile unsigned long fifo_overflows_;
+
+    bool configureFifo();
+    bool resetFifo();
+    void drainFifo();
+    bool writeRegister(uint8_t reg, uint8_t value);
+    bool readRegisters(uint8_t reg, uint8_t* buffer, size_t length);
+
+    /**
+     * Acquisition task body (arg is IMU*): drain FIFO, sleep one RTOS tick, repeat.
+     */
+    static void acquisitionTask(void* arg);
+#endif
 };
 
 #endif // IMU_H
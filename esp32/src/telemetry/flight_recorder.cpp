@@ -0,0 +1,222 @@
+#include "flight_recorder.h"
+#include <LittleFS.h>
+#include <string.h>
+
+static const uint32_t FILE_MAGIC = 0x52464C56;  // "VLFR" little-endian
+static const uint8_t FILE_VERSION = 3;  // 2: wheel_velocity appended to TelemetrySample; 3: odometry pose
+
+FlightRecorder::FlightRecorder()
+    : head_(0), count_(0), snapshot_count_(0), snapshot_reason_(TRIGGER_NONE),
+      persisted_(false), state_(STATE_EMPTY), requested_(TRIGGER_NONE),
+      persist_pending_(false), mounted_(false) {
+}
+
+bool FlightRecorder::begin() {
+    mounted_ = LittleFS.begin(true);  // true = format the partition if it does not mount
+    return mounted_;
+}
+
+void FlightRecorder::record(const TelemetrySample& sample) {
+    window_[head_] = sample;
+    head_ = (head_ + 1 == FLIGHT_RECORDER_SAMPLES) ? 0 : head_ + 1;
+    if (count_ < FLIGHT_RECORDER_SAMPLES) {
+        count_++;
+    }
+
+    // Relaxed load first: the common no-trigger tick costs one load
+    if (requested_.load(std::memory_order_relaxed) != TRIGGER_NONE) {
+        freeze((Trigger)requested_.exchange(TRIGGER_NONE, std::memory_order_acquire));
+    }
+}
+
+void FlightRecorder::trigger(Trigger reason) {
+    postRequest(reason);
+}
+
+void FlightRecorder::postRequest(Trigger reason) {
+    // Keep the highest-ranked request when several arrive in one tick
+    uint8_t current = requested_.load(std::memory_order_relaxed);
+    while (current < reason &&
+           !requested_.compare_exchange_weak(current, reason, std::memory_order_release)) {
+    }
+}
+
+void FlightRecorder::freeze(Trigger reason) {
+    if (reason == TRIGGER_NONE) {
+        return;
+    }
+
+    uint8_t expected = STATE_EMPTY;
+    if (!state_.compare_exchange_strong(expected, STATE_WRITING, std::memory_order_acquire)) {
+        if (expected != STATE_READY ||
+            !state_.compare_exchange_strong(expected, STATE_WRITING, std::memory_order_acquire)) {
+            // Comms side is reading or saving the snapshot: retry next tick
+            if (expected == STATE_BUSY) {
+                postRequest(reason);
+            }
+            return;
+        }
+        // Only a fall replaces an unread STOP snapshot; the first event is kept otherwise
+        if (reason <= snapshot_reason_) {
+            state_.store(STATE_READY, std::memory_order_release);
+            return;
+        }
+    }
+
+    // Unroll the live window oldest-first
+    if (count_ < FLIGHT_RECORDER_SAMPLES) {
+        memcpy(snapshot_, window_, count_ * sizeof(TelemetrySample));
+    } else {
+        size_t tail = FLIGHT_RECORDER_SAMPLES - head_;
+        memcpy(snapshot_, window_ + head_, tail * sizeof(TelemetrySample));
+        memcpy(snapshot_ + tail, window_, head_ * sizeof(TelemetrySample));
+    }
+    snapshot_count_ = count_;
+    snapshot_reason_ = reason;
+    persisted_ = false;
+    state_.store(STATE_READY, std::memory_order_release);
+
+    if (reason == TRIGGER_FALL) {
+        persist_pending_.store(true, std::memory_order_release);
+    }
+}
+
+void FlightRecorder::service() {
+    if (!persist_pending_.load(std::memory_order_acquire) || !mounted_) {
+        return;
+    }
+    uint8_t expected = STATE_READY;
+    if (!state_.compare_exchange_strong(expected, STATE_BUSY, std::memory_order_acquire)) {
+        return;  // Still being written: next pass
+    }
+    persist_pending_.store(false, std::memory_order_relaxed);
+    persisted_ = writeFile();
+    state_.store(STATE_READY, std::memory_order_release);
+}
+
+bool FlightRecorder::save() {
+    if (!mounted_ || !acquire()) {
+        return false;
+    }
+    persisted_ = writeFile();
+    bool saved = persisted_;
+    release();
+    return saved;
+}
+
+void FlightRecorder::clear() {
+    for (;;) {
+        uint8_t expected = state_.load(std::memory_order_acquire);
+        if (expected == STATE_WRITING) {
+            vTaskDelay(1);  // Control task is mid-copy (tens of microseconds)
+            continue;
+        }
+        if (state_.compare_exchange_strong(expected, STATE_BUSY, std::memory_order_acquire)) {
+            break;
+        }
+    }
+    persist_pending_.store(false, std::memory_order_relaxed);
+    if (mounted_ && LittleFS.exists(FLIGHT_RECORDER_FILE)) {
+        LittleFS.remove(FLIGHT_RECORDER_FILE);
+    }
+    snapshot_count_ = 0;
+    snapshot_reason_ = TRIGGER_NONE;
+    persisted_ = false;
+    state_.store(STATE_EMPTY, std::memory_order_release);
+}
+
+bool FlightRecorder::acquire() {
+    uint8_t expected = STATE_READY;
+    if (state_.compare_exchange_strong(expected, STATE_BUSY, std::memory_order_acquire)) {
+        return true;
+    }
+    // Nothing in RAM: fall back to the window persisted before the last reboot
+    if (expected != STATE_EMPTY || !mounted_ ||
+        !state_.compare_exchange_strong(expected, STATE_BUSY, std::memory_order_acquire)) {
+        return false;
+    }
+    if (!readFile()) {
+        state_.store(STATE_EMPTY, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+void FlightRecorder::release() {
+    state_.store(STATE_READY, std::memory_order_release);
+}
+
+FlightRecorder::Trigger FlightRecorder::getReason() const {
+    return snapshot_reason_;
+}
+
+uint16_t FlightRecorder::getSampleCount() const {
+    return snapshot_count_;
+}
+
+uint32_t FlightRecorder::getTriggerTime() const {
+    return snapshot_count_ > 0 ? snapshot_[snapshot_count_ - 1].time_ms : 0;
+}
+
+bool FlightRecorder::isPersisted() const {
+    return persisted_;
+}
+
+const TelemetrySample& FlightRecorder::getSample(uint16_t index) const {
+    return snapshot_[index];
+}
+
+const char* FlightRecorder::triggerName(Trigger reason) {
+    switch (reason) {
+        case TRIGGER_STOP:
+            return "stop";
+        case TRIGGER_FALL:
+            return "fall";
+        default:
+            return "none";
+    }
+}
+
+bool FlightRecorder::writeFile() {
+    File file = LittleFS.open(FLIGHT_RECORDER_FILE, "w");
+    if (!file) {
+        return false;
+    }
+    FileHeader header;
+    header.magic = FILE_MAGIC;
+    header.version = FILE_VERSION;
+    header.reason = snapshot_reason_;
+    header.sample_size = sizeof(TelemetrySample);
+    header.sample_count = snapshot_count_;
+    header.trigger_ms = getTriggerTime();
+
+    size_t body = snapshot_count_ * sizeof(TelemetrySample);
+    bool ok = file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+              file.write(reinterpret_cast<const uint8_t*>(snapshot_), body) == body;
+    file.close();
+    return ok;
+}
+
+bool FlightRecorder::readFile() {
+    File file = LittleFS.open(FLIGHT_RECORDER_FILE, "r");
+    if (!file) {
+        return false;
+    }
+    FileHeader header;
+    bool ok = file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+              header.magic == FILE_MAGIC && header.version == FILE_VERSION &&
+              header.sample_size == sizeof(TelemetrySample) &&
+              header.sample_count > 0 && header.sample_count <= FLIGHT_RECORDER_SAMPLES;
+    if (ok) {
+        size_t body = header.sample_count * sizeof(TelemetrySample);
+        ok = file.read(reinterpret_cast<uint8_t*>(snapshot_), body) == body;
+    }
+    file.close();
+    if (!ok) {
+        return false;
+    }
+    snapshot_count_ = header.sample_count;
+    snapshot_reason_ = (Trigger)header.reason;
+    persisted_ = true;
+    return true;
+}
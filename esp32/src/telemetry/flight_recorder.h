@@ -0,0 +1,143 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "telemetry.h"
+#include "../include/config.h"
+
+class CommandContext;
+
+/**
+ * Post-mortem flight recorder.
+ *
+ * The control task copies every tick's TelemetrySample into a fixed circular
+ * window (FLIGHT_RECORDER_SAMPLES), so the last few seconds are always in RAM.
+ * trigger() (any task) asks the control task to freeze that window into a
+ * snapshot; recording continues in the live window, so a STOP snapshot does
+ * not blind the recorder to a later fall.
+ *
+ * Fall snapshots are persisted to LittleFS by service() on the comms core.
+ * STOP snapshots stay in RAM until save(): SPI flash writes pause both cores'
+ * caches for tens of milliseconds, which a still-balancing robot cannot ride
+ * out. After a fall the motors are already off, so the stall is harmless.
+ *
+ * Snapshot ownership is handed over with an atomic state (EMPTY -> WRITING ->
+ * READY <-> BUSY); the control task never waits on the comms side.
+ *
+ * INTEGRATION POINT: main.cpp controlTask records one sample per tick
+ * INTEGRATION POINT: main.cpp fall check and CommandHandler::executeStop trigger it
+ * INTEGRATION POINT: CommandHandler routes the "recorder" command to handleCommand()
+ */
+class FlightRecorder {
+public:
+    enum Trigger : uint8_t {
+        TRIGGER_NONE = 0,
+        TRIGGER_STOP = 1,  // Emergency stop (RAM only until save())
+        TRIGGER_FALL = 2   // Fall detected (persisted automatically; outranks STOP)
+    };
+
+    /**
+     * Header of the persisted window (FLIGHT_RECORDER_FILE), followed by
+     * sample_count TelemetrySamples, oldest first.
+     */
+    struct __attribute__((packed)) FileHeader {
+        uint32_t magic;
+        uint8_t version;
+        uint8_t reason;          // Trigger
+        uint16_t sample_size;    // sizeof(TelemetrySample)
+        uint16_t sample_count;
+        uint32_t trigger_ms;     // time_ms of the last sample
+    };
+
+    FlightRecorder();
+
+    /**
+     * Mount LittleFS (formats the partition on first use).
+     *
+     * @return true if flash persistence is available
+     */
+    bool begin();
+
+    /**
+     * Record one sample (control task only): one struct copy, plus a
+     * one-off window copy on the tick after a trigger.
+     */
+    void record(const TelemetrySample& sample);
+
+    /**
+     * Request a freeze at the next control tick (any task, never blocks).
+     * Does not replace an existing snapshot unless it outranks it.
+     */
+    void trigger(Trigger reason);
+
+    /**
+     * Persist a pending fall snapshot (comms task). Blocks on flash I/O.
+     */
+    void service();
+
+    /**
+     * Persist the current snapshot regardless of its trigger (comms task).
+     * Stalls the control core during the flash write.
+     *
+     * @return true if written
+     */
+    bool save();
+
+    /**
+     * Discard the RAM snapshot and the persisted file (comms task).
+     */
+    void clear();
+
+    /**
+     * Lock the snapshot for reading (comms task). Loads the persisted window
+     * when RAM holds none, e.g. after a reboot. Pair with release().
+     *
+     * @return true if a snapshot is locked and readable
+     */
+    bool acquire();
+    void release();
+
+    // Read while acquired (comms task)
+    Trigger getReason() const;
+    uint16_t getSampleCount() const;
+    uint32_t getTriggerTime() const;
+    bool isPersisted() const;
+    const TelemetrySample& getSample(uint16_t index) const;  // 0 = oldest
+
+    /**
+     * Name of a trigger for JSON responses ("stop", "fall", "none").
+     */
+    static const char* triggerName(Trigger reason);
+
+    /**
+     * "recorder" command: report, dump, save or clear the recording (comms task).
+     */
+    bool handleCommand(CommandContext& context);
+
+private:
+    enum State : uint8_t { STATE_EMPTY, STATE_WRITING, STATE_READY, STATE_BUSY };
+
+    // Live window (control task only)
+    TelemetrySample window_[FLIGHT_RECORDER_SAMPLES];
+    uint16_t head_;    // Next slot to write
+    uint16_t count_;   // Valid samples, saturates at FLIGHT_RECORDER_SAMPLES
+
+    // Frozen snapshot (owned by whoever moved state_ away from READY/EMPTY)
+    TelemetrySample snapshot_[FLIGHT_RECORDER_SAMPLES];
+    uint16_t snapshot_count_;
+    Trigger snapshot_reason_;
+    bool persisted_;
+
+    std::atomic<uint8_t> state_;
+    std::atomic<uint8_t> requested_;       // Highest pending Trigger
+    std::atomic<bool> persist_pending_;    // Fall snapshot not yet written
+    bool mounted_;
+
+    void postRequest(Trigger reason);
+    void freeze(Trigger reason);
+    bool writeFile();
+    bool readFile();
+};
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,65 @@
+#include "flight_recorder.h"
+#include "../command_handler/command_context.h"
+#include "../comms/binary_protocol.h"
+#include <string.h>
+
+bool FlightRecorder::handleCommand(CommandContext& context) {
+    // {"parameters": {"action": "status" | "dump" | "save" | "clear"}} (default "status").
+    // status/dump reply: {"success":true,"reason":"fall","samples":N,"trigger_ms":..,"saved":..};
+    // dump then sends N FRAME_OP_RECORDER frames, oldest first
+    JsonObject params = context.getParameters();
+    const char* action = params["action"] | "status";
+    if (strcmp(action, "clear") == 0) {
+        clear();
+        context.sendResponse(true, RESPONSE_OK, "Flight recorder cleared");
+        return true;
+    }
+    if (strcmp(action, "save") == 0) {
+        bool saved = save();
+        context.sendResponse(saved, saved ? RESPONSE_OK : RESPONSE_FAILED,
+                             saved ? "Flight recorder saved" : "No flight recording to save");
+        return saved;
+    }
+    bool dump = strcmp(action, "dump") == 0;
+    if (!dump && strcmp(action, "status") != 0) {
+        context.sendResponse(false, RESPONSE_INVALID_PARAMETER, "Invalid action (status, dump, save, clear)", action);
+        return false;
+    }
+    
+    if (!acquire()) {
+        StaticJsonDocument<96> doc;
+        doc["success"] = true;
+        doc["reason"] = triggerName(TRIGGER_NONE);
+        doc["samples"] = 0;
+        context.sendJson(doc);
+        return true;
+    }
+    
+    uint16_t count = getSampleCount();
+    StaticJsonDocument<160> doc;
+    doc["success"] = true;
+    doc["reason"] = triggerName(getReason());
+    doc["samples"] = count;
+    doc["trigger_ms"] = getTriggerTime();
+    doc["saved"] = isPersisted();
+    context.sendJson(doc);
+    
+    if (dump) {
+        // Same batching as the telemetry stream: whole frames per ring write
+        static const size_t FRAME_SIZE = FRAME_TELEMETRY_PAYLOAD_SIZE + FRAME_OVERHEAD;
+        static const uint16_t BATCH_FRAMES = 8;
+        uint8_t buffer[BATCH_FRAMES * FRAME_SIZE];
+        for (uint16_t i = 0; i < count; ) {
+            uint16_t batch = 0;
+            while (batch < BATCH_FRAMES && i < count) {
+                const TelemetrySample& sample = getSample(i++);
+                encodeFrame(FRAME_OP_RECORDER, reinterpret_cast<const uint8_t*>(&sample),
+                            sizeof(sample), buffer + batch * FRAME_SIZE);
+                batch++;
+            }
+            context.sendFrames(buffer, batch * FRAME_SIZE);  // Waits for room: a dump outruns the UART
+        }
+    }
+    release();
+    return true;
+}
@@ -0,0 +1,86 @@
+#include "telemetry.h"
+#include "../comms/binary_protocol.h"
+
+static_assert(sizeof(TelemetrySample) == FRAME_TELEMETRY_PAYLOAD_SIZE,
+              "TelemetrySample layout must match FRAME_TELEMETRY_PAYLOAD_SIZE");
+
+// Frames queued per TX ring write: a batch is copied in whole or dropped whole,
+// so frames stay intact when the comms task queues responses concurrently
+static const size_t TELEMETRY_BATCH_FRAMES = 8;
+
+Telemetry::Telemetry()
+    : decimation_(TELEMETRY_DEFAULT_DECIMATION), tick_counter_(0),
+      dropped_(0), tx_dropped_(0), sent_(0), tx_ring_(nullptr), task_(nullptr) {
+}
+
+void Telemetry::begin(TxRing* tx_ring) {
+    tx_ring_ = tx_ring;
+    if (task_ == nullptr) {
+        xTaskCreatePinnedToCore(drainTask, "telemetry", TELEMETRY_TASK_STACK_SIZE, this,
+                                TELEMETRY_TASK_PRIORITY, &task_, TELEMETRY_TASK_CORE);
+    }
+}
+
+void Telemetry::record(const TelemetrySample& sample) {
+    uint16_t decimation = decimation_;
+    if (decimation == 0) {
+        tick_counter_ = 0;
+        return;
+    }
+    if (++tick_counter_ < decimation) {
+        return;
+    }
+    tick_counter_ = 0;
+
+    if (!ring_.push(sample)) {
+        dropped_++;
+    }
+}
+
+void Telemetry::setDecimation(uint16_t decimation) {
+    decimation_ = decimation;
+}
+
+uint16_t Telemetry::getDecimation() const {
+    return decimation_;
+}
+
+unsigned long Telemetry::getDroppedCount() const {
+    return dropped_ + tx_dropped_;
+}
+
+unsigned long Telemetry::getSentCount() const {
+    return sent_;
+}
+
+void Telemetry::drain() {
+    static const size_t FRAME_SIZE = FRAME_TELEMETRY_PAYLOAD_SIZE + FRAME_OVERHEAD;
+    uint8_t buffer[TELEMETRY_BATCH_FRAMES * FRAME_SIZE];
+
+    for (;;) {
+        size_t frames = 0;
+        TelemetrySample sample;
+        while (frames < TELEMETRY_BATCH_FRAMES && ring_.pop(sample)) {
+            // ESP32 is little-endian: the packed struct is already in wire layout
+            encodeFrame(FRAME_OP_TELEMETRY, reinterpret_cast<const uint8_t*>(&sample),
+                        sizeof(sample), buffer + frames * FRAME_SIZE);
+            frames++;
+        }
+        if (frames == 0) {
+            return;
+        }
+        if (tx_ring_->write(buffer, frames * FRAME_SIZE, SERIAL_TX_RESPONSE_RESERVE)) {
+            sent_ += frames;
+        } else {
+            tx_dropped_ += frames;
+        }
+    }
+}
+
+void Telemetry::drainTask(void* arg) {
+    Telemetry* telemetry = static_cast<Telemetry*>(arg);
+    for (;;) {
+        telemetry->drain();
+        vTaskDelay(pdMS_TO_TICKS(TELEMETRY_DRAIN_PERIOD_MS));
+    }
+}
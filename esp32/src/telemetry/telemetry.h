@@ -0,0 +1,99 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "../comms/spsc_queue.h"
+#include "../comms/tx_ring.h"
+#include "../include/config.h"
+
+class CommandContext;
+
+/**
+ * One control-tick sample, in binary wire layout (little-endian, packed).
+ * Sent as the payload of a FRAME_OP_TELEMETRY frame; field order matches
+ * the CSV columns in matlab_tuning/log_analysis.m (extra fields follow).
+ * Mirror of pi/serial_comm/binary_protocol.py TELEMETRY_SAMPLE.
+ */
+struct __attribute__((packed)) TelemetrySample {
+    uint32_t time_ms;
+    float angle;              // degrees
+    float angular_velocity;   // degrees/sec
+    float motor_output;       // balance output (-1.0 to 1.0)
+    float velocity_setpoint;  // profiled, normalized motor output
+    float rotation_setpoint;  // profiled, normalized motor output
+    int32_t left_position;    // encoder pulses
+    int32_t right_position;
+    uint16_t tick_us;         // control tick duration
+    uint16_t interval_us;     // start-to-start interval since previous tick
+    float wheel_velocity;     // average encoder velocity fed to the controller (pulses/sec)
+    float x;                  // odometry pose: meters from the boot position, forward
+    float y;                  // meters, to the left
+    float heading;            // degrees, counter-clockwise positive, unwrapped
+};
+
+/**
+ * Balance loop telemetry stream.
+ *
+ * The control task calls record() every tick; every Nth sample (decimation)
+ * is copied into a preallocated lock-free ring. A low-priority task on the
+ * comms core drains the ring as binary frames into the serial TX ring, so the
+ * control task never formats text or touches the UART. When either ring is
+ * full (link slower than the sample rate), samples are dropped and counted.
+ * Frames never take the last SERIAL_TX_RESPONSE_RESERVE bytes of the TX ring,
+ * so a telemetry burst cannot crowd out command responses.
+ *
+ * INTEGRATION POINT: main.cpp controlTask records one sample per tick
+ * INTEGRATION POINT: CommandHandler routes the "telemetry" command to handleCommand()
+ */
+class Telemetry {
+public:
+    Telemetry();
+
+    /**
+     * Start the drain task on TELEMETRY_TASK_CORE.
+     *
+     * @param tx_ring Serial TX ring the frames are queued to
+     */
+    void begin(TxRing* tx_ring);
+
+    /**
+     * Record one sample (control task only). O(1), never blocks.
+     */
+    void record(const TelemetrySample& sample);
+
+    /**
+     * Set stream rate: one sample every `decimation` ticks (0 = off).
+     */
+    void setDecimation(uint16_t decimation);
+    uint16_t getDecimation() const;
+
+    /**
+     * Samples dropped because the sample ring or the TX ring was full.
+     */
+    unsigned long getDroppedCount() const;
+
+    /**
+     * Samples sent over serial.
+     */
+    unsigned long getSentCount() const;
+
+    /**
+     * "telemetry" command: set the decimation, or report it with the counters.
+     */
+    bool handleCommand(CommandContext& context);
+
+private:
+    SpscQueue<TelemetrySample, TELEMETRY_RING_SIZE> ring_;  // control task -> drain task
+    volatile uint16_t decimation_;
+    uint16_t tick_counter_;   // Control task only
+    volatile unsigned long dropped_;     // Sample ring full (control task)
+    volatile unsigned long tx_dropped_;  // TX ring full (drain task)
+    volatile unsigned long sent_;
+    TxRing* tx_ring_;
+    TaskHandle_t task_;
+
+    void drain();
+    static void drainTask(void* arg);
+};
+
+#endif // TELEMETRY_H
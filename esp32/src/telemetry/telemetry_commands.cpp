@@ -0,0 +1,25 @@
+#include "telemetry.h"
+#include "../command_handler/command_context.h"
+
+bool Telemetry::handleCommand(CommandContext& context) {
+    // {"parameters": {"decimation": N}}: stream every Nth control tick (0 = off);
+    // without parameters, reports the current setting
+    JsonObject params = context.getParameters();
+    if (!params["decimation"].isNull()) {
+        if (!params["decimation"].is<int>()) {
+            context.sendResponse(false, RESPONSE_INVALID_PARAMETER, "Invalid decimation (must be integer)");
+            return false;
+        }
+        int decimation = params["decimation"];
+        setDecimation((uint16_t)constrain(decimation, 0, 1000));
+    }
+    
+    StaticJsonDocument<128> doc;
+    doc["success"] = true;
+    doc["decimation"] = getDecimation();
+    doc["rate_hz"] = getDecimation() > 0 ? (float)BALANCE_LOOP_FREQ / getDecimation() : 0.0f;
+    doc["sent"] = getSentCount();
+    doc["dropped"] = getDroppedCount();
+    context.sendJson(doc);
+    return true;
+}
@@ -0,0 +1,112 @@
+#include "loop_stats.h"
+
+// Bucket upper bounds (microseconds). Dense below 1 ms where stage times live,
+// then out past 2x the 100 Hz period for interval/overrun outliers.
+static const uint32_t BUCKET_LIMITS_US[LoopStats::HISTOGRAM_BUCKETS - 1] = {
+    10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000
+};
+
+static const char* const STAGE_NAMES[LoopStats::STAGE_COUNT] = {
+    "imu", "input", "pid", "motor", "fall", "total", "interval"
+};
+
+LoopStats::LoopStats(uint32_t period_us)
+    : period_us_(period_us), reset_requested_(false),
+      tick_start_us_(0), last_tick_start_us_(0) {
+    clear();
+}
+
+void LoopStats::beginTick(int64_t now_us, uint32_t notifications) {
+    if (reset_requested_) {
+        clear();
+        reset_requested_ = false;
+    }
+
+    tick_start_us_ = now_us;
+    if (last_tick_start_us_ != 0) {
+        recordStage(STAGE_INTERVAL, (uint32_t)(now_us - last_tick_start_us_));
+    }
+    last_tick_start_us_ = now_us;
+
+    // Each notification is one timer period; extras were never serviced
+    if (notifications > 1) {
+        missed_deadline_count_ += notifications - 1;
+    }
+    tick_count_++;
+}
+
+void LoopStats::recordStage(Stage stage, uint32_t duration_us) {
+    histogram_[stage][bucketFor(duration_us)]++;
+    if (duration_us > max_duration_[stage]) {
+        max_duration_[stage] = duration_us;
+    }
+}
+
+void LoopStats::endTick(int64_t now_us) {
+    uint32_t duration_us = (uint32_t)(now_us - tick_start_us_);
+    recordStage(STAGE_TOTAL, duration_us);
+    if (duration_us > period_us_) {
+        overrun_count_++;
+    }
+}
+
+void LoopStats::requestReset() {
+    reset_requested_ = true;
+}
+
+uint32_t LoopStats::getPeriodUs() const {
+    return period_us_;
+}
+
+uint32_t LoopStats::getTickCount() const {
+    return tick_count_;
+}
+
+uint32_t LoopStats::getOverrunCount() const {
+    return overrun_count_;
+}
+
+uint32_t LoopStats::getMissedDeadlineCount() const {
+    return missed_deadline_count_;
+}
+
+uint32_t LoopStats::getMaxDuration(Stage stage) const {
+    return max_duration_[stage];
+}
+
+uint32_t LoopStats::getBucketCount(Stage stage, int bucket) const {
+    return histogram_[stage][bucket];
+}
+
+uint32_t LoopStats::getBucketLimit(int bucket) {
+    if (bucket < 0 || bucket >= HISTOGRAM_BUCKETS - 1) {
+        return 0;
+    }
+    return BUCKET_LIMITS_US[bucket];
+}
+
+const char* LoopStats::getStageName(Stage stage) {
+    return STAGE_NAMES[stage];
+}
+
+void LoopStats::clear() {
+    tick_count_ = 0;
+    overrun_count_ = 0;
+    missed_deadline_count_ = 0;
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        max_duration_[s] = 0;
+        for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            histogram_[s][b] = 0;
+        }
+    }
+    last_tick_start_us_ = 0;
+}
+
+int LoopStats::bucketFor(uint32_t duration_us) {
+    for (int b = 0; b < HISTOGRAM_BUCKETS - 1; b++) {
+        if (duration_us < BUCKET_LIMITS_US[b]) {
+            return b;
+        }
+    }
+    return HISTOGRAM_BUCKETS - 1;
+}
@@ -0,0 +1,114 @@
+#ifndef LOOP_STATS_H
+#define LOOP_STATS_H
+
+#include <Arduino.h>
+
+class CommandContext;
+
+/**
+ * Balance loop timing probe.
+ * Records per-stage durations of each control tick into fixed-bucket
+ * histograms, plus overrun (tick longer than its period) and missed
+ * deadline (timer fired again before the tick finished) counters.
+ *
+ * Written only by the control task; read by the comms task for the
+ * "stats" command. Readers see individually consistent counters, not
+ * an atomic snapshot of all of them.
+ *
+ * INTEGRATION POINT: main.cpp balanceTick() records stages
+ * INTEGRATION POINT: CommandHandler routes the "stats" command to handleCommand()
+ */
+class LoopStats {
+public:
+    /**
+     * Timed stages of one balance tick.
+     */
+    enum Stage {
+        STAGE_IMU = 0,    // IMU read
+        STAGE_INPUT,      // Queued commands + encoder velocity/position + odometry
+        STAGE_PID,        // BalanceController::update (calculatePID)
+        STAGE_MOTOR,      // L/R mix + MotorDriver::setSpeeds
+        STAGE_FALL,       // Fall check (and emergency stop if tripped)
+        STAGE_TOTAL,      // Whole tick, start to end
+        STAGE_INTERVAL,   // Start-to-start interval between consecutive ticks
+        STAGE_COUNT
+    };
+
+    static const int HISTOGRAM_BUCKETS = 12;
+
+    /**
+     * @param period_us Nominal control tick period (microseconds)
+     */
+    explicit LoopStats(uint32_t period_us);
+
+    /**
+     * Mark the start of a tick.
+     *
+     * @param now_us Current time from esp_timer_get_time()
+     * @param notifications Pending timer notifications consumed by this wake-up
+     *                      (more than one means ticks were skipped)
+     */
+    void beginTick(int64_t now_us, uint32_t notifications);
+
+    /**
+     * Record the duration of one stage of the current tick.
+     *
+     * @param stage Stage being recorded
+     * @param duration_us Stage duration (microseconds)
+     */
+    void recordStage(Stage stage, uint32_t duration_us);
+
+    /**
+     * Mark the end of a tick (records STAGE_TOTAL and overruns).
+     *
+     * @param now_us Current time from esp_timer_get_time()
+     */
+    void endTick(int64_t now_us);
+
+    /**
+     * Request all counters be cleared.
+     * Safe to call from any task; applied by the control task at the next tick.
+     */
+    void requestReset();
+
+    uint32_t getPeriodUs() const;
+    uint32_t getTickCount() const;
+    uint32_t getOverrunCount() const;
+    uint32_t getMissedDeadlineCount() const;
+    uint32_t getMaxDuration(Stage stage) const;
+    uint32_t getBucketCount(Stage stage, int bucket) const;
+
+    /**
+     * Upper bound of a histogram bucket (microseconds, exclusive).
+     * The last bucket is open-ended and returns 0.
+     */
+    static uint32_t getBucketLimit(int bucket);
+
+    /**
+     * Short name of a stage for reporting (e.g., "imu").
+     */
+    static const char* getStageName(Stage stage);
+
+    /**
+     * "stats" command: report the counters and histograms ({"reset": true}
+     * clears them afterwards). See loop_stats_commands.cpp for the reply.
+     */
+    bool handleCommand(CommandContext& context);
+
+private:
+    uint32_t period_us_;
+    volatile uint32_t tick_count_;
+    volatile uint32_t overrun_count_;
+    volatile uint32_t missed_deadline_count_;
+    volatile uint32_t max_duration_[STAGE_COUNT];
+    volatile uint32_t histogram_[STAGE_COUNT][HISTOGRAM_BUCKETS];
+    volatile bool reset_requested_;
+
+    int64_t tick_start_us_;
+    int64_t last_tick_start_us_;
+
+    void clear();
+    static int bucketFor(uint32_t duration_us);
+};
+
+#endif // LOOP_STATS_H
@@ -0,0 +1,41 @@
+#include "loop_stats.h"
+#include "../command_handler/command_context.h"
+
+bool LoopStats::handleCommand(CommandContext& context) {
+    // Reply: {"success":true,"period_us":..,"ticks":..,"overruns":..,"missed":..,"motion_timeouts":..,"tx_dropped":..,
+    //         "bucket_us":[..],"stages":{"imu":{"max":..,"hist":[..]},...}}
+    JsonObject params = context.getParameters();
+    StaticJsonDocument<2048> doc;
+    doc["success"] = true;
+    doc["period_us"] = getPeriodUs();
+    doc["ticks"] = getTickCount();
+    doc["overruns"] = getOverrunCount();
+    doc["missed"] = getMissedDeadlineCount();
+    doc["motion_timeouts"] = context.getMotionTimeouts();
+    doc["tx_dropped"] = context.getTxDroppedCount();
+    
+    // Bucket upper bounds; the final bucket is open-ended (no limit listed)
+    JsonArray limits = doc.createNestedArray("bucket_us");
+    for (int b = 0; b < HISTOGRAM_BUCKETS - 1; b++) {
+        limits.add(getBucketLimit(b));
+    }
+    
+    JsonObject stages = doc.createNestedObject("stages");
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        Stage stage = static_cast<Stage>(s);
+        JsonObject entry = stages.createNestedObject(getStageName(stage));
+        entry["max"] = getMaxDuration(stage);
+        JsonArray hist = entry.createNestedArray("hist");
+        for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            hist.add(getBucketCount(stage, b));
+        }
+    }
+    
+    context.sendJson(doc);
+    
+    // Optional: {"parameters": {"reset": true}} clears counters after reporting
+    if (params["reset"] | false) {
+        requestReset();
+    }
+    return true;
+}
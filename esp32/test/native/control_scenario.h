@@ -0,0 +1,93 @@
+#ifndef CONTROL_SCENARIO_H
+#define CONTROL_SCENARIO_H
+
+#include <math.h>
+#include <stdint.h>
+#include <Arduino.h>
+#include "../../include/config.h"
+#include "../../src/balance/balance_controller.h"
+#include "../../src/control/control_math.h"
+
+/**
+ * Scripted, deterministic inputs for the host tests (env:native).
+ * Shared by test_golden (recorded traces) and test_benchmark (timed ticks)
+ * so both exercise the same paths. Noise comes from a fixed-seed LCG:
+ * the same inputs on every host and every run.
+ */
+
+static const uint32_t SCENARIO_SEED = 12345u;
+static const int BALANCE_SCENARIO_TICKS = 600;   // 6 s at BALANCE_LOOP_FREQ
+static const int FILTER_SCENARIO_TICKS = 500;    // 5 s at BALANCE_LOOP_FREQ
+static const int GOLDEN_DECIMATION = 5;          // Every 5th tick is recorded
+static const int BALANCE_TRACE_CHANNELS = 4;     // motor output, velocity/rotation setpoint, target tilt
+
+/**
+ * Uniform noise in [-1, 1] (Numerical Recipes LCG).
+ */
+inline float scenarioNoise(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return (float)(state >> 8) / (float)(1u << 23) - 1.0f;
+}
+
+/**
+ * Sensor sample fed to the pitch filters: the rover rocking through a
+ * sinusoid plus a 3 degree lean at 2 s, seen through a biased, noisy gyro
+ * and a noisy accelerometer (g units).
+ */
+struct ImuSample {
+    float accel_x;
+    float accel_z;
+    float gyro;     // deg/s, bias included
+};
+
+inline ImuSample filterScenarioSample(int tick, uint32_t& noise) {
+    const float GYRO_BIAS = 1.5f;  // deg/s
+    float t = tick * BALANCE_LOOP_DT;
+    float w = 2.0f * (float)PI * 0.3f;
+    float lean = t >= 2.0f ? 3.0f : 0.0f;
+    float pitch = 5.0f * sinf(w * t) + lean;
+    float rate = 5.0f * w * cosf(w * t);
+    ImuSample sample;
+    sample.accel_x = sinf(pitch * (float)DEG_TO_RAD) + 0.02f * scenarioNoise(noise);
+    sample.accel_z = cosf(pitch * (float)DEG_TO_RAD) + 0.02f * scenarioNoise(noise);
+    sample.gyro = rate + GYRO_BIAS + 0.5f * scenarioNoise(noise);
+    return sample;
+}
+
+/**
+ * Controller inputs for one tick: tilt oscillation with noise, and wheels
+ * that accelerate, cruise and coast back. Motion commands are issued at fixed
+ * ticks (balanceScenarioCommand) so the setpoint profiles and the outer loop
+ * are covered, not just the inner PID.
+ */
+struct BalanceInput {
+    float angle;
+    float rate;
+    float wheel_velocity;   // pulses/s
+    float wheel_position;   // pulses
+};
+
+inline BalanceInput balanceScenarioInput(int tick, uint32_t& noise, float& position) {
+    float t = tick * BALANCE_LOOP_DT;
+    float w = 2.0f * (float)PI * 0.5f;
+    BalanceInput input;
+    input.angle = 2.0f * sinf(w * t) + 0.05f * scenarioNoise(noise);
+    input.rate = 2.0f * w * cosf(w * t) + 0.5f * scenarioNoise(noise);
+    float speed = t < 1.0f ? 0.0f : (t < 3.0f ? 10.0f * (t - 1.0f) : (t < 4.0f ? 20.0f : 20.0f * (5.0f - t)));
+    input.wheel_velocity = speed > 0.0f ? speed : 0.0f;
+    position += input.wheel_velocity * BALANCE_LOOP_DT;
+    input.wheel_position = position;
+    return input;
+}
+
+inline void balanceScenarioCommand(int tick, BalanceController& controller) {
+    if (tick == 100) {
+        controller.setVelocitySetpoint(0.4f);
+    } else if (tick == 250) {
+        controller.setRotationSetpoint(-0.3f);
+    } else if (tick == 400) {
+        controller.setNeutral();
+    }
+}
+
+#endif // CONTROL_SCENARIO_H
@@ -0,0 +1,38 @@
+#ifndef ROVER_FIXTURE_H
+#define ROVER_FIXTURE_H
+
+#include "../../include/config.h"
+#include "../../src/balance/balance_controller.h"
+#include "../../src/motor_control/motor_driver.h"
+#include "../../src/sensors/encoder_reader.h"
+#include "../../src/command_handler/command_handler.h"
+
+/**
+ * The controller, motors and encoders main.cpp creates, on main.cpp's pins,
+ * for host tests (env:native). Hardware calls land in native_shim.
+ */
+struct RoverHardware {
+    BalanceController balance;
+    MotorDriver left_motor;
+    MotorDriver right_motor;
+    EncoderReader left_encoder;
+    EncoderReader right_encoder;
+
+    RoverHardware()
+        : balance(KP, KI, KD),
+          left_motor(MOTOR_LEFT_PWM, MOTOR_LEFT_R_EN, MOTOR_LEFT_L_EN, 0),
+          right_motor(MOTOR_RIGHT_PWM, MOTOR_RIGHT_R_EN, MOTOR_RIGHT_L_EN, 1),
+          left_encoder(ENCODER_LEFT_A, ENCODER_LEFT_B),
+          right_encoder(ENCODER_RIGHT_A, ENCODER_RIGHT_B) {}
+};
+
+/**
+ * The hardware wired to a command handler; optional components stay detached.
+ */
+struct Rover : RoverHardware {
+    CommandHandler handler;
+
+    Rover() : handler(&balance, &left_motor, &right_motor, &left_encoder, &right_encoder) {}
+};
+
+#endif // ROVER_FIXTURE_H
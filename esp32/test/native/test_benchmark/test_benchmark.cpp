@@ -0,0 +1,265 @@
+/**
+ * Host benchmark for the control-path hot spots (env:native):
+ * ns per call and heap allocations per call for BalanceController::update(),
+ * CommandHandler::update(), CommandHandler::processCommand() and both pitch
+ * filters. Run with -v to see the report:
+ *   pio test -e native -f native/test_benchmark -v
+ *
+ * Host timings only rank changes (no cache, flash wait states or FPU
+ * differences of the ESP32); allocation counts carry over exactly, and any
+ * allocation on these paths fails the test.
+ */
+#include <unity.h>
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <native_shim.h>
+#include "../control_scenario.h"
+#include "../rover_fixture.h"
+
+static const int BALANCE_PASSES = 50;   // x BALANCE_SCENARIO_TICKS
+static const int FILTER_PASSES = 200;   // x FILTER_SCENARIO_TICKS
+static const int COMMAND_BATCHES = 2000;
+static const int HANDLER_TICKS = 1 + 300;  // Start + benchmark program (2 steps x 30 ticks x 5)
+static const int HANDLER_PASSES = 100;
+
+// ===== Allocation counting =====
+// Every heap entry point is counted while counting_allocations is set.
+
+static bool counting_allocations = false;
+static unsigned long allocation_count = 0;
+
+static inline void noteAllocation() {
+    if (counting_allocations) {
+        allocation_count++;
+    }
+}
+
+void* operator new(size_t size) {
+#if !defined(__GLIBC__)
+    noteAllocation();  // glibc: counted by the malloc() wrapper below
+#endif
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+#if defined(__GLIBC__)
+// C allocations too (operator new goes through malloc, so it is counted once)
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+
+extern "C" void* malloc(size_t size) {
+    noteAllocation();
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    noteAllocation();
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, size_t size) {
+    noteAllocation();
+    return __libc_realloc(p, size);
+}
+#endif
+
+// ===== Measurement =====
+
+struct Measurement {
+    std::chrono::steady_clock::time_point start;
+    unsigned long allocations_before;
+};
+
+// Start timing and counting; the caller clears counting_allocations when done
+static Measurement beginMeasurement() {
+    Measurement m;
+    m.allocations_before = allocation_count;
+    counting_allocations = true;
+    m.start = std::chrono::steady_clock::now();
+    return m;
+}
+
+static double elapsedNs(const Measurement& m) {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m.start)
+        .count();
+}
+
+static void report(const char* name, double total_ns, unsigned long calls, unsigned long allocations) {
+    char message[160];
+    snprintf(message, sizeof(message), "%-32s %9.1f ns/call %6.3f allocations/call (%lu calls, budget %lu ns/tick)",
+             name, total_ns / calls, (double)allocations / calls, calls, (unsigned long)BALANCE_LOOP_PERIOD_US * 1000);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT_MESSAGE(0, allocations, name);
+}
+
+void setUp() {
+    native_shim::reset();
+}
+
+void tearDown() {}
+
+// ===== Benchmarks =====
+
+void test_benchmark_balance_update() {
+    static BalanceInput inputs[BALANCE_SCENARIO_TICKS];
+    uint32_t noise = SCENARIO_SEED;
+    float position = 0.0f;
+    for (int tick = 0; tick < BALANCE_SCENARIO_TICKS; tick++) {
+        inputs[tick] = balanceScenarioInput(tick, noise, position);
+    }
+
+    BalanceController controller(KP, KI, KD);
+    volatile float sink = 0.0f;
+    Measurement m = beginMeasurement();
+    for (int pass = 0; pass < BALANCE_PASSES; pass++) {
+        controller.reset();
+        for (int tick = 0; tick < BALANCE_SCENARIO_TICKS; tick++) {
+            balanceScenarioCommand(tick, controller);
+            const BalanceInput& in = inputs[tick];
+            controller.update(in.angle, in.rate, in.wheel_velocity, in.wheel_position);
+            sink = controller.getMotorOutput();
+        }
+    }
+    double ns = elapsedNs(m);
+    counting_allocations = false;
+    (void)sink;
+    report("BalanceController::update", ns, (unsigned long)BALANCE_PASSES * BALANCE_SCENARIO_TICKS,
+           allocation_count - m.allocations_before);
+}
+
+template <typename Filter>
+static void benchmarkFilter(const char* name, Filter& filter) {
+    static control_t samples[FILTER_SCENARIO_TICKS][3];
+    uint32_t noise = SCENARIO_SEED;
+    for (int tick = 0; tick < FILTER_SCENARIO_TICKS; tick++) {
+        ImuSample sample = filterScenarioSample(tick, noise);
+        samples[tick][0] = control_t(sample.accel_x);
+        samples[tick][1] = control_t(sample.accel_z);
+        samples[tick][2] = control_t(sample.gyro);
+    }
+
+    const control_t dt(BALANCE_LOOP_DT);
+    volatile float sink = 0.0f;
+    Measurement m = beginMeasurement();
+    for (int pass = 0; pass < FILTER_PASSES; pass++) {
+        filter.reset();
+        for (int tick = 0; tick < FILTER_SCENARIO_TICKS; tick++) {
+            sink = (float)filter.update(samples[tick][0], samples[tick][1], samples[tick][2], dt);
+        }
+    }
+    double ns = elapsedNs(m);
+    counting_allocations = false;
+    (void)sink;
+    report(name, ns, (unsigned long)FILTER_PASSES * FILTER_SCENARIO_TICKS, allocation_count - m.allocations_before);
+}
+
+void test_benchmark_kalman_filter() {
+    KalmanPitchFilter<control_t> filter(IMU_KALMAN_Q_ANGLE, IMU_KALMAN_Q_BIAS, IMU_KALMAN_R_MEASURE, BALANCE_LOOP_DT);
+    benchmarkFilter("KalmanPitchFilter::update", filter);
+}
+
+void test_benchmark_complementary_filter() {
+    ComplementaryFilter<control_t> filter(control_t(IMU_COMPLEMENTARY_ALPHA));
+    benchmarkFilter("ComplementaryFilter::update", filter);
+}
+
+void test_benchmark_process_command() {
+    // Batches of queued motion commands (the queue is drained, untimed, between batches)
+    static const char* const LINES[] = {
+        "{\"command\":\"move_forward\",\"parameters\":{\"speed\":0.5},\"priority\":1}",
+        "{\"command\":\"rotate_clockwise\",\"parameters\":{\"speed\":0.3,\"angle\":90}}",
+        "{\"command\":\"make_square\",\"parameters\":{\"speed\":0.4,\"side_length\":0.5}}",
+    };
+    static const int LINE_COUNT = sizeof(LINES) / sizeof(LINES[0]);
+    static size_t lengths[LINE_COUNT];
+    for (int i = 0; i < LINE_COUNT; i++) {
+        lengths[i] = strlen(LINES[i]);
+    }
+
+    static Rover rover;
+    rover.handler.begin();
+    double ns = 0.0;
+    unsigned long allocations = 0;
+    unsigned long calls = 0;
+    bool all_accepted = true;
+    for (int batch = 0; batch < COMMAND_BATCHES; batch++) {
+        Measurement m = beginMeasurement();
+        for (int i = 0; i < LINE_COUNT; i++) {
+            all_accepted = rover.handler.processCommand(LINES[i], lengths[i]) && all_accepted;
+        }
+        ns += elapsedNs(m);
+        counting_allocations = false;
+        allocations += allocation_count - m.allocations_before;
+        calls += LINE_COUNT;
+
+        rover.handler.executeStop();  // Untimed: drop the batch
+        rover.handler.update();
+        native_shim::clearSerialOutput();
+    }
+    TEST_ASSERT_TRUE(all_accepted);
+    report("CommandHandler::processCommand", ns, calls, allocations);
+}
+
+void test_benchmark_handler_update() {
+    // Control-task side while an uploaded program runs: forward, turn, x5 (HANDLER_TICKS)
+    static const char PROGRAM[] =
+        "{\"command\":\"program\",\"parameters\":{\"steps\":\"04321e0010321e00\",\"repetitions\":5}}";
+
+    static Rover rover;
+    rover.handler.begin();
+    double ns = 0.0;
+    unsigned long allocations = 0;
+    for (int pass = 0; pass < HANDLER_PASSES; pass++) {
+        TEST_ASSERT_TRUE(rover.handler.processCommand(PROGRAM, sizeof(PROGRAM) - 1));
+        native_shim::clearSerialOutput();
+
+        Measurement m = beginMeasurement();
+        for (int tick = 0; tick < HANDLER_TICKS; tick++) {
+            rover.handler.update();
+        }
+        ns += elapsedNs(m);
+        counting_allocations = false;
+        allocations += allocation_count - m.allocations_before;
+    }
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, rover.balance.getVelocityTarget());  // Program ran to completion
+    report("CommandHandler::update", ns, (unsigned long)HANDLER_PASSES * HANDLER_TICKS, allocations);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_benchmark_balance_update);
+    RUN_TEST(test_benchmark_kalman_filter);
+    RUN_TEST(test_benchmark_complementary_filter);
+    RUN_TEST(test_benchmark_process_command);
+    RUN_TEST(test_benchmark_handler_update);
+    return UNITY_END();
+}
@@ -0,0 +1,242 @@
+/**
+ * CommandHandler host tests (env:native): replies, the comms -> control
+ * hand-off, STOP, sequencing, program upload, odometry-driven turns and
+ * the JSON command table.
+ * Replies are read back from the Serial capture in native_shim.
+ */
+#include <unity.h>
+#include <string.h>
+#include <native_shim.h>
+#include "../rover_fixture.h"
+#include "../../../src/odometry/odometry.h"
+#include "../../../src/timing/loop_stats.h"
+
+static Rover* rover;
+
+void setUp() {
+    native_shim::reset();
+    rover = new Rover();
+    rover->handler.begin();
+    native_shim::clearSerialOutput();
+}
+
+void tearDown() {
+    delete rover;
+    rover = nullptr;
+}
+
+/**
+ * Send one JSON command and return the reply text (capture cleared first).
+ */
+static const char* send(const char* json) {
+    native_shim::clearSerialOutput();
+    rover->handler.processCommand(json, strlen(json));
+    return native_shim::serialOutput();
+}
+
+static void tick(int count = 1) {
+    for (int i = 0; i < count; i++) {
+        native_shim::advanceMicros(BALANCE_LOOP_PERIOD_US);
+        rover->handler.update();
+        rover->balance.update(0.0f, 0.0f);
+    }
+}
+
+#define TEST_ASSERT_REPLY_HAS(reply, field) TEST_ASSERT_NOT_NULL_MESSAGE(strstr(reply, field), reply)
+
+void test_move_forward_acknowledged_and_applied_on_next_tick() {
+    const char* reply = send("{\"command\":\"move_forward\",\"parameters\":{\"speed\":0.5}}");
+    TEST_ASSERT_REPLY_HAS(reply, "{\"success\":true,\"code\":0");
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, rover->balance.getVelocityTarget());  // Comms side only queues
+
+    tick();
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, rover->balance.getVelocityTarget());
+}
+
+void test_speed_above_range_is_clamped_and_reported() {
+    const char* reply = send("{\"command\":\"move_backward\",\"parameters\":{\"speed\":1.5}}");
+    TEST_ASSERT_REPLY_HAS(reply, "\"code\":1");
+    TEST_ASSERT_REPLY_HAS(reply, "\"speed\":1.00,\"requested\":1.50");
+
+    tick();
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, rover->balance.getVelocityTarget());
+}
+
+void test_parameters_read_and_absent_ones_default() {
+    send("{\"command\":\"move_forward\",\"parameters\":{\"speed\":0.3}}");
+    tick();
+    TEST_ASSERT_EQUAL_FLOAT(0.3f, rover->balance.getVelocityTarget());
+
+    send("{\"command\":\"move_backward\"}");
+    tick();
+    TEST_ASSERT_EQUAL_FLOAT(-0.4f, rover->balance.getVelocityTarget());  // Default speed
+}
+
+void test_malformed_and_unknown_commands_rejected() {
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":"), "{\"success\":false,\"code\":2");
+    TEST_ASSERT_REPLY_HAS(send("{\"parameters\":{}}"), "{\"success\":false,\"code\":3");
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"moonwalk\"}"), "{\"success\":false,\"code\":4");
+}
+
+void test_stop_discards_commands_queued_before_it() {
+    send("{\"command\":\"move_forward\",\"parameters\":{\"speed\":0.5}}");
+    send("{\"command\":\"rotate_clockwise\",\"parameters\":{\"speed\":0.3}}");
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"stop\"}"), "{\"success\":true,\"code\":0");
+    send("{\"command\":\"rotate_counterclockwise\",\"parameters\":{\"speed\":0.2}}");
+
+    tick();  // STOP, then the command sent after it
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, rover->balance.getVelocityTarget());
+    TEST_ASSERT_EQUAL_FLOAT(-0.2f, rover->balance.getRotationTarget());
+    tick(5);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, rover->balance.getVelocityTarget());
+}
+
+void test_sequenced_commands_acknowledged_in_order() {
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"sync\"}"), "\"ack\":0,\"window\":");
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"move_forward\",\"seq\":1}"), "\"code\":0,\"seq\":1,\"ack\":1");
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"move_forward\",\"seq\":3}"), "\"code\":13,\"seq\":3,\"ack\":1");
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"move_forward\",\"seq\":1}"), "\"code\":12,\"seq\":1,\"ack\":1");
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"move_forward\",\"seq\":2}"), "\"code\":0,\"seq\":2,\"ack\":2");
+}
+
+void test_stop_drops_sequenced_commands_until_sync() {
+    send("{\"command\":\"sync\"}");
+    send("{\"command\":\"move_forward\",\"seq\":1}");
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"stop\"}"), "\"ack\":1");
+    // Resend burst written before the Pi saw the STOP: in order, but must not run
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"move_forward\",\"seq\":2}"), "\"code\":13,\"seq\":2,\"ack\":1");
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"move_forward\",\"seq\":3}"), "\"code\":13,\"seq\":3,\"ack\":1");
+    tick(5);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, rover->balance.getVelocityTarget());
+
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"sync\"}"), "\"ack\":0,\"window\":");
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"move_forward\",\"seq\":1}"), "\"code\":0,\"seq\":1,\"ack\":1");
+}
+
+void test_program_runs_on_board_then_returns_to_neutral() {
+    // One timed segment: drive forward (0x04) at 50% (0x32) for 0.30 s (30 = 0x001E)
+    const char* reply = send("{\"command\":\"program\",\"parameters\":{\"steps\":\"04321e00\"}}");
+    TEST_ASSERT_REPLY_HAS(reply, "\"code\":0,\"steps\":1");
+
+    tick();
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, rover->balance.getVelocityTarget());
+    tick(30);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, rover->balance.getVelocityTarget());
+}
+
+// Forward 50% for 0.30 s, backward (drive -1 = 0b11) 30% for 0.20 s
+static const char* const PROGRAM_FORWARD = "{\"command\":\"program\",\"parameters\":{\"steps\":\"04321e00\"}}";
+static const char* const PROGRAM_BACKWARD = "{\"command\":\"program\",\"parameters\":{\"steps\":\"0c1e1400\"}}";
+
+void test_programs_queue_behind_a_running_pattern() {
+    // One utterance split into several programs: all staged while earlier motion runs
+    send("{\"command\":\"move_forward\",\"parameters\":{\"speed\":0.2,\"duration\":0.1}}");
+    tick();
+    TEST_ASSERT_EQUAL_FLOAT(0.2f, rover->balance.getVelocityTarget());
+    TEST_ASSERT_REPLY_HAS(send(PROGRAM_FORWARD), "\"code\":0,\"steps\":1");
+    TEST_ASSERT_REPLY_HAS(send(PROGRAM_BACKWARD), "\"code\":0,\"steps\":1");
+
+    // Targets in the order they were applied: each motion, with neutral when it ends
+    const float expected[] = {0.2f, 0.0f, 0.5f, 0.0f, -0.3f, 0.0f};
+    float seen[8];
+    int changes = 0;
+    float last = rover->balance.getVelocityTarget();
+    seen[changes++] = last;
+    for (int i = 0; i < 200 && changes < 8; i++) {
+        tick();
+        if (rover->balance.getVelocityTarget() != last) {
+            last = rover->balance.getVelocityTarget();
+            seen[changes++] = last;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(6, changes);
+    for (int i = 0; i < 6; i++) {
+        TEST_ASSERT_EQUAL_FLOAT(expected[i], seen[i]);
+    }
+}
+
+void test_program_staging_full_until_released() {
+    send("{\"command\":\"move_forward\",\"parameters\":{\"speed\":0.2,\"duration\":1.0}}");
+    tick();
+    for (int i = 0; i < PROGRAM_STAGING_SLOTS; i++) {
+        TEST_ASSERT_REPLY_HAS(send(PROGRAM_FORWARD), "\"code\":0,\"steps\":1");
+    }
+    TEST_ASSERT_REPLY_HAS(send(PROGRAM_FORWARD), "\"code\":7");  // Retryable: the Pi resends it
+
+    send("{\"command\":\"stop\"}");
+    tick();  // Discarded programs give their slots back
+    TEST_ASSERT_REPLY_HAS(send(PROGRAM_FORWARD), "\"code\":0,\"steps\":1");
+}
+
+void test_turn_ends_on_odometry_heading() {
+    // Gyro-only heading: the encoders never move, so only the odometry can end the turn
+    Odometry odometry(1.0f);
+    rover->handler.setOdometry(&odometry);
+    send("{\"command\":\"turn_left\",\"parameters\":{\"angle\":45,\"speed\":0.4}}");
+
+    int ticks = 0;
+    do {
+        tick();
+        odometry.update(0, 0, 90.0f, BALANCE_LOOP_DT);
+        ticks++;
+    } while (rover->balance.getRotationTarget() != 0.0f && ticks < 200);
+    TEST_ASSERT_INT_WITHIN(2, 51, ticks);  // 45 deg at 90 deg/s, plus the start and end ticks
+}
+
+void test_invalid_program_rejected() {
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"program\",\"parameters\":{\"steps\":\"04321e0\"}}"), "\"code\":5");
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"program\",\"parameters\":{\"steps\":\"04ff1e00\"}}"), "\"code\":5");
+}
+
+void test_optional_commands_answer_once_attached() {
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"stats\"}"), "{\"success\":false,\"code\":9");
+
+    LoopStats stats(BALANCE_LOOP_PERIOD_US);
+    rover->handler.setLoopStats(&stats);
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"stats\"}"), "\"ticks\":0");
+}
+
+void test_gains_mailbox_applied_by_the_control_tick() {
+    const char* gains = "{\"command\":\"gains\",\"parameters\":{\"kp\":30}}";
+    TEST_ASSERT_REPLY_HAS(send(gains), "{\"success\":true");
+    TEST_ASSERT_REPLY_HAS(send(gains), "\"code\":8");  // Still pending: the parameters were read
+
+    tick();
+    TEST_ASSERT_REPLY_HAS(send(gains), "{\"success\":true");
+}
+
+void test_autotune_start_drops_queued_motion() {
+    send("{\"command\":\"move_forward\",\"parameters\":{\"speed\":0.5}}");
+    TEST_ASSERT_REPLY_HAS(send("{\"command\":\"autotune\",\"parameters\":{\"action\":\"start\"}}"),
+                          "{\"success\":true,\"code\":0");
+
+    tick();
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, rover->balance.getVelocityTarget());
+    TEST_ASSERT_TRUE(rover->balance.getAutotuner().isRunning());
+
+    send("{\"command\":\"stop\"}");
+    tick();
+    TEST_ASSERT_FALSE(rover->balance.getAutotuner().isRunning());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_move_forward_acknowledged_and_applied_on_next_tick);
+    RUN_TEST(test_speed_above_range_is_clamped_and_reported);
+    RUN_TEST(test_parameters_read_and_absent_ones_default);
+    RUN_TEST(test_malformed_and_unknown_commands_rejected);
+    RUN_TEST(test_stop_discards_commands_queued_before_it);
+    RUN_TEST(test_sequenced_commands_acknowledged_in_order);
+    RUN_TEST(test_stop_drops_sequenced_commands_until_sync);
+    RUN_TEST(test_program_runs_on_board_then_returns_to_neutral);
+    RUN_TEST(test_programs_queue_behind_a_running_pattern);
+    RUN_TEST(test_program_staging_full_until_released);
+    RUN_TEST(test_turn_ends_on_odometry_heading);
+    RUN_TEST(test_invalid_program_rejected);
+    RUN_TEST(test_optional_commands_answer_once_attached);
+    RUN_TEST(test_gains_mailbox_applied_by_the_control_tick);
+    RUN_TEST(test_autotune_start_drops_queued_motion);
+    return UNITY_END();
+}
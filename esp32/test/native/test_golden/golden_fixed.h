@@ -0,0 +1,333 @@
+// Recorded by test_golden (GOLDEN_RECORD), fixed build. Do not edit by hand.
+// Balance: motor output, velocity setpoint, rotation setpoint, target tilt.
+// Kalman: angle, bias. One row per 5 ticks.
+
+static const float GOLDEN_BALANCE[120][4] = {
+    {3.79333496e-02f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {9.24835205e-02f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {1.52969360e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {1.79763794e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.32162476e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.56240845e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.85140991e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.96081543e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {3.21426392e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {3.21609497e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {3.08486938e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {3.02520752e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.79647827e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.63534546e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.23892212e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {1.84310913e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {1.41464233e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {9.79461670e-02f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {5.71594238e-02f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {-5.49316406e-04f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {-5.17578125e-02f, 5.90000011e-04f, 0.00000000e+00f, 0.00000000e+00f},
+    {-8.58917236e-02f, 1.23900007e-02f, 0.00000000e+00f, -1.91040039e-02f},
+    {-1.48895264e-01f, 3.89400013e-02f, 0.00000000e+00f, 1.78833008e-02f},
+    {-1.97387695e-01f, 8.02400112e-02f, 0.00000000e+00f, 1.27441406e-01f},
+    {-2.67578125e-01f, 1.35700017e-01f, 0.00000000e+00f, 3.10821533e-01f},
+    {-3.35769653e-01f, 1.94700047e-01f, 0.00000000e+00f, 5.25848389e-01f},
+    {-3.98742676e-01f, 2.53700078e-01f, 0.00000000e+00f, 7.44415283e-01f},
+    {-4.44152832e-01f, 3.10754001e-01f, 0.00000000e+00f, 9.62982178e-01f},
+    {-4.91088867e-01f, 3.54710609e-01f, 0.00000000e+00f, 1.12936401e+00f},
+    {-5.11154175e-01f, 3.83917183e-01f, 0.00000000e+00f, 1.22619629e+00f},
+    {-5.11947632e-01f, 3.98373783e-01f, 0.00000000e+00f, 1.25247192e+00f},
+    {-4.90402222e-01f, 4.00000006e-01f, 0.00000000e+00f, 1.21005249e+00f},
+    {-4.59869385e-01f, 4.00000006e-01f, 0.00000000e+00f, 1.15045166e+00f},
+    {-4.33029175e-01f, 4.00000006e-01f, 0.00000000e+00f, 1.08947754e+00f},
+    {-3.79013062e-01f, 4.00000006e-01f, 0.00000000e+00f, 1.02731323e+00f},
+    {-3.42819214e-01f, 4.00000006e-01f, 0.00000000e+00f, 9.63867188e-01f},
+    {-2.83706665e-01f, 4.00000006e-01f, 0.00000000e+00f, 8.99047852e-01f},
+    {-2.33001709e-01f, 4.00000006e-01f, 0.00000000e+00f, 8.33068848e-01f},
+    {-1.64855957e-01f, 4.00000006e-01f, 0.00000000e+00f, 7.65716553e-01f},
+    {-1.08932495e-01f, 4.00000006e-01f, 0.00000000e+00f, 6.97174072e-01f},
+    {-5.10101318e-02f, 4.00000006e-01f, 0.00000000e+00f, 6.27258301e-01f},
+    {7.55310059e-03f, 4.00000006e-01f, 0.00000000e+00f, 5.56152344e-01f},
+    {6.33697510e-02f, 4.00000006e-01f, 0.00000000e+00f, 4.83764648e-01f},
+    {1.17218018e-01f, 4.00000006e-01f, 0.00000000e+00f, 4.10034180e-01f},
+    {1.78543091e-01f, 4.00000006e-01f, 0.00000000e+00f, 3.35113525e-01f},
+    {2.22793579e-01f, 4.00000006e-01f, 0.00000000e+00f, 2.58819580e-01f},
+    {2.42675781e-01f, 4.00000006e-01f, 0.00000000e+00f, 1.81335449e-01f},
+    {2.95104980e-01f, 4.00000006e-01f, 0.00000000e+00f, 1.02569580e-01f},
+    {3.15338135e-01f, 4.00000006e-01f, 0.00000000e+00f, 2.24304199e-02f},
+    {3.33786011e-01f, 4.00000006e-01f, 0.00000000e+00f, -5.88684082e-02f},
+    {3.42300415e-01f, 4.00000006e-01f, -1.18000002e-03f, -1.41540527e-01f},
+    {3.37844849e-01f, 4.00000006e-01f, -2.47800015e-02f, -2.25402832e-01f},
+    {3.29086304e-01f, 4.00000006e-01f, -7.78800026e-02f, -3.10638428e-01f},
+    {3.13873291e-01f, 4.00000006e-01f, -1.60353541e-01f, -3.97064209e-01f},
+    {3.09310913e-01f, 4.00000006e-01f, -2.36421198e-01f, -4.84741211e-01f},
+    {2.81753540e-01f, 4.00000006e-01f, -2.82988846e-01f, -5.73791504e-01f},
+    {2.56835938e-01f, 4.00000006e-01f, -3.00000012e-01f, -6.64031982e-01f},
+    {2.13897705e-01f, 4.00000006e-01f, -3.00000012e-01f, -7.55645752e-01f},
+    {1.80694580e-01f, 4.00000006e-01f, -3.00000012e-01f, -8.48449707e-01f},
+    {1.46560669e-01f, 4.00000006e-01f, -3.00000012e-01f, -9.42535400e-01f},
+    {1.16439819e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.03796387e+00f},
+    {7.11669922e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.07232666e+00f},
+    {3.12652588e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.09140015e+00f},
+    {-7.49206543e-03f, 4.00000006e-01f, -3.00000012e-01f, -1.11047363e+00f},
+    {-4.61273193e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.12954712e+00f},
+    {-7.50122070e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.14862061e+00f},
+    {-1.00463867e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.16769409e+00f},
+    {-1.10244751e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.18676758e+00f},
+    {-1.27044678e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.20584106e+00f},
+    {-1.28250122e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.22491455e+00f},
+    {-1.26281738e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.24398804e+00f},
+    {-1.06781006e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.26306152e+00f},
+    {-7.94677734e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.28213501e+00f},
+    {-5.86700439e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.30120850e+00f},
+    {-1.60827637e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.32028198e+00f},
+    {2.09350586e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.33935547e+00f},
+    {6.54449463e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.35842896e+00f},
+    {1.13922119e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.37750244e+00f},
+    {1.73294067e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.39657593e+00f},
+    {2.25982666e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.41564941e+00f},
+    {2.87216187e-01f, 3.99410009e-01f, -2.98820019e-01f, -1.43472290e+00f},
+    {3.25363159e-01f, 3.87610018e-01f, -2.75220037e-01f, -1.37243652e+00f},
+    {3.52859497e-01f, 3.61060023e-01f, -2.22120017e-01f, -1.34957886e+00f},
+    {4.00558472e-01f, 3.19759995e-01f, -1.39646471e-01f, -1.39810181e+00f},
+    {4.61227417e-01f, 2.64300019e-01f, -6.35788292e-02f, -1.51910400e+00f},
+    {5.20202637e-01f, 2.05300003e-01f, -1.70111880e-02f, -1.67065430e+00f},
+    {5.66696167e-01f, 1.46299973e-01f, 0.00000000e+00f, -1.82427979e+00f},
+    {6.19293213e-01f, 8.92460123e-02f, 0.00000000e+00f, -1.97671509e+00f},
+    {6.44577026e-01f, 4.52894159e-02f, 0.00000000e+00f, -2.07559204e+00f},
+    {6.58340454e-01f, 1.60828177e-02f, 0.00000000e+00f, -2.10372925e+00f},
+    {6.41281128e-01f, 1.62621844e-03f, 0.00000000e+00f, -2.05993652e+00f},
+    {6.09680176e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.94628906e+00f},
+    {5.97290039e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.91448975e+00f},
+    {5.54504395e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.87014771e+00f},
+    {5.09918213e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.81298828e+00f},
+    {4.67987061e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.74291992e+00f},
+    {4.04556274e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.65963745e+00f},
+    {3.46725464e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.56304932e+00f},
+    {2.84393311e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.45285034e+00f},
+    {2.18170166e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.32897949e+00f},
+    {1.44638062e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.19122314e+00f},
+    {9.19799805e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.16848755e+00f},
+    {4.58984375e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.17642212e+00f},
+    {3.28063965e-03f, 0.00000000e+00f, 0.00000000e+00f, -1.18435669e+00f},
+    {-3.30352783e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.19229126e+00f},
+    {-6.84356689e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.20022583e+00f},
+    {-8.67919922e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.20816040e+00f},
+    {-1.09481812e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.21609497e+00f},
+    {-1.22467041e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.22402954e+00f},
+    {-1.21017456e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.23196411e+00f},
+    {-1.19918823e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.23989868e+00f},
+    {-9.46655273e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.24783325e+00f},
+    {-8.62426758e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.25576782e+00f},
+    {-5.40924072e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.26370239e+00f},
+    {-2.38037109e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.27163696e+00f},
+    {2.23693848e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.27957153e+00f},
+    {6.53381348e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.28750610e+00f},
+    {1.16287231e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.29544067e+00f},
+    {1.63116455e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.30337524e+00f},
+    {2.12020874e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.31130981e+00f},
+};
+
+static const float GOLDEN_KALMAN[100][2] = {
+    {-1.14968872e+00f, 0.00000000e+00f},
+    {-4.84298706e-01f, -1.62658691e-02f},
+    {1.12091064e-01f, -2.27355957e-02f},
+    {6.75308228e-01f, -2.61077881e-02f},
+    {1.26161194e+00f, -3.45916748e-02f},
+    {1.78913879e+00f, -3.73382568e-02f},
+    {2.34259033e+00f, -4.75616455e-02f},
+    {2.84310913e+00f, -5.32073975e-02f},
+    {3.29769897e+00f, -5.71289062e-02f},
+    {3.72009277e+00f, -5.89904785e-02f},
+    {4.05360413e+00f, -5.45349121e-02f},
+    {4.39909363e+00f, -5.67474365e-02f},
+    {4.65606689e+00f, -5.33599854e-02f},
+    {4.89830017e+00f, -5.20629883e-02f},
+    {5.10710144e+00f, -5.15289307e-02f},
+    {5.27095032e+00f, -4.91180420e-02f},
+    {5.39176941e+00f, -4.79278564e-02f},
+    {5.42622375e+00f, -4.27551270e-02f},
+    {5.43199158e+00f, -3.81927490e-02f},
+    {5.38211060e+00f, -3.29895020e-02f},
+    {5.28089905e+00f, -2.63214111e-02f},
+    {5.13793945e+00f, -1.99890137e-02f},
+    {4.98217773e+00f, -1.53198242e-02f},
+    {4.79910278e+00f, -1.31530762e-02f},
+    {4.49275208e+00f, -3.20434570e-04f},
+    {4.19984436e+00f, 6.59179688e-03f},
+    {3.93441772e+00f, 5.44738770e-03f},
+    {3.57278442e+00f, 1.36413574e-02f},
+    {3.17228699e+00f, 2.36663818e-02f},
+    {2.78799438e+00f, 2.72521973e-02f},
+    {2.38230896e+00f, 3.34320068e-02f},
+    {1.95941162e+00f, 3.90777588e-02f},
+    {1.51533508e+00f, 4.76074219e-02f},
+    {1.03222656e+00f, 5.91278076e-02f},
+    {5.97610474e-01f, 6.49414062e-02f},
+    {1.35971069e-01f, 7.46307373e-02f},
+    {-2.85491943e-01f, 7.91015625e-02f},
+    {-6.91543579e-01f, 8.23669434e-02f},
+    {-1.11859131e+00f, 9.16442871e-02f},
+    {-1.54168701e+00f, 1.02996826e-01f},
+    {-1.87594604e+00f, 1.04949951e-01f},
+    {-1.98431396e+00f, 7.81097412e-02f},
+    {-2.11102295e+00f, 5.79986572e-02f},
+    {-2.22145081e+00f, 4.03137207e-02f},
+    {-2.33357239e+00f, 2.78167725e-02f},
+    {-2.40983582e+00f, 1.74407959e-02f},
+    {-2.48435974e+00f, 1.14593506e-02f},
+    {-2.47120667e+00f, -5.64575195e-04f},
+    {-2.49691772e+00f, -2.09045410e-03f},
+    {-2.46096802e+00f, -6.13403320e-03f},
+    {-2.35992432e+00f, -1.19476318e-02f},
+    {-2.26588440e+00f, -1.02691650e-02f},
+    {-2.11944580e+00f, -1.01928711e-02f},
+    {-1.87510681e+00f, -1.69372559e-02f},
+    {-1.59483337e+00f, -2.19879150e-02f},
+    {-1.36047363e+00f, -1.63726807e-02f},
+    {-1.09338379e+00f, -1.06353760e-02f},
+    {-7.70004272e-01f, -8.14819336e-03f},
+    {-3.79730225e-01f, -8.39233398e-03f},
+    {2.65808105e-02f, -6.59179688e-03f},
+    {4.16900635e-01f, 1.15966797e-03f},
+    {8.75869751e-01f, 3.76892090e-03f},
+    {1.33010864e+00f, 9.53674316e-03f},
+    {1.81423950e+00f, 1.39923096e-02f},
+    {2.28245544e+00f, 2.14843750e-02f},
+    {2.78895569e+00f, 2.48565674e-02f},
+    {3.25787354e+00f, 3.35083008e-02f},
+    {3.77035522e+00f, 3.65295410e-02f},
+    {4.25636292e+00f, 4.35791016e-02f},
+    {4.72529602e+00f, 5.36499023e-02f},
+    {5.16781616e+00f, 6.57958984e-02f},
+    {5.64692688e+00f, 7.03125000e-02f},
+    {6.04287720e+00f, 8.29010010e-02f},
+    {6.39767456e+00f, 9.91973877e-02f},
+    {6.79646301e+00f, 1.04919434e-01f},
+    {7.14782715e+00f, 1.14547729e-01f},
+    {7.50642395e+00f, 1.17385864e-01f},
+    {7.83045959e+00f, 1.20742798e-01f},
+    {8.10984802e+00f, 1.26434326e-01f},
+    {8.32246399e+00f, 1.34445190e-01f},
+    {8.53141785e+00f, 1.36627197e-01f},
+    {8.66380310e+00f, 1.43615723e-01f},
+    {8.73168945e+00f, 1.54510498e-01f},
+    {8.75653076e+00f, 1.65512085e-01f},
+    {8.75263977e+00f, 1.73919678e-01f},
+    {8.69152832e+00f, 1.83822632e-01f},
+    {8.62539673e+00f, 1.88964844e-01f},
+    {8.50170898e+00f, 1.95724487e-01f},
+    {8.29209900e+00f, 2.08404541e-01f},
+    {8.08226013e+00f, 2.15698242e-01f},
+    {7.81938171e+00f, 2.24105835e-01f},
+    {7.53085327e+00f, 2.32391357e-01f},
+    {7.18162537e+00f, 2.45315552e-01f},
+    {6.82525635e+00f, 2.51907349e-01f},
+    {6.48501587e+00f, 2.54470825e-01f},
+    {6.08898926e+00f, 2.61459351e-01f},
+    {5.67565918e+00f, 2.67425537e-01f},
+    {5.20637512e+00f, 2.78564453e-01f},
+    {4.74765015e+00f, 2.86758423e-01f},
+    {4.28775024e+00f, 2.94815063e-01f},
+};
+
+static const float GOLDEN_COMPLEMENTARY[100][1] = {
+    {-1.14968872e+00f},
+    {-4.53018188e-01f},
+    {1.51809692e-01f},
+    {7.16613770e-01f},
+    {1.31391907e+00f},
+    {1.84019470e+00f},
+    {2.40647888e+00f},
+    {2.90968323e+00f},
+    {3.36231995e+00f},
+    {3.77929688e+00f},
+    {4.09544373e+00f},
+    {4.43861389e+00f},
+    {4.68280029e+00f},
+    {4.91764832e+00f},
+    {5.12080383e+00f},
+    {5.27635193e+00f},
+    {5.39195251e+00f},
+    {5.41397095e+00f},
+    {5.41000366e+00f},
+    {5.35047913e+00f},
+    {5.23765564e+00f},
+    {5.08551025e+00f},
+    {4.92453003e+00f},
+    {4.74179077e+00f},
+    {4.41572571e+00f},
+    {4.11686707e+00f},
+    {3.86183167e+00f},
+    {3.49127197e+00f},
+    {3.07975769e+00f},
+    {2.69810486e+00f},
+    {2.29031372e+00f},
+    {1.86688232e+00f},
+    {1.41703796e+00f},
+    {9.23156738e-01f},
+    {4.90142822e-01f},
+    {2.34680176e-02f},
+    {-3.92303467e-01f},
+    {-7.90756226e-01f},
+    {-1.22245789e+00f},
+    {-1.65350342e+00f},
+    {-1.97547913e+00f},
+    {-2.01777649e+00f},
+    {-2.09913635e+00f},
+    {-2.17356873e+00f},
+    {-2.26472473e+00f},
+    {-2.32612610e+00f},
+    {-2.39671326e+00f},
+    {-2.36837769e+00f},
+    {-2.40095520e+00f},
+    {-2.36662292e+00f},
+    {-2.26423645e+00f},
+    {-2.18280029e+00f},
+    {-2.04475403e+00f},
+    {-1.79531860e+00f},
+    {-1.51377869e+00f},
+    {-1.29927063e+00f},
+    {-1.04989624e+00f},
+    {-7.36282349e-01f},
+    {-3.49182129e-01f},
+    {5.04760742e-02f},
+    {4.22958374e-01f},
+    {8.76083374e-01f},
+    {1.31886292e+00f},
+    {1.79592896e+00f},
+    {2.25202942e+00f},
+    {2.75602722e+00f},
+    {3.21261597e+00f},
+    {3.72514343e+00f},
+    {4.20341492e+00f},
+    {4.65992737e+00f},
+    {5.08755493e+00f},
+    {5.56843567e+00f},
+    {5.95098877e+00f},
+    {6.28700256e+00f},
+    {6.69027710e+00f},
+    {7.03846741e+00f},
+    {7.40698242e+00f},
+    {7.73950195e+00f},
+    {8.02238464e+00f},
+    {8.23420715e+00f},
+    {8.45329285e+00f},
+    {8.58644104e+00f},
+    {8.64753723e+00f},
+    {8.66627502e+00f},
+    {8.66250610e+00f},
+    {8.59899902e+00f},
+    {8.54048157e+00f},
+    {8.42080688e+00f},
+    {8.20394897e+00f},
+    {7.99815369e+00f},
+    {7.73724365e+00f},
+    {7.45138550e+00f},
+    {7.09553528e+00f},
+    {6.74601746e+00f},
+    {6.42016602e+00f},
+    {6.02853394e+00f},
+    {5.62170410e+00f},
+    {5.14865112e+00f},
+    {4.69256592e+00f},
+    {4.23588562e+00f},
+};
+
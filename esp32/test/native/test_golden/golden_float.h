@@ -0,0 +1,333 @@
+// Recorded by test_golden (GOLDEN_RECORD), float build. Do not edit by hand.
+// Balance: motor output, velocity setpoint, rotation setpoint, target tilt.
+// Kalman: angle, bias. One row per 5 ticks.
+
+static const float GOLDEN_BALANCE[120][4] = {
+    {3.79392914e-02f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {9.24788862e-02f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {1.52982935e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {1.79765731e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.32176483e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.56269366e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.85151243e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.96104789e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {3.21462750e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {3.21629554e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {3.08535278e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {3.02556276e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.79677600e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.63582557e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {2.23956481e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {1.84352309e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {1.41525641e-01f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {9.80098397e-02f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {5.72188459e-02f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {-4.91414219e-04f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f},
+    {-5.17086275e-02f, 5.90000011e-04f, 0.00000000e+00f, 0.00000000e+00f},
+    {-8.58307332e-02f, 1.23900007e-02f, 0.00000000e+00f, -1.90940052e-02f},
+    {-1.48850530e-01f, 3.89400013e-02f, 0.00000000e+00f, 1.79082807e-02f},
+    {-1.97356567e-01f, 8.02400112e-02f, 0.00000000e+00f, 1.27502516e-01f},
+    {-2.67535627e-01f, 1.35700017e-01f, 0.00000000e+00f, 3.10868442e-01f},
+    {-3.35750282e-01f, 1.94700047e-01f, 0.00000000e+00f, 5.25997996e-01f},
+    {-3.98727387e-01f, 2.53700078e-01f, 0.00000000e+00f, 7.44571567e-01f},
+    {-4.44145799e-01f, 3.10754001e-01f, 0.00000000e+00f, 9.63136613e-01f},
+    {-4.91076648e-01f, 3.54710609e-01f, 0.00000000e+00f, 1.12952495e+00f},
+    {-5.11146247e-01f, 3.83917183e-01f, 0.00000000e+00f, 1.22640955e+00f},
+    {-5.11947870e-01f, 3.98373783e-01f, 0.00000000e+00f, 1.25261033e+00f},
+    {-4.90418226e-01f, 4.00000006e-01f, 0.00000000e+00f, 1.21027040e+00f},
+    {-4.59884584e-01f, 4.00000006e-01f, 0.00000000e+00f, 1.15063417e+00f},
+    {-4.33060944e-01f, 4.00000006e-01f, 0.00000000e+00f, 1.08972156e+00f},
+    {-3.79048854e-01f, 4.00000006e-01f, 0.00000000e+00f, 1.02753258e+00f},
+    {-3.42841208e-01f, 4.00000006e-01f, 0.00000000e+00f, 9.64067459e-01f},
+    {-2.83747554e-01f, 4.00000006e-01f, 0.00000000e+00f, 8.99326086e-01f},
+    {-2.33050466e-01f, 4.00000006e-01f, 0.00000000e+00f, 8.33308399e-01f},
+    {-1.64915338e-01f, 4.00000006e-01f, 0.00000000e+00f, 7.66014457e-01f},
+    {-1.08964749e-01f, 4.00000006e-01f, 0.00000000e+00f, 6.97444201e-01f},
+    {-5.10542132e-02f, 4.00000006e-01f, 0.00000000e+00f, 6.27597690e-01f},
+    {7.50626624e-03f, 4.00000006e-01f, 0.00000000e+00f, 5.56474864e-01f},
+    {6.33221567e-02f, 4.00000006e-01f, 0.00000000e+00f, 4.84075963e-01f},
+    {1.17167644e-01f, 4.00000006e-01f, 0.00000000e+00f, 4.10400778e-01f},
+    {1.78508848e-01f, 4.00000006e-01f, 0.00000000e+00f, 3.35448802e-01f},
+    {2.22745597e-01f, 4.00000006e-01f, 0.00000000e+00f, 2.59221077e-01f},
+    {2.42638305e-01f, 4.00000006e-01f, 0.00000000e+00f, 1.81716889e-01f},
+    {2.95069814e-01f, 4.00000006e-01f, 0.00000000e+00f, 1.02936625e-01f},
+    {3.15285712e-01f, 4.00000006e-01f, 0.00000000e+00f, 2.28800923e-02f},
+    {3.33739787e-01f, 4.00000006e-01f, 0.00000000e+00f, -5.84532470e-02f},
+    {3.42257649e-01f, 4.00000006e-01f, -1.18000002e-03f, -1.41062319e-01f},
+    {3.37806791e-01f, 4.00000006e-01f, -2.47800015e-02f, -2.24947855e-01f},
+    {3.29021603e-01f, 4.00000006e-01f, -7.78800026e-02f, -3.10109675e-01f},
+    {3.13822210e-01f, 4.00000006e-01f, -1.60353541e-01f, -3.96547377e-01f},
+    {3.09286147e-01f, 4.00000006e-01f, -2.36421198e-01f, -4.84262258e-01f},
+    {2.81727612e-01f, 4.00000006e-01f, -2.82988846e-01f, -5.73252499e-01f},
+    {2.56811857e-01f, 4.00000006e-01f, -3.00000012e-01f, -6.63519382e-01f},
+    {2.13873267e-01f, 4.00000006e-01f, -3.00000012e-01f, -7.55062580e-01f},
+    {1.80650309e-01f, 4.00000006e-01f, -3.00000012e-01f, -8.47881615e-01f},
+    {1.46517947e-01f, 4.00000006e-01f, -3.00000012e-01f, -9.41977322e-01f},
+    {1.16388731e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.03734970e+00f},
+    {7.11212009e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.07171559e+00f},
+    {3.12236845e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.09076643e+00f},
+    {-7.54271075e-03f, 4.00000006e-01f, -3.00000012e-01f, -1.10981739e+00f},
+    {-4.61865440e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.12886822e+00f},
+    {-7.50828385e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.14791906e+00f},
+    {-1.00545309e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.16697001e+00f},
+    {-1.10318765e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.18602085e+00f},
+    {-1.27126217e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.20507169e+00f},
+    {-1.28332689e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.22412264e+00f},
+    {-1.26371458e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.24317348e+00f},
+    {-1.06894173e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.26222444e+00f},
+    {-7.95751885e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.28127527e+00f},
+    {-5.87898605e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.30032611e+00f},
+    {-1.62025653e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.31937706e+00f},
+    {2.08060686e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.33842790e+00f},
+    {6.53059483e-02f, 4.00000006e-01f, -3.00000012e-01f, -1.35747874e+00f},
+    {1.13780037e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.37652969e+00f},
+    {1.73157230e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.39558053e+00f},
+    {2.25846991e-01f, 4.00000006e-01f, -3.00000012e-01f, -1.41463137e+00f},
+    {2.87055910e-01f, 3.99410009e-01f, -2.98820019e-01f, -1.43368220e+00f},
+    {3.25207442e-01f, 3.87610018e-01f, -2.75220037e-01f, -1.37135696e+00f},
+    {3.52701128e-01f, 3.61060023e-01f, -2.22120017e-01f, -1.34853745e+00f},
+    {4.00423139e-01f, 3.19759995e-01f, -1.39646471e-01f, -1.39703226e+00f},
+    {4.61088359e-01f, 2.64300019e-01f, -6.35788292e-02f, -1.51802218e+00f},
+    {5.20052910e-01f, 2.05300003e-01f, -1.70111880e-02f, -1.66950107e+00f},
+    {5.66543341e-01f, 1.46299973e-01f, 0.00000000e+00f, -1.82314622e+00f},
+    {6.19138658e-01f, 8.92460123e-02f, 0.00000000e+00f, -1.97550809e+00f},
+    {6.44414902e-01f, 4.52894159e-02f, 0.00000000e+00f, -2.07441568e+00f},
+    {6.58204436e-01f, 1.60828177e-02f, 0.00000000e+00f, -2.10254288e+00f},
+    {6.41128242e-01f, 1.62621844e-03f, 0.00000000e+00f, -2.05871177e+00f},
+    {6.09541118e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.94506216e+00f},
+    {5.97166359e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.91327131e+00f},
+    {5.54374516e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.86889505e+00f},
+    {5.09782374e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.81174362e+00f},
+    {4.67863739e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.74162567e+00f},
+    {4.04437542e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.65834904e+00f},
+    {3.46599221e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.56172335e+00f},
+    {2.84274757e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.45155382e+00f},
+    {2.18039125e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.32765293e+00f},
+    {1.44503504e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.18982959e+00f},
+    {9.18353796e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.16712403e+00f},
+    {4.57487367e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.17504966e+00f},
+    {3.15427035e-03f, 0.00000000e+00f, 0.00000000e+00f, -1.18297529e+00f},
+    {-3.31783630e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.19090092e+00f},
+    {-6.85967952e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.19882655e+00f},
+    {-8.69437978e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.20675218e+00f},
+    {-1.09647095e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.21467781e+00f},
+    {-1.22624017e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.22260344e+00f},
+    {-1.21185362e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.23052907e+00f},
+    {-1.20092884e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.23845470e+00f},
+    {-9.48591009e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.24638033e+00f},
+    {-8.64269659e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.25430596e+00f},
+    {-5.42720631e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.26223159e+00f},
+    {-2.40008291e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.27015722e+00f},
+    {2.21845452e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.27808285e+00f},
+    {6.51489943e-02f, 0.00000000e+00f, 0.00000000e+00f, -1.28600848e+00f},
+    {1.16087891e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.29393411e+00f},
+    {1.62899435e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.30185974e+00f},
+    {2.11816400e-01f, 0.00000000e+00f, 0.00000000e+00f, -1.30978537e+00f},
+};
+
+static const float GOLDEN_KALMAN[100][2] = {
+    {-1.15062094e+00f, 0.00000000e+00f},
+    {-4.84738886e-01f, -1.63098574e-02f},
+    {1.12073876e-01f, -2.27780621e-02f},
+    {6.75722301e-01f, -2.61276606e-02f},
+    {1.26237571e+00f, -3.46018933e-02f},
+    {1.79024887e+00f, -3.73267271e-02f},
+    {2.34397697e+00f, -4.75394130e-02f},
+    {2.84475732e+00f, -5.31592146e-02f},
+    {3.29953480e+00f, -5.70354052e-02f},
+    {3.72212005e+00f, -5.88492081e-02f},
+    {4.05575752e+00f, -5.43160811e-02f},
+    {4.40137863e+00f, -5.64683564e-02f},
+    {4.65842772e+00f, -5.30040860e-02f},
+    {4.90069675e+00f, -5.16432002e-02f},
+    {5.10952806e+00f, -5.10443673e-02f},
+    {5.27337027e+00f, -4.85649705e-02f},
+    {5.39416885e+00f, -4.73077372e-02f},
+    {5.42855740e+00f, -4.20564935e-02f},
+    {5.43424177e+00f, -3.74393277e-02f},
+    {5.38425779e+00f, -3.21680717e-02f},
+    {5.28288841e+00f, -2.54113544e-02f},
+    {5.13977289e+00f, -1.89964436e-02f},
+    {4.98387003e+00f, -1.42619442e-02f},
+    {4.80064487e+00f, -1.20393652e-02f},
+    {4.49412107e+00f, 8.79867119e-04f},
+    {4.20099401e+00f, 7.85072520e-03f},
+    {3.93540025e+00f, 6.75083883e-03f},
+    {3.57354712e+00f, 1.50269642e-02f},
+    {3.17283082e+00f, 2.50986591e-02f},
+    {2.78835964e+00f, 2.87293773e-02f},
+    {2.38250804e+00f, 3.49588059e-02f},
+    {1.95941913e+00f, 4.06529978e-02f},
+    {1.51512873e+00f, 4.92548235e-02f},
+    {1.03178883e+00f, 6.08428046e-02f},
+    {5.97005188e-01f, 6.66935593e-02f},
+    {1.35141447e-01f, 7.64437318e-02f},
+    {-2.86506951e-01f, 8.09713379e-02f},
+    {-6.92770302e-01f, 8.42775106e-02f},
+    {-1.11995542e+00f, 9.36056674e-02f},
+    {-1.54318559e+00f, 1.04998603e-01f},
+    {-1.87756765e+00f, 1.06975615e-01f},
+    {-1.98592281e+00f, 8.00978169e-02f},
+    {-2.11263132e+00f, 5.99620417e-02f},
+    {-2.22306705e+00f, 4.22649756e-02f},
+    {-2.33518577e+00f, 2.97572911e-02f},
+    {-2.41144109e+00f, 1.93637721e-02f},
+    {-2.48596883e+00f, 1.33988662e-02f},
+    {-2.47278380e+00f, 1.35573512e-03f},
+    {-2.49844718e+00f, -1.51326472e-04f},
+    {-2.46240664e+00f, -4.17859294e-03f},
+    {-2.36129618e+00f, -9.98258125e-03f},
+    {-2.26716805e+00f, -8.28382187e-03f},
+    {-2.12060285e+00f, -8.17421637e-03f},
+    {-1.87611616e+00f, -1.48877883e-02f},
+    {-1.59570515e+00f, -1.99211612e-02f},
+    {-1.36120343e+00f, -1.42596252e-02f},
+    {-1.09398198e+00f, -8.47110990e-03f},
+    {-7.70444453e-01f, -5.94059099e-03f},
+    {-3.80002320e-01f, -6.15782430e-03f},
+    {2.65066996e-02f, -4.30046255e-03f},
+    {4.17014837e-01f, 3.52683640e-03f},
+    {8.76202226e-01f, 6.17837906e-03f},
+    {1.33062673e+00f, 1.20017463e-02f},
+    {1.81498516e+00f, 1.64998323e-02f},
+    {2.28338599e+00f, 2.40562297e-02f},
+    {2.79004955e+00f, 2.74914969e-02f},
+    {3.25911999e+00f, 3.62124369e-02f},
+    {3.77177024e+00f, 3.92861925e-02f},
+    {4.25789547e+00f, 4.63985577e-02f},
+    {4.72695065e+00f, 5.65451458e-02f},
+    {5.16955137e+00f, 6.87920228e-02f},
+    {5.64878654e+00f, 7.33772218e-02f},
+    {6.04480600e+00f, 8.60457197e-02f},
+    {6.39966679e+00f, 1.02432214e-01f},
+    {6.79848433e+00f, 1.08221821e-01f},
+    {7.14986753e+00f, 1.17935106e-01f},
+    {7.50843334e+00f, 1.20847099e-01f},
+    {7.83245134e+00f, 1.24251120e-01f},
+    {8.11179447e+00f, 1.30013645e-01f},
+    {8.32433605e+00f, 1.38093457e-01f},
+    {8.53317261e+00f, 1.40339360e-01f},
+    {8.66544628e+00f, 1.47405893e-01f},
+    {8.73322296e+00f, 1.58365443e-01f},
+    {8.75791836e+00f, 1.69438183e-01f},
+    {8.75384045e+00f, 1.77920282e-01f},
+    {8.69256496e+00f, 1.87890485e-01f},
+    {8.62621307e+00f, 1.93074062e-01f},
+    {8.50234795e+00f, 1.99896798e-01f},
+    {8.29251671e+00f, 2.12629378e-01f},
+    {8.08245182e+00f, 2.19973087e-01f},
+    {7.81934023e+00f, 2.28432745e-01f},
+    {7.53056479e+00f, 2.36771882e-01f},
+    {7.18110466e+00f, 2.49753982e-01f},
+    {6.82447147e+00f, 2.56389380e-01f},
+    {6.48397970e+00f, 2.58973330e-01f},
+    {6.08773422e+00f, 2.66006261e-01f},
+    {5.67416859e+00f, 2.72000372e-01f},
+    {5.20466328e+00f, 2.83184201e-01f},
+    {4.74571753e+00f, 2.91409820e-01f},
+    {4.28562212e+00f, 2.99492061e-01f},
+};
+
+static const float GOLDEN_COMPLEMENTARY[100][1] = {
+    {-1.15062094e+00f},
+    {-4.53425229e-01f},
+    {1.51833311e-01f},
+    {7.17097580e-01f},
+    {1.31474185e+00f},
+    {1.84135151e+00f},
+    {2.40791154e+00f},
+    {2.91133308e+00f},
+    {3.36417127e+00f},
+    {3.78130317e+00f},
+    {4.09761715e+00f},
+    {4.44091749e+00f},
+    {4.68520308e+00f},
+    {4.92009401e+00f},
+    {5.12328053e+00f},
+    {5.27878952e+00f},
+    {5.39436865e+00f},
+    {5.41634989e+00f},
+    {5.41234255e+00f},
+    {5.35275650e+00f},
+    {5.23981619e+00f},
+    {5.08756781e+00f},
+    {4.92650509e+00f},
+    {4.74366856e+00f},
+    {4.41749096e+00f},
+    {4.11846685e+00f},
+    {3.86330891e+00f},
+    {3.49261951e+00f},
+    {3.08098555e+00f},
+    {2.69918609e+00f},
+    {2.29127526e+00f},
+    {1.86770940e+00f},
+    {1.41771734e+00f},
+    {9.23725486e-01f},
+    {4.90594000e-01f},
+    {2.37470120e-02f},
+    {-3.92226338e-01f},
+    {-7.90843725e-01f},
+    {-1.22261798e+00f},
+    {-1.65373504e+00f},
+    {-1.97581232e+00f},
+    {-2.01815128e+00f},
+    {-2.09951949e+00f},
+    {-2.17401767e+00f},
+    {-2.26521206e+00f},
+    {-2.32659984e+00f},
+    {-2.39715028e+00f},
+    {-2.36874533e+00f},
+    {-2.40124893e+00f},
+    {-2.36681509e+00f},
+    {-2.26436520e+00f},
+    {-2.18279099e+00f},
+    {-2.04461837e+00f},
+    {-1.79502106e+00f},
+    {-1.51328766e+00f},
+    {-1.29862022e+00f},
+    {-1.04909432e+00f},
+    {-7.35316157e-01f},
+    {-3.48066837e-01f},
+    {5.18289730e-02f},
+    {4.24552947e-01f},
+    {8.77875805e-01f},
+    {1.32085156e+00f},
+    {1.79814386e+00f},
+    {2.25448728e+00f},
+    {2.75867295e+00f},
+    {3.21540165e+00f},
+    {3.72812796e+00f},
+    {4.20654964e+00f},
+    {4.66319323e+00f},
+    {5.09093666e+00f},
+    {5.57194424e+00f},
+    {5.95457888e+00f},
+    {6.29071999e+00f},
+    {6.69404173e+00f},
+    {7.04226971e+00f},
+    {7.41077280e+00f},
+    {7.74330997e+00f},
+    {8.02617836e+00f},
+    {8.23796177e+00f},
+    {8.45691204e+00f},
+    {8.58998871e+00f},
+    {8.65103912e+00f},
+    {8.66969013e+00f},
+    {8.66574001e+00f},
+    {8.60209751e+00f},
+    {8.54344463e+00f},
+    {8.42367935e+00f},
+    {8.20664978e+00f},
+    {8.00066566e+00f},
+    {7.73958254e+00f},
+    {7.45349264e+00f},
+    {7.09746552e+00f},
+    {6.74775839e+00f},
+    {6.42169571e+00f},
+    {6.02990437e+00f},
+    {5.62286711e+00f},
+    {5.14970255e+00f},
+    {4.69347000e+00f},
+    {4.23667860e+00f},
+};
+
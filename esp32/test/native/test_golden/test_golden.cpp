@@ -0,0 +1,174 @@
+/**
+ * Golden-output regression tests (env:native).
+ *
+ * Replays the scripted scenarios in control_scenario.h through the balance
+ * controller and both pitch filters and compares every GOLDEN_DECIMATION-th
+ * output against traces recorded from the reference build. An optimization
+ * that changes control behaviour fails here; one that only reorders float
+ * operations stays inside GOLDEN_TOLERANCE.
+ *
+ * Float and Q16.16 builds (CONTROL_USE_FIXED_POINT) have separate goldens.
+ * After an intended behaviour change, re-record the one for the current build:
+ *   GOLDEN_RECORD=$PWD/test/native/test_golden/golden_float.h pio test -e native -f native/test_golden
+ */
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <native_shim.h>
+#include "../control_scenario.h"
+
+#if CONTROL_USE_FIXED_POINT
+#include "golden_fixed.h"
+#define GOLDEN_BUILD "fixed"
+#else
+#include "golden_float.h"
+#define GOLDEN_BUILD "float"
+#endif
+
+static const int BALANCE_ROWS = BALANCE_SCENARIO_TICKS / GOLDEN_DECIMATION;
+static const int FILTER_ROWS = FILTER_SCENARIO_TICKS / GOLDEN_DECIMATION;
+static const float GOLDEN_TOLERANCE = 1e-4f;  // Relative, with an absolute floor of the same size
+
+static float balance_trace[BALANCE_ROWS][BALANCE_TRACE_CHANNELS];
+static float kalman_trace[FILTER_ROWS][2];  // angle, bias
+static float complementary_trace[FILTER_ROWS];
+
+static void runBalanceScenario() {
+    native_shim::reset();
+    BalanceController controller(KP, KI, KD);
+    uint32_t noise = SCENARIO_SEED;
+    float position = 0.0f;
+    for (int tick = 0; tick < BALANCE_SCENARIO_TICKS; tick++) {
+        balanceScenarioCommand(tick, controller);
+        BalanceInput input = balanceScenarioInput(tick, noise, position);
+        native_shim::advanceMicros(BALANCE_LOOP_PERIOD_US);
+        controller.update(input.angle, input.rate, input.wheel_velocity, input.wheel_position);
+        if (tick % GOLDEN_DECIMATION == 0) {
+            float* row = balance_trace[tick / GOLDEN_DECIMATION];
+            row[0] = controller.getMotorOutput();
+            row[1] = controller.getVelocitySetpoint();
+            row[2] = controller.getRotationSetpoint();
+            row[3] = controller.getTargetTilt();
+        }
+    }
+}
+
+static void runFilterScenario() {
+    KalmanPitchFilter<control_t> kalman(IMU_KALMAN_Q_ANGLE, IMU_KALMAN_Q_BIAS, IMU_KALMAN_R_MEASURE, BALANCE_LOOP_DT);
+    ComplementaryFilter<control_t> complementary(control_t(IMU_COMPLEMENTARY_ALPHA));
+    const control_t dt(BALANCE_LOOP_DT);
+    uint32_t noise = SCENARIO_SEED;
+    for (int tick = 0; tick < FILTER_SCENARIO_TICKS; tick++) {
+        ImuSample sample = filterScenarioSample(tick, noise);
+        control_t ax(sample.accel_x), az(sample.accel_z), gyro(sample.gyro);
+        float kalman_angle = (float)kalman.update(ax, az, gyro, dt);
+        float complementary_angle = (float)complementary.update(ax, az, gyro, dt);
+        if (tick % GOLDEN_DECIMATION == 0) {
+            int row = tick / GOLDEN_DECIMATION;
+            kalman_trace[row][0] = kalman_angle;
+            kalman_trace[row][1] = (float)kalman.bias;
+            complementary_trace[row] = complementary_angle;
+        }
+    }
+}
+
+static void assertTrace(const char* name, const float* expected, const float* actual, int count, int stride) {
+    for (int i = 0; i < count; i++) {
+        float tolerance = GOLDEN_TOLERANCE * (1.0f + fabsf(expected[i]));
+        if (!(fabsf(actual[i] - expected[i]) <= tolerance)) {
+            char message[128];
+            snprintf(message, sizeof(message), "%s: tick %d channel %d expected %.7g, got %.7g", name,
+                     (i / stride) * GOLDEN_DECIMATION, i % stride, (double)expected[i], (double)actual[i]);
+            TEST_FAIL_MESSAGE(message);
+        }
+    }
+}
+
+static void writeArray(FILE* file, const char* name, const float* values, int rows, int columns) {
+    fprintf(file, "static const float %s[%d][%d] = {\n", name, rows, columns);
+    for (int r = 0; r < rows; r++) {
+        fprintf(file, "    {");
+        for (int c = 0; c < columns; c++) {
+            fprintf(file, "%s%.8ef", c == 0 ? "" : ", ", (double)values[r * columns + c]);
+        }
+        fprintf(file, "},\n");
+    }
+    fprintf(file, "};\n\n");
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_balance_controller_matches_golden() {
+    assertTrace("balance", &GOLDEN_BALANCE[0][0], &balance_trace[0][0], BALANCE_ROWS * BALANCE_TRACE_CHANNELS,
+                BALANCE_TRACE_CHANNELS);
+}
+
+void test_kalman_filter_matches_golden() {
+    assertTrace("kalman", &GOLDEN_KALMAN[0][0], &kalman_trace[0][0], FILTER_ROWS * 2, 2);
+}
+
+void test_complementary_filter_matches_golden() {
+    assertTrace("complementary", &GOLDEN_COMPLEMENTARY[0][0], complementary_trace, FILTER_ROWS, 1);
+}
+
+void test_balance_scenario_is_repeatable() {
+    // reset() must leave no state behind, or goldens would depend on test order
+    float first[BALANCE_ROWS][BALANCE_TRACE_CHANNELS];
+    memcpy(first, balance_trace, sizeof(first));
+    runBalanceScenario();
+    TEST_ASSERT_EQUAL_MEMORY(first, balance_trace, sizeof(first));
+}
+
+void test_without_wheel_feedback_encoders_are_ignored() {
+    // A failed encoder must not steer the outer loop: any readings give the zero-reading output
+    BalanceController dead(KP, KI, KD);
+    BalanceController still(KP, KI, KD);
+    dead.setWheelFeedback(false);
+    still.setWheelFeedback(false);
+    dead.setVelocitySetpoint(0.3f);
+    still.setVelocitySetpoint(0.3f);
+    for (int i = 0; i < 500; i++) {
+        float angle = BALANCE_ANGLE_OFFSET + 0.5f * sinf(i * 0.02f);
+        dead.update(angle, 1.0f, 4000.0f, 12345.0f * i);
+        still.update(angle, 1.0f, 0.0f, 0.0f);
+        TEST_ASSERT_EQUAL_FLOAT(still.getMotorOutput(), dead.getMotorOutput());
+    }
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, dead.getTargetTilt());
+    TEST_ASSERT_FALSE(dead.hasWheelFeedback());
+}
+
+void test_record_goldens() {
+    const char* path = getenv("GOLDEN_RECORD");
+    FILE* file = fopen(path, "w");
+    TEST_ASSERT_NOT_NULL_MESSAGE(file, path);
+    fprintf(file, "// Recorded by test_golden (GOLDEN_RECORD), " GOLDEN_BUILD " build. Do not edit by hand.\n");
+    fprintf(file, "// Balance: motor output, velocity setpoint, rotation setpoint, target tilt.\n");
+    fprintf(file, "// Kalman: angle, bias. One row per %d ticks.\n\n", GOLDEN_DECIMATION);
+    writeArray(file, "GOLDEN_BALANCE", &balance_trace[0][0], BALANCE_ROWS, BALANCE_TRACE_CHANNELS);
+    writeArray(file, "GOLDEN_KALMAN", &kalman_trace[0][0], FILTER_ROWS, 2);
+    writeArray(file, "GOLDEN_COMPLEMENTARY", complementary_trace, FILTER_ROWS, 1);
+    fclose(file);
+    TEST_MESSAGE(path);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    runBalanceScenario();
+    runFilterScenario();
+
+    UNITY_BEGIN();
+    if (getenv("GOLDEN_RECORD") != nullptr) {
+        RUN_TEST(test_record_goldens);
+    } else {
+        RUN_TEST(test_balance_controller_matches_golden);
+        RUN_TEST(test_kalman_filter_matches_golden);
+        RUN_TEST(test_complementary_filter_matches_golden);
+        RUN_TEST(test_balance_scenario_is_repeatable);
+        RUN_TEST(test_without_wheel_feedback_encoders_are_ignored);
+    }
+    return UNITY_END();
+}
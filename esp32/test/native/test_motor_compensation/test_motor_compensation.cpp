@@ -0,0 +1,382 @@
+/**
+ * Motor compensation tests (env:native): the identity map passes commands
+ * through, a calibrated map is continuous through its deadband ramp and
+ * interpolates its grid, fitCurve inverts a measured sweep, and a full
+ * MotorCalibrator run against a wheel model with a deadband and mismatched
+ * gains yields maps that drive both wheels at the same speed, published
+ * for the comms task as they are applied.
+ */
+#include <unity.h>
+#include <math.h>
+#include <native_shim.h>
+#include "../rover_fixture.h"
+#include "../../../src/motor_control/motor_calibrator.h"
+#include "../../../src/odometry/odometry.h"
+
+static const uint8_t N = MotorCompensation::POINTS;
+static const uint8_t STEPS = MOTOR_CALIBRATION_STEPS;
+
+// Wheel off the ground: stalled inside the deadband, then linear in duty (pulses/sec)
+struct WheelModel {
+    float deadband;
+    float gain;
+    float speed(float duty) const {
+        float magnitude = fabsf(duty);
+        return magnitude <= deadband ? 0.0f : gain * (magnitude - deadband);
+    }
+};
+
+// Forward Gray sequence (A, B), as sim/closed_loop.cpp: EncoderReader decodes +1 per edge
+struct QuadratureSignal {
+    int pin_a;
+    int pin_b;
+    long count;
+    void moveTo(long target) {
+        while (count != target) {
+            count += target > count ? 1 : -1;
+            uint8_t phase = (uint8_t)(count & 3);
+            native_shim::setPin(pin_a, phase >= 2);
+            native_shim::setPin(pin_b, phase == 1 || phase == 2);
+        }
+    }
+};
+
+// The rover on a stand: each wheel follows its model in both directions
+struct StandRig : RoverHardware {
+    MotorCalibrator calibrator;
+    WheelModel wheels[2][2];  // [motor][direction]
+    QuadratureSignal signals[2];
+    float travel[2];
+
+    StandRig() : calibrator(&balance, &left_motor, &right_motor, &left_encoder, &right_encoder) {
+        left_motor.begin();
+        right_motor.begin();
+        left_encoder.begin();
+        right_encoder.begin();
+        signals[0] = {ENCODER_LEFT_A, ENCODER_LEFT_B, 0};
+        signals[1] = {ENCODER_RIGHT_A, ENCODER_RIGHT_B, 0};
+        travel[0] = travel[1] = 0.0f;
+    }
+
+    static float appliedDuty(MotorDriver& motor, int ledc_channel) {
+        float duty = (float)native_shim::ledcDuty(LEDC_HIGH_SPEED_MODE, ledc_channel) /
+                     (float)(1UL << motor.getPwmResolution());
+        return motor.getSpeed() < 0.0f ? -duty : duty;
+    }
+
+    float wheelSpeed(uint8_t m, float duty) const {
+        float speed = wheels[m][duty < 0.0f ? 1 : 0].speed(duty);
+        return duty < 0.0f ? -speed : speed;
+    }
+
+    // One control tick: the calibrator, then the wheels turn for a period
+    bool tick() {
+        bool owned = calibrator.service();
+        float duties[2] = {appliedDuty(left_motor, 0), appliedDuty(right_motor, 1)};
+        native_shim::advanceMicros(BALANCE_LOOP_PERIOD_US);
+        for (uint8_t m = 0; m < 2; m++) {
+            travel[m] += wheelSpeed(m, duties[m]) * BALANCE_LOOP_DT;
+            signals[m].moveTo(lroundf(travel[m]));
+        }
+        return owned;
+    }
+
+    void run() {
+        calibrator.requestStart();
+        int limit = (MotorCalibrator::TOTAL_STEPS + 1) *
+                    (MOTOR_CALIBRATION_SETTLE_MS + MOTOR_CALIBRATION_MEASURE_MS) * 1000 / BALANCE_LOOP_PERIOD_US;
+        for (int i = 0; i < limit && tick(); i++) {
+        }
+    }
+};
+
+static void fillSweep(const WheelModel& wheel, float* speeds) {
+    for (uint8_t k = 0; k <= STEPS; k++) {
+        speeds[k] = wheel.speed((float)k / STEPS);
+    }
+}
+
+void setUp() {
+    native_shim::reset();
+}
+
+void tearDown() {}
+
+void test_identity_passes_commands_through() {
+    MotorCompensation map;
+    TEST_ASSERT_TRUE(map.isIdentity());
+    const float commands[] = {-1.0f, -0.37f, -0.001f, 0.0f, 0.004f, 0.5f, 1.0f};
+    for (float command : commands) {
+        TEST_ASSERT_EQUAL_FLOAT(command, map.apply(command));
+    }
+}
+
+void test_map_interpolates_grid_and_ramps_through_deadband() {
+    float forward[N], reverse[N];
+    for (uint8_t i = 0; i < N; i++) {
+        forward[i] = 0.2f + 0.8f * i / (N - 1);
+        reverse[i] = 0.3f + 0.6f * i / (N - 1);
+    }
+    MotorCompensation map;
+    TEST_ASSERT_TRUE(map.setCurves(forward, reverse));
+    TEST_ASSERT_FALSE(map.isIdentity());
+
+    // Grid points and midpoints; reverse keeps its sign and its own curve
+    for (uint8_t i = 1; i < N; i++) {
+        float command = (float)i / (N - 1);
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f, forward[i], map.apply(command));
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f, -reverse[i], map.apply(-command));
+        float mid = command - 0.5f / (N - 1);
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.5f * (forward[i - 1] + forward[i]), map.apply(mid));
+    }
+
+    // Zero stays zero and the ramp meets the grid at MOTOR_COMPENSATION_RAMP
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, map.apply(0.0f));
+    float ramp = (float)MOTOR_COMPENSATION_RAMP;
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, map.apply(ramp), map.apply(ramp * 0.99999f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.5f * map.apply(ramp), map.apply(0.5f * ramp));
+    float previous = -1.0f;
+    for (int i = -100; i <= 100; i++) {
+        float duty = map.apply(i / 100.0f);
+        TEST_ASSERT_TRUE(duty >= previous);
+        previous = duty;
+    }
+}
+
+void test_invalid_curves_are_rejected() {
+    float forward[N], decreasing[N];
+    for (uint8_t i = 0; i < N; i++) {
+        forward[i] = (float)i / (N - 1);
+        decreasing[i] = 1.0f - forward[i];
+    }
+    float too_large[N];
+    for (uint8_t i = 0; i < N; i++) {
+        too_large[i] = forward[i] * 1.5f;
+    }
+    MotorCompensation map;
+    TEST_ASSERT_FALSE(map.setCurves(forward, decreasing));
+    TEST_ASSERT_FALSE(map.setCurves(too_large, forward));
+    TEST_ASSERT_TRUE(map.isIdentity());
+}
+
+void test_fit_inverts_linear_sweep() {
+    WheelModel wheel = {0.2f, 100.0f};
+    float speeds[STEPS + 1], curve[N];
+    fillSweep(wheel, speeds);
+    float reference = wheel.speed(1.0f);
+    TEST_ASSERT_TRUE(MotorCompensation::fitCurve(speeds, STEPS, MOTOR_CALIBRATION_MIN_VELOCITY, reference, curve));
+
+    // Deadband: the first step that moves; above it the exact inverse
+    TEST_ASSERT_FLOAT_WITHIN(1.0f / STEPS, wheel.deadband, curve[0]);
+    TEST_ASSERT_TRUE(curve[0] >= wheel.deadband);
+    for (uint8_t i = 1; i < N; i++) {
+        float share = (float)i / (N - 1);
+        float expected = wheel.deadband + share * reference / wheel.gain;
+        TEST_ASSERT_FLOAT_WITHIN(1.0f / STEPS, expected, curve[i]);
+        TEST_ASSERT_TRUE(curve[i] >= curve[i - 1]);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 1.0f, curve[N - 1]);
+}
+
+void test_fit_fails_without_motion_or_headroom() {
+    WheelModel stalled = {1.0f, 100.0f};
+    WheelModel weak = {0.2f, 50.0f};
+    float speeds[STEPS + 1], curve[N];
+    fillSweep(stalled, speeds);
+    TEST_ASSERT_FALSE(MotorCompensation::fitCurve(speeds, STEPS, MOTOR_CALIBRATION_MIN_VELOCITY, 10.0f, curve));
+    fillSweep(weak, speeds);
+    TEST_ASSERT_FALSE(MotorCompensation::fitCurve(speeds, STEPS, MOTOR_CALIBRATION_MIN_VELOCITY, 80.0f, curve));
+}
+
+void test_fitted_maps_equalize_mismatched_wheels() {
+    // Asymmetric deadbands and gains; the common reference is the slowest maximum
+    WheelModel wheels[2] = {{0.15f, 120.0f}, {0.25f, 90.0f}};
+    float reference = fminf(wheels[0].speed(1.0f), wheels[1].speed(1.0f));
+    MotorCompensation maps[2];
+    for (uint8_t m = 0; m < 2; m++) {
+        float speeds[STEPS + 1], curve[N];
+        fillSweep(wheels[m], speeds);
+        TEST_ASSERT_TRUE(MotorCompensation::fitCurve(speeds, STEPS, MOTOR_CALIBRATION_MIN_VELOCITY, reference, curve));
+        TEST_ASSERT_TRUE(maps[m].setCurves(curve, curve));
+    }
+    for (int i = 2; i <= 10; i++) {
+        float command = i / 10.0f;
+        float left = wheels[0].speed(maps[0].apply(command));
+        float right = wheels[1].speed(maps[1].apply(command));
+        TEST_ASSERT_FLOAT_WITHIN(0.02f * reference, command * reference, left);
+        TEST_ASSERT_FLOAT_WITHIN(0.02f * reference, command * reference, right);
+    }
+}
+
+void test_calibrator_sweep_equalizes_wheels() {
+    StandRig rig;
+    // Left: weak reverse; right: late deadband, strong
+    rig.wheels[0][0] = {0.15f, 400.0f};
+    rig.wheels[0][1] = {0.20f, 320.0f};
+    rig.wheels[1][0] = {0.30f, 500.0f};
+    rig.wheels[1][1] = {0.25f, 450.0f};
+    rig.run();
+    TEST_ASSERT_EQUAL(MotorCalibrator::STATE_DONE, rig.calibrator.getState());
+    TEST_ASSERT_EQUAL(MotorCalibrator::TOTAL_STEPS, rig.calibrator.getStepsDone());
+    TEST_ASSERT_TRUE(rig.calibrator.isCompensated());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, rig.left_motor.getSpeed());
+
+    // Reference: the weakest direction's maximum (left reverse, 256 pulses/s)
+    float reference = rig.calibrator.getReferenceSpeed();
+    TEST_ASSERT_FLOAT_WITHIN(8.0f, rig.wheels[0][1].speed(1.0f), reference);
+    TEST_ASSERT_FLOAT_WITHIN(8.0f, rig.wheels[1][0].speed(1.0f), rig.calibrator.getPeakSpeed(true, false));
+
+    const MotorCompensation& right = rig.right_motor.getCompensation();
+    TEST_ASSERT_FLOAT_WITHIN(1.0f / STEPS + 1e-4f, 0.3f, right.getCurve(false)[0]);
+
+    // Same command, same speed: every motor and direction within a few percent of the target
+    const MotorCompensation* maps[2] = {&rig.left_motor.getCompensation(), &right};
+    for (int i = 3; i <= 10; i++) {
+        float command = i / 10.0f;
+        for (uint8_t m = 0; m < 2; m++) {
+            float forward = rig.wheels[m][0].speed(maps[m]->apply(command));
+            float reverse = rig.wheels[m][1].speed(maps[m]->apply(-command));
+            TEST_ASSERT_FLOAT_WITHIN(0.05f * reference, command * reference, forward);
+            TEST_ASSERT_FLOAT_WITHIN(0.05f * reference, command * reference, reverse);
+        }
+    }
+}
+
+void test_stop_aborts_and_restores_previous_maps() {
+    StandRig rig;
+    for (uint8_t m = 0; m < 2; m++) {
+        rig.wheels[m][0] = rig.wheels[m][1] = {0.2f, 400.0f};
+    }
+    rig.calibrator.requestStart();
+    for (int i = 0; i < 200; i++) {
+        TEST_ASSERT_TRUE(rig.tick());
+    }
+    rig.calibrator.requestAbort();  // As CommandHandler::executeStop()
+    TEST_ASSERT_TRUE(rig.tick());   // The aborting tick still owns the motors
+    TEST_ASSERT_FALSE(rig.tick());  // Balancing resumes
+    TEST_ASSERT_EQUAL(MotorCalibrator::STATE_ABORTED, rig.calibrator.getState());
+    TEST_ASSERT_EQUAL(MotorCalibrator::ABORT_STOPPED, rig.calibrator.getAbortReason());
+    TEST_ASSERT_FALSE(rig.calibrator.isCompensated());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, rig.left_motor.getSpeed());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, rig.right_motor.getSpeed());
+}
+
+void test_stalled_wheel_aborts_with_no_motion() {
+    StandRig rig;
+    rig.wheels[0][0] = rig.wheels[0][1] = {0.2f, 400.0f};
+    rig.wheels[1][0] = rig.wheels[1][1] = {1.0f, 400.0f};  // Right wheel never turns
+    rig.run();
+    TEST_ASSERT_EQUAL(MotorCalibrator::STATE_ABORTED, rig.calibrator.getState());
+    TEST_ASSERT_EQUAL(MotorCalibrator::ABORT_NO_MOTION, rig.calibrator.getAbortReason());
+    TEST_ASSERT_FALSE(rig.calibrator.isCompensated());
+}
+
+void test_published_maps_follow_the_motors() {
+    StandRig rig;
+    for (uint8_t m = 0; m < 2; m++) {
+        rig.wheels[m][0] = {0.2f, 400.0f};
+        rig.wheels[m][1] = {0.25f, 380.0f};
+    }
+    rig.run();
+    MotorCompensation left, right;
+    rig.calibrator.getCompensation(left, right);
+    const MotorCompensation* applied[2] = {&rig.left_motor.getCompensation(), &rig.right_motor.getCompensation()};
+    const MotorCompensation* published[2] = {&left, &right};
+    for (uint8_t m = 0; m < 2; m++) {
+        TEST_ASSERT_FALSE(published[m]->isIdentity());
+        for (uint8_t i = 0; i < N; i++) {
+            TEST_ASSERT_EQUAL_FLOAT(applied[m]->getCurve(false)[i], published[m]->getCurve(false)[i]);
+            TEST_ASSERT_EQUAL_FLOAT(applied[m]->getCurve(true)[i], published[m]->getCurve(true)[i]);
+        }
+    }
+
+    // Clear lands on the control tick; the copy follows it there, not before
+    rig.calibrator.requestClear();
+    TEST_ASSERT_TRUE(rig.calibrator.isCompensated());
+    TEST_ASSERT_FALSE(rig.tick());
+    rig.calibrator.getCompensation(left, right);
+    TEST_ASSERT_TRUE(left.isIdentity());
+    TEST_ASSERT_TRUE(right.isIdentity());
+    TEST_ASSERT_FALSE(rig.calibrator.isCompensated());
+}
+
+void test_sweep_leaves_the_pose_unchanged() {
+    StandRig rig;
+    Odometry odometry(0.0f);  // Encoder heading alone: the sweep's mismatch would show in full
+    Odometry unattached(0.0f);  // Same encoders, not rebased: what the pose used to take in
+    rig.calibrator.setOdometry(&odometry);
+    rig.wheels[0][0] = rig.wheels[0][1] = {0.15f, 400.0f};
+    rig.wheels[1][0] = rig.wheels[1][1] = {0.30f, 500.0f};
+
+    // Drive and turn a little first, as balanceTick would track it
+    rig.signals[0].moveTo(120);
+    rig.signals[1].moveTo(180);
+    odometry.update(rig.left_encoder.getPosition(), rig.right_encoder.getPosition(), NAN, BALANCE_LOOP_DT);
+    unattached.update(rig.left_encoder.getPosition(), rig.right_encoder.getPosition(), NAN, BALANCE_LOOP_DT);
+    float x = odometry.getX(), y = odometry.getY(), heading = odometry.getHeading();
+    TEST_ASSERT_TRUE(heading > 1.0f);
+
+    rig.travel[0] = 120.0f;
+    rig.travel[1] = 180.0f;
+    rig.run();
+    TEST_ASSERT_EQUAL(MotorCalibrator::STATE_DONE, rig.calibrator.getState());
+
+    // First balancing tick after the sweep
+    odometry.update(rig.left_encoder.getPosition(), rig.right_encoder.getPosition(), NAN, BALANCE_LOOP_DT);
+    unattached.update(rig.left_encoder.getPosition(), rig.right_encoder.getPosition(), NAN, BALANCE_LOOP_DT);
+    TEST_ASSERT_TRUE(fabsf(unattached.getHeading() - heading) > 5.0f);
+    TEST_ASSERT_EQUAL_FLOAT(x, odometry.getX());
+    TEST_ASSERT_EQUAL_FLOAT(y, odometry.getY());
+    TEST_ASSERT_EQUAL_FLOAT(heading, odometry.getHeading());
+}
+
+void test_saved_maps_load_at_boot() {
+    float forward[N], reverse[N];
+    {
+        StandRig rig;
+        for (uint8_t m = 0; m < 2; m++) {
+            rig.wheels[m][0] = {0.2f, 400.0f};
+            rig.wheels[m][1] = {0.25f, 380.0f};
+        }
+        rig.run();
+        TEST_ASSERT_TRUE(rig.calibrator.save());
+        const MotorCompensation& map = rig.left_motor.getCompensation();
+        for (uint8_t i = 0; i < N; i++) {
+            forward[i] = map.getCurve(false)[i];
+            reverse[i] = map.getCurve(true)[i];
+        }
+    }
+    StandRig booted;  // NVS survives, motors start raw
+    TEST_ASSERT_FALSE(booted.calibrator.isCompensated());
+    TEST_ASSERT_TRUE(booted.calibrator.load());
+    TEST_ASSERT_TRUE(booted.calibrator.isCompensated());
+    const MotorCompensation& map = booted.left_motor.getCompensation();
+    for (uint8_t i = 0; i < N; i++) {
+        TEST_ASSERT_EQUAL_FLOAT(forward[i], map.getCurve(false)[i]);
+        TEST_ASSERT_EQUAL_FLOAT(reverse[i], map.getCurve(true)[i]);
+    }
+
+    TEST_ASSERT_TRUE(MotorCalibrator::erase());
+    StandRig erased;
+    TEST_ASSERT_FALSE(erased.calibrator.load());
+    TEST_ASSERT_FALSE(erased.calibrator.save());  // Nothing calibrated to save
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_identity_passes_commands_through);
+    RUN_TEST(test_map_interpolates_grid_and_ramps_through_deadband);
+    RUN_TEST(test_invalid_curves_are_rejected);
+    RUN_TEST(test_fit_inverts_linear_sweep);
+    RUN_TEST(test_fit_fails_without_motion_or_headroom);
+    RUN_TEST(test_fitted_maps_equalize_mismatched_wheels);
+    RUN_TEST(test_calibrator_sweep_equalizes_wheels);
+    RUN_TEST(test_stop_aborts_and_restores_previous_maps);
+    RUN_TEST(test_stalled_wheel_aborts_with_no_motion);
+    RUN_TEST(test_published_maps_follow_the_motors);
+    RUN_TEST(test_sweep_leaves_the_pose_unchanged);
+    RUN_TEST(test_saved_maps_load_at_boot);
+    return UNITY_END();
+}
@@ -0,0 +1,120 @@
+/**
+ * Odometry host tests (env:native): straight runs, spins and arcs land on
+ * the geometric pose, the per-pulse constants match the formulas they
+ * replace, and gyro fusion follows the gyro short term without
+ * inheriting its bias.
+ */
+#include <unity.h>
+#include <math.h>
+#include "../../../src/odometry/odometry.h"
+
+static const float DT = BALANCE_LOOP_DT;
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_constants_match_wheel_geometry() {
+    float circumference = PI * WHEEL_DIAMETER_MM / 1000.0f;
+    TEST_ASSERT_FLOAT_WITHIN(1e-7f, circumference / ENCODER_PULSES_PER_REV, Odometry::METERS_PER_PULSE);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, Odometry::METERS_PER_PULSE / (WHEELBASE_MM / 1000.0f) * 180.0f / PI,
+                             Odometry::DEGREES_PER_PULSE_DIFFERENCE);
+}
+
+void test_straight_run_moves_along_x() {
+    Odometry odometry(0.0f);
+    for (long p = 1; p <= 40; p++) {
+        odometry.update(p, p, NAN, DT);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 40 * Odometry::METERS_PER_PULSE, odometry.getX());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, odometry.getY());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, odometry.getHeading());
+}
+
+void test_spin_in_place_turns_without_moving() {
+    Odometry odometry(0.0f);
+    for (long p = 1; p <= 10; p++) {
+        odometry.update(-p, p, NAN, DT);  // Right wheel forward: counter-clockwise
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 20 * Odometry::DEGREES_PER_PULSE_DIFFERENCE, odometry.getHeading());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, odometry.getX());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, odometry.getY());
+}
+
+void test_heading_is_not_wrapped() {
+    Odometry odometry(0.0f);
+    long pulses = (long)ceilf(720.0f / Odometry::DEGREES_PER_PULSE_DIFFERENCE / 2.0f);
+    odometry.update(pulses, -pulses, NAN, DT);
+    TEST_ASSERT_TRUE(odometry.getHeading() < -720.0f);
+}
+
+void test_left_arc_ends_left_of_start() {
+    // Right wheel three pulses for every left one: a left arc through about a quarter turn
+    Odometry odometry(0.0f);
+    long left = 0, right = 0;
+    while (odometry.getHeading() < 90.0f) {
+        left += 1;
+        right += 3;
+        odometry.update(left, right, NAN, DT);
+    }
+    TEST_ASSERT_TRUE(odometry.getX() > 0.0f);
+    TEST_ASSERT_TRUE(odometry.getY() > 0.0f);
+
+    // Chord of the arc: radius from the wheel travel, angle from the heading
+    float heading = odometry.getHeading() * (float)(PI / 180.0);
+    float radius = ((left + right) * 0.5f * Odometry::METERS_PER_PULSE) / heading;
+    TEST_ASSERT_FLOAT_WITHIN(0.02f * radius, radius * sinf(heading), odometry.getX());
+    TEST_ASSERT_FLOAT_WITHIN(0.02f * radius, radius * (1.0f - cosf(heading)), odometry.getY());
+}
+
+void test_reset_moves_origin_to_current_pose() {
+    Odometry odometry(0.0f);
+    odometry.update(10, 30, NAN, DT);
+    odometry.reset(10, 30);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, odometry.getHeading());
+    odometry.update(12, 32, NAN, DT);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2 * Odometry::METERS_PER_PULSE, odometry.getX());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, odometry.getY());
+}
+
+void test_gyro_fills_in_between_encoder_pulses() {
+    // Spin from the gyro alone: the encoder heading (no pulse yet) only slowly pulls it back
+    Odometry odometry(ODOMETRY_GYRO_WEIGHT);
+    for (int i = 0; i < 10; i++) {
+        odometry.update(0, 0, 90.0f, DT);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.3f, 9.0f, odometry.getHeading());
+}
+
+void test_gyro_bias_does_not_accumulate() {
+    // 0.5 deg/s residual bias over a minute standing still: bounded by w / (1 - w) * bias * dt
+    Odometry odometry(ODOMETRY_GYRO_WEIGHT);
+    for (int i = 0; i < 60 * BALANCE_LOOP_FREQ; i++) {
+        odometry.update(0, 0, 0.5f, DT);
+    }
+    float bound = ODOMETRY_GYRO_WEIGHT / (1.0f - ODOMETRY_GYRO_WEIGHT) * 0.5f * DT;
+    TEST_ASSERT_TRUE(odometry.getHeading() <= bound * 1.01f);
+    TEST_ASSERT_TRUE(odometry.getHeading() < 30.0f);  // Integration alone: 30 degrees
+}
+
+void test_nan_yaw_rate_uses_encoders() {
+    Odometry odometry(ODOMETRY_GYRO_WEIGHT);
+    odometry.update(0, 4, NAN, DT);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 4 * Odometry::DEGREES_PER_PULSE_DIFFERENCE, odometry.getHeading());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_constants_match_wheel_geometry);
+    RUN_TEST(test_straight_run_moves_along_x);
+    RUN_TEST(test_spin_in_place_turns_without_moving);
+    RUN_TEST(test_heading_is_not_wrapped);
+    RUN_TEST(test_left_arc_ends_left_of_start);
+    RUN_TEST(test_reset_moves_origin_to_current_pose);
+    RUN_TEST(test_gyro_fills_in_between_encoder_pulses);
+    RUN_TEST(test_gyro_bias_does_not_accumulate);
+    RUN_TEST(test_nan_yaw_rate_uses_encoders);
+    return UNITY_END();
+}
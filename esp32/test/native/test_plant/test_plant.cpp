@@ -0,0 +1,128 @@
+/**
+ * Plant model and closed-loop simulator tests (env:native): the physics
+ * falls and drives the right way round, the firmware controller holds it
+ * up with damping gains and not without, and a parallel sweep returns
+ * exactly what a serial one does.
+ */
+#include <unity.h>
+#include <vector>
+#include "../../../sim/sweep.h"
+
+// Gains that hold the default plant through the default scenario (from a sweep)
+static const float STABLE_KP = 0.3f;
+static const float STABLE_KI = 0.002f;
+static const float STABLE_KD = 0.02f;
+
+void setUp() {}
+
+void tearDown() {}
+
+static SimConfig quietConfig(float kp, float ki, float kd) {
+    SimConfig config = SimConfig::defaults();
+    config.kp = kp;
+    config.ki = ki;
+    config.kd = kd;
+    config.sensor_noise = false;
+    config.push_time = -1.0f;
+    config.command_time = -1.0f;
+    return config;
+}
+
+void test_upright_plant_at_rest_stays_put() {
+    PlantModel plant(PlantParameters::rover());
+    for (int i = 0; i < 1000; i++) {
+        plant.step(0.0f, 0.0f, 0.001f);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, plant.getPitch());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, plant.getTravel());
+}
+
+void test_tilted_plant_falls_the_way_it_leans() {
+    PlantModel plant(PlantParameters::rover());
+    plant.reset(2.0f);
+    for (int i = 0; i < 500; i++) {
+        plant.step(0.0f, 0.0f, 0.001f);
+    }
+    TEST_ASSERT_GREATER_THAN_FLOAT(20.0f, plant.getPitch());
+}
+
+void test_forward_duty_drives_forward_and_differential_duty_turns() {
+    PlantModel plant(PlantParameters::rover());
+    for (int i = 0; i < 100; i++) {
+        plant.step(0.5f, 0.5f, 0.001f);
+    }
+    TEST_ASSERT_GREATER_THAN_FLOAT(0.0f, plant.getSpeed());
+    TEST_ASSERT_LESS_THAN_FLOAT(0.0f, plant.getPitch());  // Reaction torque tips the body back
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, plant.getHeading());
+
+    plant.reset(0.0f);
+    for (int i = 0; i < 100; i++) {
+        plant.step(0.5f, -0.5f, 0.001f);
+    }
+    TEST_ASSERT_GREATER_THAN_FLOAT(0.0f, plant.getLeftTravel());
+    TEST_ASSERT_LESS_THAN_FLOAT(0.0f, plant.getRightTravel());
+}
+
+void test_zero_gains_fall() {
+    SimResult result = simulate(quietConfig(0.0f, 0.0f, 0.0f));
+    TEST_ASSERT_TRUE(result.fell);
+    TEST_ASSERT_LESS_THAN_FLOAT(2.0f, result.fall_time);
+    TEST_ASSERT_GREATER_THAN_FLOAT(1000.0f, result.cost);
+}
+
+void test_stable_gains_survive_default_scenario() {
+    SimConfig config = SimConfig::defaults();
+    config.kp = STABLE_KP;
+    config.ki = STABLE_KI;
+    config.kd = STABLE_KD;
+    SimResult result = simulate(config);
+    TEST_ASSERT_FALSE(result.fell);
+    TEST_ASSERT_LESS_THAN_FLOAT(2.0f, result.rms_pitch);
+    TEST_ASSERT_LESS_THAN_FLOAT(10.0f, result.max_pitch);
+    TEST_ASSERT_LESS_THAN_FLOAT(result.rms_pitch + 10.0f, result.cost);
+}
+
+void test_controller_settles_with_estimate_on_true_pitch() {
+    // From the 3 degree tilt to upright in 2 s, with the filter tracking the plant
+    ClosedLoopSim sim(quietConfig(STABLE_KP, STABLE_KI, STABLE_KD));
+    for (int i = 0; i < 200; i++) {
+        TEST_ASSERT_TRUE(sim.tick());
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 0.0f, sim.getPlant().getPitch());
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, sim.getPitchEstimate() - sim.getPlant().getPitch());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2.0f, sim.getTime());
+}
+
+void test_parallel_sweep_matches_serial() {
+    SimConfig base = SimConfig::defaults();
+    base.duration = 3.0f;
+    GainRange kp = {0.1f, 0.4f, 4};
+    GainRange ki = {0.0f, 0.004f, 2};
+    GainRange kd = {0.0f, 0.03f, 4};
+    std::vector<SimConfig> configs = gainGrid(base, kp, ki, kd);
+    TEST_ASSERT_EQUAL(32, configs.size());
+    TEST_ASSERT_EQUAL_FLOAT(0.4f, configs[24].kp);
+    TEST_ASSERT_EQUAL_FLOAT(0.03f, configs[3].kd);
+
+    std::vector<SimResult> serial = runSweep(configs, 1);
+    std::vector<SimResult> parallel = runSweep(configs, 4);
+    for (size_t i = 0; i < configs.size(); i++) {
+        TEST_ASSERT_EQUAL(serial[i].fell, parallel[i].fell);
+        TEST_ASSERT_EQUAL_MEMORY(&serial[i].cost, &parallel[i].cost, sizeof(float));
+        TEST_ASSERT_EQUAL_MEMORY(&serial[i].rms_pitch, &parallel[i].rms_pitch, sizeof(float));
+    }
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_upright_plant_at_rest_stays_put);
+    RUN_TEST(test_tilted_plant_falls_the_way_it_leans);
+    RUN_TEST(test_forward_duty_drives_forward_and_differential_duty_turns);
+    RUN_TEST(test_zero_gains_fall);
+    RUN_TEST(test_stable_gains_survive_default_scenario);
+    RUN_TEST(test_controller_settles_with_estimate_on_true_pitch);
+    RUN_TEST(test_parallel_sweep_matches_serial);
+    return UNITY_END();
+}
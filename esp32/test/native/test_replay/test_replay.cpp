@@ -0,0 +1,174 @@
+/**
+ * Log replay tests (env:native): a log recorded from the controller replays
+ * without a mismatch (directly and through CSV), a gain change or a
+ * decimated log is reported, and the control-task path (post / start /
+ * service / stop) only replays what was streamed after the start.
+ */
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <esp_timer.h>
+#include <native_shim.h>
+#include "../control_scenario.h"
+#include "../../../src/replay/log_replay.h"
+
+static TelemetrySample scenario_log[BALANCE_SCENARIO_TICKS];
+
+/**
+ * Record the balance scenario the way balanceTick() fills TelemetrySample.
+ */
+static void recordScenarioLog() {
+    native_shim::reset();
+    BalanceController controller(KP, KI, KD);
+    uint32_t noise = SCENARIO_SEED;
+    float position = 0.0f;
+    for (int tick = 0; tick < BALANCE_SCENARIO_TICKS; tick++) {
+        balanceScenarioCommand(tick, controller);
+        BalanceInput input = balanceScenarioInput(tick, noise, position);
+        native_shim::advanceMicros(BALANCE_LOOP_PERIOD_US);
+        TelemetrySample& sample = scenario_log[tick];
+        sample.time_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        sample.left_position = (int32_t)lroundf(input.wheel_position);
+        sample.right_position = (int32_t)lroundf(input.wheel_position * 0.9f);
+        sample.wheel_velocity = input.wheel_velocity;
+        float wheel_position = (sample.left_position + sample.right_position) / 2.0f;
+        controller.update(input.angle, input.rate, sample.wheel_velocity, wheel_position);
+        sample.angle = input.angle;
+        sample.angular_velocity = input.rate;
+        sample.motor_output = controller.getMotorOutput();
+        sample.velocity_setpoint = controller.getVelocitySetpoint();
+        sample.rotation_setpoint = controller.getRotationSetpoint();
+        sample.tick_us = 0;
+        sample.interval_us = BALANCE_LOOP_PERIOD_US;
+    }
+}
+
+void setUp() {
+    native_shim::reset();
+}
+
+void tearDown() {}
+
+void test_recorded_log_replays_exactly() {
+    BalanceController controller(KP, KI, KD);
+    LogReplay replay(&controller);
+    replay.begin();
+    for (int i = 0; i < BALANCE_SCENARIO_TICKS; i++) {
+        TEST_ASSERT_EQUAL_FLOAT(scenario_log[i].motor_output, replay.step(scenario_log[i]));
+    }
+    TEST_ASSERT_EQUAL_UINT32(BALANCE_SCENARIO_TICKS, replay.getSampleCount());
+    TEST_ASSERT_EQUAL_UINT32(0, replay.getMismatchCount());
+    TEST_ASSERT_EQUAL_UINT32(LogReplay::NO_MISMATCH, replay.getFirstMismatch());
+    TEST_ASSERT_EQUAL_UINT32(0, replay.getGapCount());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, replay.getMaxError());
+}
+
+void test_csv_round_trip_replays_exactly() {
+    BalanceController controller(KP, KI, KD);
+    LogReplay replay(&controller);
+    replay.begin();
+    TelemetrySample header;
+    TEST_ASSERT_FALSE(LogReplay::parseCsv("time_ms,angle,angular_velocity,motor_output\n", header));
+
+    for (int i = 0; i < BALANCE_SCENARIO_TICKS; i++) {
+        const TelemetrySample& s = scenario_log[i];
+        char line[256];
+        // Same columns as scripts/capture_telemetry.py writes
+        snprintf(line, sizeof(line), "%u,%.9g,%.9g,%.9g,%.9g,%.9g,%d,%d,%u,%u,%.9g\r\n", (unsigned)s.time_ms,
+                 (double)s.angle, (double)s.angular_velocity, (double)s.motor_output, (double)s.velocity_setpoint,
+                 (double)s.rotation_setpoint, (int)s.left_position, (int)s.right_position, (unsigned)s.tick_us,
+                 (unsigned)s.interval_us, (double)s.wheel_velocity);
+        TelemetrySample parsed;
+        TEST_ASSERT_TRUE_MESSAGE(LogReplay::parseCsv(line, parsed), line);
+        replay.step(parsed);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, replay.getMismatchCount());
+}
+
+void test_log_analysis_columns_only() {
+    TelemetrySample sample;
+    TEST_ASSERT_TRUE(LogReplay::parseCsv("1200, 1.5, -2.25, 0.125, 0.4, -0.3\n", sample));
+    TEST_ASSERT_EQUAL_UINT32(1200, sample.time_ms);
+    TEST_ASSERT_EQUAL_FLOAT(-2.25f, sample.angular_velocity);
+    TEST_ASSERT_EQUAL_FLOAT(-0.3f, sample.rotation_setpoint);
+    TEST_ASSERT_EQUAL_INT32(0, sample.left_position);
+    TEST_ASSERT_TRUE(isnan(sample.wheel_velocity));
+    TEST_ASSERT_FALSE(LogReplay::parseCsv("1200,1.5,-2.25,0.125,0.4\n", sample));
+    TEST_ASSERT_FALSE(LogReplay::parseCsv("\n", sample));
+}
+
+void test_gain_change_is_reported() {
+    BalanceController controller(KP * 1.5f, KI, KD);
+    LogReplay replay(&controller);
+    replay.begin();
+    for (int i = 0; i < BALANCE_SCENARIO_TICKS; i++) {
+        replay.step(scenario_log[i]);
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(BALANCE_SCENARIO_TICKS / 2, replay.getMismatchCount());
+    TEST_ASSERT_LESS_THAN_UINT32(10, replay.getFirstMismatch());
+    TEST_ASSERT_GREATER_THAN_FLOAT(REPLAY_TOLERANCE, replay.getRmsError());
+}
+
+void test_decimated_log_counts_gaps() {
+    BalanceController controller(KP, KI, KD);
+    LogReplay replay(&controller);
+    replay.begin();
+    for (int i = 0; i < 100; i += 2) {
+        replay.step(scenario_log[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(50, replay.getSampleCount());
+    TEST_ASSERT_EQUAL_UINT32(49, replay.getGapCount());
+}
+
+void test_control_task_replays_only_samples_after_start() {
+    BalanceController controller(KP, KI, KD);
+    LogReplay replay(&controller);
+    TEST_ASSERT_FALSE(replay.service());  // Idle: balanceTick() runs
+
+    replay.post(scenario_log[0]);  // Stale: queued before the start request
+    replay.requestStart();
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(replay.post(scenario_log[i]));
+    }
+    TEST_ASSERT_TRUE(replay.service());
+    TEST_ASSERT_TRUE(replay.isActive());
+    TEST_ASSERT_EQUAL_UINT32(REPLAY_SAMPLES_PER_TICK, replay.getSampleCount());
+    TEST_ASSERT_TRUE(replay.service());
+    TEST_ASSERT_EQUAL_UINT32(100, replay.getSampleCount());
+    TEST_ASSERT_EQUAL_UINT32(0, replay.getMismatchCount());
+
+    replay.requestStop();
+    TEST_ASSERT_TRUE(replay.service());  // The stopping tick is still a replay tick
+    TEST_ASSERT_FALSE(replay.isActive());
+    TEST_ASSERT_FALSE(replay.service());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, controller.getVelocitySetpoint());
+    TEST_ASSERT_EQUAL_UINT32(100, replay.getSampleCount());  // Kept for the status reply
+}
+
+void test_full_queue_drops_and_counts() {
+    BalanceController controller(KP, KI, KD);
+    LogReplay replay(&controller);
+    replay.requestStart();
+    replay.service();
+    for (int i = 0; i < REPLAY_QUEUE_SIZE; i++) {
+        TEST_ASSERT_TRUE(replay.post(scenario_log[i]));
+    }
+    TEST_ASSERT_FALSE(replay.post(scenario_log[REPLAY_QUEUE_SIZE]));
+    TEST_ASSERT_EQUAL_UINT32(1, replay.getDroppedCount());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    recordScenarioLog();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_recorded_log_replays_exactly);
+    RUN_TEST(test_csv_round_trip_replays_exactly);
+    RUN_TEST(test_log_analysis_columns_only);
+    RUN_TEST(test_gain_change_is_reported);
+    RUN_TEST(test_decimated_log_counts_gaps);
+    RUN_TEST(test_control_task_replays_only_samples_after_start);
+    RUN_TEST(test_full_queue_drops_and_counts);
+    return UNITY_END();
+}
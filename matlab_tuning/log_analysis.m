@@ -3,28 +3,24 @@
 % This is THE MOST PRACTICAL script - use after hardware works
 %
 % What to look for:
-%   - Motor saturation (output hitting ±255)
+%   - Motor saturation (normalized output hitting ±1)
 %   - Oscillations (too much Kp or not enough Kd)
 %   - Slow recovery (not enough Kp)
 %   - Steady-state error (need more Ki)
 %
 % How to use:
-%   1. Add logging to ESP32 main.cpp (see instructions below)
-%   2. Run rover, save serial output to CSV file
+%   1. Capture telemetry: python scripts/capture_telemetry.py -o rover_log.csv
+%   2. Run rover, Ctrl+C to stop (CSV written by the script)
 %   3. Load CSV here and analyze
 
 clear; close all; clc;
 
 %% Instructions for Data Collection
 fprintf('=== Data Collection Instructions ===\n');
-fprintf('Add this to ESP32 main.cpp inside the balance loop:\n\n');
-fprintf('  Serial.print(millis()); Serial.print(\",\");\n');
-fprintf('  Serial.print(angle); Serial.print(\",\");\n');
-fprintf('  Serial.print(angular_velocity); Serial.print(\",\");\n');
-fprintf('  Serial.print(motorOutput); Serial.print(\",\");\n');
-fprintf('  Serial.print(velocity_setpoint); Serial.print(\",\");\n');
-fprintf('  Serial.print(rotation_setpoint); Serial.println();\n\n');
-fprintf('Then: pio device monitor > log.csv\n');
+fprintf('Stream binary telemetry from the ESP32 and decode it to CSV:\n\n');
+fprintf('  python scripts/capture_telemetry.py --decimation 1 -o rover_log.csv\n\n');
+fprintf('Columns 1-6: time_ms, angle, angular_velocity, motor_output,\n');
+fprintf('             velocity_setpoint, rotation_setpoint (extra columns ignored)\n');
 fprintf('Run rover for 10-30 seconds, then Ctrl+C\n\n');
 
 %% Load Data
@@ -39,7 +35,7 @@ if ~exist(log_file, 'file')
     t = (0:0.01:10)';
     angle = 5*sin(2*pi*0.5*t) .* exp(-0.2*t) + randn(size(t))*0.5;
     angular_velocity = gradient(angle) / 0.01;
-    motor_output = -40*angle - 2*angular_velocity + randn(size(t))*10;
+    motor_output = -0.157*angle - 0.00784*angular_velocity + randn(size(t))*0.04;
     velocity_setpoint = zeros(size(t));
     rotation_setpoint = zeros(size(t));
     
@@ -85,15 +81,15 @@ ylabel('Angular Velocity (deg/s)');
 subplot(3,1,3);
 plot(time, motor_output, 'r-', 'LineWidth', 1.5);
 hold on;
-yline(255, 'k--', 'LineWidth', 1, 'DisplayName', 'Saturation');
-yline(-255, 'k--', 'LineWidth', 1);
+yline(1, 'k--', 'LineWidth', 1, 'DisplayName', 'Saturation');
+yline(-1, 'k--', 'LineWidth', 1);
 grid on;
-ylabel('Motor Output');
+ylabel('Motor Output (normalized)');
 xlabel('Time (s)');
 legend('Motor Command', 'Saturation Limits');
 
 %% Analysis: Saturation
-saturation_pct = sum(abs(motor_output) >= 255) / length(motor_output) * 100;
+saturation_pct = sum(abs(motor_output) >= 1) / length(motor_output) * 100;
 fprintf('=== Saturation Analysis ===\n');
 fprintf('Motor saturated %.1f%% of the time\n', saturation_pct);
 if saturation_pct > 10
@@ -107,7 +103,7 @@ fprintf('\n');
 
 %% Analysis: Oscillations
 % Detect oscillations using FFT
-Fs = 100;  % Sample rate (Hz)
+Fs = 1000 / median(diff(time_ms));  % Sample rate (Hz): 100 / telemetry decimation
 L = length(angle);
 Y = fft(angle);
 P2 = abs(Y/L);
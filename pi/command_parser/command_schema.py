@@ -1,6 +1,6 @@
 """Command schema definitions for voice_rover."""
 
-from enum import Enum
+from enum import Enum, IntEnum
 from dataclasses import dataclass
 from typing import Optional, Dict, Any
 
@@ -29,6 +29,40 @@ class CommandType(Enum):
     # Advanced commands (expanded to sequences)
     DANCE = "dance"
 
+    # Diagnostic commands (sent by tooling, never produced by the voice parser)
+    STATS = "stats"
+    TELEMETRY = "telemetry"
+    RECORDER = "recorder"
+    PWM = "pwm"
+    GAINS = "gains"
+    AUTOTUNE = "autotune"
+    SYNC = "sync"  # Restart transport sequence numbering (SerialInterface.enable_pipelining)
+
+    # Uploaded segment sequence, run on the ESP32 (see program_compiler.py)
+    PROGRAM = "program"
+
+
+class ResponseCode(IntEnum):
+    """Status codes in the "code" field of ESP32 JSON responses.
+
+    Mirror of esp32/src/command_handler/response_codes.h (values never renumbered).
+    """
+
+    OK = 0
+    CLAMPED = 1  # Accepted with speed clamped; reply carries "speed" and "requested"
+    PARSE_ERROR = 2
+    INVALID_COMMAND = 3
+    UNKNOWN_COMMAND = 4
+    INVALID_PARAMETER = 5
+    NOT_IMPLEMENTED = 6
+    QUEUE_FULL = 7
+    BUSY = 8
+    NOT_AVAILABLE = 9
+    LINE_TOO_LONG = 10
+    FAILED = 11
+    DUPLICATE = 12  # Sequence number already acknowledged: not executed again
+    OUT_OF_ORDER = 13  # Sequence gap: dropped, resend from "ack" + 1
+
 
 @dataclass
 class Command:
@@ -37,6 +71,7 @@ class Command:
     command_type: CommandType
     parameters: Dict[str, Any]
     priority: int = 0  # Higher priority commands execute first (STOP has highest)
+    seq: Optional[int] = None  # Transport sequence number, assigned by SerialInterface when pipelining
 
     def to_json(self) -> Dict[str, Any]:
         """Convert command to JSON format for serial transmission.
@@ -44,11 +79,14 @@ class Command:
         Returns:
             Dictionary representation of command
         """
-        return {
+        message = {
             "command": self.command_type.value,
             "parameters": self.parameters,
             "priority": self.priority
         }
+        if self.seq is not None:
+            message["seq"] = self.seq
+        return message
 
 
 # Priority levels
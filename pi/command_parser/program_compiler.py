@@ -0,0 +1,162 @@
+"""Compile consecutive motion commands into one on-board program.
+
+A compound utterance ("turn left then move forward for 2 seconds then spin")
+parses into several commands. Sent one by one, the Pi must stay attached
+for the whole routine. Commands with a bounded length are instead packed
+into a single "program" command, uploaded in one line and run by the
+ESP32's motion executor with no further traffic.
+
+Step format mirrors esp32/src/command_handler/motion_patterns.h
+(decodeProgramStep): 4 bytes per segment, hex encoded.
+
+The built-in routines (make_square, make_star, dance, ...) are already
+stored in ESP32 flash and stay single commands.
+"""
+
+import struct
+from typing import List, Optional
+
+from .command_schema import Command, CommandType, PRIORITY_NORMAL
+
+# Must match PROGRAM_MAX_STEPS in esp32/include/config.h
+MAX_PROGRAM_STEPS = 16
+
+# Segment kinds (MotionSegmentKind)
+SEGMENT_TIMED = 0     # Target in seconds
+SEGMENT_DISTANCE = 1  # Target in meters
+SEGMENT_ANGLE = 2     # Target in degrees
+
+# [kind | drive << 2 | turn << 4][speed %][uint16 target / 100]
+PROGRAM_STEP = struct.Struct("<BBH")
+MAX_TARGET = 0xFFFF / 100.0
+
+# Firmware defaults for absent parameters (motion_patterns.cpp)
+DEFAULT_SPEED = 0.4
+DEFAULT_DURATION = 1.0
+DEFAULT_ANGLE = 90.0
+DEFAULT_SPIN_SPEED = 0.5
+DEFAULT_SPIN_DURATION = 2.0
+
+
+def encode_step(kind: int, drive: int, turn: int, target: float, speed: float) -> bytes:
+    """Pack one program segment.
+
+    Args:
+        kind: SEGMENT_TIMED, SEGMENT_DISTANCE or SEGMENT_ANGLE
+        drive: +1 forward, -1 backward, 0 none
+        turn: +1 clockwise, -1 counterclockwise, 0 none
+        target: Seconds, meters or degrees (0 to MAX_TARGET)
+        speed: 0.0-1.0
+
+    Returns:
+        PROGRAM_STEP bytes
+    """
+    header = kind | ((drive & 0x03) << 2) | ((turn & 0x03) << 4)
+    percent = int(round(max(0.0, min(1.0, speed)) * 100))
+    if percent == 0 and (drive or turn):
+        percent = 1  # 0 means "program speed parameter" on the ESP32
+    return PROGRAM_STEP.pack(header, percent, int(round(abs(target) * 100)))
+
+
+def _param(command: Command, name: str, default: Optional[float]) -> Optional[float]:
+    value = command.parameters.get(name, default)
+    if value is None or isinstance(value, bool) or not isinstance(value, (int, float)):
+        return None
+    return float(value)
+
+
+def compile_steps(command: Command) -> Optional[bytes]:
+    """Compile one command into program segments.
+
+    Args:
+        command: Parsed command
+
+    Returns:
+        Encoded segments, or None if the command has no bounded program form
+        (open-ended primitives, built-in routines, diagnostics)
+    """
+    kind = command.command_type
+    speed = _param(command, "speed", DEFAULT_SPEED)
+    if speed is None:
+        return None
+
+    if kind in (CommandType.MOVE_FORWARD, CommandType.MOVE_BACKWARD):
+        if "duration" not in command.parameters:
+            return None  # Holds its setpoint until changed
+        step = (SEGMENT_TIMED, 1 if kind == CommandType.MOVE_FORWARD else -1, 0,
+                _param(command, "duration", None))
+    elif kind in (CommandType.MOVE_FORWARD_FOR_TIME, CommandType.MOVE_BACKWARD_FOR_TIME):
+        step = (SEGMENT_TIMED, 1 if kind == CommandType.MOVE_FORWARD_FOR_TIME else -1, 0,
+                _param(command, "duration", DEFAULT_DURATION))
+    elif kind in (CommandType.ROTATE_CLOCKWISE, CommandType.ROTATE_COUNTERCLOCKWISE):
+        if "angle" not in command.parameters:
+            return None
+        step = (SEGMENT_ANGLE, 0, 1 if kind == CommandType.ROTATE_CLOCKWISE else -1,
+                _param(command, "angle", None))
+    elif kind in (CommandType.TURN_LEFT, CommandType.TURN_RIGHT):
+        step = (SEGMENT_ANGLE, 0, 1 if kind == CommandType.TURN_RIGHT else -1,
+                _param(command, "angle", DEFAULT_ANGLE))
+    elif kind == CommandType.SPIN:
+        speed = _param(command, "speed", DEFAULT_SPIN_SPEED)
+        step = (SEGMENT_TIMED, 0, 1, _param(command, "duration", DEFAULT_SPIN_DURATION))
+    else:
+        return None
+
+    segment_kind, drive, turn, target = step
+    if speed is None or target is None or not 0.0 <= abs(target) <= MAX_TARGET:
+        return None
+    return encode_step(segment_kind, drive, turn, target, speed)
+
+
+def build_program(steps: List[bytes], priority: int = PRIORITY_NORMAL) -> Command:
+    """Wrap encoded segments in a "program" command.
+
+    Args:
+        steps: Encoded segments (at most MAX_PROGRAM_STEPS)
+        priority: Command priority
+
+    Returns:
+        Program command
+    """
+    if not 1 <= len(steps) <= MAX_PROGRAM_STEPS:
+        raise ValueError(f"program needs 1-{MAX_PROGRAM_STEPS} steps, got {len(steps)}")
+    return Command(CommandType.PROGRAM, {"steps": b"".join(steps).hex()}, priority)
+
+
+def compile_commands(commands: List[Command]) -> List[Command]:
+    """Merge runs of bounded motion commands into programs.
+
+    Order is preserved. Runs of two or more compilable commands with the same
+    priority become one program (split every MAX_PROGRAM_STEPS segments);
+    everything else passes through unchanged.
+
+    Args:
+        commands: Parsed commands in execution order
+
+    Returns:
+        Commands to enqueue
+    """
+    result: List[Command] = []
+    run: List[Command] = []
+    run_steps: List[bytes] = []
+
+    def flush_run():
+        if len(run) >= 2:
+            for start in range(0, len(run_steps), MAX_PROGRAM_STEPS):
+                result.append(build_program(run_steps[start:start + MAX_PROGRAM_STEPS], run[0].priority))
+        else:
+            result.extend(run)
+        run.clear()
+        run_steps.clear()
+
+    for command in commands:
+        steps = compile_steps(command)
+        if steps is None or (run and command.priority != run[0].priority):
+            flush_run()
+        if steps is None:
+            result.append(command)
+        else:
+            run.append(command)
+            run_steps.append(steps)
+    flush_run()
+    return result
@@ -19,10 +19,15 @@ WHISPER_LANGUAGE = "en"
 SERIAL_PORT = "/dev/ttyUSB0"
 SERIAL_BAUDRATE = 115200
 SERIAL_TIMEOUT = 1.0
+SERIAL_WINDOW = 8             # Sequenced commands in flight before send_command() waits for ACKs
+SERIAL_ACK_TIMEOUT = 0.5      # Seconds without an ACK before in-flight commands are resent
+SERIAL_MAX_RETRIES = 3        # Resends before in-flight commands are abandoned
+SERIAL_RESEND_HOLDOFF = 0.05  # Minimum seconds between go-back-N resends (ignores the rest of a NAK burst)
 
 # Command queue settings
 MAX_QUEUE_SIZE = 100
 COMMAND_TIMEOUT = 5.0
+PROGRAM_UPLOAD = True  # Send runs of bounded motions as one on-board "program" (needs matching firmware)
 
 # Audio capture settings
 AUDIO_CAPTURE_DURATION = 8.0  # Duration in seconds to capture audio after wake word
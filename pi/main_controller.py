@@ -17,10 +17,12 @@ from .command_parser.parser import CommandParser
 from .command_queue.queue_manager import CommandQueueManager
 from .serial_comm.serial_interface import SerialInterface
 from .command_parser.command_schema import Command, CommandType, PRIORITY_STOP
+from .command_parser.program_compiler import compile_commands
 from .config import (
     SAMPLE_RATE, AUDIO_CHANNELS, WAKE_WORD, WAKE_WORD_SENSITIVITY,
     WHISPER_MODEL_SIZE, MAX_QUEUE_SIZE, SERIAL_PORT, SERIAL_BAUDRATE,
-    COMMAND_TIMEOUT, AUDIO_CAPTURE_DURATION, LOG_LEVEL, LOG_FORMAT
+    COMMAND_TIMEOUT, AUDIO_CAPTURE_DURATION, LOG_LEVEL, LOG_FORMAT, SERIAL_WINDOW,
+    PROGRAM_UPLOAD
 )
 
 
@@ -63,6 +65,8 @@ class VoiceRoverController:
                 self.logger.warning("Serial connection failed on startup, will retry in executor")
             else:
                 self.logger.info("Serial connection established")
+                self.serial.enable_pipelining()
+            self.serial.start_reader()  # Picks up the link whenever the executor reconnects
             
             # 2. Load Whisper model (blocking, critical dependency)
             try:
@@ -158,6 +162,7 @@ class VoiceRoverController:
             self.logger.error(f"Error unloading Whisper model: {e}")
         
         try:
+            self.serial.stop_reader()
             self.serial.disconnect()
         except Exception as e:
             self.logger.error(f"Error disconnecting serial: {e}")
@@ -226,6 +231,10 @@ class VoiceRoverController:
                 self.logger.warning("No commands parsed from transcription")
                 return
             
+            # Bounded motions run back to back on the ESP32 from one upload
+            if PROGRAM_UPLOAD:
+                commands = compile_commands(commands)
+            
             # Process each command
             for cmd in commands:
                 if cmd.command_type == CommandType.STOP:
@@ -252,7 +261,10 @@ class VoiceRoverController:
     def _command_executor_loop(self) -> None:
         """Continuously execute commands from queue.
         
-        Dequeues commands sequentially and sends them to ESP32 via serial.
+        Dequeues commands in priority order and sends them to ESP32 via serial.
+        With pipelining, everything already queued (up to SERIAL_WINDOW) goes
+        out back to back before the replies are read, so a parsed sentence
+        reaches the ESP32 in one burst instead of one round trip per command.
         Reads and logs responses. Handles errors gracefully without crashing.
         """
         while self._running:
@@ -261,11 +273,26 @@ class VoiceRoverController:
                 command = self.queue.dequeue(timeout=1.0)
                 
                 if command:
-                    self.logger.info(f"Executing command: {command.command_type}")
+                    batch = [command]
+                    if self.serial.is_pipelined():
+                        while len(batch) < SERIAL_WINDOW and not self.queue.is_empty():
+                            extra = self.queue.dequeue(timeout=0)
+                            if extra is None:
+                                break
+                            batch.append(extra)
+                    
+                    sent = 0
+                    for command in batch:
+                        self.logger.info(f"Executing command: {command.command_type}")
+                        
+                        # Send to ESP32 (SerialInterface handles retries)
+                        if self.serial.send_command(command):
+                            sent += 1
+                        else:
+                            self.logger.error("Failed to send command to ESP32")
                     
-                    # Send to ESP32 (SerialInterface handles retries)
-                    if self.serial.send_command(command):
-                        # Read response (non-blocking with timeout)
+                    # Replies arrive in command order
+                    for _ in range(sent):
                         response = self.serial.read_response(
                             blocking=True,
                             timeout=COMMAND_TIMEOUT
@@ -274,8 +301,6 @@ class VoiceRoverController:
                             self.logger.info(f"ESP32 response: {response}")
                         else:
                             self.logger.warning("No response from ESP32")
-                    else:
-                        self.logger.error("Failed to send command to ESP32")
             
             except Exception as e:
                 self.logger.error(f"Error in command executor: {e}", exc_info=True)
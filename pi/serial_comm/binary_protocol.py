@@ -0,0 +1,305 @@
+"""Compact binary framing for commands to the ESP32.
+
+Mirror of esp32/src/comms/binary_protocol.h and command_ids.h: keep in sync.
+
+FRAME: [0xA5][opcode][payload][crc16 lo][crc16 hi]
+PAYLOAD: Fixed size per opcode, little-endian
+CRC: CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over opcode + payload
+OPCODES: Command ids (never renumbered); device -> Pi opcodes have bit 7 set
+
+0xA5 never occurs in ASCII JSON, so frames and JSON lines share one stream.
+"""
+
+import math
+import struct
+from typing import Optional, Dict, Any, List, Tuple
+from ..command_parser.command_schema import Command, CommandType, PRIORITY_STOP
+
+
+FRAME_START = 0xA5
+FRAME_OVERHEAD = 4  # start + opcode + crc16
+PROTOCOL_VERSION = 4  # binary_mode handshake reply; 2 adds sequence numbers, 3 wheel_velocity in telemetry, 4 odometry pose
+
+OPCODES = {
+    CommandType.MOVE_FORWARD: 0x01,
+    CommandType.MOVE_BACKWARD: 0x02,
+    CommandType.ROTATE_CLOCKWISE: 0x03,
+    CommandType.ROTATE_COUNTERCLOCKWISE: 0x04,
+    CommandType.STOP: 0x05,
+    CommandType.TURN_LEFT: 0x10,
+    CommandType.TURN_RIGHT: 0x11,
+    CommandType.MOVE_FORWARD_FOR_TIME: 0x12,
+    CommandType.MOVE_BACKWARD_FOR_TIME: 0x13,
+    CommandType.MAKE_SQUARE: 0x14,
+    CommandType.MAKE_CIRCLE: 0x15,
+    CommandType.MAKE_STAR: 0x16,
+    CommandType.ZIGZAG: 0x17,
+    CommandType.SPIN: 0x18,
+    CommandType.DANCE: 0x19,
+}
+COMMAND_NAMES = {opcode: command_type.value for command_type, opcode in OPCODES.items()}
+
+OP_STOP = OPCODES[CommandType.STOP]
+OP_JSON_MODE = 0x21
+OP_RESPONSE = 0x80
+OP_TELEMETRY = 0x81
+OP_RECORDER = 0x82  # Flight recorder dump: same payload as OP_TELEMETRY
+OP_REPLAY_SAMPLE = 0x2B  # Pi -> ESP32 log replay stream: same payload as OP_TELEMETRY, never answered
+
+# Motion payload: speed, duration, angle, distance (NaN = absent); repetitions, direction; seq (0 = none)
+COMMAND_PAYLOAD = struct.Struct("<ffffBBH")
+# Response payload: success, command id, response code; seq (0 = none), cumulative ack
+RESPONSE_PAYLOAD = struct.Struct("<BBBHH")
+
+# Telemetry sample (esp32/src/telemetry/telemetry.h TelemetrySample)
+TELEMETRY_SAMPLE = struct.Struct("<IfffffiiHHffff")
+# First six columns are the log_analysis.m CSV layout; the rest are extras
+TELEMETRY_FIELDS = (
+    "time_ms",
+    "angle",
+    "angular_velocity",
+    "motor_output",
+    "velocity_setpoint",
+    "rotation_setpoint",
+    "left_position",
+    "right_position",
+    "tick_us",
+    "interval_us",
+    "wheel_velocity",
+    "x",
+    "y",
+    "heading",
+)
+
+PAYLOAD_SIZES = {opcode: COMMAND_PAYLOAD.size for opcode in OPCODES.values()}
+PAYLOAD_SIZES[OP_STOP] = 0
+PAYLOAD_SIZES[OP_JSON_MODE] = 0
+PAYLOAD_SIZES[OP_RESPONSE] = RESPONSE_PAYLOAD.size
+PAYLOAD_SIZES[OP_TELEMETRY] = TELEMETRY_SAMPLE.size
+PAYLOAD_SIZES[OP_RECORDER] = TELEMETRY_SAMPLE.size
+PAYLOAD_SIZES[OP_REPLAY_SAMPLE] = TELEMETRY_SAMPLE.size
+
+# Pattern size parameters share the distance slot (ESP32 checks them in this order)
+DISTANCE_KEYS = ("side_length", "radius", "size", "segment_length")
+
+# parse_frame() status values
+FRAME_OK = "ok"
+FRAME_INCOMPLETE = "incomplete"
+FRAME_INVALID = "invalid"
+
+
+def crc16_ccitt(data: bytes, crc: int = 0xFFFF) -> int:
+    """Compute CRC-16/CCITT-FALSE.
+
+    Args:
+        data: Bytes to checksum
+        crc: Running CRC (0xFFFF to start)
+
+    Returns:
+        16-bit CRC
+    """
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def encode_frame(opcode: int, payload: bytes = b"") -> bytes:
+    """Build a complete frame.
+
+    Args:
+        opcode: Frame opcode
+        payload: Payload bytes (size must match PAYLOAD_SIZES)
+
+    Returns:
+        Frame bytes
+    """
+    body = bytes([opcode]) + payload
+    return bytes([FRAME_START]) + body + struct.pack("<H", crc16_ccitt(body))
+
+
+def _float_param(parameters: Dict[str, Any], key: str) -> float:
+    value = parameters.get(key)
+    if isinstance(value, bool) or not isinstance(value, (int, float)):
+        return math.nan
+    return float(value)
+
+
+def encode_command(command: Command) -> Optional[bytes]:
+    """Encode a command as a binary frame.
+
+    Args:
+        command: Command to encode
+
+    Returns:
+        Frame bytes, or None if the command has no binary opcode (send as JSON)
+    """
+    if command.command_type == CommandType.STOP or command.priority == PRIORITY_STOP:
+        return encode_frame(OP_STOP)
+
+    opcode = OPCODES.get(command.command_type)
+    if opcode is None:
+        return None
+
+    params = command.parameters
+    speed = params.get("speed")
+    if speed is not None and (isinstance(speed, bool) or not isinstance(speed, (int, float))):
+        return None  # Let the ESP32 reject it with a descriptive JSON error
+
+    distance = math.nan
+    for key in DISTANCE_KEYS:
+        if key in params:
+            distance = _float_param(params, key)
+            break
+
+    repetitions = params.get("repetitions", 0)
+    repetitions = max(0, min(255, int(repetitions))) if isinstance(repetitions, (int, float)) else 0
+    direction = 1 if params.get("direction") == "right" else 0
+
+    payload = COMMAND_PAYLOAD.pack(
+        _float_param(params, "speed"),
+        _float_param(params, "duration"),
+        _float_param(params, "angle"),
+        distance,
+        repetitions,
+        direction,
+        command.seq or 0,
+    )
+    return encode_frame(opcode, payload)
+
+
+def parse_frame(buffer: bytes, start: int = 0) -> Tuple[str, int, int, bytes]:
+    """Parse a frame beginning at buffer[start] (which must be FRAME_START).
+
+    Args:
+        buffer: Received bytes
+        start: Index of the FRAME_START byte
+
+    Returns:
+        (status, end, opcode, payload): end is the index just past the frame
+        when status is FRAME_OK
+    """
+    if len(buffer) < start + 2:
+        return FRAME_INCOMPLETE, start, 0, b""
+
+    opcode = buffer[start + 1]
+    size = PAYLOAD_SIZES.get(opcode)
+    if size is None:
+        return FRAME_INVALID, start, opcode, b""
+
+    end = start + FRAME_OVERHEAD + size
+    if len(buffer) < end:
+        return FRAME_INCOMPLETE, start, opcode, b""
+
+    body = buffer[start + 1:end - 2]
+    (crc,) = struct.unpack("<H", buffer[end - 2:end])
+    if crc != crc16_ccitt(body):
+        return FRAME_INVALID, start, opcode, b""
+
+    return FRAME_OK, end, opcode, bytes(body[1:])
+
+
+def split_stream(buffer: bytes) -> Tuple[List[Tuple[int, bytes]], bytes, bytes]:
+    """Separate complete frames from the text (JSON lines) around them.
+
+    Args:
+        buffer: Received bytes
+
+    Returns:
+        (frames, text, remaining): frames as (opcode, payload) in arrival
+        order, text bytes outside frames, and the unparsed tail (a partial frame)
+    """
+    frames = []
+    text = bytearray()
+    position = 0
+    start = buffer.find(bytes([FRAME_START]))
+    while start != -1:
+        status, end, opcode, payload = parse_frame(buffer, start)
+        if status == FRAME_INCOMPLETE:
+            text += buffer[position:start]
+            return frames, bytes(text), bytes(buffer[start:])
+        if status == FRAME_OK:
+            text += buffer[position:start]
+            frames.append((opcode, payload))
+            position = end
+            start = buffer.find(bytes([FRAME_START]), end)
+        else:
+            # Stray start byte or corrupt frame: skip the start byte
+            text += buffer[position:start]
+            position = start + 1
+            start = buffer.find(bytes([FRAME_START]), position)
+    text += buffer[position:]
+    return frames, bytes(text), b""
+
+
+def decode_telemetry(payload: bytes) -> Dict[str, Any]:
+    """Decode a telemetry frame payload.
+
+    Args:
+        payload: OP_TELEMETRY or OP_RECORDER payload
+
+    Returns:
+        Dictionary keyed by TELEMETRY_FIELDS
+    """
+    return dict(zip(TELEMETRY_FIELDS, TELEMETRY_SAMPLE.unpack(payload)))
+
+
+def encode_replay_sample(sample: Dict[str, Any]) -> bytes:
+    """Encode a logged sample as an OP_REPLAY_SAMPLE frame.
+
+    Args:
+        sample: Values keyed by TELEMETRY_FIELDS (numbers or CSV strings); the
+            first six are required, missing extras are 0 and a missing
+            wheel_velocity is NaN (the ESP32 then derives it from the positions)
+
+    Returns:
+        Frame bytes
+    """
+    def number(field, default=0.0):
+        value = sample.get(field)
+        return default if value is None or value == "" else float(value)
+
+    payload = TELEMETRY_SAMPLE.pack(
+        int(number("time_ms")) & 0xFFFFFFFF,
+        number("angle"),
+        number("angular_velocity"),
+        number("motor_output"),
+        number("velocity_setpoint"),
+        number("rotation_setpoint"),
+        int(round(number("left_position"))),
+        int(round(number("right_position"))),
+        max(0, min(0xFFFF, int(number("tick_us")))),
+        max(0, min(0xFFFF, int(number("interval_us")))),
+        number("wheel_velocity", math.nan),
+        number("x"),
+        number("y"),
+        number("heading"),
+    )
+    return encode_frame(OP_REPLAY_SAMPLE, payload)
+
+
+def decode_frame(opcode: int, payload: bytes) -> Optional[Dict[str, Any]]:
+    """Convert a device -> Pi frame into a response dictionary.
+
+    Args:
+        opcode: Frame opcode
+        payload: Frame payload
+
+    Returns:
+        Response dictionary (same "success" key as JSON responses), or None
+    """
+    if opcode == OP_RESPONSE:
+        success, command_id, code, seq, ack = RESPONSE_PAYLOAD.unpack(payload)
+        response = {
+            "success": bool(success),
+            "command": COMMAND_NAMES.get(command_id, command_id),
+            "code": code,
+        }
+        if seq:
+            response["seq"] = seq
+        if seq or ack:
+            response["ack"] = ack  # Sequenced link (JSON replies carry "ack" the same way)
+        return response
+    return None
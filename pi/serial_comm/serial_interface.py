@@ -2,12 +2,20 @@
 
 INTEGRATION POINT: Main controller uses send_command() to send commands
 INTEGRATION POINT: Command executor reads responses via read_response()
-PROTOCOL: Newline-delimited JSON
+PROTOCOL: Newline-delimited JSON; binary frames after enable_binary_mode()
+PIPELINING: After enable_pipelining(), commands carry sequence numbers and up to
+    `window` are in flight; the ESP32 answers with cumulative ACKs (go-back-N)
+READER: After start_reader(), a thread owns the port's read side: it frames
+    everything as it arrives, runs the ACK bookkeeping, wakes read_response()
+    and calls subscribe() callbacks (telemetry, recorder frames, replies)
 BAUDRATE: 115200
-STOP COMMAND: Bypasses queue, sent immediately
+STOP COMMAND: Bypasses queue, sent immediately (send_stop(): never waits on a
+    read, a full send window or a resync)
 """
 
-from typing import Optional, Dict, Any
+from collections import OrderedDict, deque
+from dataclasses import replace
+from typing import Optional, Dict, Any, Callable, Tuple
 import json
 import serial
 import serial.tools.list_ports
@@ -15,19 +23,145 @@ import time
 import threading
 import logging
 import glob
-from ..command_parser.command_schema import Command, PRIORITY_STOP
-from ..config import SERIAL_PORT, SERIAL_BAUDRATE, SERIAL_TIMEOUT
+from ..command_parser.command_schema import Command, CommandType, ResponseCode, PRIORITY_STOP
+from . import binary_protocol
+from ..config import (
+    SERIAL_PORT, SERIAL_BAUDRATE, SERIAL_TIMEOUT,
+    SERIAL_WINDOW, SERIAL_ACK_TIMEOUT, SERIAL_MAX_RETRIES, SERIAL_RESEND_HOLDOFF
+)
+
+SEQ_MAX = 0xFFFF  # Sequence numbers run 1..SEQ_MAX and wrap to 1 (0 = unsequenced)
+
+# subscribe() topics
+TOPIC_RESPONSE = "response"      # Every reply read_response() will return, as it is queued
+TOPIC_TELEMETRY = "telemetry"    # Decoded telemetry samples (binary_protocol.TELEMETRY_FIELDS)
+TOPIC_RECORDER = "recorder"      # Decoded flight recorder dump samples
+TOPICS = (TOPIC_RESPONSE, TOPIC_TELEMETRY, TOPIC_RECORDER)
+
+
+def next_seq(seq: int) -> int:
+    """Sequence number after seq (skips 0 on wrap)."""
+    return 1 if seq >= SEQ_MAX else seq + 1
+
+
+def seq_covered(seq: int, ack: int) -> bool:
+    """Check whether a cumulative ack includes seq (within half the sequence space)."""
+    if ack == 0:
+        return False
+    return (ack - seq) % SEQ_MAX < SEQ_MAX // 2
+
+
+class _InFlight:
+    """A sequenced command awaiting its ACK."""
+
+    __slots__ = ("command", "data", "sent_at")
+
+    def __init__(self, command: Command, data: bytes, sent_at: float):
+        self.command = command
+        self.data = data
+        self.sent_at = sent_at
+
+
+class _Framer:
+    """Splits the received byte stream into JSON lines and binary frames.
+
+    Bytes are appended to one bytearray and consumed through a read offset,
+    so a burst of messages costs one copy in and one copy out per message
+    (json.loads needs its own bytes) instead of re-slicing the remaining
+    buffer for each one. The consumed prefix is dropped once the buffer
+    empties or the offset passes COMPACT_AT.
+    """
+
+    __slots__ = ("_buffer", "_pos")
+
+    LINE, FRAME, INVALID = range(3)
+    COMPACT_AT = 4096
+    _START = bytes([binary_protocol.FRAME_START])
+
+    def __init__(self, data: bytes = b""):
+        self.reset(data)
+
+    def reset(self, data: bytes = b"") -> None:
+        """Discard everything buffered and start over from data."""
+        self._buffer = bytearray(data)
+        self._pos = 0
+
+    def feed(self, data: bytes) -> None:
+        """Append received bytes."""
+        self._buffer += data
+
+    def pending(self) -> bytes:
+        """Copy of the bytes not yet returned by pop()."""
+        return bytes(self._buffer[self._pos:])
+
+    def pop(self):
+        """Remove the next complete message.
+
+        A frame is taken where its start byte comes before the next newline;
+        text before it (a partial line) stays buffered around it.
+
+        Returns:
+            None when more bytes are needed, else (kind, opcode, data):
+            (LINE, 0, line without newline), (FRAME, opcode, payload) or
+            (INVALID, opcode, b"") for a stray start byte or corrupt frame
+            (the start byte is dropped)
+        """
+        buffer, pos = self._buffer, self._pos
+        if pos >= len(buffer):
+            self._compact()
+            return None
+
+        # Both searches stop at the first message, so a burst is scanned once
+        if buffer[pos] == binary_protocol.FRAME_START:
+            newline, start = -1, pos
+        else:
+            newline = buffer.find(b"\n", pos)
+            start = buffer.find(self._START, pos, newline if newline != -1 else len(buffer))
+
+        if start != -1:
+            status, end, opcode, payload = binary_protocol.parse_frame(buffer, start)
+            if status == binary_protocol.FRAME_INCOMPLETE:
+                return None
+            if status == binary_protocol.FRAME_INVALID:
+                self._cut(start, start + 1)
+                return self.INVALID, opcode, b""
+            self._cut(start, end)
+            return self.FRAME, opcode, payload
+
+        if newline == -1:
+            return None
+        line = bytes(buffer[pos:newline])
+        self._pos = newline + 1
+        self._compact()
+        return self.LINE, 0, line
+
+    def _cut(self, start: int, end: int) -> None:
+        """Remove buffer[start:end]: a step of the offset when nothing precedes it."""
+        if start == self._pos:
+            self._pos = end
+            self._compact()
+        else:
+            del self._buffer[start:end]
+
+    def _compact(self) -> None:
+        if self._pos >= len(self._buffer):
+            self._buffer.clear()
+            self._pos = 0
+        elif self._pos > self.COMPACT_AT:
+            del self._buffer[:self._pos]
+            self._pos = 0
 
 
 class SerialInterface:
     """Handles serial communication with ESP32."""
 
-    def __init__(self, port: str = None, baudrate: int = None):
+    def __init__(self, port: str = None, baudrate: int = None, window: int = None):
         """Initialize serial interface.
 
         Args:
             port: Serial port path (defaults to config, auto-detects if None)
             baudrate: Communication baud rate (defaults to config)
+            window: Sequenced commands in flight once pipelining is enabled (defaults to config)
         """
         self.logger = logging.getLogger(__name__)
         self.port = port if port is not None and port != "" else SERIAL_PORT
@@ -37,8 +171,41 @@ class SerialInterface:
         self._connected = False
         self._reconnect_attempts = 0
         self._max_backoff_seconds = 10
-        self._read_buffer = b""
-        self._lock = threading.Lock()
+        self._framer = _Framer()
+        self._binary_mode = False
+        self._telemetry_callback = None
+        self._pose = None
+        self._lock = threading.Lock()             # Link, framing and in-flight state
+        self._arrived = threading.Condition(self._lock)  # Notified by the reader thread per chunk
+        self._write_lock = threading.Lock()       # One write at a time; held for a single write only
+        # Reader thread (see start_reader) and subscribers
+        self._reader = None
+        self._reader_stop = threading.Event()
+        self._subscribers = {topic: () for topic in TOPICS}  # Replaced, never mutated: read without the lock
+        self._events = deque()                     # (topic, message) awaiting dispatch
+        # STOP priority path (see send_stop)
+        self._stop_sent = threading.Event()        # Written; in-flight bookkeeping not yet applied
+        self._stop_generation = 0
+        # Pipelining (see enable_pipelining)
+        self.window = window or SERIAL_WINDOW
+        self._pipelined = False
+        self._resync = False            # Renumber before the next sequenced send (after STOP or a lost sync)
+        self._next_seq = 1
+        self._in_flight = OrderedDict()  # seq -> _InFlight, oldest first
+        self._responses = deque()        # Replies ready for read_response(), in command order
+        self._retries = 0                # Consecutive resends without the ACK advancing
+        self._last_resend = 0.0
+        self._syncing = False            # A "sync" handshake is waiting for its reply
+        self._sync_reply = None
+
+    @property
+    def _read_buffer(self) -> bytes:
+        """Received bytes not yet framed (a copy)."""
+        return self._framer.pending()
+
+    @_read_buffer.setter
+    def _read_buffer(self, data: bytes) -> None:
+        self._framer.reset(data)
 
     def connect(self) -> bool:
         """Establish serial connection to ESP32.
@@ -74,6 +241,10 @@ class SerialInterface:
                 self._connected = True
                 self._reconnect_attempts = 0
                 self._read_buffer = b""
+                self._binary_mode = False
+                self._pipelined = False  # Fresh link: stop-and-wait until enable_pipelining()
+                self._in_flight.clear()
+                self._responses.clear()
                 self.logger.info(f"Serial connection established: {port} @ {self.baudrate}")
                 return True
             except serial.SerialException as e:
@@ -108,86 +279,379 @@ class SerialInterface:
             
         Note:
             STOP commands bypass queue and are sent immediately by caller.
-            This method handles all commands uniformly.
+            While pipelining, other commands get the next sequence number and
+            the call only waits if `window` commands are already unacknowledged;
+            their replies are collected with read_response(). STOP (by type or
+            priority) goes through send_stop().
+        """
+        if command.command_type == CommandType.STOP or command.priority == PRIORITY_STOP:
+            return self.send_stop(command)
+        if not self._connected and not self.connect():
+            return False
+        
+        # Reconnecting happens outside the lock: connect() takes it, and the
+        # backoff wait must not hold up readers or other senders
+        try:
+            with self._lock:
+                if self._pipelined:
+                    sent = self._send_sequenced(command)
+                else:
+                    self._write(self._encode_command(command))
+                    self.logger.debug(f"Sent command: {command.command_type.value}")
+                    sent = True
+        except serial.SerialException as e:
+            self.logger.error(f"Serial write error: {e}")
+            self._connected = False
+            if self._reconnect():
+                return self.send_command(command)
+            return False
+        except Exception as e:
+            self.logger.error(f"Unexpected error sending command: {e}")
+            return False
+        if self._reader is None:
+            self._dispatch()
+        return sent
+
+    def send_stop(self, command: Optional[Command] = None) -> bool:
+        """Send STOP at once, ahead of anything waiting on the interface.
+
+        The message only takes the write lock, which every sender holds for a
+        single write, so a blocked read_response(), a full send window or a
+        resync never delays it. It is never sequenced. While pipelining,
+        everything in flight is abandoned (the ESP32 discards it anyway, and
+        commands still waiting for window room are not sent). Numbering restarts
+        before the next command. That bookkeeping happens at once if the
+        interface is idle, otherwise as soon as the current holder next looks.
+
+        Args:
+            command: The STOP command to send (default: a plain STOP)
+
+        Returns:
+            True if sent
+        """
+        command = replace(command or Command(CommandType.STOP, {}, PRIORITY_STOP), seq=None)
+        if not self._connected and not self.connect():
+            return False
+        try:
+            data = self._encode_command(command)
+            with self._write_lock:
+                # Flag and write together: a resend either went out before STOP or sees the flag
+                self._stop_sent.set()
+                self._serial.write(data)
+            self._serial.flush()
+        except serial.SerialException as e:
+            self.logger.error(f"Serial write error: {e}")
+            self._connected = False
+            if self._reconnect():
+                return self.send_stop(command)
+            return False
+        if self._lock.acquire(blocking=False):
+            try:
+                self._apply_stop()
+            finally:
+                self._lock.release()
+        self.logger.debug("Sent STOP")
+        return True
+
+    def read_response(self, blocking: bool = True, timeout: float = None) -> Optional[Dict[str, Any]]:
+        """Read response from ESP32.
+
+        Args:
+            blocking: If True, wait for response until timeout. If False, return immediately if no data.
+            timeout: Maximum time to wait for response (defaults to config, only used if blocking=True)
+
+        Returns:
+            Response dictionary, or None if timeout/error/no data available
         """
         with self._lock:
-            if not self._connected:
-                if not self.connect():
-                    return False
+            response = self._read(blocking, timeout)
+        if self._reader is None:
+            self._dispatch()
+        return response
+
+    def _read(self, blocking: bool, timeout: Optional[float]) -> Optional[Dict[str, Any]]:
+        """read_response() body (lock held)."""
+        if not self._connected:
+            return None
+        
+        timeout = timeout or SERIAL_TIMEOUT
+        
+        try:
+            if self._reader is not None:
+                # The reader thread frames replies as they arrive: wait for its notification
+                deadline = time.time() + timeout
+                while True:
+                    found, response = self._poll()
+                    if found or not blocking:
+                        return response
+                    remaining = deadline - time.time()
+                    if remaining <= 0:
+                        self.logger.warning(f"Read response timeout after {timeout}s")
+                        return None
+                    self._arrived.wait(remaining)
             
+            if blocking:
+                start_time = time.time()
+                iterations = 0
+                max_iterations = int(timeout * 100)
+                
+                while iterations < max_iterations:
+                    found, response = self._poll()
+                    if found:
+                        return response
+                    
+                    if time.time() - start_time >= timeout:
+                        break
+                    
+                    time.sleep(0.01)
+                    iterations += 1
+                
+                self.logger.warning(f"Read response timeout after {timeout}s")
+                return None
+            else:
+                found, response = self._poll()
+                return response if found else None
+                
+        except serial.SerialException as e:
+            self.logger.error(f"Serial read error: {e}")
+            self._connected = False
+            return None
+        except Exception as e:
+            self.logger.error(f"Unexpected error reading response: {e}")
+            return None
+
+    def enable_binary_mode(self, timeout: float = None) -> bool:
+        """Switch commands to compact binary frames (JSON handshake first).
+
+        Firmware without binary support rejects the handshake as an unknown
+        command, and the link stays on JSON.
+
+        Args:
+            timeout: Maximum time to wait for the handshake reply
+
+        Returns:
+            True if the ESP32 accepted binary framing
+        """
+        with self._lock:
+            if not self._connected:
+                return False
             try:
-                json_str = self._serialize_command(command)
-                self._serial.write(json_str.encode('utf-8'))
-                self._serial.flush()
-                self.logger.debug(f"Sent command: {command.command_type.value}")
-                return True
+                handshake = json.dumps({"command": "binary_mode", "parameters": {}, "priority": 0}) + "\n"
+                self._write(handshake.encode('utf-8'))
             except serial.SerialException as e:
                 self.logger.error(f"Serial write error: {e}")
                 self._connected = False
-                if self._reconnect():
-                    return self.send_command(command)
                 return False
-            except Exception as e:
-                self.logger.error(f"Unexpected error sending command: {e}")
+
+        response = self.read_response(blocking=True, timeout=timeout)
+        accepted = bool(response and response.get("success") and
+                        response.get("protocol") == binary_protocol.PROTOCOL_VERSION)
+        with self._lock:
+            self._binary_mode = accepted
+        if accepted:
+            self.logger.info(f"Binary framing enabled (protocol {response['protocol']})")
+        else:
+            self.logger.warning("ESP32 did not accept binary framing, staying on JSON")
+        return accepted
+
+    def disable_binary_mode(self) -> bool:
+        """Return the link to JSON-only commands.
+
+        Returns:
+            True if the request was sent
+        """
+        with self._lock:
+            if not self._binary_mode:
+                return True
+            self._binary_mode = False
+            if not self._connected:
+                return False
+            try:
+                self._write(binary_protocol.encode_frame(binary_protocol.OP_JSON_MODE))
+                return True
+            except serial.SerialException as e:
+                self.logger.error(f"Serial write error: {e}")
+                self._connected = False
                 return False
 
-    def read_response(self, blocking: bool = True, timeout: float = None) -> Optional[Dict[str, Any]]:
-        """Read response from ESP32.
+    def enable_pipelining(self, timeout: float = None) -> bool:
+        """Start sequenced, windowed command transport ("sync" handshake).
+
+        The ESP32 restarts its numbering and reports its command queue size,
+        which caps the window. Firmware without sequencing rejects "sync" and
+        the link stays stop-and-wait.
 
         Args:
-            blocking: If True, wait for response until timeout. If False, return immediately if no data.
-            timeout: Maximum time to wait for response (defaults to config, only used if blocking=True)
+            timeout: Maximum time to wait for the handshake reply
 
         Returns:
-            Response dictionary, or None if timeout/error/no data available
+            True if pipelining is active
         """
         with self._lock:
             if not self._connected:
-                return None
-            
-            timeout = timeout or SERIAL_TIMEOUT
-            
+                return False
             try:
-                if blocking:
-                    start_time = time.time()
-                    iterations = 0
-                    max_iterations = int(timeout * 100)
-                    
-                    while iterations < max_iterations:
-                        if self._serial.in_waiting > 0:
-                            data = self._serial.read(self._serial.in_waiting)
-                            self._read_buffer += data
-                        
-                        if b'\n' in self._read_buffer:
-                            line, self._read_buffer = self._read_buffer.split(b'\n', 1)
-                            return self._parse_response(line)
-                        
-                        if time.time() - start_time >= timeout:
-                            break
-                        
-                        time.sleep(0.01)
-                        iterations += 1
-                    
-                    self.logger.warning(f"Read response timeout after {timeout}s")
-                    return None
-                else:
-                    if self._serial.in_waiting > 0:
-                        data = self._serial.read(self._serial.in_waiting)
-                        self._read_buffer += data
-                    
-                    if b'\n' in self._read_buffer:
-                        line, self._read_buffer = self._read_buffer.split(b'\n', 1)
-                        return self._parse_response(line)
-                    
-                    return None
-                    
+                self._pipelined = self._sync(timeout or SERIAL_TIMEOUT)
             except serial.SerialException as e:
-                self.logger.error(f"Serial read error: {e}")
+                self.logger.error(f"Serial write error: {e}")
                 self._connected = False
-                return None
-            except Exception as e:
-                self.logger.error(f"Unexpected error reading response: {e}")
-                return None
+                self._pipelined = False
+            if self._pipelined:
+                self.logger.info(f"Command pipelining enabled (window {self.window})")
+            else:
+                self.logger.warning("ESP32 did not accept sequencing, staying stop-and-wait")
+            return self._pipelined
+
+    def is_pipelined(self) -> bool:
+        """Check whether commands are sent with sequence numbers.
+
+        Returns:
+            True if pipelining is active
+        """
+        return self._pipelined
+
+    def in_flight(self) -> int:
+        """Number of sequenced commands sent but not yet acknowledged.
+
+        Returns:
+            Unacknowledged command count
+        """
+        with self._lock:
+            return len(self._in_flight)
+
+    def wait_for_acks(self, timeout: float = None) -> bool:
+        """Block until every sequenced command has been acknowledged.
+
+        Replies stay queued for read_response().
+
+        Args:
+            timeout: Maximum time to wait (defaults to config)
+
+        Returns:
+            True if nothing is left in flight
+        """
+        deadline = time.time() + (timeout or SERIAL_TIMEOUT)
+        while True:
+            with self._lock:
+                if not self._connected:
+                    return False
+                self._pump()
+                if not self._in_flight:
+                    return True
+                remaining = deadline - time.time()
+                if remaining <= 0:
+                    return False
+                if self._reader is not None:
+                    self._arrived.wait(min(remaining, SERIAL_ACK_TIMEOUT))
+                    continue
+            self._dispatch()
+            time.sleep(0.01)
+
+    def set_telemetry_callback(self, callback: Optional[Callable[[Dict[str, Any]], None]]) -> None:
+        """Receive telemetry samples streamed by the ESP32.
+
+        Telemetry frames are never returned by read_response(); without a
+        callback they are discarded. One callback slot, kept alongside the
+        TOPIC_TELEMETRY subscribers.
+
+        Args:
+            callback: Called with a decoded sample dict (binary_protocol.TELEMETRY_FIELDS)
+        """
+        self._telemetry_callback = callback
+
+    def subscribe(self, topic: str, callback: Callable[[Dict[str, Any]], None]) -> Callable[[], None]:
+        """Call callback for every message of a topic.
+
+        TOPIC_RESPONSE callbacks see each reply as it is queued for
+        read_response() (which still returns it). TOPIC_TELEMETRY and
+        TOPIC_RECORDER callbacks get the decoded samples. Callbacks run in
+        arrival order, on the reader thread while it runs (otherwise on the
+        thread whose call read the data), without the interface lock. They
+        may send commands, but slow callbacks delay the rest of the stream.
+
+        Args:
+            topic: TOPIC_RESPONSE, TOPIC_TELEMETRY or TOPIC_RECORDER
+            callback: Called with the message dict
+
+        Returns:
+            Function that removes the subscription
+
+        Raises:
+            ValueError: Unknown topic
+        """
+        if topic not in self._subscribers:
+            raise ValueError(f"Unknown topic: {topic}")
+        with self._lock:
+            self._subscribers[topic] = self._subscribers[topic] + (callback,)
+
+        def unsubscribe():
+            with self._lock:
+                self._subscribers[topic] = tuple(c for c in self._subscribers[topic] if c is not callback)
+        return unsubscribe
+
+    def start_reader(self) -> None:
+        """Move reading to a dedicated thread ("SerialReader").
+
+        The thread blocks on the port, frames messages as bytes arrive, runs
+        the ACK bookkeeping (resends included) and wakes read_response(),
+        wait_for_acks() and a send waiting for window room, none of which
+        poll the port any more. It follows reconnects and keeps running
+        through disconnect() until stop_reader().
+        """
+        with self._lock:
+            if self._reader is not None:
+                return
+            self._reader_stop.clear()
+            self._reader = threading.Thread(target=self._reader_loop, daemon=True, name="SerialReader")
+            self._reader.start()
+        self.logger.info("Serial reader thread started")
+
+    def stop_reader(self, timeout: float = None) -> None:
+        """Stop the reader thread; reads go back to polling the port.
+
+        Args:
+            timeout: Maximum time to wait for the thread (defaults to twice the port timeout)
+        """
+        reader = self._reader
+        if reader is None:
+            return
+        self._reader_stop.set()
+        reader.join(timeout or 2 * SERIAL_TIMEOUT)
+        if reader.is_alive():
+            self.logger.warning("Serial reader thread did not stop")
+        with self._lock:
+            self._reader = None
+            self._arrived.notify_all()
+        self._dispatch()
+
+    def is_reader_running(self) -> bool:
+        """Check whether the reader thread owns the read side.
+
+        Returns:
+            True between start_reader() and stop_reader()
+        """
+        return self._reader is not None
+
+    def get_pose(self) -> Optional[Tuple[float, float, float]]:
+        """Latest odometry pose from the telemetry stream.
+
+        The ESP32 tracks the pose every control tick (encoders fused with
+        the gyro); this is the newest sample read, so it is only current
+        while telemetry is enabled and responses are being read.
+
+        Returns:
+            (x, y, heading): meters from the boot pose (x forward, y left)
+            and degrees counter-clockwise, or None before the first sample
+        """
+        return self._pose
+
+    def is_binary_mode(self) -> bool:
+        """Check whether commands are sent as binary frames.
+
+        Returns:
+            True if binary framing is active
+        """
+        return self._binary_mode
 
     def is_connected(self) -> bool:
         """Check if serial connection is active.
@@ -198,6 +662,299 @@ class SerialInterface:
         with self._lock:
             return self._connected and (self._serial is not None and self._serial.is_open)
 
+    def _poll(self):
+        """Take in received bytes and return the next reply (lock held).
+
+        Returns:
+            (found, response): found is False when no reply is ready; while
+            pipelining, ACK bookkeeping and resends happen here and only final
+            replies are returned. Unparseable lines are skipped
+        """
+        if self._pipelined:
+            self._pump()
+        else:
+            self._receive()
+        if self._responses:
+            return True, self._responses.popleft()
+        return False, None
+
+    def _pump(self) -> None:
+        """Drain received replies into the ACK state machine and run resend timers (lock held)."""
+        self._receive()
+        if self._resync and self._in_flight:
+            self._renumber()
+        else:
+            self._check_ack_timeout()
+
+    def _receive(self) -> None:
+        """Frame everything received so far and route each reply through _accept() (lock held).
+
+        Reads the port itself only while no reader thread runs.
+        """
+        self._apply_stop()
+        if self._reader is None and self._serial.in_waiting > 0:
+            self._framer.feed(self._serial.read(self._serial.in_waiting))
+        while True:
+            found, response = self._pop_message()
+            if not found:
+                break
+            self._accept(response)
+
+    def _check_ack_timeout(self) -> None:
+        """Resend everything in flight once the oldest command has waited SERIAL_ACK_TIMEOUT (lock held)."""
+        if self._in_flight and not self._resync:
+            oldest = next(iter(self._in_flight.values()))
+            if time.time() - oldest.sent_at >= SERIAL_ACK_TIMEOUT:
+                self._go_back_n("ACK timeout", holdoff=0.0)
+
+    def _reader_loop(self) -> None:
+        """Reader thread: block on the port, frame what arrives, wake waiters, dispatch."""
+        while not self._reader_stop.is_set():
+            port = self._serial
+            if not self._connected or port is None:
+                self._reader_stop.wait(0.1)
+                continue
+            try:
+                data = port.read(max(1, port.in_waiting))  # Blocks up to the port timeout
+            except Exception as e:
+                if self._connected and self._serial is port:
+                    self.logger.error(f"Serial read error: {e}")
+                    self._connected = False  # The next send reconnects
+                self._reader_stop.wait(0.1)
+                continue
+            with self._lock:
+                if data and self._serial is port:
+                    self._framer.feed(data)
+                try:
+                    self._receive()
+                    self._check_ack_timeout()  # Resends go out while the sender is busy elsewhere
+                except serial.SerialException as e:
+                    self.logger.error(f"Serial write error: {e}")
+                    self._connected = False
+                self._arrived.notify_all()
+            self._dispatch()
+
+    def _wait(self, timeout: float) -> None:
+        """Pause a loop that waits for replies (lock held).
+
+        With the reader thread the lock is released until it delivers (so it
+        can); otherwise the caller polls the port again after sleeping.
+        """
+        if self._reader is not None:
+            self._arrived.wait(timeout)
+        else:
+            time.sleep(timeout)
+
+    def _write(self, data: bytes, flush: bool = True) -> None:
+        """Write one message (any thread; the state lock is not needed)."""
+        with self._write_lock:
+            self._serial.write(data)
+        if flush:
+            self._serial.flush()
+
+    def _resend(self, data: bytes) -> bool:
+        """Write one resend unless STOP went out since the last _apply_stop() (lock held).
+
+        Returns:
+            False if STOP was sent: the rest of the burst must not follow it
+        """
+        with self._write_lock:
+            if self._stop_sent.is_set():
+                return False
+            self._serial.write(data)
+        return True
+
+    def _apply_stop(self) -> None:
+        """In-flight bookkeeping for a STOP written by send_stop() (lock held)."""
+        if not self._stop_sent.is_set():
+            return
+        self._stop_sent.clear()
+        self._stop_generation += 1
+        if self._pipelined:
+            if self._in_flight:
+                self._abandon_in_flight("cancelled by STOP")
+            self._resync = True
+        self._arrived.notify_all()
+
+    def _deliver(self, response: Dict[str, Any]) -> None:
+        """Queue a reply for read_response() and its subscribers (lock held)."""
+        self._responses.append(response)
+        if self._subscribers[TOPIC_RESPONSE]:
+            self._events.append((TOPIC_RESPONSE, response))
+
+    def _dispatch(self) -> None:
+        """Run subscriber callbacks for queued events, oldest first (lock not held)."""
+        while True:
+            try:
+                topic, message = self._events.popleft()
+            except IndexError:
+                return
+            callbacks = self._subscribers[topic]
+            if topic == TOPIC_TELEMETRY and self._telemetry_callback:
+                callbacks = callbacks + (self._telemetry_callback,)
+            for callback in callbacks:
+                try:
+                    callback(message)
+                except Exception as e:
+                    self.logger.error(f"Error in {topic} subscriber: {e}", exc_info=True)
+
+    def _accept(self, response: Optional[Dict[str, Any]]) -> None:
+        """Apply one reply to the in-flight window (lock held).
+
+        Cumulative ACK: every command up to "ack" is done. Its own reply is
+        passed on; commands whose reply was lost get a stand-in
+        {"success": None, "seq": n, "ack": ack}. A reply that leaves its
+        command unacknowledged (gap, queue full, parse error) is a NAK:
+        everything in flight is resent from ack + 1.
+        """
+        if response is None:
+            return  # Unparseable line (status text or noise)
+        if self._syncing and ("window" in response or
+                              (response.get("code") == ResponseCode.UNKNOWN_COMMAND and not response.get("seq"))):
+            self._sync_reply = response  # Handshake reply, or its rejection by older firmware
+            return
+        if "window" in response:
+            return  # Late "sync" reply
+        ack = response.get("ack")
+        seq = response.get("seq", 0)
+        if ack is None or (not self._in_flight and not seq):
+            self._deliver(response)  # Unsequenced reply (STOP, diagnostics, older firmware)
+            return
+
+        released = False
+        while self._in_flight:
+            first = next(iter(self._in_flight))
+            if not seq_covered(first, ack):
+                break
+            self._in_flight.popitem(last=False)
+            released = True
+            if first == seq:
+                self._deliver(response)
+            else:
+                self._deliver({"success": None, "seq": first, "ack": ack})
+        if released:
+            self._retries = 0
+
+        if seq_covered(seq, ack) or not self._in_flight:
+            return  # Final reply (already passed on above) or stale duplicate
+        if self._in_flight and next(iter(self._in_flight)) != next_seq(ack):
+            # The ESP32 expects a number we never sent (it rebooted or missed a sync)
+            self.logger.warning(f"Sequence mismatch (ack {ack}), renumbering in-flight commands")
+            self._resync = True
+            return
+        if not seq and response.get("success"):
+            self._deliver(response)  # Unsequenced success (e.g. STOP) while commands are in flight
+            return
+        code = response.get("code")
+        holdoff = SERIAL_ACK_TIMEOUT if code == ResponseCode.QUEUE_FULL else SERIAL_RESEND_HOLDOFF
+        self._go_back_n(f"NAK (code {code}, ack {ack})", holdoff)
+
+    def _go_back_n(self, reason: str, holdoff: float) -> None:
+        """Resend everything in flight, oldest first (lock held)."""
+        now = time.time()
+        if now - self._last_resend < holdoff:
+            return  # Rest of the NAK burst for copies already resent
+        self._retries += 1
+        if self._retries > SERIAL_MAX_RETRIES:
+            self.logger.error(f"Giving up on {len(self._in_flight)} in-flight commands after {reason}")
+            self._abandon_in_flight("retries exhausted")
+            return
+        self.logger.warning(f"Resending {len(self._in_flight)} commands: {reason}")
+        self._last_resend = now
+        for entry in self._in_flight.values():
+            entry.sent_at = now
+            if not self._resend(entry.data):
+                self.logger.info("STOP sent during resend, rest of the burst dropped")
+                break
+        self._serial.flush()
+        self._apply_stop()  # Abandons what is in flight if the burst was cut short
+
+    def _abandon_in_flight(self, reason: str) -> None:
+        """Drop every in-flight command, answering each with a failure stand-in (lock held)."""
+        for seq in self._in_flight:
+            self._deliver({"success": False, "seq": seq, "error": reason})
+        self._in_flight.clear()
+        self._retries = 0
+
+    def _renumber(self) -> None:
+        """Restart numbering with "sync" and resend what is in flight under new numbers (lock held)."""
+        pending = [entry.command for entry in self._in_flight.values()]
+        self._in_flight.clear()
+        generation = self._stop_generation
+        if not self._sync(SERIAL_TIMEOUT):
+            self.logger.error("Sequence resync failed")
+            self._in_flight.update((command.seq, _InFlight(command, b"", 0.0)) for command in pending)
+            self._abandon_in_flight("resync failed")
+            return
+        for command in pending:
+            self._apply_stop()
+            if self._stop_generation != generation:
+                # Commands from before a STOP are never resent after it, even under new numbers
+                self._deliver({"success": False, "seq": command.seq, "error": "cancelled by STOP"})
+                continue
+            self._send_sequenced(command)
+
+    def _sync(self, timeout: float) -> bool:
+        """Send "sync" and wait for its reply (lock held).
+
+        Returns:
+            True if the ESP32 restarted its numbering
+        """
+        handshake = json.dumps({"command": CommandType.SYNC.value, "parameters": {}, "priority": 0}) + "\n"
+        self._sync_reply = None
+        self._syncing = True  # _accept() hands the reply over; replies to earlier commands pass on
+        try:
+            self._write(handshake.encode('utf-8'))
+            deadline = time.time() + timeout
+            while time.time() < deadline:
+                self._receive()
+                response = self._sync_reply
+                if response is None:
+                    self._wait(0.01)
+                    continue
+                if "window" not in response or not response.get("success"):
+                    return False  # Firmware without sequencing
+                self.window = max(1, min(self.window, int(response["window"])))
+                self._next_seq = next_seq(int(response.get("ack", 0)))
+                self._resync = False
+                self._retries = 0
+                return True
+            return False
+        finally:
+            self._syncing = False
+
+    def _send_sequenced(self, command: Command) -> bool:
+        """Send a command under the next sequence number, waiting for window room (lock held).
+
+        Returns:
+            True if sent
+        """
+        self._apply_stop()
+        generation = self._stop_generation
+        if self._resync and not self._in_flight:
+            if not self._sync(SERIAL_TIMEOUT):
+                self.logger.error("Sequence resync failed")
+                return False
+        deadline = time.time() + SERIAL_ACK_TIMEOUT * (SERIAL_MAX_RETRIES + 1)
+        while len(self._in_flight) >= self.window:
+            if time.time() >= deadline:
+                self.logger.warning("Send window full, command not sent")
+                return False
+            self._wait(0.005)
+            self._pump()
+            if self._stop_generation != generation:
+                self.logger.info("STOP sent while waiting for window room, command not sent")
+                return False
+
+        seq = self._next_seq
+        self._next_seq = next_seq(seq)
+        sequenced = replace(command, seq=seq)
+        data = self._encode_command(sequenced)
+        self._in_flight[seq] = _InFlight(sequenced, data, time.time())
+        self._write(data)
+        self.logger.debug(f"Sent command {seq}: {command.command_type.value}")
+        return True
+
     def _serialize_command(self, command: Command) -> str:
         """Convert command to JSON string for transmission.
 
@@ -208,6 +965,55 @@ class SerialInterface:
             JSON string with newline terminator
         """
         return json.dumps(command.to_json()) + "\n"
+
+    def _encode_command(self, command: Command) -> bytes:
+        """Encode command for the current link mode.
+
+        Args:
+            command: Command to encode
+
+        Returns:
+            Binary frame in binary mode (when the command has an opcode), else JSON line bytes
+        """
+        if self._binary_mode:
+            frame = binary_protocol.encode_command(command)
+            if frame is not None:
+                return frame
+        return self._serialize_command(command).encode('utf-8')
+
+    def _pop_message(self):
+        """Remove the next reply (JSON line or response frame) from the framer (lock held).
+
+        Telemetry and recorder frames are consumed here and queued for
+        subscribers; they are never returned.
+
+        Returns:
+            (found, response): found is False when more bytes are needed
+        """
+        while True:
+            message = self._framer.pop()
+            if message is None:
+                return False, None
+            kind, opcode, data = message
+            if kind == _Framer.INVALID:
+                # Stray start byte or corrupt frame: the start byte is dropped and scanning goes on
+                self.logger.warning(f"Dropped invalid frame (opcode 0x{opcode:02x})")
+                continue
+            if kind == _Framer.LINE:
+                return True, self._parse_response(data)
+            if opcode == binary_protocol.OP_TELEMETRY:
+                # Unsolicited stream, not a command response
+                sample = binary_protocol.decode_telemetry(data)
+                self._pose = (sample["x"], sample["y"], sample["heading"])
+                if self._subscribers[TOPIC_TELEMETRY] or self._telemetry_callback:
+                    self._events.append((TOPIC_TELEMETRY, sample))
+                continue
+            if opcode == binary_protocol.OP_RECORDER:
+                # Flight recorder dump (read by scripts/dump_flight_recorder.py)
+                if self._subscribers[TOPIC_RECORDER]:
+                    self._events.append((TOPIC_RECORDER, binary_protocol.decode_telemetry(data)))
+                continue
+            return True, binary_protocol.decode_frame(opcode, data)
     
     def _parse_response(self, line: bytes) -> Optional[Dict[str, Any]]:
         """Parse response line from ESP32.
@@ -244,6 +1050,8 @@ class SerialInterface:
         """Attempt to reconnect with exponential backoff.
         
         Retries indefinitely with exponential backoff capped at max_backoff_seconds.
+        Runs without the interface lock (connect() takes it), so the backoff
+        holds up neither the reader thread nor STOP.
         
         Returns:
             True if reconnection successful, False otherwise
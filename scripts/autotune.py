@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""Run the ESP32 relay autotuner and optionally apply the gains it finds.
+
+The robot must be balancing on open floor. For a few seconds the balance PID
+is replaced by a relay that rocks the robot within +/-10 degrees. The ESP32
+measures the ultimate gain and period and proposes Ziegler-Nichols gains.
+An abort (tilt limit, timeout, STOP) hands control straight back to the PID.
+
+Usage:
+    python scripts/autotune.py                 # run and report candidate gains
+    python scripts/autotune.py --apply         # run, then switch to the new gains
+    python scripts/autotune.py --apply --save  # ... and keep them across reboots
+"""
+
+import argparse
+import json
+import sys
+import time
+from pathlib import Path
+
+import serial
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+from pi.config import SERIAL_PORT, SERIAL_BAUDRATE
+
+
+def request(ser, parameters, timeout=2.0):
+    """Send an autotune command and return its JSON reply (None on timeout)."""
+    cmd = {"command": "autotune", "parameters": parameters, "priority": 0}
+    ser.write((json.dumps(cmd) + "\n").encode('utf-8'))
+    ser.flush()
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        line = ser.readline().decode('utf-8', errors='replace').strip()
+        try:
+            reply = json.loads(line)
+        except json.JSONDecodeError:
+            continue  # Status prints from the ESP32
+        if isinstance(reply, dict) and "success" in reply:
+            return reply
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", default=SERIAL_PORT)
+    parser.add_argument("--baudrate", type=int, default=SERIAL_BAUDRATE)
+    parser.add_argument("--apply", action="store_true", help="Switch to the candidate gains when done")
+    parser.add_argument("--save", action="store_true", help="With --apply: persist the gains to flash")
+    parser.add_argument("--timeout", type=float, default=20.0, help="Seconds to wait for the run")
+    args = parser.parse_args()
+
+    ser = serial.Serial(args.port, args.baudrate, timeout=0.1)
+    try:
+        reply = request(ser, {"action": "start"})
+        if reply is None or not reply["success"]:
+            print(f"Autotune did not start: {reply}")
+            sys.exit(1)
+        print("Autotune running (send STOP or Ctrl+C to abort)")
+
+        deadline = time.time() + args.timeout
+        status = None
+        try:
+            while time.time() < deadline:
+                time.sleep(0.5)
+                status = request(ser, {"action": "status"})
+                if status and status.get("state") in ("done", "aborted"):
+                    break
+        except KeyboardInterrupt:
+            request(ser, {"action": "abort"})
+            print("Aborted")
+            sys.exit(1)
+
+        if status is None or status.get("state") != "done":
+            if status is None or status.get("state") == "running":
+                request(ser, {"action": "abort"})
+            print(f"Autotune failed: {status}")
+            sys.exit(1)
+
+        print(f"Ku {status['ku']:.4f}  Tu {status['tu']:.3f} s  amplitude {status['amplitude']:.2f} deg")
+        print(f"Candidate gains: kp {status['kp']:.5f}  ki {status['ki']:.5f}  kd {status['kd']:.5f}")
+
+        if args.apply:
+            print(request(ser, {"action": "apply", "save": args.save}))
+    finally:
+        ser.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Run the ESP32 motor compensation sweep and optionally save the maps.
+
+The rover must be on a stand with both wheels off the ground. Balancing is
+suspended for about 30 s while the ESP32 steps both motors through their
+duty range, forward and then reverse, and measures each wheel's speed with
+its encoder. It then fits the duty each motor needs per command: the
+deadband, the forward/reverse asymmetry and the left/right mismatch. The
+new maps are active as soon as the sweep finishes. An abort (STOP, Ctrl+C,
+a wheel that never turns) keeps the previous maps.
+
+Usage:
+    python scripts/calibrate_motors.py          # run and report the fitted maps
+    python scripts/calibrate_motors.py --save   # run, then keep the maps across reboots
+    python scripts/calibrate_motors.py --clear  # back to raw duty, saved maps erased
+"""
+
+import argparse
+import json
+import sys
+import time
+from pathlib import Path
+
+import serial
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+from pi.config import SERIAL_PORT, SERIAL_BAUDRATE
+
+
+def request(ser, parameters, timeout=2.0):
+    """Send a motor_cal command and return its JSON reply (None on timeout)."""
+    cmd = {"command": "motor_cal", "parameters": parameters, "priority": 0}
+    ser.write((json.dumps(cmd) + "\n").encode('utf-8'))
+    ser.flush()
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        line = ser.readline().decode('utf-8', errors='replace').strip()
+        try:
+            reply = json.loads(line)
+        except json.JSONDecodeError:
+            continue  # Status prints from the ESP32
+        if isinstance(reply, dict) and "success" in reply:
+            return reply
+    return None
+
+
+def print_maps(status):
+    """Print deadbands, sweep maxima and the duty curves from a status reply."""
+    print(f"Reference speed {status['reference']:.1f} pulses/s (slowest maximum)")
+    for side in ("left", "right"):
+        forward_peak, reverse_peak = status["peak"][side]
+        curves = status.get(side, {})
+        forward = curves.get("forward", [])
+        reverse = curves.get("reverse", [])
+        if forward and reverse:
+            print(f"{side:>5}: deadband forward {forward[0]:.3f}  reverse {reverse[0]:.3f}  "
+                  f"max {forward_peak:.1f} / {reverse_peak:.1f} pulses/s")
+        print("       forward " + " ".join(f"{duty:.3f}" for duty in forward))
+        print("       reverse " + " ".join(f"{duty:.3f}" for duty in reverse))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", default=SERIAL_PORT)
+    parser.add_argument("--baudrate", type=int, default=SERIAL_BAUDRATE)
+    parser.add_argument("--save", action="store_true", help="Persist the fitted maps to flash")
+    parser.add_argument("--clear", action="store_true", help="Return to raw duty and erase the saved maps")
+    parser.add_argument("--timeout", type=float, default=60.0, help="Seconds to wait for the sweep")
+    args = parser.parse_args()
+
+    ser = serial.Serial(args.port, args.baudrate, timeout=0.1)
+    try:
+        if args.clear:
+            reply = request(ser, {"action": "clear"})
+            print(reply)
+            sys.exit(0 if reply and reply["success"] else 1)
+
+        reply = request(ser, {"action": "start"})
+        if reply is None or not reply["success"]:
+            print(f"Motor calibration did not start: {reply}")
+            sys.exit(1)
+        print("Motor calibration running, wheels off the ground (send STOP or Ctrl+C to abort)")
+
+        deadline = time.time() + args.timeout
+        status = None
+        try:
+            while time.time() < deadline:
+                time.sleep(1.0)
+                status = request(ser, {"action": "status"})
+                if status is None:
+                    continue
+                if status.get("state") in ("done", "aborted"):
+                    break
+                print(f"  step {status['step']}/{status['steps']}", end="\r", flush=True)
+        except KeyboardInterrupt:
+            request(ser, {"action": "abort"})
+            print("\nAborted")
+            sys.exit(1)
+        print()
+
+        if status is None or status.get("state") != "done":
+            if status is None or status.get("state") == "running":
+                request(ser, {"action": "abort"})
+            print(f"Motor calibration failed: {status}")
+            sys.exit(1)
+
+        print_maps(status)
+
+        if args.save:
+            print(request(ser, {"action": "save"}))
+    finally:
+        ser.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""Capture ESP32 balance telemetry to CSV for matlab_tuning/log_analysis.m.
+
+Enables the binary telemetry stream, decodes frames and writes one CSV row
+per sample. Columns 1-6 are the log_analysis.m layout (time_ms, angle,
+angular_velocity, motor_output, velocity_setpoint, rotation_setpoint);
+encoder positions, tick timing, the controller's wheel velocity and the
+odometry pose (x, y in m, heading in degrees) follow.
+
+Usage:
+    python scripts/capture_telemetry.py
+    python scripts/capture_telemetry.py --port /dev/ttyUSB0 --decimation 1 --seconds 20 -o rover_log.csv
+"""
+
+import argparse
+import csv
+import json
+import sys
+import time
+from pathlib import Path
+
+import serial
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+from pi.serial_comm import binary_protocol
+from pi.config import SERIAL_PORT, SERIAL_BAUDRATE
+
+
+def set_decimation(ser, decimation):
+    """Send the telemetry command (JSON link; no handshake needed)."""
+    cmd = {"command": "telemetry", "parameters": {"decimation": decimation}, "priority": 0}
+    ser.write((json.dumps(cmd) + "\n").encode('utf-8'))
+    ser.flush()
+
+
+def extract_samples(buffer):
+    """Pull complete telemetry frames out of buffer.
+
+    Returns:
+        (samples, remaining buffer); JSON lines and other frames are dropped
+    """
+    frames, _, remaining = binary_protocol.split_stream(buffer)
+    samples = [binary_protocol.decode_telemetry(payload)
+               for opcode, payload in frames if opcode == binary_protocol.OP_TELEMETRY]
+    return samples, remaining
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", default=SERIAL_PORT)
+    parser.add_argument("--baudrate", type=int, default=SERIAL_BAUDRATE)
+    parser.add_argument("--decimation", type=int, default=1,
+                        help="Stream every Nth 100 Hz control tick (default: 1 = 100 Hz)")
+    parser.add_argument("--seconds", type=float, default=0, help="Stop after this long (default: until Ctrl+C)")
+    parser.add_argument("-o", "--output", default="rover_log.csv")
+    args = parser.parse_args()
+
+    ser = serial.Serial(args.port, args.baudrate, timeout=0.1)
+    set_decimation(ser, args.decimation)
+    print(f"Capturing telemetry from {args.port} to {args.output} (Ctrl+C to stop)")
+
+    count = 0
+    buffer = b""
+    start_time = time.time()
+    try:
+        with open(args.output, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(binary_protocol.TELEMETRY_FIELDS)
+            while args.seconds <= 0 or time.time() - start_time < args.seconds:
+                buffer += ser.read(max(1, ser.in_waiting))
+                samples, buffer = extract_samples(buffer)
+                for sample in samples:
+                    writer.writerow([sample[field] for field in binary_protocol.TELEMETRY_FIELDS])
+                count += len(samples)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        set_decimation(ser, 0)
+        ser.close()
+
+    print(f"Wrote {count} samples to {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Pull the ESP32 flight recorder window (last seconds before a fall or STOP) to CSV.
+
+The recorder holds every 100 Hz control tick leading up to the trigger.
+Fall windows survive a reboot (LittleFS); STOP windows live in RAM until
+saved with --save. Columns match scripts/capture_telemetry.py, so the CSV
+loads into matlab_tuning/log_analysis.m unchanged.
+
+Usage:
+    python scripts/dump_flight_recorder.py
+    python scripts/dump_flight_recorder.py --port /dev/ttyUSB0 -o fall.csv --clear
+    python scripts/dump_flight_recorder.py --status
+"""
+
+import argparse
+import csv
+import json
+import sys
+import time
+from pathlib import Path
+
+import serial
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+from pi.serial_comm import binary_protocol
+from pi.config import SERIAL_PORT, SERIAL_BAUDRATE
+
+
+def send_action(ser, action):
+    """Send the recorder command (JSON link; no handshake needed)."""
+    cmd = {"command": "recorder", "parameters": {"action": action}, "priority": 0}
+    ser.write((json.dumps(cmd) + "\n").encode('utf-8'))
+    ser.flush()
+
+
+def read_reply(ser, timeout, dump=False):
+    """Read the JSON reply and, for a dump, the OP_RECORDER frames after it.
+
+    Returns:
+        (reply dict or None, list of samples)
+    """
+    reply = None
+    samples = []
+    text = b""
+    buffer = b""
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        buffer += ser.read(max(1, ser.in_waiting))
+        frames, new_text, buffer = binary_protocol.split_stream(buffer)
+        samples += [binary_protocol.decode_telemetry(payload)
+                    for opcode, payload in frames if opcode == binary_protocol.OP_RECORDER]
+        text += new_text
+        while reply is None and b"\n" in text:
+            line, text = text.split(b"\n", 1)
+            try:
+                message = json.loads(line.decode('utf-8', errors='replace').strip())
+            except json.JSONDecodeError:
+                continue  # Status prints from the ESP32
+            if isinstance(message, dict) and "success" in message:
+                reply = message
+        if reply is not None:
+            if not dump or not reply.get("success"):
+                break
+            if len(samples) >= reply.get("samples", 0):
+                break
+    return reply, samples
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", default=SERIAL_PORT)
+    parser.add_argument("--baudrate", type=int, default=SERIAL_BAUDRATE)
+    parser.add_argument("-o", "--output", default="flight_recorder.csv")
+    parser.add_argument("--status", action="store_true", help="Only report what the recorder holds")
+    parser.add_argument("--save", action="store_true", help="Persist a STOP window to flash (stalls balancing briefly)")
+    parser.add_argument("--clear", action="store_true", help="Discard the recording after a successful dump")
+    parser.add_argument("--timeout", type=float, default=5.0, help="Seconds to wait for the dump")
+    args = parser.parse_args()
+
+    ser = serial.Serial(args.port, args.baudrate, timeout=0.1)
+    try:
+        if args.save:
+            send_action(ser, "save")
+            reply, _ = read_reply(ser, args.timeout)
+            print(reply)
+
+        if args.status:
+            send_action(ser, "status")
+            reply, _ = read_reply(ser, args.timeout)
+            print(reply)
+            return
+
+        send_action(ser, "dump")
+        reply, samples = read_reply(ser, args.timeout, dump=True)
+        if reply is None or not reply.get("success"):
+            print(f"Dump failed: {reply}")
+            sys.exit(1)
+        if reply.get("samples", 0) == 0:
+            print("Flight recorder is empty")
+            return
+
+        with open(args.output, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(binary_protocol.TELEMETRY_FIELDS)
+            for sample in samples:
+                writer.writerow([sample[field] for field in binary_protocol.TELEMETRY_FIELDS])
+        print(f"Wrote {len(samples)}/{reply['samples']} samples ({reply['reason']} at "
+              f"{reply['trigger_ms']} ms, saved={reply['saved']}) to {args.output}")
+
+        if args.clear and len(samples) == reply["samples"]:
+            send_action(ser, "clear")
+            reply, _ = read_reply(ser, args.timeout)
+            print(reply)
+    finally:
+        ser.close()
+
+
+if __name__ == "__main__":
+    main()
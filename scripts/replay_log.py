@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""Replay a telemetry CSV through the controller on the ESP32 (hardware in the loop).
+
+Streams the rows of a scripts/capture_telemetry.py log (or any CSV in the
+matlab_tuning/log_analysis.m column order) to the ESP32 as replay frames.
+While replaying, the firmware holds the motors off and feeds each sample to
+BalanceController::update() in place of the IMU and encoders, then compares
+its motor output with the logged one. Keep the rover on a stand.
+
+Rows go out as fast as the link and the control task take them: at most
+--window samples are in flight, paced by the "replay" status counters.
+For the same check on the host without hardware: pio run -e replay.
+
+Usage:
+    python scripts/replay_log.py rover_log.csv
+    python scripts/replay_log.py rover_log.csv --port /dev/ttyUSB0 --window 64
+"""
+
+import argparse
+import csv
+import json
+import sys
+import time
+from pathlib import Path
+
+import serial
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+from pi.serial_comm import binary_protocol
+from pi.config import SERIAL_PORT, SERIAL_BAUDRATE
+
+
+def send_action(ser, action):
+    """Send the replay command (JSON link; no handshake needed)."""
+    cmd = {"command": "replay", "parameters": {"action": action}, "priority": 0}
+    ser.write((json.dumps(cmd) + "\n").encode('utf-8'))
+    ser.flush()
+
+
+def read_reply(ser, timeout):
+    """Read the next JSON reply, skipping status prints and stray frames.
+
+    Returns:
+        Reply dict, or None on timeout
+    """
+    text = b""
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        text += ser.read(max(1, ser.in_waiting))
+        _, text, _ = binary_protocol.split_stream(text)
+        while b"\n" in text:
+            line, text = text.split(b"\n", 1)
+            try:
+                message = json.loads(line.decode('utf-8', errors='replace').strip())
+            except json.JSONDecodeError:
+                continue
+            if isinstance(message, dict) and "success" in message:
+                return message
+    return None
+
+
+def request(ser, action, timeout):
+    send_action(ser, action)
+    reply = read_reply(ser, timeout)
+    if reply is None:
+        raise RuntimeError(f"No reply to replay {action}")
+    if not reply.get("success"):
+        raise RuntimeError(f"replay {action} failed: {reply}")
+    return reply
+
+
+def wait_for(ser, condition, timeout):
+    """Poll status until condition(reply) holds.
+
+    Returns:
+        Last status reply
+    """
+    deadline = time.time() + timeout
+    while True:
+        status = request(ser, "status", timeout)
+        if condition(status) or time.time() > deadline:
+            return status
+
+
+def print_summary(status, sent):
+    print(f"Replayed {status['samples']}/{sent} samples ({status['dropped']} dropped, "
+          f"{status['gaps']} gap ticks, {status['falls']} falls)")
+    print(f"Motor output: {status['mismatches']} mismatches > {status['tolerance']}, "
+          f"max error {status['max_error']:.6f}, rms {status['rms_error']:.6f}")
+    if "first_mismatch" in status:
+        print(f"First mismatch at sample {status['first_mismatch']}")
+    print(f"BalanceController::update(): mean {status['mean_update_us']:.1f} us, "
+          f"max {status['max_update_us']} us")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", help="Telemetry CSV (capture_telemetry.py columns)")
+    parser.add_argument("--port", default=SERIAL_PORT)
+    parser.add_argument("--baudrate", type=int, default=SERIAL_BAUDRATE)
+    parser.add_argument("--window", type=int, default=64,
+                        help="Samples in flight at most (default 64, half of REPLAY_QUEUE_SIZE)")
+    parser.add_argument("--timeout", type=float, default=2.0, help="Reply timeout in seconds")
+    args = parser.parse_args()
+
+    with open(args.log, newline="") as f:
+        rows = [row for row in csv.reader(f) if row]
+    if rows and rows[0][0].strip() == "time_ms":
+        fields, rows = [name.strip() for name in rows[0]], rows[1:]  # Header row names the columns
+    else:
+        fields = binary_protocol.TELEMETRY_FIELDS
+    rows = [dict(zip(fields, row)) for row in rows]
+
+    ser = serial.Serial(args.port, args.baudrate, timeout=0.1)
+    sent = 0
+    start_time = time.time()
+    try:
+        request(ser, "start", args.timeout)
+        wait_for(ser, lambda status: status["active"], args.timeout)
+        print(f"Replaying {len(rows)} samples from {args.log} on {args.port} (motors off)")
+
+        processed = 0
+        for row in rows:
+            while sent - processed >= args.window:
+                status = request(ser, "status", args.timeout)
+                processed = status["samples"] + status["dropped"]
+            ser.write(binary_protocol.encode_replay_sample(row))
+            sent += 1
+        status = wait_for(ser, lambda s: s["samples"] + s["dropped"] >= sent, args.timeout)
+    except KeyboardInterrupt:
+        status = request(ser, "status", args.timeout)
+    finally:
+        send_action(ser, "stop")
+        ser.close()
+
+    elapsed = time.time() - start_time
+    print_summary(status, sent)
+    print(f"{elapsed:.1f} s wall time for {status['samples'] / 100.0:.1f} s of logged control")
+    return 1 if status["mismatches"] > 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
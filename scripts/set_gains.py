@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Set the ESP32 balance PID gains live (no reflash).
+
+Gains take effect at the next 100 Hz control tick. A single set applies at
+every speed; --row builds a speed-indexed table the firmware interpolates
+over |wheel speed|. --save keeps the result in flash across reboots.
+
+Gains are on the firmware's normalized scale (motor output per degree).
+Pass --matlab to convert values from matlab_tuning/pole_sweep.m (+/-255 scale).
+
+Usage:
+    python scripts/set_gains.py                            # print the active table
+    python scripts/set_gains.py --kp 0.16 --kd 0.008
+    python scripts/set_gains.py --matlab --kp 40 --ki 0.5 --kd 2.0 --save
+    python scripts/set_gains.py --row 0 0.157 0.002 0.008 --row 0.6 0.12 0.002 0.010
+    python scripts/set_gains.py --defaults --save          # back to config.h, clear flash
+"""
+
+import argparse
+import json
+import sys
+import time
+from pathlib import Path
+
+import serial
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+from pi.config import SERIAL_PORT, SERIAL_BAUDRATE
+
+MATLAB_SCALE = 255.0  # pole_sweep.m gains are per +/-255 motor units
+
+
+def build_parameters(args):
+    """Translate command-line options into "gains" command parameters."""
+    scale = 1.0 / MATLAB_SCALE if args.matlab else 1.0
+    params = {}
+    if args.defaults:
+        params["defaults"] = True
+    elif args.row:
+        params["table"] = [[speed, kp * scale, ki * scale, kd * scale]
+                           for speed, kp, ki, kd in args.row]
+    else:
+        for name in ("kp", "ki", "kd"):
+            value = getattr(args, name)
+            if value is not None:
+                params[name] = value * scale
+    if args.save:
+        params["save"] = True
+    return params
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", default=SERIAL_PORT)
+    parser.add_argument("--baudrate", type=int, default=SERIAL_BAUDRATE)
+    parser.add_argument("--kp", type=float)
+    parser.add_argument("--ki", type=float)
+    parser.add_argument("--kd", type=float)
+    parser.add_argument("--row", type=float, nargs=4, action="append", metavar=("SPEED", "KP", "KI", "KD"),
+                        help="Table row (speed in m/s, increasing); repeat for up to 4 rows")
+    parser.add_argument("--defaults", action="store_true", help="Restore the config.h gains")
+    parser.add_argument("--matlab", action="store_true", help="Gains are on the +/-255 MATLAB scale")
+    parser.add_argument("--save", action="store_true", help="Persist to flash (brief balance-loop stall)")
+    parser.add_argument("--timeout", type=float, default=2.0)
+    args = parser.parse_args()
+
+    cmd = {"command": "gains", "parameters": build_parameters(args), "priority": 0}
+    ser = serial.Serial(args.port, args.baudrate, timeout=0.1)
+    try:
+        ser.write((json.dumps(cmd) + "\n").encode('utf-8'))
+        ser.flush()
+        deadline = time.time() + args.timeout
+        while time.time() < deadline:
+            line = ser.readline().decode('utf-8', errors='replace').strip()
+            try:
+                reply = json.loads(line)
+            except json.JSONDecodeError:
+                continue  # Status prints from the ESP32
+            if isinstance(reply, dict) and "success" in reply:
+                print(json.dumps(reply))
+                sys.exit(0 if reply["success"] else 1)
+        print("No reply from ESP32")
+        sys.exit(1)
+    finally:
+        ser.close()
+
+
+if __name__ == "__main__":
+    main()
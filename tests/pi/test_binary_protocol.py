@@ -0,0 +1,284 @@
+"""Unit tests for the binary command framing (pi/serial_comm/binary_protocol.py)."""
+
+import math
+import struct
+from unittest.mock import Mock
+from pi.serial_comm import binary_protocol
+from pi.serial_comm.serial_interface import SerialInterface
+from pi.command_parser.command_schema import Command, CommandType, PRIORITY_NORMAL, PRIORITY_STOP
+
+
+class TestFrameEncoding:
+    """Frame layout and checksum tests."""
+
+    def test_crc16_check_value(self):
+        """CRC-16/CCITT-FALSE standard check value."""
+        assert binary_protocol.crc16_ccitt(b"123456789") == 0x29B1
+
+    def test_stop_frame_is_four_bytes(self):
+        """STOP has no payload: start, opcode, crc16."""
+        frame = binary_protocol.encode_command(Command(CommandType.STOP, {}, PRIORITY_STOP))
+        assert len(frame) == 4
+        assert frame[0] == binary_protocol.FRAME_START
+        assert frame[1] == binary_protocol.OP_STOP
+
+    def test_priority_stop_encodes_stop(self):
+        """Priority 100 is treated as STOP, matching the JSON path."""
+        frame = binary_protocol.encode_command(Command(CommandType.MOVE_FORWARD, {"speed": 0.5}, PRIORITY_STOP))
+        assert frame[1] == binary_protocol.OP_STOP
+
+    def test_motion_payload_round_trip(self):
+        """Encoded parameters decode to the same values."""
+        cmd = Command(CommandType.MAKE_CIRCLE, {"radius": 0.75, "direction": "right", "speed": 0.4}, PRIORITY_NORMAL)
+        frame = binary_protocol.encode_command(cmd)
+        assert len(frame) == binary_protocol.FRAME_OVERHEAD + binary_protocol.COMMAND_PAYLOAD.size
+
+        status, end, opcode, payload = binary_protocol.parse_frame(frame)
+        assert status == binary_protocol.FRAME_OK
+        assert end == len(frame)
+        assert opcode == binary_protocol.OPCODES[CommandType.MAKE_CIRCLE]
+
+        speed, duration, angle, distance, repetitions, direction, seq = binary_protocol.COMMAND_PAYLOAD.unpack(payload)
+        assert math.isclose(speed, 0.4, rel_tol=1e-6)
+        assert math.isnan(duration)
+        assert math.isnan(angle)
+        assert distance == 0.75
+        assert repetitions == 0
+        assert direction == 1
+        assert seq == 0
+
+    def test_sequence_number_in_payload(self):
+        """Command.seq travels in the last payload field."""
+        cmd = Command(CommandType.MOVE_FORWARD, {"speed": 0.4}, PRIORITY_NORMAL, seq=513)
+        _, _, _, payload = binary_protocol.parse_frame(binary_protocol.encode_command(cmd))
+        assert binary_protocol.COMMAND_PAYLOAD.size == 20
+        assert binary_protocol.COMMAND_PAYLOAD.unpack(payload)[-1] == 513
+
+    def test_non_numeric_speed_falls_back_to_json(self):
+        """Invalid speed is left for the ESP32 to reject with a JSON error."""
+        cmd = Command(CommandType.MOVE_FORWARD, {"speed": "fast"}, PRIORITY_NORMAL)
+        assert binary_protocol.encode_command(cmd) is None
+
+    def test_no_opcode_falls_back_to_json(self):
+        """Diagnostic commands stay on JSON."""
+        assert binary_protocol.encode_command(Command(CommandType.STATS, {}, PRIORITY_NORMAL)) is None
+
+    def test_binary_frame_smaller_than_json(self):
+        """STOP frame is a fraction of the JSON line."""
+        interface = SerialInterface(port="/dev/ttyUSB0")
+        cmd = Command(CommandType.STOP, {}, PRIORITY_STOP)
+        json_len = len(interface._serialize_command(cmd).encode('utf-8'))
+        assert len(binary_protocol.encode_command(cmd)) * 10 <= json_len
+
+
+class TestFrameParsing:
+    """Frame parsing tests."""
+
+    def test_corrupt_crc_rejected(self):
+        """Single bit error is detected."""
+        frame = bytearray(binary_protocol.encode_frame(binary_protocol.OP_RESPONSE, binary_protocol.RESPONSE_PAYLOAD.pack(1, 0x05, 0, 0, 0)))
+        frame[2] ^= 0x01
+        status, _, _, _ = binary_protocol.parse_frame(bytes(frame))
+        assert status == binary_protocol.FRAME_INVALID
+
+    def test_incomplete_frame(self):
+        """Partial frame waits for more bytes."""
+        frame = binary_protocol.encode_frame(binary_protocol.OP_RESPONSE, binary_protocol.RESPONSE_PAYLOAD.pack(1, 0x05, 0, 0, 0))
+        status, _, _, _ = binary_protocol.parse_frame(frame[:-1])
+        assert status == binary_protocol.FRAME_INCOMPLETE
+
+    def test_decode_response(self):
+        """Response frame maps to the JSON response shape."""
+        response = binary_protocol.decode_frame(binary_protocol.OP_RESPONSE, struct.pack("<BBBHH", 1, 0x05, 0, 0, 0))
+        assert response == {"success": True, "command": "stop", "code": 0}
+
+    def test_decode_sequenced_response(self):
+        """Sequence number and cumulative ACK are decoded when present."""
+        payload = struct.pack("<BBBHH", 0, 0x01, 13, 7, 5)
+        response = binary_protocol.decode_frame(binary_protocol.OP_RESPONSE, payload)
+        assert response == {"success": False, "command": "move_forward", "code": 13, "seq": 7, "ack": 5}
+
+
+class TestSerialInterfaceBinary:
+    """SerialInterface behaviour with binary framing."""
+
+    def setup_method(self):
+        self.interface = SerialInterface(port="/dev/ttyUSB0", baudrate=115200)
+        self.interface.logger = Mock()
+        self.interface._connected = True
+        self.interface._serial = Mock()
+        self.interface._serial.is_open = True
+
+    def test_send_uses_frames_in_binary_mode(self):
+        """Commands are written as frames once binary mode is on."""
+        self.interface._binary_mode = True
+        assert self.interface.send_command(Command(CommandType.STOP, {}, PRIORITY_STOP))
+        written = self.interface._serial.write.call_args[0][0]
+        assert written == binary_protocol.encode_frame(binary_protocol.OP_STOP)
+
+    def test_send_uses_json_by_default(self):
+        """JSON remains the default link format."""
+        assert self.interface.send_command(Command(CommandType.STOP, {}, PRIORITY_STOP))
+        written = self.interface._serial.write.call_args[0][0]
+        assert written.endswith(b"\n")
+
+    def test_mixed_stream(self):
+        """JSON lines and frames are read back in arrival order."""
+        frame = binary_protocol.encode_frame(binary_protocol.OP_RESPONSE,
+                                             binary_protocol.RESPONSE_PAYLOAD.pack(1, 0x01, 0, 0, 0))
+        self.interface._read_buffer = b'{"success": false}\n' + frame + b'{"success": true}\n'
+        self.interface._serial.in_waiting = 0
+
+        assert self.interface.read_response(blocking=False) == {"success": False}
+        assert self.interface.read_response(blocking=False) == {"success": True, "command": "move_forward", "code": 0}
+        assert self.interface.read_response(blocking=False) == {"success": True}
+        assert self.interface._read_buffer == b""
+
+    def test_stray_start_byte_skipped(self):
+        """Garbage start byte does not block the following JSON line."""
+        self.interface._read_buffer = bytes([binary_protocol.FRAME_START]) + b'{"success": true}\n'
+        self.interface._serial.in_waiting = 0
+
+        assert self.interface.read_response(blocking=False) == {"success": True}
+
+    def test_handshake_rejected_stays_json(self):
+        """Old firmware rejects binary_mode: link stays on JSON."""
+        self.interface._serial.in_waiting = 0
+        self.interface._read_buffer = b'{"success": false, "message": "Unknown command: binary_mode"}\n'
+        assert not self.interface.enable_binary_mode(timeout=0.1)
+        assert not self.interface.is_binary_mode()
+
+    def test_handshake_accepted(self):
+        """Handshake reply with protocol version enables binary mode."""
+        self.interface._serial.in_waiting = 0
+        self.interface._read_buffer = b'{"success": true, "protocol": 4}\n'
+        assert self.interface.enable_binary_mode(timeout=0.1)
+        assert self.interface.is_binary_mode()
+
+    def test_handshake_old_protocol_stays_json(self):
+        """Firmware speaking an older frame layout is not switched to binary."""
+        self.interface._serial.in_waiting = 0
+        self.interface._read_buffer = b'{"success": true, "protocol": 3}\n'
+        assert not self.interface.enable_binary_mode(timeout=0.1)
+        assert not self.interface.is_binary_mode()
+
+
+class TestTelemetry:
+    """Telemetry frame decoding and stream handling."""
+
+    def setup_method(self):
+        self.interface = SerialInterface(port="/dev/ttyUSB0", baudrate=115200)
+        self.interface.logger = Mock()
+        self.interface._connected = True
+        self.interface._serial = Mock()
+        self.interface._serial.is_open = True
+        self.interface._serial.in_waiting = 0
+
+    def _frame(self, time_ms):
+        payload = binary_protocol.TELEMETRY_SAMPLE.pack(time_ms, 1.5, -2.0, 40.0, 10.0, 0.0, 12, -12, 850, 10000, 3.5, 0.75, -0.5, 90.0)
+        return binary_protocol.encode_frame(binary_protocol.OP_TELEMETRY, payload)
+
+    def test_sample_size_matches_firmware(self):
+        """Payload size mirrors FRAME_TELEMETRY_PAYLOAD_SIZE (52)."""
+        assert binary_protocol.TELEMETRY_SAMPLE.size == 52
+
+    def test_decode_telemetry(self):
+        """Fields decode by name in CSV column order."""
+        _, _, _, payload = binary_protocol.parse_frame(self._frame(1234))
+        sample = binary_protocol.decode_telemetry(payload)
+        assert list(sample.keys())[:6] == ["time_ms", "angle", "angular_velocity", "motor_output",
+                                           "velocity_setpoint", "rotation_setpoint"]
+        assert sample["time_ms"] == 1234
+        assert sample["left_position"] == 12
+        assert sample["tick_us"] == 850
+        assert sample["wheel_velocity"] == 3.5
+        assert (sample["x"], sample["y"], sample["heading"]) == (0.75, -0.5, 90.0)
+
+    def test_telemetry_not_returned_as_response(self):
+        """Streamed samples go to the callback; responses still come through."""
+        samples = []
+        self.interface.set_telemetry_callback(samples.append)
+        self.interface._read_buffer = self._frame(1) + b'{"success": true}\n' + self._frame(2)
+
+        assert self.interface.read_response(blocking=False) == {"success": True}
+        assert self.interface.read_response(blocking=False) is None
+        assert [s["time_ms"] for s in samples] == [1, 2]
+        assert self.interface._read_buffer == b""
+
+    def test_pose_from_telemetry(self):
+        """The last streamed sample's odometry pose is kept without a callback."""
+        assert self.interface.get_pose() is None
+        self.interface._read_buffer = self._frame(1)
+
+        assert self.interface.read_response(blocking=False) is None
+        assert self.interface.get_pose() == (0.75, -0.5, 90.0)
+
+
+class TestFlightRecorder:
+    """Flight recorder dump frames and stream splitting."""
+
+    def _frame(self, time_ms):
+        payload = binary_protocol.TELEMETRY_SAMPLE.pack(time_ms, 30.0, 90.0, 0.0, 0.0, 0.0, 5, 5, 900, 10000, 0.0, 0.0, 0.0, 0.0)
+        return binary_protocol.encode_frame(binary_protocol.OP_RECORDER, payload)
+
+    def test_split_stream_separates_text_and_frames(self):
+        """Reply line and dump frames are pulled apart; a partial frame stays buffered."""
+        partial = self._frame(3)[:10]
+        buffer = b'{"success": true, "samples": 2}\r\n' + self._frame(1) + self._frame(2) + partial
+        frames, text, remaining = binary_protocol.split_stream(buffer)
+
+        assert [binary_protocol.decode_telemetry(p)["time_ms"] for _, p in frames] == [1, 2]
+        assert all(opcode == binary_protocol.OP_RECORDER for opcode, _ in frames)
+        assert text == b'{"success": true, "samples": 2}\r\n'
+        assert remaining == partial
+
+    def test_split_stream_skips_corrupt_frame(self):
+        """A corrupt frame is dropped without losing the next one."""
+        bad = bytearray(self._frame(1))
+        bad[5] ^= 0xFF
+        frames, _, remaining = binary_protocol.split_stream(bytes(bad) + self._frame(2))
+
+        assert [binary_protocol.decode_telemetry(p)["time_ms"] for _, p in frames] == [2]
+        assert remaining == b""
+
+    def test_recorder_frames_not_returned_as_response(self):
+        """SerialInterface skips dump frames instead of treating them as responses."""
+        interface = SerialInterface(port="/dev/ttyUSB0", baudrate=115200)
+        interface.logger = Mock()
+        interface._connected = True
+        interface._serial = Mock()
+        interface._serial.is_open = True
+        interface._serial.in_waiting = 0
+        interface._read_buffer = self._frame(1) + b'{"success": true}\n'
+
+        assert interface.read_response(blocking=False) == {"success": True}
+        assert interface._read_buffer == b""
+
+
+class TestReplay:
+    """Log replay frames (scripts/replay_log.py)."""
+
+    def test_csv_row_round_trip(self):
+        """A capture_telemetry.py row encodes to the TelemetrySample layout."""
+        row = dict(zip(binary_protocol.TELEMETRY_FIELDS,
+                       ["1230", "1.5", "-2.0", "0.25", "0.4", "0.0", "12", "-12", "850", "10000", "3.5"]))
+        status, _, opcode, payload = binary_protocol.parse_frame(binary_protocol.encode_replay_sample(row))
+
+        assert status == binary_protocol.FRAME_OK
+        assert opcode == binary_protocol.OP_REPLAY_SAMPLE
+        sample = binary_protocol.decode_telemetry(payload)
+        assert sample["time_ms"] == 1230
+        assert sample["motor_output"] == 0.25
+        assert sample["right_position"] == -12
+        assert sample["wheel_velocity"] == 3.5
+
+    def test_log_analysis_columns_only(self):
+        """Six-column logs: extras are zero, wheel velocity NaN (derived on the ESP32)."""
+        row = {"time_ms": 10, "angle": 1.0, "angular_velocity": 0.0, "motor_output": 0.1,
+               "velocity_setpoint": 0.0, "rotation_setpoint": 0.0}
+        _, _, _, payload = binary_protocol.parse_frame(binary_protocol.encode_replay_sample(row))
+        sample = binary_protocol.decode_telemetry(payload)
+
+        assert sample["left_position"] == 0
+        assert sample["interval_us"] == 0
+        assert math.isnan(sample["wheel_velocity"])
@@ -0,0 +1,88 @@
+"""Unit tests for motion program compilation (pi/command_parser/program_compiler.py)."""
+
+import re
+from pathlib import Path
+
+from pi.command_parser import program_compiler
+from pi.command_parser.command_schema import Command, CommandType, PRIORITY_NORMAL, PRIORITY_STOP
+
+
+def _steps(command):
+    data = bytes.fromhex(command.parameters["steps"])
+    return [program_compiler.PROGRAM_STEP.unpack_from(data, i)
+            for i in range(0, len(data), program_compiler.PROGRAM_STEP.size)]
+
+
+class TestEncodeStep:
+    """Segment encoding shared with decodeProgramStep() on the ESP32."""
+
+    def test_layout(self):
+        """Kind, drive and turn share the first byte; target is in hundredths."""
+        step = program_compiler.encode_step(program_compiler.SEGMENT_ANGLE, 0, -1, 90.0, 0.4)
+        assert step == bytes([0x02 | (0x03 << 4), 40]) + (9000).to_bytes(2, "little")
+
+    def test_moving_step_never_zero_speed(self):
+        """Speed 0 means "program speed" on the ESP32, so moving steps keep at least 1%."""
+        header, speed, target = program_compiler.PROGRAM_STEP.unpack(
+            program_compiler.encode_step(program_compiler.SEGMENT_TIMED, 1, 0, 1.0, 0.0))
+        assert speed == 1
+
+    def test_max_steps_matches_firmware(self):
+        """MAX_PROGRAM_STEPS mirrors PROGRAM_MAX_STEPS in config.h."""
+        config = (Path(__file__).parents[2] / "esp32" / "include" / "config.h").read_text()
+        assert int(re.search(r"#define PROGRAM_MAX_STEPS (\d+)", config).group(1)) == \
+            program_compiler.MAX_PROGRAM_STEPS
+
+
+class TestCompileCommands:
+    """Merging parsed commands into programs."""
+
+    def test_run_becomes_one_program(self):
+        """Bounded motions in a row are uploaded once."""
+        commands = [
+            Command(CommandType.TURN_LEFT, {"angle": 45.0, "speed": 0.4}, PRIORITY_NORMAL),
+            Command(CommandType.MOVE_FORWARD_FOR_TIME, {"duration": 2.0, "speed": 0.6}, PRIORITY_NORMAL),
+            Command(CommandType.SPIN, {"duration": 1.5, "speed": 0.5}, PRIORITY_NORMAL),
+        ]
+        result = program_compiler.compile_commands(commands)
+        assert len(result) == 1
+        assert result[0].command_type == CommandType.PROGRAM
+        assert _steps(result[0]) == [
+            (0x02 | (0x03 << 4), 40, 4500),  # Angle, counterclockwise
+            (0x00 | (0x01 << 2), 60, 200),   # Timed, forward
+            (0x00 | (0x01 << 4), 50, 150),   # Timed, clockwise
+        ]
+
+    def test_open_ended_and_builtin_pass_through(self):
+        """Setpoint primitives and flash routines split runs and stay as they are."""
+        forward = Command(CommandType.MOVE_FORWARD, {"speed": 0.4}, PRIORITY_NORMAL)
+        square = Command(CommandType.MAKE_SQUARE, {"side_length": 0.5, "speed": 0.4}, PRIORITY_NORMAL)
+        turn = Command(CommandType.TURN_RIGHT, {"angle": 90.0, "speed": 0.4}, PRIORITY_NORMAL)
+        result = program_compiler.compile_commands([forward, turn, square, turn])
+        assert result == [forward, turn, square, turn]
+
+    def test_single_command_not_wrapped(self):
+        """A lone bounded command is sent under its own name."""
+        turn = Command(CommandType.TURN_RIGHT, {"angle": 90.0}, PRIORITY_NORMAL)
+        assert program_compiler.compile_commands([turn]) == [turn]
+
+    def test_stop_splits_run(self):
+        """STOP keeps its place and is never folded into a program."""
+        turn = Command(CommandType.TURN_RIGHT, {}, PRIORITY_NORMAL)
+        stop = Command(CommandType.STOP, {}, PRIORITY_STOP)
+        result = program_compiler.compile_commands([turn, turn, stop, turn])
+        assert [c.command_type for c in result] == [CommandType.PROGRAM, CommandType.STOP, CommandType.TURN_RIGHT]
+
+    def test_long_run_split(self):
+        """Runs longer than the ESP32 slot become several programs."""
+        turn = Command(CommandType.TURN_RIGHT, {}, PRIORITY_NORMAL)
+        result = program_compiler.compile_commands([turn] * (program_compiler.MAX_PROGRAM_STEPS + 3))
+        assert [len(_steps(c)) for c in result] == [program_compiler.MAX_PROGRAM_STEPS, 3]
+
+    def test_program_fits_command_line(self):
+        """A full program, sequenced, stays under SERIAL_MAX_LINE_LENGTH (256)."""
+        import json
+        turn = Command(CommandType.TURN_RIGHT, {}, PRIORITY_NORMAL)
+        program = program_compiler.compile_commands([turn] * program_compiler.MAX_PROGRAM_STEPS)[0]
+        program.seq = 65535
+        assert len(json.dumps(program.to_json())) + 1 <= 256
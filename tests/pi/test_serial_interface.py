@@ -2,11 +2,15 @@
 
 import pytest
 import json
+import re
+import threading
 import time
+from pathlib import Path
 from unittest.mock import Mock, patch, MagicMock, call
 import serial
-from pi.serial_comm.serial_interface import SerialInterface
-from pi.command_parser.command_schema import Command, CommandType, PRIORITY_STOP, PRIORITY_NORMAL
+from pi.serial_comm import binary_protocol
+from pi.serial_comm.serial_interface import SerialInterface, _Framer
+from pi.command_parser.command_schema import Command, CommandType, ResponseCode, PRIORITY_STOP, PRIORITY_NORMAL
 
 
 class TestSerialInterface:
@@ -362,3 +366,363 @@ class TestSerialInterface:
         
         assert all(results)
         assert len(results) == 30
+
+
+class TestResponseCodes:
+    """Numeric response codes shared with the firmware."""
+
+    HEADER = Path(__file__).parents[2] / "esp32" / "src" / "command_handler" / "response_codes.h"
+
+    def test_codes_mirror_firmware(self):
+        """Every RESPONSE_* value in response_codes.h has the same name and value here."""
+        firmware = {name: int(value) for name, value in
+                    re.findall(r"RESPONSE_(\w+) = (\d+)", self.HEADER.read_text())}
+        assert firmware == {code.name: code.value for code in ResponseCode}
+
+    def test_clamped_reply_decodes(self):
+        """A non-verbose reply carries the code and numeric fields only."""
+        interface = SerialInterface(port="/dev/ttyUSB0", baudrate=115200)
+        interface._connected = True
+        interface._serial = Mock()
+        interface._serial.in_waiting = 0
+        interface._read_buffer = b'{"success":true,"code":1,"speed":1.00,"requested":1.50}\r\n'
+
+        response = interface.read_response(blocking=False)
+        assert ResponseCode(response["code"]) is ResponseCode.CLAMPED
+        assert response["requested"] == 1.5
+
+
+class FakeSequencedEsp:
+    """Serial stand-in that answers like the firmware's go-back-N receiver.
+
+    Set drop_next to lose the next n commands on the wire (never seen by the ESP32).
+    Like the firmware, sequenced commands after a STOP are dropped until the next sync.
+    """
+
+    def __init__(self, window=16):
+        self.window = window
+        self.is_open = True
+        self.ack = 0
+        self.sequenced = False
+        self.executed = []
+        self.drop_next = 0
+        self.stopped = False
+        self.wire = []  # Command names in the order written, lost ones included
+        self._outbound = b""
+
+    @property
+    def in_waiting(self):
+        return len(self._outbound)
+
+    def read(self, size):
+        data, self._outbound = self._outbound[:size], self._outbound[size:]
+        return data
+
+    def flush(self):
+        pass
+
+    def write(self, data):
+        for line in data.decode().splitlines():
+            self.wire.append(json.loads(line)["command"])
+            if self.drop_next:
+                self.drop_next -= 1
+                continue
+            self._receive(json.loads(line))
+
+    def _reply(self, **fields):
+        self._outbound += (json.dumps(fields) + "\r\n").encode()
+
+    def _receive(self, message):
+        name = message["command"]
+        if name == "sync":
+            self.sequenced, self.ack, self.stopped = True, 0, False
+            self._reply(success=True, code=0, ack=0, window=self.window)
+            return
+        seq = message.get("seq", 0)
+        if name == "stop" or not seq:
+            self.executed.append((name, seq))
+            self.stopped = self.stopped or (name == "stop" and self.sequenced)
+            self._reply(success=True, code=0, **({"ack": self.ack} if self.sequenced else {}))
+        elif self.stopped:
+            self._reply(success=False, code=ResponseCode.OUT_OF_ORDER, seq=seq, ack=self.ack)
+        elif seq == self.ack + 1:
+            self.executed.append((name, seq))
+            self.ack = seq
+            self._reply(success=True, code=0, seq=seq, ack=self.ack)
+        elif seq <= self.ack:
+            self._reply(success=True, code=ResponseCode.DUPLICATE, seq=seq, ack=self.ack)
+        else:
+            self._reply(success=False, code=ResponseCode.OUT_OF_ORDER, seq=seq, ack=self.ack)
+
+
+class TestPipelining:
+    """Sequenced, windowed command transport."""
+
+    def setup_method(self):
+        self.esp = FakeSequencedEsp()
+        self.interface = SerialInterface(port="/dev/ttyUSB0", baudrate=115200, window=4)
+        self.interface.logger = Mock()
+        self.interface._connected = True
+        self.interface._serial = self.esp
+
+    def _move(self, speed=0.4):
+        return Command(CommandType.MOVE_FORWARD, {"speed": speed}, PRIORITY_NORMAL)
+
+    def test_sync_caps_window(self):
+        """Handshake switches on sequencing and never exceeds the ESP32 queue size."""
+        self.esp.window = 2
+        assert self.interface.enable_pipelining(timeout=0.1)
+        assert self.interface.is_pipelined()
+        assert self.interface.window == 2
+
+    def test_old_firmware_stays_stop_and_wait(self):
+        """Firmware that does not know "sync" leaves the link unsequenced."""
+        self.interface._serial = Mock()
+        self.interface._serial.in_waiting = 0
+        self.interface._read_buffer = b'{"success":false,"code":4}\r\n'
+        assert not self.interface.enable_pipelining(timeout=0.1)
+        assert not self.interface.is_pipelined()
+
+    def test_window_sent_before_first_reply(self):
+        """A burst of commands goes out without waiting for replies, in order."""
+        self.interface.enable_pipelining(timeout=0.1)
+        for _ in range(4):
+            assert self.interface.send_command(self._move())
+        assert [seq for _, seq in self.esp.executed] == [1, 2, 3, 4]
+
+        responses = [self.interface.read_response(timeout=0.1) for _ in range(4)]
+        assert [r["seq"] for r in responses] == [1, 2, 3, 4]
+        assert self.interface.in_flight() == 0
+
+    def test_lost_command_resent_go_back_n(self):
+        """A dropped command is NAKed by its successor and everything after ack is resent."""
+        self.interface.enable_pipelining(timeout=0.1)
+        self.interface.send_command(self._move())
+        self.esp.drop_next = 1
+        self.interface.send_command(self._move())
+        self.interface.send_command(self._move())
+
+        assert self.interface.wait_for_acks(timeout=1.0)
+        assert [seq for _, seq in self.esp.executed] == [1, 2, 3]
+        responses = [self.interface.read_response(timeout=0.1) for _ in range(3)]
+        assert [r["seq"] for r in responses] == [1, 2, 3]
+        assert all(r["success"] for r in responses)
+
+    def test_lost_reply_covered_by_cumulative_ack(self):
+        """A missing reply is implied by the next ACK and reported as a stand-in."""
+        self.interface.enable_pipelining(timeout=0.1)
+        self.interface.send_command(self._move())
+        self.interface.send_command(self._move())
+        self.esp._outbound = self.esp._outbound.split(b"\r\n", 1)[1]  # Lose the reply to seq 1
+
+        first = self.interface.read_response(timeout=0.1)
+        second = self.interface.read_response(timeout=0.1)
+        assert first == {"success": None, "seq": 1, "ack": 2}
+        assert second["seq"] == 2 and second["success"]
+
+    def test_duplicate_not_executed_twice(self):
+        """A resend the ESP32 already acknowledged is swallowed, not re-run."""
+        self.interface.enable_pipelining(timeout=0.1)
+        self.interface.send_command(self._move())
+        self.interface.read_response(timeout=0.1)
+        self.esp.write((json.dumps({"command": "move_forward", "parameters": {"speed": 0.4},
+                                    "priority": 0, "seq": 1}) + "\n").encode())
+
+        assert self.interface.read_response(blocking=False) is None
+        assert len(self.esp.executed) == 1
+
+    def test_stop_unsequenced_and_restarts_numbering(self):
+        """STOP bypasses sequencing; the next command re-syncs and starts at 1."""
+        self.interface.enable_pipelining(timeout=0.1)
+        self.interface.send_command(self._move())
+        self.interface.read_response(timeout=0.1)
+
+        assert self.interface.send_command(Command(CommandType.STOP, {}, PRIORITY_STOP))
+        assert self.esp.executed[-1] == ("stop", 0)
+        assert self.interface.read_response(timeout=0.1)["success"]
+
+        self.interface.send_command(self._move())
+        assert self.esp.executed[-1] == ("move_forward", 1)
+
+    def test_stop_cuts_resend_burst(self):
+        """Resends never follow a STOP another thread wrote mid-burst."""
+        self.interface.enable_pipelining(timeout=0.1)
+        self.esp.drop_next = 3
+        for _ in range(3):
+            self.interface.send_command(self._move())
+        with self.interface._lock:  # Pumping thread busy: STOP bookkeeping is deferred
+            assert self.interface.send_stop()
+            self.interface._go_back_n("ACK timeout", holdoff=0.0)
+        assert self.esp.wire[-1] == "stop"  # Nothing resent behind it
+        assert self.esp.executed == [("stop", 0)]
+        assert self.interface.in_flight() == 0
+        cancelled = [self.interface.read_response(timeout=0.1) for _ in range(3)]
+        assert all(r["error"] == "cancelled by STOP" for r in cancelled)
+
+        self.interface.send_command(self._move())  # Re-syncs first
+        assert self.esp.executed[-1] == ("move_forward", 1)
+
+    def test_esp_reboot_renumbers(self):
+        """NAK whose ack does not match what was sent triggers a resync and resend."""
+        self.interface.enable_pipelining(timeout=0.1)
+        for _ in range(3):
+            self.interface.send_command(self._move())
+            self.interface.read_response(timeout=0.1)
+        self.esp.ack = 0  # Rebooted: sequencing reset, expects 1
+
+        self.interface.send_command(self._move())  # Goes out as seq 4
+        assert self.interface.wait_for_acks(timeout=1.0)
+        assert self.esp.executed[-1] == ("move_forward", 1)
+        assert self.interface.read_response(timeout=0.1)["seq"] == 1
+
+
+class ThreadedFakeEsp(FakeSequencedEsp):
+    """FakeSequencedEsp whose read() blocks like a port with a timeout."""
+
+    def __init__(self, window=16):
+        super().__init__(window)
+        self._ready = threading.Condition()
+
+    def read(self, size):
+        with self._ready:
+            if not self._outbound:
+                self._ready.wait(0.05)
+            return super().read(size)
+
+    def write(self, data):
+        with self._ready:
+            super().write(data)
+            self._ready.notify_all()
+
+    def push(self, data):
+        """Bytes the ESP32 sends unprompted (telemetry, status text)."""
+        with self._ready:
+            self._outbound += data
+            self._ready.notify_all()
+
+
+def _telemetry_frame(time_ms=1000):
+    payload = binary_protocol.TELEMETRY_SAMPLE.pack(time_ms, 1.5, -2.0, 40.0, 10.0, 0.0, 12, -12, 850, 10000,
+                                                    3.5, 0.75, -0.5, 90.0)
+    return binary_protocol.encode_frame(binary_protocol.OP_TELEMETRY, payload)
+
+
+class TestReaderThread:
+    """Reads, ACKs and callbacks driven by the SerialReader thread."""
+
+    def setup_method(self):
+        self.esp = ThreadedFakeEsp()
+        self.interface = SerialInterface(port="/dev/ttyUSB0", baudrate=115200, window=4)
+        self.interface.logger = Mock()
+        self.interface._connected = True
+        self.interface._serial = self.esp
+        self.interface.start_reader()
+
+    def teardown_method(self):
+        self.interface.stop_reader()
+
+    def _move(self):
+        return Command(CommandType.MOVE_FORWARD, {"speed": 0.4}, PRIORITY_NORMAL)
+
+    def test_reply_delivered_by_reader(self):
+        """read_response() waits on the reader instead of polling the port."""
+        assert self.interface.is_reader_running()
+        assert self.interface.send_command(self._move())
+        response = self.interface.read_response(timeout=1.0)
+        assert response["success"]
+        assert self.esp._outbound == b""
+
+    def test_pipelined_window_through_reader(self):
+        """A burst larger than the window drains as the reader takes in ACKs."""
+        assert self.interface.enable_pipelining(timeout=1.0)
+        for _ in range(8):
+            assert self.interface.send_command(self._move())
+        assert self.interface.wait_for_acks(timeout=1.0)
+        assert [seq for _, seq in self.esp.executed] == list(range(1, 9))
+
+    def test_subscribers_get_telemetry_and_responses(self):
+        """Telemetry and replies reach subscribers without anyone reading."""
+        samples, replies = threading.Event(), []
+        self.interface.subscribe("telemetry", lambda sample: samples.set())
+        unsubscribe = self.interface.subscribe("response", replies.append)
+
+        self.esp.push(_telemetry_frame())
+        self.interface.send_command(self._move())
+        assert samples.wait(1.0)
+        deadline = time.time() + 1.0
+        while not replies and time.time() < deadline:
+            time.sleep(0.01)
+        assert replies and replies[0]["success"]
+        assert self.interface.read_response(timeout=1.0)["success"]  # Still queued for the reader of replies
+
+        unsubscribe()
+        self.interface.send_command(self._move())
+        self.interface.read_response(timeout=1.0)
+        assert len(replies) == 1
+
+    def test_unknown_topic_rejected(self):
+        with pytest.raises(ValueError):
+            self.interface.subscribe("status", print)
+
+    def test_stop_not_blocked_by_lock_holder(self):
+        """STOP goes out while another thread holds the interface lock."""
+        with self.interface._lock:
+            sender = threading.Thread(target=self.interface.send_command,
+                                      args=(Command(CommandType.STOP, {}, PRIORITY_STOP),))
+            sender.start()
+            sender.join(1.0)
+            assert not sender.is_alive()
+            assert self.esp.executed[-1] == ("stop", 0)
+
+    def test_stop_cancels_send_waiting_for_window(self):
+        """A command waiting for window room is dropped once STOP is sent."""
+        self.esp.window = 1
+        assert self.interface.enable_pipelining(timeout=1.0)
+        self.esp.drop_next = 100  # Nothing is ACKed, so the window stays full
+        assert self.interface.send_command(self._move())
+        results = []
+        sender = threading.Thread(target=lambda: results.append(self.interface.send_command(self._move())))
+        sender.start()
+        time.sleep(0.05)
+        self.esp.drop_next = 0
+        assert self.interface.send_stop()
+        sender.join(1.0)
+        assert results == [False]
+        assert self.esp.executed[-1] == ("stop", 0)
+        assert self.interface.in_flight() == 0
+
+
+class TestFramer:
+    """Byte stream framing shared by the reader thread and polling."""
+
+    def test_burst_of_lines_and_frames(self):
+        framer = _Framer()
+        frame = _telemetry_frame()
+        framer.feed(b'{"a":1}\r\n' + frame + b'{"b":2}\r\n')
+        assert framer.pop() == (_Framer.LINE, 0, b'{"a":1}\r')
+        kind, opcode, _ = framer.pop()
+        assert (kind, opcode) == (_Framer.FRAME, binary_protocol.OP_TELEMETRY)
+        assert framer.pop() == (_Framer.LINE, 0, b'{"b":2}\r')
+        assert framer.pop() is None
+        assert framer.pending() == b""
+
+    def test_frame_split_across_reads(self):
+        framer = _Framer()
+        frame = _telemetry_frame()
+        framer.feed(frame[:10])
+        assert framer.pop() is None
+        framer.feed(frame[10:])
+        assert framer.pop()[0] == _Framer.FRAME
+
+    def test_frame_inside_partial_line(self):
+        """A frame that interrupts a text line is taken out; the line stays whole."""
+        framer = _Framer()
+        framer.feed(b'{"a":' + _telemetry_frame() + b'1}\n')
+        assert framer.pop()[0] == _Framer.FRAME
+        assert framer.pop() == (_Framer.LINE, 0, b'{"a":1}')
+
+    def test_stray_start_byte_dropped(self):
+        framer = _Framer()
+        framer.feed(bytes([binary_protocol.FRAME_START, 0xFF, 0, 0, 0]) + b'ok\n')
+        assert framer.pop() == (_Framer.INVALID, 0xFF, b"")
+        assert framer.pop() == (_Framer.LINE, 0, b'\xff\x00\x00\x00ok')